@@ -72,6 +72,16 @@ MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_PutBlock,
         unsigned int*, httpStatus,
         BUFFER_HANDLE, httpResponse)
 
+/**
+* @brief  Adds the ID of a block uploaded earlier (e.g. before a restart) to a block ID list, without uploading it again
+*
+* @param  blockIDList         The list where to store the block IDs
+* @param  blockID             The block id (from 00000 to 49999)
+*/
+MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_AddUploadedBlockId,
+        SINGLYLINKEDLIST_HANDLE, blockIDList,
+        unsigned int, blockID)
+
 /**
 * @brief  Synchronously sends a put block list request to Azure Storage
 *
@@ -87,6 +97,19 @@ MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_PutBlockList,
     SINGLYLINKEDLIST_HANDLE, blockIDList,
     unsigned int*, httpStatus,
     BUFFER_HANDLE, httpResponse)
+
+/**
+* @brief  Same as Blob_PutBlockList, also setting the Content-Encoding the blob is served with
+*
+* @param  contentEncoding     Value of the blob's Content-Encoding (e.g. "gzip"), or NULL to leave it unset
+*/
+MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_PutBlockListWithContentEncoding,
+    HTTPAPIEX_HANDLE, httpApiExHandle,
+    const char*, relativePath,
+    SINGLYLINKEDLIST_HANDLE, blockIDList,
+    const char*, contentEncoding,
+    unsigned int*, httpStatus,
+    BUFFER_HANDLE, httpResponse)
 #ifdef __cplusplus
 }
 #endif
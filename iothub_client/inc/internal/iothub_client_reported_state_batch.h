@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file   iothub_client_reported_state_batch.h
+*    @brief  The @c reported_state_batch merges pending reported properties patches into a single patch,
+*            so that a device reporting at a high rate sends one twin update per flush instead of one per call.
+*/
+
+#ifndef IOTHUB_CLIENT_REPORTED_STATE_BATCH_H
+#define IOTHUB_CLIENT_REPORTED_STATE_BATCH_H
+
+#include "umock_c/umock_c_prod.h"
+
+#include "iothub_client_core_common.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdbool.h>
+#endif
+
+typedef struct REPORTED_STATE_BATCH_INSTANCE_TAG* REPORTED_STATE_BATCH_HANDLE;
+
+MOCKABLE_FUNCTION(, REPORTED_STATE_BATCH_HANDLE, reported_state_batch_create);
+MOCKABLE_FUNCTION(, void, reported_state_batch_destroy, REPORTED_STATE_BATCH_HANDLE, batch);
+
+/**
+    * @brief    Merges a reported properties patch into the pending one. A property written by a later patch
+    *           replaces the value written by an earlier one; nested objects are merged property by property.
+    *
+    * @param    batch                   Handle returned by @c reported_state_batch_create.
+    * @param    reportedState           The reported properties patch, a JSON object (not NULL-terminated).
+    * @param    size                    Size of @p reportedState.
+    * @param    reportedStateCallback   Called with the status of the merged patch once it completes. Can be NULL.
+    * @param    userContextCallback     Context passed to @p reportedStateCallback.
+    *
+    * @return   0 on success, non-zero if @p reportedState is not a JSON object or could not be merged.
+    */
+MOCKABLE_FUNCTION(, int, reported_state_batch_add, REPORTED_STATE_BATCH_HANDLE, batch, const unsigned char*, reportedState, size_t, size, IOTHUB_CLIENT_REPORTED_STATE_CALLBACK, reportedStateCallback, void*, userContextCallback);
+
+/**
+    * @brief    Tells whether @p reportedState must not be merged into the pending patch, because the merged patch would
+    *           not have the same effect as the pending patch followed by @p reportedState. That is the case when a
+    *           property, at any depth, is an object in one of them and not in the other (e.g. null). The pending
+    *           patch must then be flushed before adding @p reportedState.
+    *
+    * @return   true if the pending patch must be flushed first, false otherwise (including when nothing is pending).
+    */
+MOCKABLE_FUNCTION(, bool, reported_state_batch_conflicts, REPORTED_STATE_BATCH_HANDLE, batch, const unsigned char*, reportedState, size_t, size);
+
+/** @brief  Returns the number of reported properties patches merged since the last flush. */
+MOCKABLE_FUNCTION(, size_t, reported_state_batch_get_count, REPORTED_STATE_BATCH_HANDLE, batch);
+
+/** @brief  Returns the size in bytes the pending patch will have once serialized. */
+MOCKABLE_FUNCTION(, size_t, reported_state_batch_get_size, REPORTED_STATE_BATCH_HANDLE, batch);
+
+/**
+    * @brief    Serializes the pending patch and starts a new one.
+    *
+    * @param    batch               Handle returned by @c reported_state_batch_create.
+    * @param    reportedState       Receives the merged patch. It is owned by the batch and valid until the next call.
+    * @param    size                Receives the size of @p reportedState.
+    * @param    completionContext   Receives the context to pass to @c reported_state_batch_complete once the
+    *                               merged patch completes.
+    *
+    * @return   0 on success, non-zero if nothing is pending or the patch could not be serialized.
+    */
+MOCKABLE_FUNCTION(, int, reported_state_batch_flush, REPORTED_STATE_BATCH_HANDLE, batch, const unsigned char**, reportedState, size_t*, size, void**, completionContext);
+
+/**
+    * @brief    IOTHUB_CLIENT_REPORTED_STATE_CALLBACK for a flushed patch. Calls back every caller whose patch was
+    *           merged into it with @p status_code, then releases @p completionContext.
+    */
+MOCKABLE_FUNCTION(, void, reported_state_batch_complete, int, status_code, void*, completionContext);
+
+/**
+    * @brief    Discards the pending patch without sending it. Calls back every caller whose patch was merged into it
+    *           with @p status_code. Used when the pending patch can no longer be flushed, e.g. on destroy.
+    */
+MOCKABLE_FUNCTION(, void, reported_state_batch_abandon, REPORTED_STATE_BATCH_HANDLE, batch, int, status_code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOTHUB_CLIENT_REPORTED_STATE_BATCH_H */
@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include "azure_c_shared_utility/optionhandler.h"
+#include "azure_c_shared_utility/tickcounter.h"
 #include "umock_c/umock_c_prod.h"
 #include "iothub_client_core_ll.h"
 #include "internal/iothubtransport.h"
@@ -32,12 +33,16 @@ typedef enum RETRY_ACTION_TAG
 struct RETRY_CONTROL_INSTANCE_TAG;
 typedef struct RETRY_CONTROL_INSTANCE_TAG* RETRY_CONTROL_HANDLE;
 
-MOCKABLE_FUNCTION(, RETRY_CONTROL_HANDLE, retry_control_create, IOTHUB_CLIENT_RETRY_POLICY, policy, unsigned int, max_retry_time_in_secs);
+// tick_counter is owned by the caller and must outlive the retry control.
+MOCKABLE_FUNCTION(, RETRY_CONTROL_HANDLE, retry_control_create, IOTHUB_CLIENT_RETRY_POLICY, policy, unsigned int, max_retry_time_in_secs, TICK_COUNTER_HANDLE, tick_counter);
 MOCKABLE_FUNCTION(, int, retry_control_should_retry, RETRY_CONTROL_HANDLE, retry_control_handle, RETRY_ACTION*, retry_action);
 MOCKABLE_FUNCTION(, void, retry_control_reset, RETRY_CONTROL_HANDLE, retry_control_handle);
 MOCKABLE_FUNCTION(, int, retry_control_set_option, RETRY_CONTROL_HANDLE, retry_control_handle, const char*, name, const void*, value);
 MOCKABLE_FUNCTION(, OPTIONHANDLER_HANDLE, retry_control_retrieve_options, RETRY_CONTROL_HANDLE, retry_control_handle);
 MOCKABLE_FUNCTION(, void, retry_control_destroy, RETRY_CONTROL_HANDLE, retry_control_handle);
+MOCKABLE_FUNCTION(, int, retry_control_budget_init);
+MOCKABLE_FUNCTION(, void, retry_control_budget_deinit);
+MOCKABLE_FUNCTION(, int, retry_control_set_global_budget, unsigned int, attempts_per_second);
 
 MOCKABLE_FUNCTION(, int, is_timeout_reached, time_t, start_time, unsigned int, timeout_in_secs, bool*, is_timed_out);
 
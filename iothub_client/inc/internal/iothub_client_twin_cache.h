@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file   iothub_client_twin_cache.h
+*    @brief  The @c twin_cache keeps a local copy of the desired properties of the twin, indexed by
+*            their $version, so that repeated full twin documents can be reduced to what actually changed.
+*/
+
+#ifndef IOTHUB_CLIENT_TWIN_CACHE_H
+#define IOTHUB_CLIENT_TWIN_CACHE_H
+
+#include "umock_c/umock_c_prod.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#include "iothub_client_core_common.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+/** @brief What the caller should deliver to the application after @c twin_cache_update. */
+#define TWIN_CACHE_UPDATE_RESULT_VALUES \
+    TWIN_CACHE_UPDATE_DELIVER,          \
+    TWIN_CACHE_UPDATE_DELIVER_PATCH,    \
+    TWIN_CACHE_UPDATE_UNCHANGED,        \
+    TWIN_CACHE_UPDATE_OUT_OF_SYNC,      \
+    TWIN_CACHE_UPDATE_ERROR
+
+MU_DEFINE_ENUM_WITHOUT_INVALID(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_RESULT_VALUES);
+
+typedef struct TWIN_CACHE_INSTANCE_TAG* TWIN_CACHE_HANDLE;
+
+MOCKABLE_FUNCTION(, TWIN_CACHE_HANDLE, twin_cache_create);
+MOCKABLE_FUNCTION(, void, twin_cache_destroy, TWIN_CACHE_HANDLE, twin_cache);
+MOCKABLE_FUNCTION(, void, twin_cache_reset, TWIN_CACHE_HANDLE, twin_cache);
+
+/**
+    * @brief    Applies a twin document or a desired properties patch received from IoT Hub to the cache.
+    *
+    * @param    twin_cache      Handle returned by @c twin_cache_create.
+    * @param    update_state    DEVICE_TWIN_UPDATE_COMPLETE for a full twin document, DEVICE_TWIN_UPDATE_PARTIAL for a patch.
+    * @param    payload         The document as received from IoT Hub (not NULL-terminated).
+    * @param    size            Size of @p payload.
+    * @param    patch           On TWIN_CACHE_UPDATE_DELIVER_PATCH, receives a desired properties patch holding only what
+    *                           differs from the cached copy. It is owned by the cache and valid until the next call.
+    * @param    patch_size      Receives the size of @p patch.
+    *
+    * @return   TWIN_CACHE_UPDATE_DELIVER when @p payload should be delivered as received,
+    *           TWIN_CACHE_UPDATE_DELIVER_PATCH when @p patch should be delivered instead as a partial update,
+    *           TWIN_CACHE_UPDATE_UNCHANGED when the cache is already at (or past) this version,
+    *           TWIN_CACHE_UPDATE_OUT_OF_SYNC when a patch skipped versions; @p payload should be delivered and
+    *           a full twin document requested to fill the gap,
+    *           TWIN_CACHE_UPDATE_ERROR when @p payload could not be applied.
+    */
+MOCKABLE_FUNCTION(, TWIN_CACHE_UPDATE_RESULT, twin_cache_update, TWIN_CACHE_HANDLE, twin_cache, DEVICE_TWIN_UPDATE_STATE, update_state, const unsigned char*, payload, size_t, size, const unsigned char**, patch, size_t*, patch_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOTHUB_CLIENT_TWIN_CACHE_H */
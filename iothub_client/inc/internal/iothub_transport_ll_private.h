@@ -12,6 +12,7 @@ typedef union IOTHUB_IDENTITY_INFO_TAG IOTHUB_IDENTITY_INFO;
 #include "azure_c_shared_utility/doublylinkedlist.h"
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/tickcounter.h"
 #include "internal/iothub_client_authorization.h"
 #include "iothub_message.h"
 
@@ -48,6 +49,9 @@ extern "C"
 
         /** @brief  A string that identifies the module.  Optional. */
         const char* moduleId;
+
+        /** @brief  The client's tick counter, shared with the transport's per-device components. Owned by the client. */
+        TICK_COUNTER_HANDLE tick_counter;
     } IOTHUB_DEVICE_CONFIG;
 
     typedef struct TRANSPORT_CALLBACKS_INFO_TAG
@@ -36,6 +36,9 @@ typedef struct AMQP_CONNECTION_CONFIG_TAG
     const void* on_state_changed_context;
     size_t svc2cl_keep_alive_timeout_secs;
     double cl2svc_keep_alive_send_ratio;
+    // Maximum number of devices attached to each session handed out by amqp_connection_acquire_session_handle.
+    // 0 means all devices share the single default session of the connection.
+    size_t max_devices_per_session;
 } AMQP_CONNECTION_CONFIG;
 
 typedef struct AMQP_CONNECTION_INSTANCE* AMQP_CONNECTION_HANDLE;
@@ -44,6 +47,27 @@ MOCKABLE_FUNCTION(, AMQP_CONNECTION_HANDLE, amqp_connection_create, AMQP_CONNECT
 MOCKABLE_FUNCTION(, void, amqp_connection_destroy, AMQP_CONNECTION_HANDLE, conn_handle);
 MOCKABLE_FUNCTION(, void, amqp_connection_do_work, AMQP_CONNECTION_HANDLE, conn_handle);
 MOCKABLE_FUNCTION(, int, amqp_connection_get_session_handle, AMQP_CONNECTION_HANDLE, conn_handle, SESSION_HANDLE*, session_handle);
+
+/**
+* @brief    Obtains a session for a device to create its links on. If max_devices_per_session is 0 this is the default session of the connection.
+*           Otherwise the first session with fewer than max_devices_per_session devices is returned, and a new session is created on the
+*           same connection when all existing ones are full. The CBS link always remains on the default session.
+*
+* @param    conn_handle        A handle to the amqp_connection instance.
+* @param    session_handle     Set to the session assigned to the caller.
+*
+* @returns  0 if the function succeeds, non-zero otherwise.
+*/
+MOCKABLE_FUNCTION(, int, amqp_connection_acquire_session_handle, AMQP_CONNECTION_HANDLE, conn_handle, SESSION_HANDLE*, session_handle);
+
+/**
+* @brief    Returns a session obtained with amqp_connection_acquire_session_handle. All links created by the caller on that session must have been
+*           destroyed already; additional sessions are destroyed once the last device using them releases them.
+*
+* @param    conn_handle        A handle to the amqp_connection instance.
+* @param    session_handle     The session previously returned by amqp_connection_acquire_session_handle.
+*/
+MOCKABLE_FUNCTION(, void, amqp_connection_release_session_handle, AMQP_CONNECTION_HANDLE, conn_handle, SESSION_HANDLE, session_handle);
 MOCKABLE_FUNCTION(, int, amqp_connection_get_cbs_handle, AMQP_CONNECTION_HANDLE, conn_handle, CBS_HANDLE*, cbs_handle);
 MOCKABLE_FUNCTION(, int, amqp_connection_set_logging, AMQP_CONNECTION_HANDLE, conn_handle, bool, is_trace_on);
 
@@ -6,6 +6,7 @@
 
 #include "umock_c/umock_c_prod.h"
 #include "azure_c_shared_utility/optionhandler.h"
+#include "azure_c_shared_utility/tickcounter.h"
 #include "azure_uamqp_c/session.h"
 #include "azure_uamqp_c/cbs.h"
 #include "iothub_message.h"
@@ -20,6 +21,8 @@ extern "C"
 // @brief    name of option to apply the instance obtained using amqp_device_retrieve_options
 #define DEVICE_OPTION_SAVED_OPTIONS "saved_device_options"
 #define DEVICE_OPTION_EVENT_SEND_TIMEOUT_SECS "event_send_timeout_secs"
+#define DEVICE_OPTION_EVENT_SEND_TIMEOUT_MS "event_send_timeout_ms"
+#define DEVICE_OPTION_RECEIVER_LINK_CREDIT "receiver_link_credit"
 #define DEVICE_OPTION_CBS_REQUEST_TIMEOUT_SECS "cbs_request_timeout_secs"
 #define DEVICE_OPTION_SAS_TOKEN_REFRESH_TIME_SECS "sas_token_refresh_time_secs"
 #define DEVICE_OPTION_SAS_TOKEN_LIFETIME_SECS "sas_token_lifetime_secs"
@@ -104,6 +107,9 @@ typedef struct DEVICE_CONFIG_TAG
     // Auth module used to generating handle authorization
     // with either SAS Token, x509 Certs, and Device SAS Token
     IOTHUB_AUTHORIZATION_HANDLE authorization_module;
+
+    // Owned by the caller; must outlive the device.
+    TICK_COUNTER_HANDLE tick_counter;
 } AMQP_DEVICE_CONFIG;
 
 typedef struct AMQP_DEVICE_INSTANCE* AMQP_DEVICE_HANDLE;
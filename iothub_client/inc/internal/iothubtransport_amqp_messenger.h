@@ -7,6 +7,7 @@
 #include "umock_c/umock_c_prod.h"
 #include "azure_c_shared_utility/optionhandler.h"
 #include "azure_c_shared_utility/map.h"
+#include "azure_c_shared_utility/tickcounter.h"
 #include "azure_uamqp_c/message.h"
 #include "azure_uamqp_c/session.h"
 #include "azure_uamqp_c/link.h"
@@ -110,6 +111,9 @@ typedef struct AMQP_MESSENGER_CONFIG_TAG
 
     pfTransport_GetOption_Product_Info_Callback prod_info_cb;
     void* prod_info_ctx;
+
+    // Owned by the caller; must outlive the messenger.
+    TICK_COUNTER_HANDLE tick_counter;
 } AMQP_MESSENGER_CONFIG;
 
 MOCKABLE_FUNCTION(, AMQP_MESSENGER_HANDLE, amqp_messenger_create, const AMQP_MESSENGER_CONFIG*, messenger_config);
@@ -6,6 +6,7 @@
 
 #include "umock_c/umock_c_prod.h"
 #include "azure_c_shared_utility/optionhandler.h"
+#include "azure_c_shared_utility/tickcounter.h"
 #include "azure_uamqp_c/session.h"
 
 #include "azure_uamqp_c/amqp_definitions_sequence_no.h"
@@ -20,6 +21,9 @@ extern "C"
 
 
 #define TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_SECS "telemetry_event_send_timeout_secs"
+#define TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_MS "telemetry_event_send_timeout_ms"
+// @brief    Link credit (prefetch window) granted by the C2D/input message receiver link; 0 uses the uAMQP default.
+#define TELEMETRY_MESSENGER_OPTION_RECEIVER_LINK_CREDIT "telemetry_receiver_link_credit"
 #define TELEMETRY_MESSENGER_OPTION_SAVED_OPTIONS "saved_telemetry_messenger_options"
 
 typedef struct TELEMETRY_MESSENGER_INSTANCE* TELEMETRY_MESSENGER_HANDLE;
@@ -74,6 +78,8 @@ typedef struct TELEMETRY_MESSENGER_CONFIG_TAG
     char* iothub_host_fqdn;
     ON_TELEMETRY_MESSENGER_STATE_CHANGED_CALLBACK on_state_changed_callback;
     void* on_state_changed_context;
+    // Owned by the caller; must outlive the messenger.
+    TICK_COUNTER_HANDLE tick_counter;
 } TELEMETRY_MESSENGER_CONFIG;
 
 #define AMQP_BATCHING_RESERVE_SIZE              (1024)
@@ -11,6 +11,7 @@
 #include "azure_macro_utils/macro_utils.h"
 #include "umock_c/umock_c_prod.h"
 #include "azure_c_shared_utility/optionhandler.h"
+#include "azure_c_shared_utility/tickcounter.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -56,8 +57,12 @@ typedef struct MESSAGE_QUEUE_CONFIG_TAG
     *           The @c user_context passed is the same provided as argument by the upper layer on @c message_queue_add.
     */
     PROCESS_MESSAGE_CALLBACK on_process_message_callback;
-    size_t max_message_enqueued_time_secs;
-    size_t max_message_processing_time_secs;
+    /**
+    * @brief    Tick counter used to time messages out. It is owned by the caller and must outlive the MESSAGE_QUEUE.
+    */
+    TICK_COUNTER_HANDLE tick_counter;
+    size_t max_message_enqueued_time_ms;
+    size_t max_message_processing_time_ms;
     size_t max_retry_count;
 } MESSAGE_QUEUE_CONFIG;
 
@@ -144,6 +149,17 @@ MOCKABLE_FUNCTION(, void, message_queue_do_work, MESSAGE_QUEUE_HANDLE, message_q
 */
 MOCKABLE_FUNCTION(, int, message_queue_set_max_message_enqueued_time_secs, MESSAGE_QUEUE_HANDLE, message_queue, size_t, seconds);
 
+/**
+* @brief    Sets the maximum time, in milliseconds, a message will be within MESSAGE_QUEUE (in either pending or in-progress lists).
+*
+* @param    message_queue    A @c MESSAGE_QUEUE_HANDLE obtained using message_queue_create.
+*
+* @param    milliseconds    Number of milliseconds to set for this timeout. A value of zero de-activates this timeout control.
+*
+* @returns    Zero if the no errors occur, non-zero otherwise.
+*/
+MOCKABLE_FUNCTION(, int, message_queue_set_max_message_enqueued_time_ms, MESSAGE_QUEUE_HANDLE, message_queue, size_t, milliseconds);
+
 /**
 * @brief    Sets the maximum time, in seconds, a message will be in-progress within MESSAGE_QUEUE.
 *
@@ -155,6 +171,17 @@ MOCKABLE_FUNCTION(, int, message_queue_set_max_message_enqueued_time_secs, MESSA
 */
 MOCKABLE_FUNCTION(, int, message_queue_set_max_message_processing_time_secs, MESSAGE_QUEUE_HANDLE, message_queue, size_t, seconds);
 
+/**
+* @brief    Sets the maximum time, in milliseconds, a message will be in-progress within MESSAGE_QUEUE.
+*
+* @param    message_queue    A @c MESSAGE_QUEUE_HANDLE obtained using message_queue_create.
+*
+* @param    milliseconds    Number of milliseconds to set for this timeout. A value of zero de-activates this timeout control.
+*
+* @returns    Zero if the no errors occur, non-zero otherwise.
+*/
+MOCKABLE_FUNCTION(, int, message_queue_set_max_message_processing_time_ms, MESSAGE_QUEUE_HANDLE, message_queue, size_t, milliseconds);
+
 /**
 * @brief    Sets the maximum number of times MESSAGE_QUEUE will try to re-process a message (no counting the initial attempt).
 *
@@ -78,7 +78,8 @@ typedef struct IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT_STRUCT* IOTHUB_CLIENT_LL_UP
     IOTHUB_CLIENT_RETRY_LINEAR_BACKOFF,      \
     IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF,                 \
     IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER,                 \
-    IOTHUB_CLIENT_RETRY_RANDOM
+    IOTHUB_CLIENT_RETRY_RANDOM,                 \
+    IOTHUB_CLIENT_RETRY_DECORRELATED_JITTER
 
     /** @brief Enumeration specifying the retry strategy the IoT Hub client should use.
     */
@@ -357,6 +358,35 @@ typedef struct IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT_STRUCT* IOTHUB_CLIENT_LL_UP
     */
     typedef IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT(*IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX)(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context);
 
+    /**
+    *  @brief           Compression stage plugged into the multi-block upload to blob APIs with OPTION_BLOB_UPLOAD_COMPRESSION.
+    *
+    *  @remarks         The SDK does not link a compression library; the application provides the codec (gzip, zstd, ...).
+    *                   The data returned by IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX is passed through @c compress, and
+    *                   the compressed output is re-chunked into full blocks before being uploaded. The blob is committed
+    *                   with @c contentEncoding as its Content-Encoding.
+    */
+    typedef struct IOTHUB_CLIENT_FILE_UPLOAD_COMPRESSION_TAG
+    {
+        /** @brief Content-Encoding of the uploaded blob, e.g. "gzip". */
+        const char* contentEncoding;
+
+        /** @brief Starts the compressed stream of one upload. Returns a stream handle, or NULL on failure. */
+        void* (*beginStream)(void* context);
+
+        /** @brief Compresses @c input and returns the output produced so far in @c output and @c outputSize (which may be 0).
+        *          The output must remain valid until the next call on the stream. A NULL @c input marks the end of the data,
+        *          and the call must flush the remaining output. Returns 0 on success. */
+        int (*compress)(void* stream, const unsigned char* input, size_t inputSize, const unsigned char** output, size_t* outputSize);
+
+        /** @brief Ends the stream (successful or not), reporting the raw bytes given by the application and the compressed
+        *          bytes uploaded. */
+        void (*endStream)(void* stream, size_t rawByteCount, size_t compressedByteCount);
+
+        /** @brief Passed to @c beginStream. */
+        void* context;
+    } IOTHUB_CLIENT_FILE_UPLOAD_COMPRESSION;
+
     /** @brief    This struct specifies IoT Hub client configuration. */
     typedef struct IOTHUB_CLIENT_CONFIG_TAG
     {
@@ -0,0 +1,153 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file    iothub_client_dispatcher.h
+*   @brief   APIs that route IoT Plug and Play commands and writable properties to per-component handlers.
+*
+*   @details Applications modeled with DTDLv2 typically receive every command through a single
+*            IOTHUB_CLIENT_COMMAND_CALLBACK_ASYNC and every property update through a single
+*            IOTHUB_CLIENT_PROPERTIES_RECEIVED_CALLBACK, and then compare component, command and property
+*            names one at a time to find the code that handles them.
+*
+*            The dispatcher lets the application declare its components, their commands and their writable
+*            properties once.  It builds sorted lookup tables from them, so that routing a request costs a
+*            binary search instead of a string comparison per handler.
+*
+*            Pseudocode to demonstrate the relationship between the dispatcher and the client:
+*                   static const IOTHUB_CLIENT_DISPATCHER_COMMAND thermostatCommands[] = { { "getMaxMinReport", OnGetMaxMinReport } };
+*                   static const IOTHUB_CLIENT_DISPATCHER_PROPERTY thermostatProperties[] = { { "targetTemperature", OnTargetTemperature } };
+*                   IOTHUB_CLIENT_DISPATCHER_COMPONENT components[] = {
+*                       { IOTHUB_CLIENT_DISPATCHER_COMPONENT_STRUCT_VERSION_1, "thermostat1", thermostatCommands, 1, thermostatProperties, 1, thermostat1 },
+*                       ...
+*                   };
+*
+*                   dispatcher = IoTHubClient_Dispatcher_Create(components, numComponents);
+*                   IoTHubDeviceClient_LL_SubscribeToCommands(deviceHandle, IoTHubClient_Dispatcher_CommandCallback, dispatcher);
+*                   IoTHubDeviceClient_LL_GetPropertiesAndSubscribeToUpdatesAsync(deviceHandle, IoTHubClient_Dispatcher_PropertiesCallback, dispatcher);
+*/
+
+#ifndef IOTHUB_CLIENT_DISPATCHER_H
+#define IOTHUB_CLIENT_DISPATCHER_H
+
+#include "umock_c/umock_c_prod.h"
+
+#include "iothub_client_core_common.h"
+#include "iothub_client_properties.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C"
+{
+#else
+#include <stddef.h>
+#endif
+
+/** @brief Status code returned to IoT Hub for a command that no component declared. */
+#define IOTHUB_CLIENT_DISPATCHER_COMMAND_NOT_FOUND_STATUS 404
+
+/**
+* @brief    Function callback application implements to process a writable property routed by the dispatcher.
+*
+* @param[in]    property              The property received from IoT Hub.  Only valid for the duration of the callback.
+* @param[in]    propertiesVersion     Version of the properties, to be used when acknowledging the property with
+*                                     @p IoTHubClient_Properties_Serializer_CreateWritableResponse().
+* @param[in]    userContextCallback   The @p userContextCallback of the component the property belongs to.
+*/
+typedef void(*IOTHUB_CLIENT_DISPATCHER_PROPERTY_CALLBACK)(
+            const IOTHUB_CLIENT_PROPERTY_PARSED* property,
+            int propertiesVersion,
+            void* userContextCallback);
+
+/** @brief A command of a component and the callback that handles it. */
+typedef struct IOTHUB_CLIENT_DISPATCHER_COMMAND_TAG {
+    /** @brief Name of the command. */
+    const char* commandName;
+    /** @brief Callback invoked with the @p userContextCallback of the component when the command is received. */
+    IOTHUB_CLIENT_COMMAND_CALLBACK_ASYNC commandCallback;
+} IOTHUB_CLIENT_DISPATCHER_COMMAND;
+
+/** @brief A writable property of a component and the callback that handles it. */
+typedef struct IOTHUB_CLIENT_DISPATCHER_PROPERTY_TAG {
+    /** @brief Name of the writable property. */
+    const char* propertyName;
+    /** @brief Callback invoked with the @p userContextCallback of the component when the property is received. */
+    IOTHUB_CLIENT_DISPATCHER_PROPERTY_CALLBACK propertyCallback;
+} IOTHUB_CLIENT_DISPATCHER_PROPERTY;
+
+/** @brief Current version of @p IOTHUB_CLIENT_DISPATCHER_COMPONENT structure.  */
+#define IOTHUB_CLIENT_DISPATCHER_COMPONENT_STRUCT_VERSION_1 1
+
+/** @brief A component of the device, with the commands and writable properties it handles. */
+typedef struct IOTHUB_CLIENT_DISPATCHER_COMPONENT_TAG {
+    /** @brief   Version of the structure.  Currently must be IOTHUB_CLIENT_DISPATCHER_COMPONENT_STRUCT_VERSION_1. */
+    int structVersion;
+    /** @brief   Name of the component.  NULL for the root component. */
+    const char* componentName;
+    /** @brief   Commands of the component.  May be NULL if @p numCommands is 0. */
+    const IOTHUB_CLIENT_DISPATCHER_COMMAND* commands;
+    /** @brief   Number of elements in @p commands. */
+    size_t numCommands;
+    /** @brief   Writable properties of the component.  May be NULL if @p numWritableProperties is 0. */
+    const IOTHUB_CLIENT_DISPATCHER_PROPERTY* writableProperties;
+    /** @brief   Number of elements in @p writableProperties. */
+    size_t numWritableProperties;
+    /** @brief   Context passed to the callbacks of this component. */
+    void* userContextCallback;
+} IOTHUB_CLIENT_DISPATCHER_COMPONENT;
+
+/**
+* @brief   Handle of a dispatcher created by @p IoTHubClient_Dispatcher_Create().
+*/
+typedef struct IOTHUB_CLIENT_DISPATCHER_TAG* IOTHUB_CLIENT_DISPATCHER_HANDLE;
+
+/**
+* @brief   Creates a dispatcher for the given components.
+*
+* @param[in]   components      Components of the device.
+* @param[in]   numComponents   Number of elements contained in @p components.
+*
+* @remarks  The @p components array is copied, but the component, command and property names are not.  They must
+*           remain valid until @p IoTHubClient_Dispatcher_Destroy() is called, which string literals do.
+*           Component names, and command and property names within a component, must be unique.
+*
+* @return   The dispatcher upon success or NULL upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_CLIENT_DISPATCHER_HANDLE, IoTHubClient_Dispatcher_Create, const IOTHUB_CLIENT_DISPATCHER_COMPONENT*, components, size_t, numComponents);
+
+/**
+* @brief   IOTHUB_CLIENT_COMMAND_CALLBACK_ASYNC that routes a command to the callback declared for it.
+*
+* @param[in]   commandRequest        The command received from IoT Hub.
+* @param[out]  commandResponse       The response to the command, filled in by the command's callback.
+* @param[in]   userContextCallback   The IOTHUB_CLIENT_DISPATCHER_HANDLE.
+*
+* @remarks  Pass this function and the dispatcher to @p IoTHubDeviceClient_LL_SubscribeToCommands() or its equivalents.
+*           Commands no component declared are answered with IOTHUB_CLIENT_DISPATCHER_COMMAND_NOT_FOUND_STATUS.
+*/
+MOCKABLE_FUNCTION(, void, IoTHubClient_Dispatcher_CommandCallback, const IOTHUB_CLIENT_COMMAND_REQUEST*, commandRequest, IOTHUB_CLIENT_COMMAND_RESPONSE*, commandResponse, void*, userContextCallback);
+
+/**
+* @brief   IOTHUB_CLIENT_PROPERTIES_RECEIVED_CALLBACK that routes each writable property to the callback declared for it.
+*
+* @param[in]   payloadType           Whether the payload is the full set of properties or an update of the writable ones.
+* @param[in]   payload               The properties received from IoT Hub.
+* @param[in]   payloadLength         Number of bytes of @p payload.
+* @param[in]   userContextCallback   The IOTHUB_CLIENT_DISPATCHER_HANDLE.
+*
+* @remarks  Pass this function and the dispatcher to @p IoTHubDeviceClient_LL_GetPropertiesAndSubscribeToUpdatesAsync()
+*           or its equivalents.  Reported properties, and writable properties no component declared, are skipped.
+*/
+MOCKABLE_FUNCTION(, void, IoTHubClient_Dispatcher_PropertiesCallback, IOTHUB_CLIENT_PROPERTY_PAYLOAD_TYPE, payloadType, const unsigned char*, payload, size_t, payloadLength, void*, userContextCallback);
+
+/**
+* @brief   Frees a dispatcher created by @p IoTHubClient_Dispatcher_Create().
+*
+* @param[in]   dispatcherHandle   Dispatcher to free.
+*/
+MOCKABLE_FUNCTION(, void, IoTHubClient_Dispatcher_Destroy, IOTHUB_CLIENT_DISPATCHER_HANDLE, dispatcherHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOTHUB_CLIENT_DISPATCHER_H */
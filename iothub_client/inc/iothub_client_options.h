@@ -20,6 +20,8 @@ extern "C"
 
     static STATIC_VAR_UNUSED const char* OPTION_RETRY_INTERVAL_SEC = "retry_interval_sec";
     static STATIC_VAR_UNUSED const char* OPTION_RETRY_MAX_DELAY_SECS = "retry_max_delay_secs";
+    // Process-wide limit on reconnection attempts started per second, shared by all clients (0 disables it)
+    static STATIC_VAR_UNUSED const char* OPTION_RETRY_BUDGET_PER_SEC = "retry_budget_per_sec";
 
     static STATIC_VAR_UNUSED const char* OPTION_LOG_TRACE = "logtrace";
 
@@ -44,6 +46,10 @@ extern "C"
 
     static STATIC_VAR_UNUSED const char* OPTION_SAS_TOKEN_LIFETIME = "sas_token_lifetime";
     static STATIC_VAR_UNUSED const char* OPTION_SAS_TOKEN_REFRESH_TIME = "sas_token_refresh_time";
+    static STATIC_VAR_UNUSED const char* OPTION_SAS_TOKEN_CACHE = "sas_token_cache";
+    static STATIC_VAR_UNUSED const char* OPTION_TWIN_CACHE = "twin_cache";
+    static STATIC_VAR_UNUSED const char* OPTION_REPORTED_STATE_BATCH_INTERVAL = "reported_state_batch_interval_ms";
+    static STATIC_VAR_UNUSED const char* OPTION_REPORTED_STATE_BATCH_SIZE = "reported_state_batch_size";
     static STATIC_VAR_UNUSED const char* OPTION_CBS_REQUEST_TIMEOUT = "cbs_request_timeout";
 
     static STATIC_VAR_UNUSED const char* OPTION_MIN_POLLING_TIME = "MinimumPollingTime";
@@ -62,6 +68,33 @@ extern "C"
 
     static STATIC_VAR_UNUSED const char* OPTION_BLOB_UPLOAD_TLS_RENEGOTIATION = "blob_upload_tls_renegotiation";
 
+    /*
+    * @brief    Number of blocks uploaded concurrently by the multi-block upload to blob APIs, each over its own connection
+    *           to the storage host. Value is a size_t between 1 (default, sequential upload) and 64. The block data
+    *           callback is still invoked sequentially from a single thread; each block is copied before it is handed off.
+    */
+    static STATIC_VAR_UNUSED const char* OPTION_BLOB_UPLOAD_PARALLELISM = "blob_upload_parallelism";
+
+    /*
+    * @brief    Maximum number of uploads the convenience layer runs at the same time (size_t). Further upload requests are
+    *           queued and run, in order, by the threads of finished uploads. The default, 0, starts one thread per upload.
+    */
+    static STATIC_VAR_UNUSED const char* OPTION_BLOB_UPLOAD_MAX_CONCURRENT_UPLOADS = "blob_upload_max_concurrent_uploads";
+
+    /*
+    * @brief    Keeps the HTTPS connections to IoT Hub and to the storage host open between uploads (bool, default false),
+    *           so back-to-back uploads do not each pay for new TLS handshakes. Changing any other upload to blob
+    *           option closes the kept connections.
+    */
+    static STATIC_VAR_UNUSED const char* OPTION_BLOB_UPLOAD_REUSE_CONNECTIONS = "blob_upload_reuse_connections";
+
+    /*
+    * @brief    Compression stage for the multi-block upload to blob APIs (const IOTHUB_CLIENT_FILE_UPLOAD_COMPRESSION*,
+    *           NULL to turn it off). With OPTION_BLOB_UPLOAD_PARALLELISM above 1, compression runs on the thread calling
+    *           the get-data callback while compressed blocks are uploaded by the upload threads.
+    */
+    static STATIC_VAR_UNUSED const char* OPTION_BLOB_UPLOAD_COMPRESSION = "blob_upload_compression";
+
     /*
     * @brief    Specifies the Digital Twin Model Id of the connection. Only valid for use with MQTT Transport
     */
@@ -100,6 +133,26 @@ extern "C"
     */
     static STATIC_VAR_UNUSED const char* OPTION_EVENT_SEND_TIMEOUT_SECS = "event_send_timeout_secs";
 
+    /*
+    * @brief Same as OPTION_EVENT_SEND_TIMEOUT_SECS, but the value is given in milliseconds, allowing sub-second send timeouts.
+    *        This option is applicable only to AMQP protocol.
+    */
+    static STATIC_VAR_UNUSED const char* OPTION_EVENT_SEND_TIMEOUT_MS = "event_send_timeout_ms";
+
+    /*
+    * @brief Link credit (prefetch window, in messages) granted by the cloud-to-device and module input message receiver link.
+    *        Higher values let high-rate consumers keep more messages in flight. Value is a size_t; 0 restores the uAMQP default.
+    *        Takes effect when the receiver link is next created. This option is applicable only to AMQP protocol.
+    */
+    static STATIC_VAR_UNUSED const char* OPTION_AMQP_RECEIVER_LINK_CREDIT = "amqp_receiver_link_credit";
+
+    /*
+    * @brief Maximum number of multiplexed devices whose links are placed on the same AMQP session. Value is a size_t; 0 (default)
+    *        keeps all devices on the single session of the connection. Applies to the next AMQP connection the transport opens, so set it
+    *        before registering devices. This option is applicable only to AMQP protocol and is set on the shared transport.
+    */
+    static STATIC_VAR_UNUSED const char* OPTION_AMQP_MAX_DEVICES_PER_SESSION = "amqp_max_devices_per_session";
+
     //diagnostic sampling percentage value, [0-100]
     static STATIC_VAR_UNUSED const char* OPTION_DIAGNOSTIC_SAMPLING_PERCENTAGE = "diag_sampling_percentage";
 
@@ -213,6 +213,52 @@ MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_Properties_Serializer_Cre
 */
 MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_Properties_Serializer_CreateWritableResponse, const IOTHUB_CLIENT_PROPERTY_WRITABLE_RESPONSE*, properties, size_t, numProperties, const char*, componentName, unsigned char**, serializedProperties, size_t*, serializedPropertiesLength);
 
+/**
+* @brief   Serializes reported properties into a buffer provided by the application, appending them to the properties
+*          already serialized there.
+*
+* @param[in]     properties                  Pointer to IOTHUB_CLIENT_PROPERTY_REPORTED to be serialized.
+* @param[in]     numProperties               Number of elements contained in @p properties.
+* @param[in]     componentName               Optional component name these properties are part of.  May be NULL for 
+*                                            default component.
+* @param[in,out] serializedProperties        Buffer receiving the serialized properties.
+*                                            Note: This is NOT a null-terminated string.
+* @param[in]     serializedPropertiesSize    Size in bytes of @p serializedProperties.
+* @param[in,out] serializedPropertiesLength  Length of the properties already serialized in @p serializedProperties, 
+*                                            0 to start a new payload.  Updated to the new length on success.
+*
+* @remarks  Calling this API once per component builds a single payload with the properties of several components, 
+*           so they can be sent with one call to @p IoTHubDeviceClient_LL_SendPropertiesAsync().  Each component 
+*           (and the default component) should only be appended once per payload.
+*
+*           No memory is allocated.  If @p serializedProperties is too small, IOTHUB_CLIENT_INVALID_SIZE is returned 
+*           and its contents are left unchanged.
+*
+* @return   IOTHUB_CLIENT_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_Properties_Serializer_AppendReported, const IOTHUB_CLIENT_PROPERTY_REPORTED*, properties, size_t, numProperties, const char*, componentName, unsigned char*, serializedProperties, size_t, serializedPropertiesSize, size_t*, serializedPropertiesLength);
+
+/**
+* @brief   Serializes the response to writable properties into a buffer provided by the application, appending them 
+*          to the properties already serialized there.
+*
+* @param[in]     properties                  Pointer to #IOTHUB_CLIENT_PROPERTY_WRITABLE_RESPONSE to be serialized.
+* @param[in]     numProperties               Number of elements contained in @p properties.
+* @param[in]     componentName               Optional component name these properties are part of.  May be NULL for 
+*                                            default component.
+* @param[in,out] serializedProperties        Buffer receiving the serialized properties.
+*                                            Note: This is NOT a null-terminated string.
+* @param[in]     serializedPropertiesSize    Size in bytes of @p serializedProperties.
+* @param[in,out] serializedPropertiesLength  Length of the properties already serialized in @p serializedProperties, 
+*                                            0 to start a new payload.  Updated to the new length on success.
+*
+* @remarks  See @p IoTHubClient_Properties_Serializer_AppendReported().  Writable responses and reported properties 
+*           may be appended to the same payload.
+*
+* @return   IOTHUB_CLIENT_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_Properties_Serializer_AppendWritableResponse, const IOTHUB_CLIENT_PROPERTY_WRITABLE_RESPONSE*, properties, size_t, numProperties, const char*, componentName, unsigned char*, serializedProperties, size_t, serializedPropertiesSize, size_t*, serializedPropertiesLength);
+
 /**
 * @brief   Frees serialized properties that were initially allocated with IoTHubClient_Properties_Serializer_CreateReported() 
 *          or IoTHubClient_Properties_Serializer_CreateWritableResponse().
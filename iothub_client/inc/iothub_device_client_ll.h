@@ -370,6 +370,45 @@ typedef IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT_HANDLE IOTHUB_CLIENT_LL_AZURE_STOR
     */
      MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubDeviceClient_LL_UploadToBlob, IOTHUB_DEVICE_CLIENT_LL_HANDLE, iotHubClientHandle, const char*, destinationFileName, const unsigned char*, source, size_t, size);
 
+     /**
+     * @brief    This API uploads to Azure Storage the content of the local file @p sourceFilePath
+     *           under the blob name @p devicename/destinationFileName
+     *
+     * @param    iotHubClientHandle      The handle created by a call to the create function.
+     * @param    destinationFileName     name of the file.
+     * @param    sourceFilePath          path of the local file to upload.
+     *
+     * @remark   The file is uploaded in 4 MB blocks, each read directly into the HTTP request body,
+     *           so neither the whole file nor an application-side copy of each block is kept in memory.
+     *           An empty file is rejected with IOTHUB_CLIENT_INVALID_ARG, as it would not create a blob.
+     *
+     * @warning  Other _LL_ functions such as IoTHubDeviceClient_LL_SendEventAsync() queue work to be performed later and do not block.  IoTHubDeviceClient_LL_UploadFileToBlob
+     *           will block however until the upload is completed or fails, which may take a while.
+     *
+     * @return   IOTHUB_CLIENT_OK upon success or an error code upon failure.
+     */
+     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubDeviceClient_LL_UploadFileToBlob, IOTHUB_DEVICE_CLIENT_LL_HANDLE, iotHubClientHandle, const char*, destinationFileName, const char*, sourceFilePath);
+
+     /**
+     * @brief    Same as IoTHubDeviceClient_LL_UploadFileToBlob(), but saves the upload progress to @p checkpointFilePath
+     *           after every block so that an interrupted upload can be resumed.
+     *
+     * @param    iotHubClientHandle      The handle created by a call to the create function.
+     * @param    destinationFileName     name of the file.
+     * @param    sourceFilePath          path of the local file to upload.
+     * @param    checkpointFilePath      path of the file where the upload progress is kept.
+     *
+     * @remark   Calling this function again with the same arguments after a failure (or after the process restarted)
+     *           skips the blocks already in Azure Storage instead of uploading the whole file again. A new SAS URI is
+     *           requested from IoT Hub on each call, so an expired SAS does not prevent resuming. The checkpoint is
+     *           ignored if the source file size changed, and removed once the upload succeeds.
+     *
+     * @warning  This function blocks until the upload is completed or fails, which may take a while.
+     *
+     * @return   IOTHUB_CLIENT_OK upon success or an error code upon failure.
+     */
+     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubDeviceClient_LL_UploadFileToBlobResumable, IOTHUB_DEVICE_CLIENT_LL_HANDLE, iotHubClientHandle, const char*, destinationFileName, const char*, sourceFilePath, const char*, checkpointFilePath);
+
      /**
      * @brief    This API uploads to Azure Storage the content provided block by block by @p getDataCallback
      *           under the blob name @p devicename/destinationFileName
@@ -16,6 +16,7 @@ static const char blockListXmlEnd[] = "</BlockList>";
 static const char blockListUriMarker[] = "&comp=blocklist";
 static const char blockListLatestTagXmlBegin[] = "<Latest>";
 static const char blockListLatestTagXmlEnd[] = "</Latest>";
+static const char blobContentEncodingHeader[] = "x-ms-blob-content-encoding";
 
 // Size of the string containing an Azure Blob Block ID.
 // For more details please see
@@ -71,6 +72,25 @@ static STRING_HANDLE createBlockIdListXml(SINGLYLINKEDLIST_HANDLE blockIDList)
     return blockIdListXml;
 }
 
+// Block IDs are the base64 encoding of the zero-padded block number, so the same block always gets the same ID.
+static STRING_HANDLE createEncodedBlockId(unsigned int blockID)
+{
+    STRING_HANDLE result;
+    char blockIdString[AZURE_BLOB_BLOCK_ID_SIZE]; /*this will contain 000000... 049999*/
+
+    if (sprintf(blockIdString, "%6u", (unsigned int)blockID) != AZURE_BLOB_BLOCK_ID_LENGTH) /*produces 000000... 049999*/
+    {
+        LogError("failed to sprintf");
+        result = NULL;
+    }
+    else if ((result = Azure_Base64_Encode_Bytes((const unsigned char*)blockIdString, AZURE_BLOB_BLOCK_ID_LENGTH)) == NULL)
+    {
+        LogError("unable to Azure_Base64_Encode_Bytes");
+    }
+
+    return result;
+}
+
 static bool removeAndDestroyBlockIdInList(const void* item, const void* match_context, bool* continue_processing)
 {
     (void)match_context;
@@ -157,89 +177,79 @@ BLOB_RESULT Blob_PutBlock(
         result = BLOB_ERROR;
     }
     else
-    {   
-        char blockIdString[AZURE_BLOB_BLOCK_ID_SIZE]; /*this will contain 000000... 049999*/
-        if (sprintf(blockIdString, "%6u", (unsigned int)blockID) != AZURE_BLOB_BLOCK_ID_LENGTH) /*produces 000000... 049999*/
+    {
+        STRING_HANDLE blockIdEncodedString = createEncodedBlockId(blockID);
+
+        if (blockIdEncodedString == NULL)
         {
-            LogError("failed to sprintf");
             result = BLOB_ERROR;
         }
         else
         {
-            STRING_HANDLE blockIdEncodedString = Azure_Base64_Encode_Bytes((const unsigned char*)blockIdString, AZURE_BLOB_BLOCK_ID_LENGTH);
+            LIST_ITEM_HANDLE newListItem = singlylinkedlist_add(blockIDList, blockIdEncodedString);
 
-            if (blockIdEncodedString == NULL)
+            /*add the blockId base64 encoded to the XML*/
+            if (newListItem == NULL)
             {
-                LogError("unable to Azure_Base64_Encode_Bytes");
+                LogError("unable to store block ID");
+                STRING_delete(blockIdEncodedString);
                 result = BLOB_ERROR;
             }
             else
             {
-                LIST_ITEM_HANDLE newListItem = singlylinkedlist_add(blockIDList, blockIdEncodedString);
+                STRING_HANDLE newRelativePath = STRING_construct(relativePath);
 
-                /*add the blockId base64 encoded to the XML*/
-                if (newListItem == NULL)
+                if (newRelativePath == NULL)
                 {
-                    LogError("unable to store block ID");
+                    LogError("unable to STRING_construct");
+                    (void)singlylinkedlist_remove(blockIDList, newListItem);
                     STRING_delete(blockIdEncodedString);
                     result = BLOB_ERROR;
                 }
                 else
                 {
-                    STRING_HANDLE newRelativePath = STRING_construct(relativePath);
-
-                    if (newRelativePath == NULL)
+                    if (!(
+                        (STRING_concat(newRelativePath, "&comp=block&blockid=") == 0) &&
+                        (STRING_concat_with_STRING(newRelativePath, blockIdEncodedString) == 0)
+                        ))
                     {
-                        LogError("unable to STRING_construct");
+                        LogError("unable to STRING concatenate");
                         (void)singlylinkedlist_remove(blockIDList, newListItem);
                         STRING_delete(blockIdEncodedString);
                         result = BLOB_ERROR;
                     }
                     else
                     {
-                        if (!(
-                            (STRING_concat(newRelativePath, "&comp=block&blockid=") == 0) &&
-                            (STRING_concat_with_STRING(newRelativePath, blockIdEncodedString) == 0)
-                            ))
+                        unsigned int httpResponseStatusCode = 0;
+
+                        if (HTTPAPIEX_ExecuteRequest(
+                                httpApiExHandle,
+                                HTTPAPI_REQUEST_PUT,
+                                STRING_c_str(newRelativePath),
+                                NULL,
+                                blockData,
+                                &httpResponseStatusCode,
+                                NULL,
+                                httpResponse) != HTTPAPIEX_OK ||
+                                !IS_HTTP_STATUS_CODE_SUCCESS(httpResponseStatusCode))
                         {
-                            LogError("unable to STRING concatenate");
+                            LogError("unable to HTTPAPIEX_ExecuteRequest (HTTP response status %u)", httpResponseStatusCode);
                             (void)singlylinkedlist_remove(blockIDList, newListItem);
                             STRING_delete(blockIdEncodedString);
-                            result = BLOB_ERROR;
+                            result = BLOB_HTTP_ERROR;
                         }
                         else
                         {
-                            unsigned int httpResponseStatusCode = 0;
-
-                            if (HTTPAPIEX_ExecuteRequest(
-                                    httpApiExHandle,
-                                    HTTPAPI_REQUEST_PUT,
-                                    STRING_c_str(newRelativePath),
-                                    NULL,
-                                    blockData,
-                                    &httpResponseStatusCode,
-                                    NULL,
-                                    httpResponse) != HTTPAPIEX_OK ||
-                                    !IS_HTTP_STATUS_CODE_SUCCESS(httpResponseStatusCode))
-                            {
-                                LogError("unable to HTTPAPIEX_ExecuteRequest (HTTP response status %u)", httpResponseStatusCode);
-                                (void)singlylinkedlist_remove(blockIDList, newListItem);
-                                STRING_delete(blockIdEncodedString);
-                                result = BLOB_HTTP_ERROR;
-                            }
-                            else
-                            {
-                                result = BLOB_OK;
-                            }
-
-                            if (httpStatus != NULL)
-                            {
-                                *httpStatus = httpResponseStatusCode;
-                            }
+                            result = BLOB_OK;
                         }
 
-                        STRING_delete(newRelativePath);
+                        if (httpStatus != NULL)
+                        {
+                            *httpStatus = httpResponseStatusCode;
+                        }
                     }
+
+                    STRING_delete(newRelativePath);
                 }
             }
         }
@@ -247,6 +257,43 @@ BLOB_RESULT Blob_PutBlock(
     return result;
 }
 
+BLOB_RESULT Blob_AddUploadedBlockId(SINGLYLINKEDLIST_HANDLE blockIDList, unsigned int blockID)
+{
+    BLOB_RESULT result;
+
+    if (blockIDList == NULL)
+    {
+        LogError("invalid argument detected blockIDList=%p", blockIDList);
+        result = BLOB_INVALID_ARG;
+    }
+    else if (blockID > 49999) /*outside the expected range of 000000... 049999*/
+    {
+        LogError("block ID too large");
+        result = BLOB_ERROR;
+    }
+    else
+    {
+        STRING_HANDLE blockIdEncodedString = createEncodedBlockId(blockID);
+
+        if (blockIdEncodedString == NULL)
+        {
+            result = BLOB_ERROR;
+        }
+        else if (singlylinkedlist_add(blockIDList, blockIdEncodedString) == NULL)
+        {
+            LogError("unable to store block ID");
+            STRING_delete(blockIdEncodedString);
+            result = BLOB_ERROR;
+        }
+        else
+        {
+            result = BLOB_OK;
+        }
+    }
+
+    return result;
+}
+
 void Blob_ClearBlockIdList(SINGLYLINKEDLIST_HANDLE blockIdList)
 {
     if (blockIdList != NULL)
@@ -265,6 +312,17 @@ BLOB_RESULT Blob_PutBlockList(
     SINGLYLINKEDLIST_HANDLE blockIDList,
     unsigned int* httpStatus,
     BUFFER_HANDLE httpResponse)
+{
+    return Blob_PutBlockListWithContentEncoding(httpApiExHandle, relativePath, blockIDList, NULL, httpStatus, httpResponse);
+}
+
+BLOB_RESULT Blob_PutBlockListWithContentEncoding(
+    HTTPAPIEX_HANDLE httpApiExHandle,
+    const char* relativePath,
+    SINGLYLINKEDLIST_HANDLE blockIDList,
+    const char* contentEncoding,
+    unsigned int* httpStatus,
+    BUFFER_HANDLE httpResponse)
 {
     BLOB_RESULT result;
 
@@ -322,12 +380,20 @@ BLOB_RESULT Blob_PutBlockList(
                     else
                     {
                         unsigned int httpResponseStatusCode = 0;
+                        HTTP_HEADERS_HANDLE requestHttpHeaders = NULL;
 
-                        if (HTTPAPIEX_ExecuteRequest(
+                        if (contentEncoding != NULL &&
+                            ((requestHttpHeaders = HTTPHeaders_Alloc()) == NULL ||
+                             HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, blobContentEncodingHeader, contentEncoding) != HTTP_HEADERS_OK))
+                        {
+                            LogError("failed to set the blob content encoding header");
+                            result = BLOB_ERROR;
+                        }
+                        else if (HTTPAPIEX_ExecuteRequest(
                                 httpApiExHandle,
                                 HTTPAPI_REQUEST_PUT,
                                 STRING_c_str(newRelativePath),
-                                NULL,
+                                requestHttpHeaders,
                                 blockIDListAsBuffer,
                                 &httpResponseStatusCode,
                                 NULL,
@@ -347,6 +413,11 @@ BLOB_RESULT Blob_PutBlockList(
                         {
                             *httpStatus = httpResponseStatusCode;
                         }
+
+                        if (requestHttpHeaders != NULL)
+                        {
+                            HTTPHeaders_Free(requestHttpHeaders);
+                        }
                         
                         BUFFER_delete(blockIDListAsBuffer);
                     }
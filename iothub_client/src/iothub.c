@@ -7,6 +7,7 @@
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_macro_utils/macro_utils.h"
 #include "iothub.h"
+#include "internal/iothub_client_retry_control.h"
 
 int IoTHub_Init(void)
 {
@@ -16,6 +17,12 @@ int IoTHub_Init(void)
         LogError("Platform initialization failed");
         result = MU_FAILURE;
     }
+    else if (retry_control_budget_init() != 0)
+    {
+        LogError("Retry budget initialization failed");
+        platform_deinit();
+        result = MU_FAILURE;
+    }
     else
     {
         result = 0;
@@ -25,5 +32,6 @@ int IoTHub_Init(void)
 
 void IoTHub_Deinit(void)
 {
+    retry_control_budget_deinit();
     platform_deinit();
 }
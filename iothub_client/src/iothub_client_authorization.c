@@ -14,6 +14,7 @@
 #include "azure_c_shared_utility/azure_base64.h"
 #include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/safe_math.h"
+#include "azure_c_shared_utility/lock.h"
 
 #ifdef USE_PROV_MODULE
 #include "azure_prov_client/internal/iothub_auth_client.h"
@@ -24,6 +25,19 @@
 #define DEFAULT_SAS_TOKEN_EXPIRY_TIME_SECS          3600
 #define INDEFINITE_TIME                             ((time_t)(-1))
 #define MIN_SAS_EXPIRY_TIME                         5  // 5 seconds
+#define SAS_TOKEN_CACHE_SIZE                        4
+// Cached tokens are only handed out during the first part of their lifetime. Transports assume the token
+// they receive is fresh and renew it at SAS_REFRESH_MULTIPLIER (80%) of the lifetime, which must still fall
+// before the real expiry of a token that was issued up to this much earlier.
+#define SAS_TOKEN_CACHE_REUSE_PERCENT               10
+
+typedef struct SAS_TOKEN_CACHE_ENTRY_TAG
+{
+    char* scope;
+    char* key_name;
+    char* sas_token;
+    uint64_t reuse_until;
+} SAS_TOKEN_CACHE_ENTRY;
 
 typedef struct IOTHUB_AUTHORIZATION_DATA_TAG
 {
@@ -36,6 +50,9 @@ typedef struct IOTHUB_AUTHORIZATION_DATA_TAG
 #ifdef USE_PROV_MODULE
     IOTHUB_SECURITY_HANDLE device_auth_handle;
 #endif
+    bool sas_token_cache_enabled;
+    LOCK_HANDLE sas_token_cache_lock;
+    SAS_TOKEN_CACHE_ENTRY sas_token_cache[SAS_TOKEN_CACHE_SIZE];
 } IOTHUB_AUTHORIZATION_DATA;
 
 static int get_seconds_since_epoch(uint64_t* seconds)
@@ -55,6 +72,92 @@ static int get_seconds_since_epoch(uint64_t* seconds)
     return result;
 }
 
+static void clear_sas_token_cache_entry(SAS_TOKEN_CACHE_ENTRY* entry)
+{
+    free(entry->scope);
+    free(entry->key_name);
+    free(entry->sas_token);
+    memset(entry, 0, sizeof(SAS_TOKEN_CACHE_ENTRY));
+}
+
+static void clear_sas_token_cache(IOTHUB_AUTHORIZATION_DATA* handle)
+{
+    size_t index;
+    for (index = 0; index < SAS_TOKEN_CACHE_SIZE; index++)
+    {
+        if (handle->sas_token_cache[index].sas_token != NULL)
+        {
+            clear_sas_token_cache_entry(&handle->sas_token_cache[index]);
+        }
+    }
+}
+
+static SAS_TOKEN_CACHE_ENTRY* find_sas_token_cache_entry(IOTHUB_AUTHORIZATION_DATA* handle, const char* scope, const char* key_name)
+{
+    SAS_TOKEN_CACHE_ENTRY* result = NULL;
+    size_t index;
+
+    for (index = 0; index < SAS_TOKEN_CACHE_SIZE; index++)
+    {
+        SAS_TOKEN_CACHE_ENTRY* entry = &handle->sas_token_cache[index];
+        if (entry->sas_token != NULL &&
+            strcmp(entry->scope, scope) == 0 &&
+            ((entry->key_name == NULL && key_name == NULL) ||
+             (entry->key_name != NULL && key_name != NULL && strcmp(entry->key_name, key_name) == 0)))
+        {
+            result = entry;
+            break;
+        }
+    }
+    return result;
+}
+
+static void store_sas_token_cache_entry(IOTHUB_AUTHORIZATION_DATA* handle, SAS_TOKEN_CACHE_ENTRY* entry, const char* scope, const char* key_name, const char* sas_token, uint64_t issue_time)
+{
+    uint64_t reuse_window = (handle->token_expiry_time_sec / 100) * SAS_TOKEN_CACHE_REUSE_PERCENT;
+
+    if (entry == NULL)
+    {
+        // Take a free slot, or evict the entry closest to the end of its reuse window
+        size_t index;
+        entry = &handle->sas_token_cache[0];
+        for (index = 0; index < SAS_TOKEN_CACHE_SIZE; index++)
+        {
+            if (handle->sas_token_cache[index].sas_token == NULL)
+            {
+                entry = &handle->sas_token_cache[index];
+                break;
+            }
+            else if (handle->sas_token_cache[index].reuse_until < entry->reuse_until)
+            {
+                entry = &handle->sas_token_cache[index];
+            }
+        }
+    }
+
+    if (entry->sas_token != NULL)
+    {
+        clear_sas_token_cache_entry(entry);
+    }
+
+    // A failure here only means the next caller generates a new token
+    if (mallocAndStrcpy_s(&entry->scope, scope) != 0 ||
+        (key_name != NULL && mallocAndStrcpy_s(&entry->key_name, key_name) != 0) ||
+        mallocAndStrcpy_s(&entry->sas_token, sas_token) != 0)
+    {
+        LogError("Failed caching the SAS token");
+        clear_sas_token_cache_entry(entry);
+    }
+    else
+    {
+        entry->reuse_until = issue_time + reuse_window;
+        if (entry->reuse_until < issue_time)
+        {
+            entry->reuse_until = UINT64_MAX;
+        }
+    }
+}
+
 static IOTHUB_AUTHORIZATION_DATA* initialize_auth_client(const char* device_id, const char* module_id)
 {
     IOTHUB_AUTHORIZATION_DATA* result;
@@ -220,6 +323,11 @@ void IoTHubClient_Auth_Destroy(IOTHUB_AUTHORIZATION_HANDLE handle)
         free(handle->device_id);
         free(handle->module_id);
         free(handle->device_sas_token);
+        if (handle->sas_token_cache_lock != NULL)
+        {
+            clear_sas_token_cache(handle);
+            Lock_Deinit(handle->sas_token_cache_lock);
+        }
         free(handle);
     }
 }
@@ -368,125 +476,173 @@ IOTHUB_CREDENTIAL_TYPE IoTHubClient_Auth_Get_Credential_Type(IOTHUB_AUTHORIZATIO
     return result;
 }
 
-char* IoTHubClient_Auth_Get_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle, const char* scope, uint64_t expiry_time_relative_seconds, const char* key_name)
+static char* create_sas_token(IOTHUB_AUTHORIZATION_DATA* handle, const char* scope, const char* key_name)
 {
     char* result;
-    (void)expiry_time_relative_seconds;
-    if (handle == NULL)
-    {
-        LogError("Invalid Parameter handle: %p", handle);
-        result = NULL;
-    }
-    else
+    if (handle->cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_AUTH)
     {
-        if (handle->cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_AUTH)
-        {
 #ifdef USE_PROV_MODULE
-            DEVICE_AUTH_CREDENTIAL_INFO dev_auth_cred;
-            uint64_t sec_since_epoch;
+        DEVICE_AUTH_CREDENTIAL_INFO dev_auth_cred;
+        uint64_t sec_since_epoch;
 
-            if (get_seconds_since_epoch(&sec_since_epoch) != 0)
+        if (get_seconds_since_epoch(&sec_since_epoch) != 0)
+        {
+            LogError("failure getting seconds from epoch");
+            result = NULL;
+        }
+        else
+        {
+            memset(&dev_auth_cred, 0, sizeof(DEVICE_AUTH_CREDENTIAL_INFO));
+            uint64_t expiry_time = sec_since_epoch + handle->token_expiry_time_sec;
+            if (expiry_time < sec_since_epoch)
             {
-                LogError("failure getting seconds from epoch");
+                expiry_time = UINT64_MAX;
+            }
+            dev_auth_cred.sas_info.expiry_seconds = expiry_time;
+            dev_auth_cred.sas_info.token_scope = scope;
+            dev_auth_cred.sas_info.key_name = key_name;
+            dev_auth_cred.dev_auth_type = AUTH_TYPE_SAS;
+
+            CREDENTIAL_RESULT* cred_result = iothub_device_auth_generate_credentials(handle->device_auth_handle, &dev_auth_cred);
+            if (cred_result == NULL)
+            {
+                LogError("failure getting credentials from device auth module");
                 result = NULL;
             }
             else
             {
-                memset(&dev_auth_cred, 0, sizeof(DEVICE_AUTH_CREDENTIAL_INFO));
-                uint64_t expiry_time = sec_since_epoch + handle->token_expiry_time_sec;
-                if (expiry_time < sec_since_epoch)
-                {
-                    expiry_time = UINT64_MAX;
-                }
-                dev_auth_cred.sas_info.expiry_seconds = expiry_time;
-                dev_auth_cred.sas_info.token_scope = scope;
-                dev_auth_cred.sas_info.key_name = key_name;
-                dev_auth_cred.dev_auth_type = AUTH_TYPE_SAS;
-
-                CREDENTIAL_RESULT* cred_result = iothub_device_auth_generate_credentials(handle->device_auth_handle, &dev_auth_cred);
-                if (cred_result == NULL)
+                if (mallocAndStrcpy_s(&result, cred_result->auth_cred_result.sas_result.sas_token) != 0)
                 {
-                    LogError("failure getting credentials from device auth module");
+                    LogError("failure allocating Sas Token");
                     result = NULL;
                 }
-                else
-                {
-                    if (mallocAndStrcpy_s(&result, cred_result->auth_cred_result.sas_result.sas_token) != 0)
-                    {
-                        LogError("failure allocating Sas Token");
-                        result = NULL;
-                    }
-                    free(cred_result);
-                }
+                free(cred_result);
             }
+        }
 #else
-            LogError("Failed HSM module is not supported");
-            result = NULL;
+        LogError("Failed HSM module is not supported");
+        result = NULL;
 #endif
-        }
-        else if (handle->cred_type == IOTHUB_CREDENTIAL_TYPE_SAS_TOKEN)
+    }
+    else if (handle->cred_type == IOTHUB_CREDENTIAL_TYPE_SAS_TOKEN)
+    {
+        if (handle->device_sas_token != NULL)
         {
-            if (handle->device_sas_token != NULL)
+            if (mallocAndStrcpy_s(&result, handle->device_sas_token) != 0)
             {
-                if (mallocAndStrcpy_s(&result, handle->device_sas_token) != 0)
-                {
-                    LogError("failure allocating sas token");
-                    result = NULL;
-                }
-            }
-            else
-            {
-                LogError("failure device sas token is NULL");
+                LogError("failure allocating sas token");
                 result = NULL;
             }
         }
-        else if (handle->cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY)
+        else
         {
-            if (scope == NULL)
+            LogError("failure device sas token is NULL");
+            result = NULL;
+        }
+    }
+    else if (handle->cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY)
+    {
+        if (scope == NULL)
+        {
+            LogError("Invalid Parameter scope: %p", scope);
+            result = NULL;
+        }
+        else
+        {
+            STRING_HANDLE sas_token;
+            uint64_t sec_since_epoch;
+
+            if (get_seconds_since_epoch(&sec_since_epoch) != 0)
             {
-                LogError("Invalid Parameter scope: %p", scope);
+                LogError("failure getting seconds from epoch");
                 result = NULL;
             }
             else
             {
-                STRING_HANDLE sas_token;
-                uint64_t sec_since_epoch;
+                uint64_t expiry_time = sec_since_epoch + handle->token_expiry_time_sec;
+                if (expiry_time < sec_since_epoch)
+                {
+                    expiry_time = UINT64_MAX;
+                }
 
-                if (get_seconds_since_epoch(&sec_since_epoch) != 0)
+                if ( (sas_token = SASToken_CreateString(handle->device_key, scope, key_name, expiry_time)) == NULL)
                 {
-                    LogError("failure getting seconds from epoch");
+                    LogError("Failed creating sas_token");
                     result = NULL;
                 }
                 else
                 {
-                    uint64_t expiry_time = sec_since_epoch + handle->token_expiry_time_sec;
-                    if (expiry_time < sec_since_epoch)
-                    {
-                        expiry_time = UINT64_MAX;
-                    }
-
-                    if ( (sas_token = SASToken_CreateString(handle->device_key, scope, key_name, expiry_time)) == NULL)
+                    if (mallocAndStrcpy_s(&result, STRING_c_str(sas_token) ) != 0)
                     {
-                        LogError("Failed creating sas_token");
+                        LogError("Failed copying result");
                         result = NULL;
                     }
-                    else
-                    {
-                        if (mallocAndStrcpy_s(&result, STRING_c_str(sas_token) ) != 0)
-                        {
-                            LogError("Failed copying result");
-                            result = NULL;
-                        }
-                        STRING_delete(sas_token);
-                    }
+                    STRING_delete(sas_token);
                 }
             }
         }
-        else
+    }
+    else
+    {
+        LogError("Failed getting sas token invalid credential type");
+        result = NULL;
+    }
+    return result;
+}
+
+static char* get_cached_sas_token(IOTHUB_AUTHORIZATION_DATA* handle, const char* scope, const char* key_name)
+{
+    char* result;
+    uint64_t sec_since_epoch;
+
+    if (get_seconds_since_epoch(&sec_since_epoch) != 0)
+    {
+        LogError("failure getting seconds from epoch");
+        result = NULL;
+    }
+    else if (Lock(handle->sas_token_cache_lock) != LOCK_OK)
+    {
+        LogError("failure locking the SAS token cache");
+        result = NULL;
+    }
+    else
+    {
+        // Generating under the lock makes concurrent callers for the same scope wait for, and then share, one token
+        SAS_TOKEN_CACHE_ENTRY* entry = find_sas_token_cache_entry(handle, scope, key_name);
+        if (entry != NULL && sec_since_epoch < entry->reuse_until)
         {
-            LogError("Failed getting sas token invalid credential type");
-            result = NULL;
+            if (mallocAndStrcpy_s(&result, entry->sas_token) != 0)
+            {
+                LogError("failure copying cached sas token");
+                result = NULL;
+            }
         }
+        else if ((result = create_sas_token(handle, scope, key_name)) != NULL)
+        {
+            store_sas_token_cache_entry(handle, entry, scope, key_name, result, sec_since_epoch);
+        }
+        (void)Unlock(handle->sas_token_cache_lock);
+    }
+    return result;
+}
+
+char* IoTHubClient_Auth_Get_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle, const char* scope, uint64_t expiry_time_relative_seconds, const char* key_name)
+{
+    char* result;
+    (void)expiry_time_relative_seconds;
+    if (handle == NULL)
+    {
+        LogError("Invalid Parameter handle: %p", handle);
+        result = NULL;
+    }
+    else if (handle->sas_token_cache_enabled && scope != NULL &&
+        (handle->cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY || handle->cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_AUTH))
+    {
+        result = get_cached_sas_token(handle, scope, key_name);
+    }
+    else
+    {
+        result = create_sas_token(handle, scope, key_name);
     }
     return result;
 }
@@ -638,6 +794,19 @@ int IoTHubClient_Auth_Set_SasToken_Expiry(IOTHUB_AUTHORIZATION_HANDLE handle, ui
     else
     {
         handle->token_expiry_time_sec = expiry_time_seconds;
+        if (handle->sas_token_cache_lock != NULL)
+        {
+            // Cached tokens were issued with the previous lifetime
+            if (Lock(handle->sas_token_cache_lock) != LOCK_OK)
+            {
+                LogError("failure locking the SAS token cache");
+            }
+            else
+            {
+                clear_sas_token_cache(handle);
+                (void)Unlock(handle->sas_token_cache_lock);
+            }
+        }
         result = 0;
     }
     return result;
@@ -657,3 +826,37 @@ uint64_t IoTHubClient_Auth_Get_SasToken_Expiry(IOTHUB_AUTHORIZATION_HANDLE handl
     }
     return result;
 }
+
+int IoTHubClient_Auth_Set_SasToken_Cache(IOTHUB_AUTHORIZATION_HANDLE handle, bool enable_cache)
+{
+    int result;
+    if (handle == NULL)
+    {
+        LogError("Invalid handle value handle: NULL");
+        result = MU_FAILURE;
+    }
+    else if (enable_cache && handle->sas_token_cache_lock == NULL && (handle->sas_token_cache_lock = Lock_Init()) == NULL)
+    {
+        LogError("Failure creating the SAS token cache lock");
+        result = MU_FAILURE;
+    }
+    else if (handle->sas_token_cache_lock != NULL && Lock(handle->sas_token_cache_lock) != LOCK_OK)
+    {
+        LogError("failure locking the SAS token cache");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        handle->sas_token_cache_enabled = enable_cache;
+        if (handle->sas_token_cache_lock != NULL)
+        {
+            if (!enable_cache)
+            {
+                clear_sas_token_cache(handle);
+            }
+            (void)Unlock(handle->sas_token_cache_lock);
+        }
+        result = 0;
+    }
+    return result;
+}
@@ -31,6 +31,7 @@
 static const int DEFAULT_COMMAND_RESPONSE_STATUS_CODE = 500;
 
 struct IOTHUB_QUEUE_CONTEXT_TAG;
+struct HTTPWORKER_THREAD_INFO_TAG;
 
 typedef struct IOTHUB_CLIENT_CORE_INSTANCE_TAG
 {
@@ -54,6 +55,10 @@ typedef struct IOTHUB_CLIENT_CORE_INSTANCE_TAG
     struct IOTHUB_QUEUE_CONTEXT_TAG* method_user_context;
     tickcounter_ms_t do_work_freq_ms;
     tickcounter_ms_t currentMessageTimeout;
+    size_t maxConcurrentUploads; /*0 means one thread per upload*/
+    size_t activeUploadWorkers;
+    struct HTTPWORKER_THREAD_INFO_TAG* pendingUploadsHead; /*uploads waiting for a pooled upload thread, in arrival order*/
+    struct HTTPWORKER_THREAD_INFO_TAG* pendingUploadsTail;
 } IOTHUB_CLIENT_CORE_INSTANCE;
 
 typedef enum HTTPWORKER_THREAD_TYPE_TAG
@@ -98,6 +103,8 @@ typedef struct HTTPWORKER_THREAD_INFO_TAG
     UPLOADTOBLOB_SAVED_DATA uploadBlobSavedData;
     INVOKE_METHOD_SAVED_DATA invokeMethodSavedData;
     UPLOADTOBLOB_MULTIBLOCK_SAVED_DATA uploadBlobMultiblockSavedData;
+    void (*runUpload)(struct HTTPWORKER_THREAD_INFO_TAG* threadInfo); /*performs the upload, used by pooled upload threads*/
+    struct HTTPWORKER_THREAD_INFO_TAG* nextPendingUpload;
 }HTTPWORKER_THREAD_INFO;
 
 #define USER_CALLBACK_TYPE_VALUES       \
@@ -231,6 +238,31 @@ static void freeHttpWorkerThreadInfo(HTTPWORKER_THREAD_INFO* threadInfo)
     free(threadInfo);
 }
 
+// Reports FILE_UPLOAD_ERROR to uploads that were queued for a pooled upload thread but never started, and frees them.
+static void failPendingUploads(HTTPWORKER_THREAD_INFO* pendingUploads)
+{
+    while (pendingUploads != NULL)
+    {
+        HTTPWORKER_THREAD_INFO* upload = pendingUploads;
+        pendingUploads = upload->nextPendingUpload;
+
+        if (upload->uploadBlobMultiblockSavedData.getDataCallback != NULL)
+        {
+            upload->uploadBlobMultiblockSavedData.getDataCallback(FILE_UPLOAD_ERROR, NULL, NULL, upload->context);
+        }
+        else if (upload->uploadBlobMultiblockSavedData.getDataCallbackEx != NULL)
+        {
+            (void)upload->uploadBlobMultiblockSavedData.getDataCallbackEx(FILE_UPLOAD_ERROR, NULL, NULL, upload->context);
+        }
+        else if (upload->uploadBlobSavedData.iotHubClientFileUploadCallback != NULL)
+        {
+            upload->uploadBlobSavedData.iotHubClientFileUploadCallback(FILE_UPLOAD_ERROR, upload->context);
+        }
+
+        freeHttpWorkerThreadInfo(upload);
+    }
+}
+
 /*this function is called from _Destroy and from ScheduleWork_Thread to join finished blobUpload threads and free that memory*/
 static void garbageCollectorImpl(IOTHUB_CLIENT_CORE_INSTANCE* iotHubClientInstance)
 {
@@ -1227,6 +1259,7 @@ void IoTHubClientCore_Destroy(IOTHUB_CLIENT_CORE_HANDLE iotHubClientHandle)
         bool joinClientThread;
         bool joinTransportThread;
         size_t vector_size;
+        HTTPWORKER_THREAD_INFO* pendingUploads;
 
         IOTHUB_CLIENT_CORE_INSTANCE* iotHubClientInstance = (IOTHUB_CLIENT_CORE_INSTANCE*)iotHubClientHandle;
 
@@ -1301,6 +1334,11 @@ void IoTHubClientCore_Destroy(IOTHUB_CLIENT_CORE_HANDLE iotHubClientHandle)
             singlylinkedlist_destroy(iotHubClientInstance->httpWorkerThreadInfoList);
         }
 
+        // Uploads are left in the queue only if an upload slot could not be given back.
+        pendingUploads = iotHubClientInstance->pendingUploadsHead;
+        iotHubClientInstance->pendingUploadsHead = NULL;
+        iotHubClientInstance->pendingUploadsTail = NULL;
+
         IoTHubClientCore_LL_Destroy(iotHubClientInstance->IoTHubClientLLHandle);
 
         if (Unlock(iotHubClientInstance->LockHandle) != LOCK_OK)
@@ -1308,6 +1346,8 @@ void IoTHubClientCore_Destroy(IOTHUB_CLIENT_CORE_HANDLE iotHubClientHandle)
             LogError("unable to Unlock");
         }
 
+        failPendingUploads(pendingUploads);
+
         vector_size = VECTOR_size(iotHubClientInstance->saved_user_callback_list);
         size_t index = 0;
         for (index = 0; index < vector_size; index++)
@@ -1759,6 +1799,13 @@ IOTHUB_CLIENT_RESULT IoTHubClientCore_SetOption(IOTHUB_CLIENT_CORE_HANDLE iotHub
                     LogError("Invalid value: OPTION_DO_WORK_FREQUENCY_IN_MS cannot exceed %d ms. If you wish to reduce the frequency further, consider using the LL layer.", DO_WORK_MAXIMUM_ALLOWED_FREQUENCY);
                 }
             }
+#ifndef DONT_USE_UPLOADTOBLOB
+            else if (strcmp(OPTION_BLOB_UPLOAD_MAX_CONCURRENT_UPLOADS, optionName) == 0)
+            {
+                iotHubClientInstance->maxConcurrentUploads = *(size_t*)value;
+                result = IOTHUB_CLIENT_OK;
+            }
+#endif
             else if (strcmp(OPTION_MESSAGE_TIMEOUT, optionName) == 0)
             {
                 iotHubClientInstance->currentMessageTimeout = * (tickcounter_ms_t *)value;
@@ -2348,10 +2395,9 @@ static IOTHUB_CLIENT_RESULT initializeUploadToBlobData(HTTPWORKER_THREAD_INFO* t
 }
 
 
-static int uploadingThread(void *data)
+static void runUploadToBlob(HTTPWORKER_THREAD_INFO* threadInfo)
 {
     IOTHUB_CLIENT_FILE_UPLOAD_RESULT upload_result;
-    HTTPWORKER_THREAD_INFO* threadInfo = (HTTPWORKER_THREAD_INFO*)data;
 
     srand((unsigned int)get_time(NULL));
 
@@ -2371,10 +2417,141 @@ static int uploadingThread(void *data)
     {
         threadInfo->uploadBlobSavedData.iotHubClientFileUploadCallback(upload_result, threadInfo->context);
     }
+}
+
+static int uploadingThread(void *data)
+{
+    HTTPWORKER_THREAD_INFO* threadInfo = (HTTPWORKER_THREAD_INFO*)data;
+
+    runUploadToBlob(threadInfo);
+
+    return markThreadReadyToBeGarbageCollected(threadInfo);
+}
+
+// Returns the next queued upload for a pooled upload thread that is done with its current one.
+// When nothing is queued the thread gives its slot back, so the next upload request starts a new thread.
+static HTTPWORKER_THREAD_INFO* takeNextPendingUpload(IOTHUB_CLIENT_CORE_INSTANCE* iotHubClientInstance)
+{
+    HTTPWORKER_THREAD_INFO* result;
+
+    // The slot can only be given back under the lock, so the thread keeps it (and keeps running) until it gets the lock.
+    while (Lock(iotHubClientInstance->LockHandle) != LOCK_OK)
+    {
+        LogError("unable to Lock, retrying");
+        ThreadAPI_Sleep((unsigned int)iotHubClientInstance->do_work_freq_ms);
+    }
+
+    if ((result = iotHubClientInstance->pendingUploadsHead) != NULL)
+    {
+        iotHubClientInstance->pendingUploadsHead = result->nextPendingUpload;
+
+        if (iotHubClientInstance->pendingUploadsHead == NULL)
+        {
+            iotHubClientInstance->pendingUploadsTail = NULL;
+        }
+
+        result->nextPendingUpload = NULL;
+    }
+    else
+    {
+        iotHubClientInstance->activeUploadWorkers--;
+    }
+
+    (void)Unlock(iotHubClientInstance->LockHandle);
+
+    return result;
+}
+
+// Thread used when OPTION_BLOB_UPLOAD_MAX_CONCURRENT_UPLOADS is set. After the upload it was started for, it keeps
+// running the queued ones, so a burst of uploads reuses a bounded number of threads instead of creating one each.
+static int pooledUploadThread(void* data)
+{
+    HTTPWORKER_THREAD_INFO* threadInfo = (HTTPWORKER_THREAD_INFO*)data;
+    HTTPWORKER_THREAD_INFO* upload = threadInfo;
+
+    while (upload != NULL)
+    {
+        upload->runUpload(upload);
+
+        // Queued uploads were never added to httpWorkerThreadInfoList, only the one owning this thread is garbage collected.
+        if (upload != threadInfo)
+        {
+            freeHttpWorkerThreadInfo(upload);
+        }
+
+        upload = takeNextPendingUpload(threadInfo->iotHubClientHandle);
+    }
 
     return markThreadReadyToBeGarbageCollected(threadInfo);
 }
 
+static IOTHUB_CLIENT_RESULT startUploadWorker(IOTHUB_CLIENT_CORE_HANDLE iotHubClientHandle, HTTPWORKER_THREAD_INFO* threadInfo, THREAD_START_FUNC uploadThreadFunc, void (*runUpload)(HTTPWORKER_THREAD_INFO* threadInfo))
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    threadInfo->runUpload = runUpload;
+
+    if (iotHubClientHandle->maxConcurrentUploads == 0)
+    {
+        result = startHttpWorkerThread(iotHubClientHandle, threadInfo, uploadThreadFunc);
+    }
+    else if ((result = StartWorkerThreadIfNeeded(iotHubClientHandle)) != IOTHUB_CLIENT_OK)
+    {
+        LogError("Could not start worker thread");
+    }
+    else if (Lock(iotHubClientHandle->LockHandle) != LOCK_OK)
+    {
+        LogError("Lock failed");
+        result = IOTHUB_CLIENT_ERROR;
+    }
+    else
+    {
+        bool startThread;
+
+        if (iotHubClientHandle->activeUploadWorkers < iotHubClientHandle->maxConcurrentUploads)
+        {
+            iotHubClientHandle->activeUploadWorkers++;
+            startThread = true;
+        }
+        else
+        {
+            if (iotHubClientHandle->pendingUploadsTail == NULL)
+            {
+                iotHubClientHandle->pendingUploadsHead = threadInfo;
+            }
+            else
+            {
+                iotHubClientHandle->pendingUploadsTail->nextPendingUpload = threadInfo;
+            }
+
+            iotHubClientHandle->pendingUploadsTail = threadInfo;
+            startThread = false;
+        }
+
+        (void)Unlock(iotHubClientHandle->LockHandle);
+
+        if (!startThread)
+        {
+            result = IOTHUB_CLIENT_OK;
+        }
+        else if ((result = startHttpWorkerThread(iotHubClientHandle, threadInfo, pooledUploadThread)) != IOTHUB_CLIENT_OK)
+        {
+            if (Lock(iotHubClientHandle->LockHandle) != LOCK_OK)
+            {
+                // The slot stays taken. Uploads still queued when the client is destroyed are failed there.
+                LogError("unable to Lock - the upload slot is not released");
+            }
+            else
+            {
+                iotHubClientHandle->activeUploadWorkers--;
+                (void)Unlock(iotHubClientHandle->LockHandle);
+            }
+        }
+    }
+
+    return result;
+}
+
 IOTHUB_CLIENT_RESULT IoTHubClientCore_UploadToBlobAsync(IOTHUB_CLIENT_CORE_HANDLE iotHubClientHandle, const char* destinationFileName, const unsigned char* source, size_t size, IOTHUB_CLIENT_FILE_UPLOAD_CALLBACK iotHubClientFileUploadCallback, void* context)
 {
     IOTHUB_CLIENT_RESULT result;
@@ -2407,7 +2584,7 @@ IOTHUB_CLIENT_RESULT IoTHubClientCore_UploadToBlobAsync(IOTHUB_CLIENT_CORE_HANDL
             LogError("unable to initialize upload blob info");
             result = IOTHUB_CLIENT_ERROR;
         }
-        else if ((result = startHttpWorkerThread(iotHubClientHandle, threadInfo, uploadingThread)) != IOTHUB_CLIENT_OK)
+        else if ((result = startUploadWorker(iotHubClientHandle, threadInfo, uploadingThread, runUploadToBlob)) != IOTHUB_CLIENT_OK)
         {
             LogError("unable to start upload thread");
             freeHttpWorkerThreadInfo(threadInfo);
@@ -2466,9 +2643,8 @@ static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT uploadToBlobMultiblockCallbackW
     }
 }
 
-static int uploadMultipleBlock_thread(void* data)
+static void runUploadMultipleBlocks(HTTPWORKER_THREAD_INFO* threadInfo)
 {
-    HTTPWORKER_THREAD_INFO* threadInfo = (HTTPWORKER_THREAD_INFO*)data;
     IOTHUB_CLIENT_CORE_LL_HANDLE llHandle = threadInfo->iotHubClientHandle->IoTHubClientLLHandle;
 
     IOTHUB_CLIENT_RESULT result;
@@ -2494,9 +2670,15 @@ static int uploadMultipleBlock_thread(void* data)
 
         (void)threadInfo->uploadBlobMultiblockSavedData.getDataCallbackEx(finalUploadToBlobResult, NULL, NULL, threadInfo->context);
     }
-    (void)markThreadReadyToBeGarbageCollected(threadInfo);
+}
 
-    return result;
+static int uploadMultipleBlock_thread(void* data)
+{
+    HTTPWORKER_THREAD_INFO* threadInfo = (HTTPWORKER_THREAD_INFO*)data;
+
+    runUploadMultipleBlocks(threadInfo);
+
+    return markThreadReadyToBeGarbageCollected(threadInfo);
 }
 
 IOTHUB_CLIENT_RESULT IoTHubClientCore_UploadMultipleBlocksToBlobAsync(IOTHUB_CLIENT_CORE_HANDLE iotHubClientHandle, const char* destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK getDataCallback, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
@@ -2530,7 +2712,7 @@ IOTHUB_CLIENT_RESULT IoTHubClientCore_UploadMultipleBlocksToBlobAsync(IOTHUB_CLI
             threadInfo->uploadBlobMultiblockSavedData.getDataCallback = getDataCallback;
             threadInfo->uploadBlobMultiblockSavedData.getDataCallbackEx = getDataCallbackEx;
 
-            if ((result = startHttpWorkerThread(iotHubClientHandle, threadInfo, uploadMultipleBlock_thread)) != IOTHUB_CLIENT_OK)
+            if ((result = startUploadWorker(iotHubClientHandle, threadInfo, uploadMultipleBlock_thread, runUploadMultipleBlocks)) != IOTHUB_CLIENT_OK)
             {
                 LogError("unable to start upload thread");
                 freeHttpWorkerThreadInfo(threadInfo);
@@ -26,6 +26,8 @@
 #include "internal/iothub_client_authorization.h"
 #include "internal/iothub_client_private.h"
 #include "internal/iothub_client_diagnostic.h"
+#include "internal/iothub_client_twin_cache.h"
+#include "internal/iothub_client_reported_state_batch.h"
 #include "internal/iothubtransport.h"
 
 #ifndef DONT_USE_UPLOADTOBLOB
@@ -41,6 +43,7 @@
 #define LOG_ERROR_RESULT LogError("result = %s", MU_ENUM_TO_STRING(IOTHUB_CLIENT_RESULT, result));
 #define INDEFINITE_TIME ((time_t)(-1))
 #define ERROR_CODE_BECAUSE_DESTROY 0
+#define ERROR_CODE_REPORTED_STATE_BATCH_FAILURE 500
 
 MU_DEFINE_ENUM_STRINGS_WITHOUT_INVALID(IOTHUB_CLIENT_FILE_UPLOAD_RESULT, IOTHUB_CLIENT_FILE_UPLOAD_RESULT_VALUES);
 MU_DEFINE_ENUM_STRINGS_WITHOUT_INVALID(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_RESULT_VALUES);
@@ -133,6 +136,11 @@ typedef struct IOTHUB_CLIENT_CORE_LL_HANDLE_DATA_TAG
 #endif
     uint32_t data_msg_id;
     bool complete_twin_update_encountered;
+    TWIN_CACHE_HANDLE twin_cache;
+    REPORTED_STATE_BATCH_HANDLE reported_state_batch;
+    tickcounter_ms_t reported_state_batch_interval;
+    size_t reported_state_batch_size;
+    tickcounter_ms_t reported_state_batch_started;
     IOTHUB_AUTHORIZATION_HANDLE authorization_module;
     STRING_HANDLE product_info;
     IOTHUB_DIAGNOSTIC_SETTING_DATA diagnostic_setting;
@@ -558,6 +566,32 @@ static void IoTHubClientCore_LL_SendComplete(PDLIST_ENTRY completed, IOTHUB_CLIE
     }
 }
 
+static void IoTHubClientCore_LL_RetrievePropertyComplete(DEVICE_TWIN_UPDATE_STATE update_state, const unsigned char* payLoad, size_t size, void* ctx);
+
+// With the twin cache enabled, a full twin document whose desired $version was already delivered (e.g. the one
+// requested after every reconnect) is dropped, and one with a newer version is reduced to a patch of what changed.
+static void deliver_twin_update_through_cache(IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData, DEVICE_TWIN_UPDATE_STATE update_state, const unsigned char* payLoad, size_t size)
+{
+    const unsigned char* patch = NULL;
+    size_t patch_size = 0;
+    TWIN_CACHE_UPDATE_RESULT update_result = twin_cache_update(handleData->twin_cache, update_state, payLoad, size, &patch, &patch_size);
+
+    if (update_result == TWIN_CACHE_UPDATE_DELIVER_PATCH)
+    {
+        handleData->deviceTwinCallback(DEVICE_TWIN_UPDATE_PARTIAL, patch, patch_size, handleData->deviceTwinContextCallback);
+    }
+    else if (update_result != TWIN_CACHE_UPDATE_UNCHANGED && payLoad != NULL)
+    {
+        handleData->deviceTwinCallback(update_state, payLoad, size, handleData->deviceTwinContextCallback);
+
+        if (update_result == TWIN_CACHE_UPDATE_OUT_OF_SYNC &&
+            handleData->IoTHubTransport_GetTwinAsync(handleData->deviceHandle, IoTHubClientCore_LL_RetrievePropertyComplete, handleData) != IOTHUB_CLIENT_OK)
+        {
+            LogError("Failed requesting the full twin to resynchronize the twin cache");
+        }
+    }
+}
+
 static void IoTHubClientCore_LL_RetrievePropertyComplete(DEVICE_TWIN_UPDATE_STATE update_state, const unsigned char* payLoad, size_t size, void* ctx)
 {
     if (ctx == NULL)
@@ -575,7 +609,14 @@ static void IoTHubClientCore_LL_RetrievePropertyComplete(DEVICE_TWIN_UPDATE_STAT
             }
             if (handleData->complete_twin_update_encountered)
             {
-                handleData->deviceTwinCallback(update_state, payLoad, size, handleData->deviceTwinContextCallback);
+                if (handleData->twin_cache == NULL)
+                {
+                    handleData->deviceTwinCallback(update_state, payLoad, size, handleData->deviceTwinContextCallback);
+                }
+                else
+                {
+                    deliver_twin_update_through_cache(handleData, update_state, payLoad, size);
+                }
             }
         }
     }
@@ -1144,6 +1185,7 @@ static IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* initialize_iothub_client(const IOTHUB_
                     deviceConfig.deviceSasToken = config->deviceSasToken;
                     deviceConfig.authorization_module = result->authorization_module;
                     deviceConfig.moduleId = module_id;
+                    deviceConfig.tick_counter = result->tickCounter;
 
                     if ((result->deviceHandle = result->IoTHubTransport_Register(result->transportHandle, &deviceConfig, &(result->waitingToSend))) == NULL)
                     {
@@ -1241,6 +1283,80 @@ static IOTHUB_DEVICE_TWIN* dev_twin_data_create(IOTHUB_CLIENT_CORE_LL_HANDLE_DAT
     return result;
 }
 
+// Queues the merged reported properties patch as a single twin update; its callers are called back together.
+// Fails, leaving the patch and its callers in the batch, only when the patch could not be flushed.
+static int flush_reported_state_batch(IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData)
+{
+    int result;
+    const unsigned char* reportedState;
+    size_t size;
+    void* completionContext;
+
+    if (reported_state_batch_flush(handleData->reported_state_batch, &reportedState, &size, &completionContext) != 0)
+    {
+        LogError("Failure flushing the reported state batch");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        IOTHUB_DEVICE_TWIN* client_data = dev_twin_data_create(handleData, get_next_item_id(handleData), reportedState, size, reported_state_batch_complete, completionContext);
+        if (client_data == NULL)
+        {
+            LogError("Failure constructing device twin data for the reported state batch");
+            reported_state_batch_complete(ERROR_CODE_REPORTED_STATE_BATCH_FAILURE, completionContext);
+        }
+        else
+        {
+            DList_InsertTailList(&(handleData->iot_msg_queue), &(client_data->entry));
+        }
+        result = 0;
+    }
+
+    return result;
+}
+
+static IOTHUB_CLIENT_RESULT add_to_reported_state_batch(IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData, const unsigned char* reportedState, size_t size, IOTHUB_CLIENT_REPORTED_STATE_CALLBACK reportedStateCallback, void* userContextCallback)
+{
+    IOTHUB_CLIENT_RESULT result;
+    bool first_in_batch = (reported_state_batch_get_count(handleData->reported_state_batch) == 0);
+    // A patch that cannot be merged into the pending one without changing what IoT Hub ends up with starts a new batch
+    bool flush_first = (!first_in_batch && reported_state_batch_conflicts(handleData->reported_state_batch, reportedState, size));
+    tickcounter_ms_t nowTick = 0;
+
+    if (flush_first && flush_reported_state_batch(handleData) != 0)
+    {
+        LogError("Failure flushing the reported state batch ahead of a conflicting patch");
+        result = IOTHUB_CLIENT_ERROR;
+    }
+    else if ((first_in_batch || flush_first) && tickcounter_get_current_ms(handleData->tickCounter, &nowTick) != 0)
+    {
+        LogError("unable to get the current ms");
+        result = IOTHUB_CLIENT_ERROR;
+    }
+    else if (reported_state_batch_add(handleData->reported_state_batch, reportedState, size, reportedStateCallback, userContextCallback) != 0)
+    {
+        LogError("Failure adding reported state to the batch");
+        result = IOTHUB_CLIENT_ERROR;
+    }
+    else
+    {
+        if (first_in_batch || flush_first)
+        {
+            handleData->reported_state_batch_started = nowTick;
+        }
+
+        if (handleData->reported_state_batch_size != 0 &&
+            reported_state_batch_get_size(handleData->reported_state_batch) >= handleData->reported_state_batch_size)
+        {
+            // On failure the patch stays pending and DoWork flushes it once the interval elapses
+            (void)flush_reported_state_batch(handleData);
+        }
+        result = IOTHUB_CLIENT_OK;
+    }
+
+    return result;
+}
+
 static void on_get_device_twin_completed(DEVICE_TWIN_UPDATE_STATE update_state, const unsigned char* payLoad, size_t size, void* userContextCallback)
 {
     if (userContextCallback == NULL)
@@ -1808,6 +1924,15 @@ void IoTHubClientCore_LL_Destroy(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle
             free(temp);
         }
 
+        if (handleData->reported_state_batch != NULL && reported_state_batch_get_count(handleData->reported_state_batch) > 0)
+        {
+            // Pending callers are called back with the rest of the queue, or right here if the patch cannot be queued
+            if (flush_reported_state_batch(handleData) != 0)
+            {
+                reported_state_batch_abandon(handleData->reported_state_batch, ERROR_CODE_REPORTED_STATE_BATCH_FAILURE);
+            }
+        }
+
         while ((unsend = DList_RemoveHeadList(&(handleData->iot_msg_queue))) != &(handleData->iot_msg_queue))
         {
             IOTHUB_DEVICE_TWIN* temp = containingRecord(unsend, IOTHUB_DEVICE_TWIN, entry);
@@ -1839,6 +1964,14 @@ void IoTHubClientCore_LL_Destroy(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle
 
         delete_event_callback_list(handleData);
 
+        if (handleData->twin_cache != NULL)
+        {
+            twin_cache_destroy(handleData->twin_cache);
+        }
+        if (handleData->reported_state_batch != NULL)
+        {
+            reported_state_batch_destroy(handleData->reported_state_batch);
+        }
         IoTHubClient_Auth_Destroy(handleData->authorization_module);
         tickcounter_destroy(handleData->tickCounter);
 #ifndef DONT_USE_UPLOADTOBLOB
@@ -2126,6 +2259,20 @@ void IoTHubClientCore_LL_DoWork(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle)
         IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_CORE_LL_HANDLE_DATA*)iotHubClientHandle;
         DoTimeouts(handleData);
 
+        if (handleData->reported_state_batch != NULL && reported_state_batch_get_count(handleData->reported_state_batch) > 0)
+        {
+            tickcounter_ms_t nowTick;
+            if (tickcounter_get_current_ms(handleData->tickCounter, &nowTick) != 0)
+            {
+                LogError("unable to get the current ms, reported state batch not flushed");
+            }
+            else if (nowTick - handleData->reported_state_batch_started >= handleData->reported_state_batch_interval)
+            {
+                // On failure the patch stays pending and is flushed again on a later DoWork
+                (void)flush_reported_state_batch(handleData);
+            }
+        }
+
         DLIST_ENTRY* client_item = handleData->iot_msg_queue.Flink;
         while (client_item != &(handleData->iot_msg_queue)) /*while we are not at the end of the list*/
         {
@@ -2149,6 +2296,11 @@ void IoTHubClientCore_LL_DoWork(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle)
                 else
                 {
                     LogError("Failure queue processing item");
+                    if (queue_data->reported_state_callback == reported_state_batch_complete)
+                    {
+                        // The merged patch owns its callers' callbacks
+                        reported_state_batch_complete(ERROR_CODE_REPORTED_STATE_BATCH_FAILURE, queue_data->context);
+                    }
                     device_twin_data_destroy(queue_data);
                 }
             }
@@ -2346,7 +2498,10 @@ IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_SetOption(IOTHUB_CLIENT_CORE_LL_HANDLE
         else if ((strcmp(optionName, OPTION_BLOB_UPLOAD_TIMEOUT_SECS) == 0) || 
                  (strcmp(optionName, OPTION_CURL_VERBOSE) == 0) || 
                  (strcmp(optionName, OPTION_NETWORK_INTERFACE_UPLOAD_TO_BLOB) == 0) ||
-                 (strcmp(optionName, OPTION_BLOB_UPLOAD_TLS_RENEGOTIATION) == 0))
+                 (strcmp(optionName, OPTION_BLOB_UPLOAD_TLS_RENEGOTIATION) == 0) ||
+                 (strcmp(optionName, OPTION_BLOB_UPLOAD_PARALLELISM) == 0) ||
+                 (strcmp(optionName, OPTION_BLOB_UPLOAD_REUSE_CONNECTIONS) == 0) ||
+                 (strcmp(optionName, OPTION_BLOB_UPLOAD_COMPRESSION) == 0))
         {
 #ifndef DONT_USE_UPLOADTOBLOB
             // This option just gets passed down into IoTHubClientCore_LL_UploadToBlob
@@ -2375,6 +2530,79 @@ IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_SetOption(IOTHUB_CLIENT_CORE_LL_HANDLE
                 result = IOTHUB_CLIENT_OK;
             }
         }
+        else if (strcmp(optionName, OPTION_SAS_TOKEN_CACHE) == 0)
+        {
+            if (IoTHubClient_Auth_Set_SasToken_Cache(handleData->authorization_module, *(const bool*)value) != 0)
+            {
+                LogError("Failed setting the SAS token cache");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        else if (strcmp(optionName, OPTION_TWIN_CACHE) == 0)
+        {
+            if (*(const bool*)value)
+            {
+                if (handleData->twin_cache == NULL && (handleData->twin_cache = twin_cache_create()) == NULL)
+                {
+                    LogError("Failed creating the twin cache");
+                    result = IOTHUB_CLIENT_ERROR;
+                }
+                else
+                {
+                    result = IOTHUB_CLIENT_OK;
+                }
+            }
+            else
+            {
+                if (handleData->twin_cache != NULL)
+                {
+                    twin_cache_destroy(handleData->twin_cache);
+                    handleData->twin_cache = NULL;
+                }
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        else if (strcmp(optionName, OPTION_REPORTED_STATE_BATCH_INTERVAL) == 0)
+        {
+            handleData->reported_state_batch_interval = *(const tickcounter_ms_t*)value;
+
+            if (handleData->reported_state_batch_interval != 0)
+            {
+                if (handleData->reported_state_batch == NULL && (handleData->reported_state_batch = reported_state_batch_create()) == NULL)
+                {
+                    LogError("Failed creating the reported state batch");
+                    handleData->reported_state_batch_interval = 0;
+                    result = IOTHUB_CLIENT_ERROR;
+                }
+                else
+                {
+                    result = IOTHUB_CLIENT_OK;
+                }
+            }
+            else
+            {
+                if (handleData->reported_state_batch != NULL)
+                {
+                    if (reported_state_batch_get_count(handleData->reported_state_batch) > 0 &&
+                        flush_reported_state_batch(handleData) != 0)
+                    {
+                        reported_state_batch_abandon(handleData->reported_state_batch, ERROR_CODE_REPORTED_STATE_BATCH_FAILURE);
+                    }
+                    reported_state_batch_destroy(handleData->reported_state_batch);
+                    handleData->reported_state_batch = NULL;
+                }
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        else if (strcmp(optionName, OPTION_REPORTED_STATE_BATCH_SIZE) == 0)
+        {
+            handleData->reported_state_batch_size = *(const size_t*)value;
+            result = IOTHUB_CLIENT_OK;
+        }
         else if (strcmp(optionName, OPTION_MODEL_ID) == 0)
         {
             if (handleData->model_id != NULL)
@@ -2436,6 +2664,11 @@ IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_SetDeviceTwinCallback(IOTHUB_CLIENT_COR
             {
                 handleData->deviceTwinCallback = deviceTwinCallback;
                 handleData->deviceTwinContextCallback = userContextCallback;
+                // A newly registered callback must first see the full document
+                if (handleData->twin_cache != NULL)
+                {
+                    twin_cache_reset(handleData->twin_cache);
+                }
                 result = IOTHUB_CLIENT_OK;
             }
             else
@@ -2455,6 +2688,18 @@ IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_SendReportedState(IOTHUB_CLIENT_CORE_LL
         result = IOTHUB_CLIENT_INVALID_ARG;
         LogError("Invalid argument specified iothubClientHandle=%p, reportedState=%p, size=%lu", iotHubClientHandle, reportedState, (unsigned long)size);
     }
+    else if (iotHubClientHandle->reported_state_batch != NULL)
+    {
+        if (iotHubClientHandle->IoTHubTransport_Subscribe_DeviceTwin(iotHubClientHandle->transportHandle) != 0)
+        {
+            LogError("Failure subscribing to device twin");
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            result = add_to_reported_state_batch(iotHubClientHandle, reportedState, size, reportedStateCallback, userContextCallback);
+        }
+    }
     else
     {
         IOTHUB_CLIENT_CORE_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_CORE_LL_HANDLE_DATA*)iotHubClientHandle;
@@ -2815,6 +3060,51 @@ IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_UploadToBlob(IOTHUB_CLIENT_CORE_LL_HAND
     return result;
 }
 
+IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_UploadFileToBlob(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle, const char* destinationFileName, const char* sourceFilePath)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    if (
+        (iotHubClientHandle == NULL) ||
+        (destinationFileName == NULL) ||
+        (sourceFilePath == NULL)
+        )
+    {
+        LogError("invalid parameters iotHubClientHandle=%p, destinationFileName=%s, sourceFilePath=%s",
+            iotHubClientHandle, MU_P_OR_NULL(destinationFileName), MU_P_OR_NULL(sourceFilePath));
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        result = IoTHubClient_LL_UploadToBlob_UploadFile(iotHubClientHandle->uploadToBlobHandle, destinationFileName, sourceFilePath, NULL);
+    }
+
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClientCore_LL_UploadFileToBlobResumable(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle, const char* destinationFileName, const char* sourceFilePath, const char* checkpointFilePath)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    if (
+        (iotHubClientHandle == NULL) ||
+        (destinationFileName == NULL) ||
+        (sourceFilePath == NULL) ||
+        (checkpointFilePath == NULL)
+        )
+    {
+        LogError("invalid parameters iotHubClientHandle=%p, destinationFileName=%s, sourceFilePath=%s, checkpointFilePath=%s",
+            iotHubClientHandle, MU_P_OR_NULL(destinationFileName), MU_P_OR_NULL(sourceFilePath), MU_P_OR_NULL(checkpointFilePath));
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        result = IoTHubClient_LL_UploadToBlob_UploadFile(iotHubClientHandle->uploadToBlobHandle, destinationFileName, sourceFilePath, checkpointFilePath);
+    }
+
+    return result;
+}
+
 typedef struct UPLOAD_MULTIPLE_BLOCKS_WRAPPER_CONTEXT_TAG
 {
     IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK getDataCallback;
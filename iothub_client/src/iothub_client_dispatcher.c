@@ -0,0 +1,326 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#include "iothub_client_dispatcher.h"
+
+// Response payload for commands no component declared.  The SDK frees command responses, so it is copied with malloc().
+static const char DISPATCHER_COMMAND_NOT_FOUND_PAYLOAD[] = "{}";
+
+// The root component is stored under an empty name so that it sorts, and is looked up, like any other component.
+static const char DISPATCHER_ROOT_COMPONENT_NAME[] = "";
+
+typedef struct DISPATCHER_COMPONENT_TAG
+{
+    const char* componentName;
+    // Sorted by name, so that they can be looked up with bsearch().
+    IOTHUB_CLIENT_DISPATCHER_COMMAND* commands;
+    size_t numCommands;
+    IOTHUB_CLIENT_DISPATCHER_PROPERTY* writableProperties;
+    size_t numWritableProperties;
+    void* userContextCallback;
+} DISPATCHER_COMPONENT;
+
+typedef struct IOTHUB_CLIENT_DISPATCHER_TAG
+{
+    // Sorted by name.  The components, commands and properties are stored in the same allocation as the dispatcher.
+    DISPATCHER_COMPONENT* components;
+    size_t numComponents;
+} IOTHUB_CLIENT_DISPATCHER;
+
+static int CompareComponents(const void* left, const void* right)
+{
+    return strcmp(((const DISPATCHER_COMPONENT*)left)->componentName, ((const DISPATCHER_COMPONENT*)right)->componentName);
+}
+
+static int CompareCommands(const void* left, const void* right)
+{
+    return strcmp(((const IOTHUB_CLIENT_DISPATCHER_COMMAND*)left)->commandName, ((const IOTHUB_CLIENT_DISPATCHER_COMMAND*)right)->commandName);
+}
+
+static int CompareProperties(const void* left, const void* right)
+{
+    return strcmp(((const IOTHUB_CLIENT_DISPATCHER_PROPERTY*)left)->propertyName, ((const IOTHUB_CLIENT_DISPATCHER_PROPERTY*)right)->propertyName);
+}
+
+// HasDuplicates returns true if two consecutive elements of the sorted array compare equal.
+static bool HasDuplicates(const void* elements, size_t numElements, size_t elementSize, int (*compare)(const void*, const void*))
+{
+    bool result = false;
+
+    for (size_t i = 1; i < numElements; i++)
+    {
+        if (compare((const char*)elements + ((i - 1) * elementSize), (const char*)elements + (i * elementSize)) == 0)
+        {
+            result = true;
+            break;
+        }
+    }
+
+    return result;
+}
+
+// VerifyComponents makes sure the components passed to IoTHubClient_Dispatcher_Create are valid, and counts the commands
+// and properties they declare.
+static bool VerifyComponents(const IOTHUB_CLIENT_DISPATCHER_COMPONENT* components, size_t numComponents, size_t* totalCommands, size_t* totalProperties)
+{
+    size_t i;
+
+    *totalCommands = 0;
+    *totalProperties = 0;
+
+    for (i = 0; i < numComponents; i++)
+    {
+        const IOTHUB_CLIENT_DISPATCHER_COMPONENT* component = &components[i];
+        size_t j;
+
+        if ((component->structVersion != IOTHUB_CLIENT_DISPATCHER_COMPONENT_STRUCT_VERSION_1) ||
+            ((component->commands == NULL) && (component->numCommands != 0)) ||
+            ((component->writableProperties == NULL) && (component->numWritableProperties != 0)))
+        {
+            LogError("Component at index %lu is invalid", (unsigned long)i);
+            break;
+        }
+
+        for (j = 0; j < component->numCommands; j++)
+        {
+            if ((component->commands[j].commandName == NULL) || (component->commands[j].commandCallback == NULL))
+            {
+                LogError("Command at index %lu of component at index %lu is invalid", (unsigned long)j, (unsigned long)i);
+                break;
+            }
+        }
+
+        if (j != component->numCommands)
+        {
+            break;
+        }
+
+        for (j = 0; j < component->numWritableProperties; j++)
+        {
+            if ((component->writableProperties[j].propertyName == NULL) || (component->writableProperties[j].propertyCallback == NULL))
+            {
+                LogError("Property at index %lu of component at index %lu is invalid", (unsigned long)j, (unsigned long)i);
+                break;
+            }
+        }
+
+        if (j != component->numWritableProperties)
+        {
+            break;
+        }
+
+        *totalCommands += component->numCommands;
+        *totalProperties += component->numWritableProperties;
+    }
+
+    return (i == numComponents);
+}
+
+// FindComponent returns the component called componentName (NULL for the root component), or NULL if there is none.
+static const DISPATCHER_COMPONENT* FindComponent(const IOTHUB_CLIENT_DISPATCHER* dispatcher, const char* componentName)
+{
+    DISPATCHER_COMPONENT key;
+    key.componentName = (componentName == NULL) ? DISPATCHER_ROOT_COMPONENT_NAME : componentName;
+
+    return (const DISPATCHER_COMPONENT*)bsearch(&key, dispatcher->components, dispatcher->numComponents, sizeof(DISPATCHER_COMPONENT), CompareComponents);
+}
+
+IOTHUB_CLIENT_DISPATCHER_HANDLE IoTHubClient_Dispatcher_Create(const IOTHUB_CLIENT_DISPATCHER_COMPONENT* components, size_t numComponents)
+{
+    IOTHUB_CLIENT_DISPATCHER* result;
+    size_t totalCommands;
+    size_t totalProperties;
+
+    if ((components == NULL) || (numComponents == 0))
+    {
+        LogError("Invalid argument (components=%p, numComponents=%lu)", components, (unsigned long)numComponents);
+        result = NULL;
+    }
+    else if (VerifyComponents(components, numComponents, &totalCommands, &totalProperties) == false)
+    {
+        LogError("Invalid components");
+        result = NULL;
+    }
+    else if ((result = (IOTHUB_CLIENT_DISPATCHER*)calloc(1, sizeof(IOTHUB_CLIENT_DISPATCHER) + (numComponents * sizeof(DISPATCHER_COMPONENT)) +
+                                                          (totalCommands * sizeof(IOTHUB_CLIENT_DISPATCHER_COMMAND)) +
+                                                          (totalProperties * sizeof(IOTHUB_CLIENT_DISPATCHER_PROPERTY)))) == NULL)
+    {
+        LogError("Cannot allocate dispatcher for %lu components", (unsigned long)numComponents);
+    }
+    else
+    {
+        IOTHUB_CLIENT_DISPATCHER_COMMAND* nextCommand;
+        IOTHUB_CLIENT_DISPATCHER_PROPERTY* nextProperty;
+        bool duplicates = false;
+
+        result->components = (DISPATCHER_COMPONENT*)(result + 1);
+        result->numComponents = numComponents;
+        nextCommand = (IOTHUB_CLIENT_DISPATCHER_COMMAND*)(result->components + numComponents);
+        nextProperty = (IOTHUB_CLIENT_DISPATCHER_PROPERTY*)(nextCommand + totalCommands);
+
+        for (size_t i = 0; (i < numComponents) && (duplicates == false); i++)
+        {
+            DISPATCHER_COMPONENT* component = &result->components[i];
+
+            component->componentName = (components[i].componentName == NULL) ? DISPATCHER_ROOT_COMPONENT_NAME : components[i].componentName;
+            component->userContextCallback = components[i].userContextCallback;
+
+            component->commands = nextCommand;
+            component->numCommands = components[i].numCommands;
+            if (component->numCommands != 0)
+            {
+                memcpy(component->commands, components[i].commands, component->numCommands * sizeof(IOTHUB_CLIENT_DISPATCHER_COMMAND));
+                qsort(component->commands, component->numCommands, sizeof(IOTHUB_CLIENT_DISPATCHER_COMMAND), CompareCommands);
+            }
+            nextCommand += component->numCommands;
+
+            component->writableProperties = nextProperty;
+            component->numWritableProperties = components[i].numWritableProperties;
+            if (component->numWritableProperties != 0)
+            {
+                memcpy(component->writableProperties, components[i].writableProperties, component->numWritableProperties * sizeof(IOTHUB_CLIENT_DISPATCHER_PROPERTY));
+                qsort(component->writableProperties, component->numWritableProperties, sizeof(IOTHUB_CLIENT_DISPATCHER_PROPERTY), CompareProperties);
+            }
+            nextProperty += component->numWritableProperties;
+
+            if (HasDuplicates(component->commands, component->numCommands, sizeof(IOTHUB_CLIENT_DISPATCHER_COMMAND), CompareCommands) ||
+                HasDuplicates(component->writableProperties, component->numWritableProperties, sizeof(IOTHUB_CLIENT_DISPATCHER_PROPERTY), CompareProperties))
+            {
+                LogError("Component %s declares a command or property more than once", component->componentName);
+                duplicates = true;
+            }
+        }
+
+        if (duplicates == false)
+        {
+            qsort(result->components, numComponents, sizeof(DISPATCHER_COMPONENT), CompareComponents);
+
+            if (HasDuplicates(result->components, numComponents, sizeof(DISPATCHER_COMPONENT), CompareComponents))
+            {
+                LogError("A component is declared more than once");
+                duplicates = true;
+            }
+        }
+
+        if (duplicates)
+        {
+            free(result);
+            result = NULL;
+        }
+    }
+
+    return result;
+}
+
+void IoTHubClient_Dispatcher_CommandCallback(const IOTHUB_CLIENT_COMMAND_REQUEST* commandRequest, IOTHUB_CLIENT_COMMAND_RESPONSE* commandResponse, void* userContextCallback)
+{
+    const IOTHUB_CLIENT_DISPATCHER* dispatcher = (const IOTHUB_CLIENT_DISPATCHER*)userContextCallback;
+
+    if ((commandRequest == NULL) || (commandResponse == NULL) || (dispatcher == NULL))
+    {
+        LogError("Invalid argument (commandRequest=%p, commandResponse=%p, userContextCallback=%p)", commandRequest, commandResponse, userContextCallback);
+    }
+    else
+    {
+        const DISPATCHER_COMPONENT* component;
+        const IOTHUB_CLIENT_DISPATCHER_COMMAND* command = NULL;
+        IOTHUB_CLIENT_DISPATCHER_COMMAND key;
+
+        key.commandName = commandRequest->commandName;
+
+        if (((component = FindComponent(dispatcher, commandRequest->componentName)) != NULL) && (commandRequest->commandName != NULL))
+        {
+            command = (const IOTHUB_CLIENT_DISPATCHER_COMMAND*)bsearch(&key, component->commands, component->numCommands, sizeof(IOTHUB_CLIENT_DISPATCHER_COMMAND), CompareCommands);
+        }
+
+        if (command != NULL)
+        {
+            command->commandCallback(commandRequest, commandResponse, component->userContextCallback);
+        }
+        else
+        {
+            LogError("Command %s of component %s is not declared", MU_P_OR_NULL(commandRequest->commandName), MU_P_OR_NULL(commandRequest->componentName));
+            commandResponse->statusCode = IOTHUB_CLIENT_DISPATCHER_COMMAND_NOT_FOUND_STATUS;
+
+            if ((commandResponse->payload = (unsigned char*)malloc(sizeof(DISPATCHER_COMMAND_NOT_FOUND_PAYLOAD) - 1)) == NULL)
+            {
+                LogError("Cannot allocate command response");
+                commandResponse->payloadLength = 0;
+            }
+            else
+            {
+                memcpy(commandResponse->payload, DISPATCHER_COMMAND_NOT_FOUND_PAYLOAD, sizeof(DISPATCHER_COMMAND_NOT_FOUND_PAYLOAD) - 1);
+                commandResponse->payloadLength = sizeof(DISPATCHER_COMMAND_NOT_FOUND_PAYLOAD) - 1;
+            }
+        }
+    }
+}
+
+void IoTHubClient_Dispatcher_PropertiesCallback(IOTHUB_CLIENT_PROPERTY_PAYLOAD_TYPE payloadType, const unsigned char* payload, size_t payloadLength, void* userContextCallback)
+{
+    const IOTHUB_CLIENT_DISPATCHER* dispatcher = (const IOTHUB_CLIENT_DISPATCHER*)userContextCallback;
+    IOTHUB_CLIENT_PROPERTIES_DESERIALIZER_HANDLE deserializerHandle;
+    int propertiesVersion;
+
+    if (dispatcher == NULL)
+    {
+        LogError("Invalid argument (userContextCallback=NULL)");
+    }
+    else if (IoTHubClient_Properties_Deserializer_Create(payloadType, payload, payloadLength, &deserializerHandle) != IOTHUB_CLIENT_OK)
+    {
+        LogError("Cannot deserialize properties");
+    }
+    else
+    {
+        if (IoTHubClient_Properties_Deserializer_GetVersion(deserializerHandle, &propertiesVersion) != IOTHUB_CLIENT_OK)
+        {
+            LogError("Cannot get properties version");
+        }
+        else
+        {
+            IOTHUB_CLIENT_PROPERTY_PARSED property;
+            bool propertySpecified;
+
+            property.structVersion = IOTHUB_CLIENT_PROPERTY_PARSED_STRUCT_VERSION_1;
+
+            while ((IoTHubClient_Properties_Deserializer_GetNext(deserializerHandle, &property, &propertySpecified) == IOTHUB_CLIENT_OK) && (propertySpecified == true))
+            {
+                const DISPATCHER_COMPONENT* component;
+
+                // Properties reported by the device itself are not routed; only the writable ones the service sets are.
+                if ((property.propertyType == IOTHUB_CLIENT_PROPERTY_TYPE_WRITABLE) &&
+                    ((component = FindComponent(dispatcher, property.componentName)) != NULL))
+                {
+                    IOTHUB_CLIENT_DISPATCHER_PROPERTY key;
+                    const IOTHUB_CLIENT_DISPATCHER_PROPERTY* writableProperty;
+
+                    key.propertyName = property.name;
+
+                    if ((writableProperty = (const IOTHUB_CLIENT_DISPATCHER_PROPERTY*)bsearch(&key, component->writableProperties, component->numWritableProperties, sizeof(IOTHUB_CLIENT_DISPATCHER_PROPERTY), CompareProperties)) != NULL)
+                    {
+                        writableProperty->propertyCallback(&property, propertiesVersion, component->userContextCallback);
+                    }
+                }
+
+                IoTHubClient_Properties_DeserializerProperty_Destroy(&property);
+            }
+        }
+
+        IoTHubClient_Properties_Deserializer_Destroy(deserializerHandle);
+    }
+}
+
+void IoTHubClient_Dispatcher_Destroy(IOTHUB_CLIENT_DISPATCHER_HANDLE dispatcherHandle)
+{
+    if (dispatcherHandle != NULL)
+    {
+        // The components, commands and properties are part of the same allocation.
+        free(dispatcherHandle);
+    }
+}
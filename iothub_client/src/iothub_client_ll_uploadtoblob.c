@@ -3,8 +3,18 @@
 
 #ifndef DONT_USE_UPLOADTOBLOB
 
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+// Makes off_t (used by fseeko/ftello) 64-bit on 32-bit POSIX platforms.
+#define _FILE_OFFSET_BITS 64
+#endif
+
 #include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
 #include <string.h>
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/string_tokenizer.h"
@@ -16,6 +26,9 @@
 #include "azure_c_shared_utility/urlencode.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/safe_math.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
+#include "azure_c_shared_utility/threadapi.h"
 
 #include "iothub_client_core_ll.h"
 #include "iothub_client_options.h"
@@ -43,6 +56,19 @@ static const char* const HEADER_APP_JSON = "application/json";
 #define HTTP_STATUS_CODE_BAD_REQUEST        400
 #define IS_HTTP_STATUS_CODE_SUCCESS(x)      ((x) >= 100 && (x) < 300)
 
+#define DEFAULT_BLOB_UPLOAD_PARALLELISM     1
+#define MAX_BLOB_UPLOAD_PARALLELISM         64
+// Upper bound for each wait on the parallel upload conditions, so a lost wake-up only delays (never stalls) the upload.
+#define PARALLEL_UPLOAD_WAIT_TIMEOUT_MS     1000
+#define FILE_UPLOAD_BLOCK_SIZE              (4 * 1024 * 1024)
+
+static const char* const CHECKPOINT_DESTINATION_FILE_NAME = "destinationFileName";
+static const char* const CHECKPOINT_SOURCE_FILE_PATH = "sourceFilePath";
+static const char* const CHECKPOINT_SOURCE_SIZE = "sourceSize";
+static const char* const CHECKPOINT_BLOCK_SIZE = "blockSize";
+static const char* const CHECKPOINT_UPLOADED_BLOCK_COUNT = "uploadedBlockCount";
+static const char* const CHECKPOINT_CORRELATION_ID = "correlationId";
+
 typedef struct UPLOADTOBLOB_X509_CREDENTIALS_TAG
 {
     char* x509certificate;
@@ -58,6 +84,16 @@ typedef enum UPLOADTOBLOB_CURL_VERBOSITY_TAG
     UPLOADTOBLOB_CURL_VERBOSITY_OFF
 } UPLOADTOBLOB_CURL_VERBOSITY;
 
+// An HTTP connection kept open between uploads when OPTION_BLOB_UPLOAD_REUSE_CONNECTIONS is set.
+// It is lent to one upload at a time; concurrent uploads fall back to a connection of their own.
+typedef struct UPLOADTOBLOB_HTTP_SESSION_TAG
+{
+    char* hostname;
+    HTTPAPIEX_HANDLE httpApiHandle;
+    bool isInUse;
+    bool isStale;
+} UPLOADTOBLOB_HTTP_SESSION;
+
 typedef struct IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA_TAG
 {
     const char* deviceId;
@@ -76,6 +112,12 @@ typedef struct IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA_TAG
     size_t blob_upload_timeout_millisecs;
     const char* networkInterface;
     bool tls_renegotiation;
+    size_t blob_upload_parallelism;
+    bool reuse_connections;
+    LOCK_HANDLE sessionLock;
+    UPLOADTOBLOB_HTTP_SESSION iotHubSession;
+    UPLOADTOBLOB_HTTP_SESSION blobStorageSession;
+    IOTHUB_CLIENT_FILE_UPLOAD_COMPRESSION compression;
 } IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA;
 
 typedef struct BLOB_UPLOAD_CONTEXT_TAG
@@ -94,8 +136,74 @@ typedef struct IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT_STRUCT
     SINGLYLINKEDLIST_HANDLE blockIdList;
 
     HTTPAPIEX_HANDLE blobHttpApiHandle;
+    BUFFER_HANDLE fileBlockData; /* reused by every IoTHubClient_LL_UploadToBlob_PutBlockFromFile call, created on first use */
+    char* contentEncoding; /* set for the duration of a compressed upload, committed with the block list */
 } IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT;
 
+// Data source wrapped around the application's get-data callback when OPTION_BLOB_UPLOAD_COMPRESSION is set.
+// It hands out full blocks of compressed data, so small compressed chunks do not each become a block.
+typedef struct COMPRESSED_UPLOAD_TAG
+{
+    IOTHUB_CLIENT_FILE_UPLOAD_COMPRESSION compression; /* copied, so the option can change while this upload runs */
+    void* stream;
+    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx;
+    void* context;
+    unsigned char* block;
+    size_t blockSize;
+    const unsigned char* pendingOutput; /* compressor output not yet copied into block */
+    size_t pendingOutputSize;
+    size_t rawByteCount;
+    size_t compressedByteCount;
+    bool isInputDone;
+    bool isFlushed;
+} COMPRESSED_UPLOAD;
+
+// Progress of a file upload, persisted after every block so an interrupted upload can skip the blocks already in Azure Storage.
+typedef struct UPLOAD_FILE_CHECKPOINT_TAG
+{
+    const char* checkpointFilePath; /* NULL when progress is not persisted */
+    const char* destinationFileName;
+    const char* sourceFilePath;
+    int64_t sourceSize;
+    uint32_t uploadedBlockCount;
+    char* correlationId; /* upload still open in IoT Hub, NULL once its completion has been notified */
+} UPLOAD_FILE_CHECKPOINT;
+
+typedef struct PARALLEL_UPLOAD_BLOCK_TAG
+{
+    unsigned int blockID;
+    BUFFER_HANDLE blockData;
+} PARALLEL_UPLOAD_BLOCK;
+
+// State shared between the thread reading blocks from the user callback and the workers uploading them.
+// Everything below lock is protected by it.
+typedef struct PARALLEL_UPLOAD_TAG
+{
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT* uploadContext;
+    LOCK_HANDLE lock;
+    COND_HANDLE blockAvailable;
+    COND_HANDLE slotAvailable;
+
+    PARALLEL_UPLOAD_BLOCK* ring; /* blocks read from the user, waiting for a worker */
+    size_t ringCapacity;
+    size_t ringHead;
+    size_t ringCount;
+    STRING_HANDLE* blockIds; /* encoded block IDs indexed by block number, so Put Block List keeps the original order */
+    size_t blockIdsCapacity;
+    bool isProducerDone;
+    bool isError;
+} PARALLEL_UPLOAD;
+
+typedef struct PARALLEL_UPLOAD_WORKER_TAG
+{
+    PARALLEL_UPLOAD* parallelUpload;
+    HTTPAPIEX_HANDLE httpApiHandle;
+    bool ownsHttpApiHandle;
+    SINGLYLINKEDLIST_HANDLE blockIdList;
+    THREAD_HANDLE threadHandle;
+    bool isFailed; /* set by the worker when it could not take the lock; read by the caller after joining it */
+} PARALLEL_UPLOAD_WORKER;
+
 static int send_http_sas_request(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* upload_client, HTTPAPIEX_HANDLE http_api_handle, const char* relative_path, HTTP_HEADERS_HANDLE request_header, BUFFER_HANDLE blobBuffer, BUFFER_HANDLE response_buff)
 {
     int result;
@@ -465,6 +573,140 @@ static HTTPAPIEX_HANDLE createIotHubHttpApiExHandle(IOTHUB_CLIENT_LL_UPLOADTOBLO
     return iotHubHttpApiExHandle;
 }
 
+static void destroyHttpSession(UPLOADTOBLOB_HTTP_SESSION* session)
+{
+    HTTPAPIEX_Destroy(session->httpApiHandle);
+    free(session->hostname);
+    (void)memset(session, 0, sizeof(UPLOADTOBLOB_HTTP_SESSION));
+}
+
+// Returns the kept-alive connection to hostname if it is idle, NULL otherwise (the caller then opens a new one).
+static HTTPAPIEX_HANDLE takeHttpSession(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* upload_data, UPLOADTOBLOB_HTTP_SESSION* session, const char* hostname)
+{
+    HTTPAPIEX_HANDLE result = NULL;
+
+    if (upload_data->reuse_connections)
+    {
+        if (Lock(upload_data->sessionLock) != LOCK_OK)
+        {
+            LogError("unable to Lock, a new connection will be used");
+        }
+        else
+        {
+            if (session->httpApiHandle != NULL && !session->isInUse && !session->isStale &&
+                strcmp(session->hostname, hostname) == 0)
+            {
+                session->isInUse = true;
+                result = session->httpApiHandle;
+            }
+
+            (void)Unlock(upload_data->sessionLock);
+        }
+    }
+
+    return result;
+}
+
+// Hands a connection back once a request is done with it. It is kept for the next upload if connection reuse is on
+// and no other connection to that host is kept already; otherwise it is closed.
+static void returnHttpSession(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* upload_data, UPLOADTOBLOB_HTTP_SESSION* session, const char* hostname, HTTPAPIEX_HANDLE httpApiHandle)
+{
+    if (upload_data->sessionLock == NULL)
+    {
+        HTTPAPIEX_Destroy(httpApiHandle);
+    }
+    else if (Lock(upload_data->sessionLock) != LOCK_OK)
+    {
+        LogError("unable to Lock, closing connection");
+
+        if (httpApiHandle != session->httpApiHandle)
+        {
+            HTTPAPIEX_Destroy(httpApiHandle);
+        }
+    }
+    else
+    {
+        if (httpApiHandle == session->httpApiHandle)
+        {
+            session->isInUse = false;
+
+            if (session->isStale || !upload_data->reuse_connections)
+            {
+                destroyHttpSession(session);
+            }
+        }
+        else if (upload_data->reuse_connections && session->httpApiHandle == NULL)
+        {
+            char* hostnameCopy;
+
+            if (mallocAndStrcpy_s(&hostnameCopy, hostname) != 0)
+            {
+                LogError("failed copying hostname, closing connection");
+                HTTPAPIEX_Destroy(httpApiHandle);
+            }
+            else
+            {
+                session->hostname = hostnameCopy;
+                session->httpApiHandle = httpApiHandle;
+            }
+        }
+        else
+        {
+            HTTPAPIEX_Destroy(httpApiHandle);
+        }
+
+        (void)Unlock(upload_data->sessionLock);
+    }
+}
+
+// Kept-alive connections were configured with the options in effect when they were opened; drop them when those change.
+static void invalidateHttpSessions(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* upload_data)
+{
+    if (upload_data->sessionLock != NULL)
+    {
+        if (Lock(upload_data->sessionLock) != LOCK_OK)
+        {
+            LogError("unable to Lock, kept-alive connections were not invalidated");
+        }
+        else
+        {
+            UPLOADTOBLOB_HTTP_SESSION* sessions[2] = { &upload_data->iotHubSession, &upload_data->blobStorageSession };
+            size_t i;
+
+            for (i = 0; i < sizeof(sessions) / sizeof(sessions[0]); i++)
+            {
+                if (sessions[i]->isInUse)
+                {
+                    sessions[i]->isStale = true;
+                }
+                else if (sessions[i]->httpApiHandle != NULL)
+                {
+                    destroyHttpSession(sessions[i]);
+                }
+            }
+
+            (void)Unlock(upload_data->sessionLock);
+        }
+    }
+}
+
+static HTTPAPIEX_HANDLE acquireIotHubHttpApiExHandle(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* upload_data)
+{
+    HTTPAPIEX_HANDLE result = takeHttpSession(upload_data, &upload_data->iotHubSession, upload_data->hostname);
+
+    if (result == NULL)
+    {
+        result = createIotHubHttpApiExHandle(upload_data);
+    }
+
+    return result;
+}
+
+static void releaseIotHubHttpApiExHandle(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* upload_data, HTTPAPIEX_HANDLE iotHubHttpApiExHandle)
+{
+    returnHttpSession(upload_data, &upload_data->iotHubSession, upload_data->hostname, iotHubHttpApiExHandle);
+}
+
 static int IoTHubClient_LL_UploadToBlob_GetBlobCredentialsFromIoTHub(
     IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* upload_data, const char* destinationFileName, char** correlationId, char** sasUri)
 {
@@ -509,7 +751,7 @@ static int IoTHubClient_LL_UploadToBlob_GetBlobCredentialsFromIoTHub(
                 }
                 else
                 {
-                    HTTPAPIEX_HANDLE iotHubHttpApiExHandle = createIotHubHttpApiExHandle(upload_data);
+                    HTTPAPIEX_HANDLE iotHubHttpApiExHandle = acquireIotHubHttpApiExHandle(upload_data);
 
                     if (iotHubHttpApiExHandle == NULL)
                     {
@@ -599,7 +841,7 @@ static int IoTHubClient_LL_UploadToBlob_GetBlobCredentialsFromIoTHub(
                             HTTPHeaders_Free(iotHubRequestHttpHeaders);
                         }
 
-                        HTTPAPIEX_Destroy(iotHubHttpApiExHandle);
+                        releaseIotHubHttpApiExHandle(upload_data, iotHubHttpApiExHandle);
                     }
 
                     BUFFER_delete(responseContent);
@@ -629,7 +871,7 @@ static int IoTHubClient_LL_UploadToBlob_NotifyIoTHubOfUploadCompletion(IOTHUB_CL
     }
     else
     {
-        HTTPAPIEX_HANDLE iotHubHttpApiExHandle = createIotHubHttpApiExHandle(upload_data);
+        HTTPAPIEX_HANDLE iotHubHttpApiExHandle = acquireIotHubHttpApiExHandle(upload_data);
 
         if (iotHubHttpApiExHandle == NULL)
         {
@@ -689,7 +931,7 @@ static int IoTHubClient_LL_UploadToBlob_NotifyIoTHubOfUploadCompletion(IOTHUB_CL
                 HTTPHeaders_Free(iotHubRequestHttpHeaders);
             }
 
-            HTTPAPIEX_Destroy(iotHubHttpApiExHandle);
+            releaseIotHubHttpApiExHandle(upload_data, iotHubHttpApiExHandle);
         }
 
         STRING_delete(relativePathNotification);
@@ -725,7 +967,19 @@ static void destroyUploadToBlobContextInstance(IOTHUB_CLIENT_LL_UPLOADTOBLOB_CON
 {
     if (uploadContext != NULL)
     {
-        HTTPAPIEX_Destroy(uploadContext->blobHttpApiHandle);
+        if (uploadContext->u2bClientData == NULL || uploadContext->blobHttpApiHandle == NULL)
+        {
+            HTTPAPIEX_Destroy(uploadContext->blobHttpApiHandle);
+        }
+        else
+        {
+            returnHttpSession(uploadContext->u2bClientData, &uploadContext->u2bClientData->blobStorageSession, uploadContext->blobStorageHostname, uploadContext->blobHttpApiHandle);
+        }
+
+        if (uploadContext->fileBlockData != NULL)
+        {
+            BUFFER_delete(uploadContext->fileBlockData);
+        }
 
         if (uploadContext->blockIdList != NULL)
         {
@@ -825,6 +1079,7 @@ IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE IoTHubClient_LL_UploadToBlob_Create(const I
             memset(upload_data, 0, sizeof(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA));
 
             upload_data->authorization_module = auth_handle;
+            upload_data->blob_upload_parallelism = DEFAULT_BLOB_UPLOAD_PARALLELISM;
 
             size_t iotHubNameLength = strlen(config->iotHubName);
             size_t iotHubSuffixLength = strlen(config->iotHubSuffix);
@@ -951,12 +1206,15 @@ IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT_HANDLE IoTHubClient_LL_UploadToBlob_Create
         {
             result->u2bClientData = upload_data;
 
-            result->blobHttpApiHandle = Blob_CreateHttpConnection(
-                result->blobStorageHostname,
-                result->u2bClientData->certificates,
-                &(result->u2bClientData->http_proxy_options),
-                result->u2bClientData->networkInterface,
-                result->u2bClientData->blob_upload_timeout_millisecs);
+            if ((result->blobHttpApiHandle = takeHttpSession(upload_data, &upload_data->blobStorageSession, result->blobStorageHostname)) == NULL)
+            {
+                result->blobHttpApiHandle = Blob_CreateHttpConnection(
+                    result->blobStorageHostname,
+                    result->u2bClientData->certificates,
+                    &(result->u2bClientData->http_proxy_options),
+                    result->u2bClientData->networkInterface,
+                    result->u2bClientData->blob_upload_timeout_millisecs);
+            }
 
             if (result->blobHttpApiHandle == NULL)
             {
@@ -1019,6 +1277,94 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_PutBlock(IOTHUB_CLIENT_LL_UPLO
     return result;
 }
 
+// Makes the context file block buffer exactly blockSize bytes long, reallocating only when the size changes.
+static unsigned char* prepareFileBlockData(IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT* uploadContext, size_t blockSize)
+{
+    unsigned char* result;
+
+    if (uploadContext->fileBlockData == NULL &&
+        (uploadContext->fileBlockData = BUFFER_new()) == NULL)
+    {
+        LogError("Failed allocating buffer for Blob block data");
+        result = NULL;
+    }
+    else if (BUFFER_length(uploadContext->fileBlockData) != blockSize &&
+        (BUFFER_unbuild(uploadContext->fileBlockData) != 0 || BUFFER_pre_build(uploadContext->fileBlockData, blockSize) != 0))
+    {
+        LogError("Failed sizing buffer for Blob block data (%lu bytes)", (unsigned long)blockSize);
+        result = NULL;
+    }
+    else
+    {
+        result = BUFFER_u_char(uploadContext->fileBlockData);
+    }
+
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_PutBlockFromFile(IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT_HANDLE uploadContext, uint32_t blockNumber, FILE* file, size_t maxBlockSize, size_t* bytesUploaded)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    if (uploadContext == NULL || file == NULL || maxBlockSize == 0 || maxBlockSize > BLOCK_SIZE || bytesUploaded == NULL)
+    {
+        LogError("invalid argument uploadContext=%p, file=%p, maxBlockSize=%lu, bytesUploaded=%p",
+            uploadContext, file, (unsigned long)maxBlockSize, bytesUploaded);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        unsigned char* blockDataPtr;
+        size_t bytesRead;
+
+        *bytesUploaded = 0;
+
+        if ((blockDataPtr = prepareFileBlockData(uploadContext, maxBlockSize)) == NULL)
+        {
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        // The block is read straight into the request body buffer, so the file content is never copied twice.
+        else if ((bytesRead = fread(blockDataPtr, 1, maxBlockSize, file)) < maxBlockSize && ferror(file))
+        {
+            LogError("Failed reading block %lu from file", (unsigned long)blockNumber);
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else if (bytesRead == 0)
+        {
+            // End of file, nothing left to upload.
+            result = IOTHUB_CLIENT_OK;
+        }
+        else if (bytesRead < maxBlockSize &&
+            BUFFER_shrink(uploadContext->fileBlockData, maxBlockSize - bytesRead, true) != 0)
+        {
+            LogError("Failed trimming buffer for Blob block data");
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            unsigned int httpResponseStatus;
+
+            if (Blob_PutBlock(
+                uploadContext->blobHttpApiHandle,
+                uploadContext->blobStorageRelativePath,
+                blockNumber, uploadContext->fileBlockData,
+                uploadContext->blockIdList,
+                &httpResponseStatus, NULL) != BLOB_OK)
+            {
+                LogError("Failed uploading Blob block data");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                *bytesUploaded = bytesRead;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+    }
+
+    return result;
+}
+
 IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_PutBlockList(IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT_HANDLE uploadContext)
 {
     IOTHUB_CLIENT_RESULT result;
@@ -1032,12 +1378,26 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_PutBlockList(IOTHUB_CLIENT_LL_
     {
         unsigned int putBlockListHttpStatus = 0;
 
+        BLOB_RESULT putBlockListResult;
+
         // Do not PUT BLOCK LIST if result is not success (isSuccess == false)
         // Otherwise we could corrupt a blob with a partial update.
-        if (Blob_PutBlockList(
+        if (uploadContext->contentEncoding != NULL)
+        {
+            putBlockListResult = Blob_PutBlockListWithContentEncoding(
+                uploadContext->blobHttpApiHandle,
+                uploadContext->blobStorageRelativePath,
+                uploadContext->blockIdList, uploadContext->contentEncoding, &putBlockListHttpStatus, NULL);
+        }
+        else
+        {
+            putBlockListResult = Blob_PutBlockList(
                 uploadContext->blobHttpApiHandle,
                 uploadContext->blobStorageRelativePath,
-                uploadContext->blockIdList, &putBlockListHttpStatus, NULL) != BLOB_OK)
+                uploadContext->blockIdList, &putBlockListHttpStatus, NULL);
+        }
+
+        if (putBlockListResult != BLOB_OK)
         {
             LogError("Failed sending block ID list to Blob Storage (%u)", putBlockListHttpStatus);
             result = IOTHUB_CLIENT_ERROR;
@@ -1115,118 +1475,1022 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_NotifyCompletion(IOTHUB_CLIENT
     return result;
 }
 
-IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_UploadMultipleBlocks(IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT_HANDLE azureStorageClientHandle, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
+// Returns true if the upload failed or was aborted by the user.
+static bool uploadBlocksSequentially(IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT* uploadContext, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context, unsigned int* blockCount)
 {
-    IOTHUB_CLIENT_RESULT result;
+    unsigned int blockID = 0;
+    bool isError;
+    unsigned char const * blockDataPtr = NULL;
+    size_t blockDataSize = 0;
+    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT getDataReturnValue;
 
-    if (azureStorageClientHandle == NULL || getDataCallbackEx == NULL)
-    {
-        LogError("invalid argument detected azureStorageClientHandle=%p getDataCallbackEx=%p", azureStorageClientHandle, getDataCallbackEx);
-        result = IOTHUB_CLIENT_INVALID_ARG;
-    }
-    else
+    do
     {
-        unsigned int blockID = 0;
-        bool isError;
-        unsigned char const * blockDataPtr = NULL;
-        size_t blockDataSize = 0;
-        IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT getDataReturnValue;
+        getDataReturnValue = getDataCallbackEx(FILE_UPLOAD_OK, &blockDataPtr, &blockDataSize, context);
 
-        do
+        if (getDataReturnValue == IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT)
         {
-            getDataReturnValue = getDataCallbackEx(FILE_UPLOAD_OK, &blockDataPtr, &blockDataSize, context);
-
-            if (getDataReturnValue == IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT)
+            LogInfo("Upload to blob has been aborted by the user");
+            isError = true;
+            break;
+        }
+        else if (blockDataPtr == NULL || blockDataSize == 0)
+        {
+            // This is how the user indicates that there is no more data to be uploaded,
+            // and the function can end with success result.
+            isError = false;
+            break;
+        }
+        else
+        {
+            if (blockDataSize > BLOCK_SIZE)
             {
-                LogInfo("Upload to blob has been aborted by the user");
+                LogError("tried to upload block of size %lu, max allowed size is %d", (unsigned long)blockDataSize, BLOCK_SIZE);
                 isError = true;
                 break;
             }
-            else if (blockDataPtr == NULL || blockDataSize == 0)
+            else if (blockID >= MAX_BLOCK_COUNT)
             {
-                // This is how the user indicates that there is no more data to be uploaded,
-                // and the function can end with success result.
-                isError = false;
+                LogError("unable to upload more than %lu blocks in one blob", (unsigned long)MAX_BLOCK_COUNT);
+                isError = true;
                 break;
             }
-            else
+            else if (IoTHubClient_LL_UploadToBlob_PutBlock(uploadContext, blockID, blockDataPtr, blockDataSize) != IOTHUB_CLIENT_OK)
             {
-                if (blockDataSize > BLOCK_SIZE)
-                {
-                    LogError("tried to upload block of size %lu, max allowed size is %d", (unsigned long)blockDataSize, BLOCK_SIZE);
-                    isError = true;
-                    break;
-                }
-                else if (blockID >= MAX_BLOCK_COUNT)
-                {
-                    LogError("unable to upload more than %lu blocks in one blob", (unsigned long)MAX_BLOCK_COUNT);
-                    isError = true;
-                    break;
-                }
-                else if (IoTHubClient_LL_UploadToBlob_PutBlock(azureStorageClientHandle, blockID, blockDataPtr, blockDataSize) != IOTHUB_CLIENT_OK)
-                {
-                    LogError("failed uploading block to blob");
-                    isError = true;
-                    break;
-                }
-
-                blockID++;
+                LogError("failed uploading block to blob");
+                isError = true;
+                break;
             }
-        }
-        while(true);
 
-        if (isError)
-        {
-            (void)getDataCallbackEx(FILE_UPLOAD_ERROR, NULL, NULL, context);
-            result = IOTHUB_CLIENT_ERROR;
-        }
-        // Checking if blockID is greater than 0 guarantees that PUT BLOCK LIST will only
-        // be attempted if at least one block has indeed been uploaded to Azure Storage.
-        // This behavior follows the behavior of the original implementation of
-        // Upload-to-Blob in azure-iot-sdk-c.
-        else if (blockID > 0 && IoTHubClient_LL_UploadToBlob_PutBlockList(azureStorageClientHandle) != IOTHUB_CLIENT_OK)
-        {
-            LogError("Failed to perform Azure Blob Put Block List operation");
-            (void)getDataCallbackEx(FILE_UPLOAD_ERROR, NULL, NULL, context);
-            result = IOTHUB_CLIENT_ERROR;
-        }
-        else
-        {
-            (void)getDataCallbackEx(FILE_UPLOAD_OK, NULL, NULL, context);
-            result = IOTHUB_CLIENT_OK;
+            blockID++;
         }
     }
+    while(true);
 
-    return result;
+    *blockCount = blockID;
+
+    return isError;
 }
 
-void IoTHubClient_LL_UploadToBlob_Destroy(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle)
+static int parallelUploadWorkerThread(void* data)
 {
-    if (handle == NULL)
-    {
-        LogError("unexpected NULL argument");
-    }
-    else
+    PARALLEL_UPLOAD_WORKER* worker = (PARALLEL_UPLOAD_WORKER*)data;
+    PARALLEL_UPLOAD* parallelUpload = worker->parallelUpload;
+    bool isDone = false;
+
+    while (!isDone)
     {
-        IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* upload_data = (IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA*)handle;
+        PARALLEL_UPLOAD_BLOCK block = { 0, NULL };
 
-        if (upload_data->cred_type == IOTHUB_CREDENTIAL_TYPE_X509 || upload_data->cred_type == IOTHUB_CREDENTIAL_TYPE_X509_ECC)
+        if (Lock(parallelUpload->lock) != LOCK_OK)
         {
-            free(upload_data->credentials.x509_credentials.x509certificate);
-            free(upload_data->credentials.x509_credentials.x509privatekey);
-            free(upload_data->credentials.x509_credentials.x509privatekeyType);
-            free(upload_data->credentials.x509_credentials.engine);
+            LogError("failed locking parallel upload state");
+            worker->isFailed = true;
+            isDone = true;
         }
-        else if (upload_data->cred_type == IOTHUB_CREDENTIAL_TYPE_SAS_TOKEN)
+        else
         {
-            free(upload_data->credentials.supplied_sas_token);
+            while (parallelUpload->ringCount == 0 && !parallelUpload->isProducerDone && !parallelUpload->isError)
+            {
+                (void)Condition_Wait(parallelUpload->blockAvailable, parallelUpload->lock, PARALLEL_UPLOAD_WAIT_TIMEOUT_MS);
+            }
+
+            if (parallelUpload->isError || parallelUpload->ringCount == 0)
+            {
+                isDone = true;
+            }
+            else
+            {
+                block = parallelUpload->ring[parallelUpload->ringHead];
+                parallelUpload->ringHead = (parallelUpload->ringHead + 1) % parallelUpload->ringCapacity;
+                parallelUpload->ringCount--;
+                (void)Condition_Post(parallelUpload->slotAvailable);
+            }
+
+            (void)Unlock(parallelUpload->lock);
         }
 
-        free((void*)upload_data->hostname);
-        if (upload_data->certificates != NULL)
+        if (block.blockData != NULL)
         {
-            free(upload_data->certificates);
-        }
+            unsigned int httpResponseStatus = 0;
+            BLOB_RESULT blobResult = Blob_PutBlock(
+                worker->httpApiHandle,
+                parallelUpload->uploadContext->blobStorageRelativePath,
+                block.blockID, block.blockData,
+                worker->blockIdList,
+                &httpResponseStatus, NULL);
+            LIST_ITEM_HANDLE blockIdItem = singlylinkedlist_get_head_item(worker->blockIdList);
+
+            BUFFER_delete(block.blockData);
+
+            if (Lock(parallelUpload->lock) != LOCK_OK)
+            {
+                LogError("failed locking parallel upload state");
+                worker->isFailed = true;
+                isDone = true;
+            }
+            else
+            {
+                if (blobResult != BLOB_OK || blockIdItem == NULL)
+                {
+                    LogError("failed uploading block %u to blob (HTTP status %u)", block.blockID, httpResponseStatus);
+                    parallelUpload->isError = true;
+                    (void)Condition_Post(parallelUpload->slotAvailable);
+                    isDone = true;
+                }
+                else
+                {
+                    // The block ID is moved out of the worker list so the caller can commit all IDs in block order.
+                    parallelUpload->blockIds[block.blockID] = (STRING_HANDLE)singlylinkedlist_item_get_value(blockIdItem);
+                    (void)singlylinkedlist_remove(worker->blockIdList, blockIdItem);
+                }
+
+                (void)Unlock(parallelUpload->lock);
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void destroyParallelUpload(PARALLEL_UPLOAD* parallelUpload)
+{
+    size_t i;
+
+    for (i = 0; i < parallelUpload->ringCount; i++)
+    {
+        BUFFER_delete(parallelUpload->ring[(parallelUpload->ringHead + i) % parallelUpload->ringCapacity].blockData);
+    }
+
+    for (i = 0; i < parallelUpload->blockIdsCapacity; i++)
+    {
+        STRING_delete(parallelUpload->blockIds[i]);
+    }
+
+    if (parallelUpload->slotAvailable != NULL)
+    {
+        Condition_Deinit(parallelUpload->slotAvailable);
+    }
+
+    if (parallelUpload->blockAvailable != NULL)
+    {
+        Condition_Deinit(parallelUpload->blockAvailable);
+    }
+
+    if (parallelUpload->lock != NULL)
+    {
+        (void)Lock_Deinit(parallelUpload->lock);
+    }
+
+    free(parallelUpload->blockIds);
+    free(parallelUpload->ring);
+}
+
+static int createParallelUpload(PARALLEL_UPLOAD* parallelUpload, IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT* uploadContext, size_t parallelism)
+{
+    int result;
+    size_t ringSize = safe_multiply_size_t(parallelism, sizeof(PARALLEL_UPLOAD_BLOCK));
+
+    (void)memset(parallelUpload, 0, sizeof(PARALLEL_UPLOAD));
+    parallelUpload->uploadContext = uploadContext;
+    parallelUpload->ringCapacity = parallelism;
+
+    if (ringSize == SIZE_MAX || (parallelUpload->ring = malloc(ringSize)) == NULL)
+    {
+        LogError("failed allocating parallel upload ring, size:%zu", ringSize);
+        result = MU_FAILURE;
+    }
+    else if ((parallelUpload->lock = Lock_Init()) == NULL)
+    {
+        LogError("failed creating parallel upload lock");
+        result = MU_FAILURE;
+    }
+    else if ((parallelUpload->blockAvailable = Condition_Init()) == NULL ||
+        (parallelUpload->slotAvailable = Condition_Init()) == NULL)
+    {
+        LogError("failed creating parallel upload conditions");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result != 0)
+    {
+        destroyParallelUpload(parallelUpload);
+    }
+
+    return result;
+}
+
+// Must be called with parallelUpload->lock held.
+static int ensureBlockIdsCapacity(PARALLEL_UPLOAD* parallelUpload, unsigned int blockID)
+{
+    int result;
+
+    if (blockID < parallelUpload->blockIdsCapacity)
+    {
+        result = 0;
+    }
+    else
+    {
+        size_t newCapacity = (parallelUpload->blockIdsCapacity == 0 ? 16 : safe_multiply_size_t(parallelUpload->blockIdsCapacity, 2));
+        size_t reallocSize;
+        STRING_HANDLE* newBlockIds;
+
+        if (newCapacity > MAX_BLOCK_COUNT)
+        {
+            newCapacity = MAX_BLOCK_COUNT;
+        }
+
+        reallocSize = safe_multiply_size_t(newCapacity, sizeof(STRING_HANDLE));
+
+        if (reallocSize == SIZE_MAX ||
+            (newBlockIds = realloc(parallelUpload->blockIds, reallocSize)) == NULL)
+        {
+            LogError("failed growing block ID array, size:%zu", reallocSize);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            (void)memset(newBlockIds + parallelUpload->blockIdsCapacity, 0, (newCapacity - parallelUpload->blockIdsCapacity) * sizeof(STRING_HANDLE));
+            parallelUpload->blockIds = newBlockIds;
+            parallelUpload->blockIdsCapacity = newCapacity;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static void destroyParallelUploadWorker(PARALLEL_UPLOAD_WORKER* worker)
+{
+    if (worker->blockIdList != NULL)
+    {
+        Blob_ClearBlockIdList(worker->blockIdList);
+        singlylinkedlist_destroy(worker->blockIdList);
+    }
+
+    if (worker->ownsHttpApiHandle)
+    {
+        Blob_DestroyHttpConnection(worker->httpApiHandle);
+    }
+}
+
+// Starts up to parallelism workers, each with its own connection to the storage host (the first one reuses the
+// context connection). Returns the number of workers running; fewer than requested is not an error.
+static size_t startParallelUploadWorkers(PARALLEL_UPLOAD* parallelUpload, PARALLEL_UPLOAD_WORKER* workers, size_t parallelism)
+{
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT* uploadContext = parallelUpload->uploadContext;
+    size_t workerCount;
+
+    for (workerCount = 0; workerCount < parallelism; workerCount++)
+    {
+        PARALLEL_UPLOAD_WORKER* worker = &workers[workerCount];
+
+        (void)memset(worker, 0, sizeof(PARALLEL_UPLOAD_WORKER));
+        worker->parallelUpload = parallelUpload;
+
+        if (workerCount == 0)
+        {
+            worker->httpApiHandle = uploadContext->blobHttpApiHandle;
+        }
+        else
+        {
+            worker->httpApiHandle = Blob_CreateHttpConnection(
+                uploadContext->blobStorageHostname,
+                uploadContext->u2bClientData->certificates,
+                &(uploadContext->u2bClientData->http_proxy_options),
+                uploadContext->u2bClientData->networkInterface,
+                uploadContext->u2bClientData->blob_upload_timeout_millisecs);
+            worker->ownsHttpApiHandle = true;
+        }
+
+        if (worker->httpApiHandle == NULL)
+        {
+            LogError("failed creating HTTP connection for upload worker %lu", (unsigned long)workerCount);
+            break;
+        }
+        else if ((worker->blockIdList = singlylinkedlist_create()) == NULL)
+        {
+            LogError("failed creating block ID list for upload worker %lu", (unsigned long)workerCount);
+            destroyParallelUploadWorker(worker);
+            break;
+        }
+        else if (ThreadAPI_Create(&worker->threadHandle, parallelUploadWorkerThread, worker) != THREADAPI_OK)
+        {
+            LogError("failed starting upload worker %lu", (unsigned long)workerCount);
+            destroyParallelUploadWorker(worker);
+            break;
+        }
+    }
+
+    return workerCount;
+}
+
+// Reads blocks from the user on the calling thread and hands them to worker threads, each uploading over its own
+// connection. Block IDs are committed to the context in block order once all workers are done.
+// Returns true if the upload failed or was aborted by the user.
+static bool uploadBlocksInParallel(IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT* uploadContext, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context, size_t parallelism, unsigned int* blockCount)
+{
+    bool isError;
+    unsigned int blockID = 0;
+    PARALLEL_UPLOAD parallelUpload;
+    PARALLEL_UPLOAD_WORKER* workers;
+    size_t workersSize = safe_multiply_size_t(parallelism, sizeof(PARALLEL_UPLOAD_WORKER));
+
+    if (workersSize == SIZE_MAX || (workers = malloc(workersSize)) == NULL)
+    {
+        LogError("failed allocating upload workers, size:%zu", workersSize);
+        isError = true;
+    }
+    else
+    {
+        if (createParallelUpload(&parallelUpload, uploadContext, parallelism) != 0)
+        {
+            LogError("failed creating parallel upload state");
+            isError = true;
+        }
+        else
+        {
+            size_t workerCount = startParallelUploadWorkers(&parallelUpload, workers, parallelism);
+            size_t i;
+
+            if (workerCount == 0)
+            {
+                LogError("no upload worker could be started");
+                isError = true;
+            }
+            else
+            {
+                unsigned char const * blockDataPtr = NULL;
+                size_t blockDataSize = 0;
+                isError = false;
+
+                while (!isError)
+                {
+                    BUFFER_HANDLE blockData;
+
+                    if (getDataCallbackEx(FILE_UPLOAD_OK, &blockDataPtr, &blockDataSize, context) == IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT)
+                    {
+                        LogInfo("Upload to blob has been aborted by the user");
+                        isError = true;
+                    }
+                    else if (blockDataPtr == NULL || blockDataSize == 0)
+                    {
+                        break;
+                    }
+                    else if (blockDataSize > BLOCK_SIZE)
+                    {
+                        LogError("tried to upload block of size %lu, max allowed size is %d", (unsigned long)blockDataSize, BLOCK_SIZE);
+                        isError = true;
+                    }
+                    else if (blockID >= MAX_BLOCK_COUNT)
+                    {
+                        LogError("unable to upload more than %lu blocks in one blob", (unsigned long)MAX_BLOCK_COUNT);
+                        isError = true;
+                    }
+                    // The user may reuse blockDataPtr as soon as the callback is invoked again, so the block is copied here.
+                    else if ((blockData = BUFFER_create(blockDataPtr, blockDataSize)) == NULL)
+                    {
+                        LogError("Failed allocating buffer for Blob block data");
+                        isError = true;
+                    }
+                    else if (Lock(parallelUpload.lock) != LOCK_OK)
+                    {
+                        LogError("failed locking parallel upload state");
+                        BUFFER_delete(blockData);
+                        isError = true;
+                    }
+                    else
+                    {
+                        while (parallelUpload.ringCount == parallelUpload.ringCapacity && !parallelUpload.isError)
+                        {
+                            (void)Condition_Wait(parallelUpload.slotAvailable, parallelUpload.lock, PARALLEL_UPLOAD_WAIT_TIMEOUT_MS);
+                        }
+
+                        if (parallelUpload.isError || ensureBlockIdsCapacity(&parallelUpload, blockID) != 0)
+                        {
+                            BUFFER_delete(blockData);
+                            isError = true;
+                        }
+                        else
+                        {
+                            size_t tail = (parallelUpload.ringHead + parallelUpload.ringCount) % parallelUpload.ringCapacity;
+                            parallelUpload.ring[tail].blockID = blockID;
+                            parallelUpload.ring[tail].blockData = blockData;
+                            parallelUpload.ringCount++;
+                            (void)Condition_Post(parallelUpload.blockAvailable);
+                            blockID++;
+                        }
+
+                        (void)Unlock(parallelUpload.lock);
+                    }
+                }
+
+                if (Lock(parallelUpload.lock) != LOCK_OK)
+                {
+                    // The workers cannot take the lock either, so they stop on their own.
+                    LogError("failed locking parallel upload state");
+                    isError = true;
+                }
+                else
+                {
+                    parallelUpload.isProducerDone = true;
+                    parallelUpload.isError = parallelUpload.isError || isError;
+
+                    for (i = 0; i < workerCount; i++)
+                    {
+                        (void)Condition_Post(parallelUpload.blockAvailable);
+                    }
+
+                    (void)Unlock(parallelUpload.lock);
+                }
+            }
+
+            for (i = 0; i < workerCount; i++)
+            {
+                int threadResult;
+                (void)ThreadAPI_Join(workers[i].threadHandle, &threadResult);
+                isError = isError || workers[i].isFailed;
+                destroyParallelUploadWorker(&workers[i]);
+            }
+
+            // All workers are joined, so the shared state can be read without the lock.
+            isError = isError || parallelUpload.isError;
+
+            if (!isError)
+            {
+                unsigned int committedBlockID;
+
+                for (committedBlockID = 0; committedBlockID < blockID; committedBlockID++)
+                {
+                    if (singlylinkedlist_add(uploadContext->blockIdList, parallelUpload.blockIds[committedBlockID]) == NULL)
+                    {
+                        LogError("unable to store block ID");
+                        isError = true;
+                        break;
+                    }
+
+                    parallelUpload.blockIds[committedBlockID] = NULL;
+                }
+            }
+
+            destroyParallelUpload(&parallelUpload);
+        }
+
+        free(workers);
+    }
+
+    *blockCount = blockID;
+
+    return isError;
+}
+
+// IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX of a compressed upload: pulls data from the application, compresses it
+// and returns it one full block at a time (the last block may be shorter). The block stays valid until the next call.
+static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT getCompressedBlock(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context)
+{
+    COMPRESSED_UPLOAD* compressedUpload = (COMPRESSED_UPLOAD*)context;
+    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT getDataResult = IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
+    (void)result;
+
+    compressedUpload->blockSize = 0;
+
+    while (compressedUpload->blockSize < FILE_UPLOAD_BLOCK_SIZE &&
+        (compressedUpload->pendingOutputSize > 0 || !compressedUpload->isFlushed))
+    {
+        if (compressedUpload->pendingOutputSize > 0)
+        {
+            size_t copySize = FILE_UPLOAD_BLOCK_SIZE - compressedUpload->blockSize;
+
+            if (copySize > compressedUpload->pendingOutputSize)
+            {
+                copySize = compressedUpload->pendingOutputSize;
+            }
+
+            (void)memcpy(compressedUpload->block + compressedUpload->blockSize, compressedUpload->pendingOutput, copySize);
+            compressedUpload->blockSize += copySize;
+            compressedUpload->pendingOutput += copySize;
+            compressedUpload->pendingOutputSize -= copySize;
+        }
+        else if (compressedUpload->isInputDone)
+        {
+            if (compressedUpload->compression.compress(compressedUpload->stream, NULL, 0, &compressedUpload->pendingOutput, &compressedUpload->pendingOutputSize) != 0)
+            {
+                LogError("failed flushing the compressed stream");
+                getDataResult = IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT;
+                break;
+            }
+
+            compressedUpload->isFlushed = true;
+        }
+        else
+        {
+            unsigned char const * rawData = NULL;
+            size_t rawSize = 0;
+
+            if (compressedUpload->getDataCallbackEx(FILE_UPLOAD_OK, &rawData, &rawSize, compressedUpload->context) == IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT)
+            {
+                getDataResult = IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT;
+                break;
+            }
+            else if (rawData == NULL || rawSize == 0)
+            {
+                compressedUpload->isInputDone = true;
+            }
+            else if (compressedUpload->compression.compress(compressedUpload->stream, rawData, rawSize, &compressedUpload->pendingOutput, &compressedUpload->pendingOutputSize) != 0)
+            {
+                LogError("failed compressing %lu bytes", (unsigned long)rawSize);
+                getDataResult = IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT;
+                break;
+            }
+            else
+            {
+                compressedUpload->rawByteCount += rawSize;
+            }
+        }
+    }
+
+    if (getDataResult == IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK)
+    {
+        compressedUpload->compressedByteCount += compressedUpload->blockSize;
+        *data = (compressedUpload->blockSize > 0) ? compressedUpload->block : NULL;
+        *size = compressedUpload->blockSize;
+    }
+
+    return getDataResult;
+}
+
+static int beginCompressedUpload(COMPRESSED_UPLOAD* compressedUpload, IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT* uploadContext, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
+{
+    int result;
+    const IOTHUB_CLIENT_FILE_UPLOAD_COMPRESSION* compression = &compressedUpload->compression;
+
+    (void)memset(compressedUpload, 0, sizeof(COMPRESSED_UPLOAD));
+    compressedUpload->compression = uploadContext->u2bClientData->compression;
+    compressedUpload->getDataCallbackEx = getDataCallbackEx;
+    compressedUpload->context = context;
+
+    if ((compressedUpload->block = malloc(FILE_UPLOAD_BLOCK_SIZE)) == NULL)
+    {
+        LogError("failed allocating compressed block");
+        result = MU_FAILURE;
+    }
+    else if (mallocAndStrcpy_s(&uploadContext->contentEncoding, compression->contentEncoding) != 0)
+    {
+        LogError("failed copying content encoding");
+        free(compressedUpload->block);
+        result = MU_FAILURE;
+    }
+    else if ((compressedUpload->stream = compression->beginStream(compression->context)) == NULL)
+    {
+        LogError("failed starting compressed stream");
+        free(uploadContext->contentEncoding);
+        uploadContext->contentEncoding = NULL;
+        free(compressedUpload->block);
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+static void endCompressedUpload(COMPRESSED_UPLOAD* compressedUpload, IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT* uploadContext)
+{
+    LogInfo("compressed upload: %lu raw bytes, %lu compressed bytes",
+        (unsigned long)compressedUpload->rawByteCount, (unsigned long)compressedUpload->compressedByteCount);
+
+    if (compressedUpload->compression.endStream != NULL)
+    {
+        compressedUpload->compression.endStream(compressedUpload->stream, compressedUpload->rawByteCount, compressedUpload->compressedByteCount);
+    }
+
+    free(uploadContext->contentEncoding);
+    uploadContext->contentEncoding = NULL;
+    free(compressedUpload->block);
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_UploadMultipleBlocks(IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT_HANDLE azureStorageClientHandle, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
+{
+    IOTHUB_CLIENT_RESULT result;
+    COMPRESSED_UPLOAD compressedUpload;
+    bool isCompressed = false;
+
+    if (azureStorageClientHandle == NULL || getDataCallbackEx == NULL)
+    {
+        LogError("invalid argument detected azureStorageClientHandle=%p getDataCallbackEx=%p", azureStorageClientHandle, getDataCallbackEx);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else if ((isCompressed = (azureStorageClientHandle->u2bClientData->compression.compress != NULL)) &&
+        beginCompressedUpload(&compressedUpload, azureStorageClientHandle, getDataCallbackEx, context) != 0)
+    {
+        LogError("failed starting compressed upload");
+        (void)getDataCallbackEx(FILE_UPLOAD_ERROR, NULL, NULL, context);
+        result = IOTHUB_CLIENT_ERROR;
+    }
+    else
+    {
+        IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX blockDataCallback = isCompressed ? getCompressedBlock : getDataCallbackEx;
+        void* blockDataContext = isCompressed ? (void*)&compressedUpload : context;
+        unsigned int blockCount;
+        bool isError;
+
+        if (azureStorageClientHandle->u2bClientData->blob_upload_parallelism > 1)
+        {
+            isError = uploadBlocksInParallel(azureStorageClientHandle, blockDataCallback, blockDataContext, azureStorageClientHandle->u2bClientData->blob_upload_parallelism, &blockCount);
+        }
+        else
+        {
+            isError = uploadBlocksSequentially(azureStorageClientHandle, blockDataCallback, blockDataContext, &blockCount);
+        }
+
+        if (isError)
+        {
+            (void)getDataCallbackEx(FILE_UPLOAD_ERROR, NULL, NULL, context);
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        // Checking if blockCount is greater than 0 guarantees that PUT BLOCK LIST will only
+        // be attempted if at least one block has indeed been uploaded to Azure Storage.
+        // This behavior follows the behavior of the original implementation of
+        // Upload-to-Blob in azure-iot-sdk-c.
+        else if (blockCount > 0 && IoTHubClient_LL_UploadToBlob_PutBlockList(azureStorageClientHandle) != IOTHUB_CLIENT_OK)
+        {
+            LogError("Failed to perform Azure Blob Put Block List operation");
+            (void)getDataCallbackEx(FILE_UPLOAD_ERROR, NULL, NULL, context);
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            (void)getDataCallbackEx(FILE_UPLOAD_OK, NULL, NULL, context);
+            result = IOTHUB_CLIENT_OK;
+        }
+
+        if (isCompressed)
+        {
+            endCompressedUpload(&compressedUpload, azureStorageClientHandle);
+        }
+    }
+
+    return result;
+}
+
+// fseek/ftell take a long, which is 32 bits on Windows and 32-bit POSIX platforms and so cannot address past 2 GB.
+static int seekFile(FILE* file, int64_t offset, int origin)
+{
+#ifdef _WIN32
+    return _fseeki64(file, offset, origin);
+#else
+    return fseeko(file, (off_t)offset, origin);
+#endif
+}
+
+static int64_t tellFile(FILE* file)
+{
+#ifdef _WIN32
+    return _ftelli64(file);
+#else
+    return (int64_t)ftello(file);
+#endif
+}
+
+static int saveUploadCheckpoint(const UPLOAD_FILE_CHECKPOINT* checkpoint)
+{
+    int result;
+    JSON_Value* json = json_value_init_object();
+    JSON_Object* json_obj;
+
+    if (json == NULL || (json_obj = json_value_get_object(json)) == NULL)
+    {
+        LogError("Failed creating upload checkpoint");
+        result = MU_FAILURE;
+    }
+    else if (json_object_set_string(json_obj, CHECKPOINT_DESTINATION_FILE_NAME, checkpoint->destinationFileName) != JSONSuccess ||
+        json_object_set_string(json_obj, CHECKPOINT_SOURCE_FILE_PATH, checkpoint->sourceFilePath) != JSONSuccess ||
+        json_object_set_number(json_obj, CHECKPOINT_SOURCE_SIZE, (double)checkpoint->sourceSize) != JSONSuccess ||
+        json_object_set_number(json_obj, CHECKPOINT_BLOCK_SIZE, (double)FILE_UPLOAD_BLOCK_SIZE) != JSONSuccess ||
+        json_object_set_number(json_obj, CHECKPOINT_UPLOADED_BLOCK_COUNT, (double)checkpoint->uploadedBlockCount) != JSONSuccess ||
+        (checkpoint->correlationId != NULL && json_object_set_string(json_obj, CHECKPOINT_CORRELATION_ID, checkpoint->correlationId) != JSONSuccess))
+    {
+        LogError("Failed filling upload checkpoint");
+        result = MU_FAILURE;
+    }
+    else if (json_serialize_to_file(json, checkpoint->checkpointFilePath) != JSONSuccess)
+    {
+        LogError("Failed writing upload checkpoint to %s", checkpoint->checkpointFilePath);
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    json_value_free(json);
+
+    return result;
+}
+
+// Picks up the progress saved by a previous attempt, but only if it was for the same destination and the same, unchanged, source.
+// A missing, unreadable or mismatching checkpoint simply means the upload starts from the first block.
+static void loadUploadCheckpoint(UPLOAD_FILE_CHECKPOINT* checkpoint)
+{
+    JSON_Value* json = json_parse_file(checkpoint->checkpointFilePath);
+    JSON_Object* json_obj;
+
+    if (json != NULL && (json_obj = json_value_get_object(json)) != NULL)
+    {
+        const char* destinationFileName = json_object_get_string(json_obj, CHECKPOINT_DESTINATION_FILE_NAME);
+        const char* sourceFilePath = json_object_get_string(json_obj, CHECKPOINT_SOURCE_FILE_PATH);
+        const char* correlationId = json_object_get_string(json_obj, CHECKPOINT_CORRELATION_ID);
+        double uploadedBlockCount = json_object_get_number(json_obj, CHECKPOINT_UPLOADED_BLOCK_COUNT);
+
+        if (destinationFileName == NULL || strcmp(destinationFileName, checkpoint->destinationFileName) != 0 ||
+            sourceFilePath == NULL || strcmp(sourceFilePath, checkpoint->sourceFilePath) != 0 ||
+            json_object_get_number(json_obj, CHECKPOINT_SOURCE_SIZE) != (double)checkpoint->sourceSize ||
+            json_object_get_number(json_obj, CHECKPOINT_BLOCK_SIZE) != (double)FILE_UPLOAD_BLOCK_SIZE ||
+            uploadedBlockCount < 0 || uploadedBlockCount * FILE_UPLOAD_BLOCK_SIZE > (double)checkpoint->sourceSize)
+        {
+            LogInfo("Ignoring upload checkpoint %s, it does not match the current upload", checkpoint->checkpointFilePath);
+        }
+        else
+        {
+            checkpoint->uploadedBlockCount = (uint32_t)uploadedBlockCount;
+
+            if (correlationId != NULL && mallocAndStrcpy_s(&checkpoint->correlationId, correlationId) != 0)
+            {
+                LogError("Failed copying correlation id of the interrupted upload");
+                checkpoint->correlationId = NULL;
+            }
+        }
+    }
+
+    json_value_free(json);
+}
+
+static void updateUploadCheckpoint(const UPLOAD_FILE_CHECKPOINT* checkpoint)
+{
+    if (checkpoint->checkpointFilePath != NULL && saveUploadCheckpoint(checkpoint) != 0)
+    {
+        // Not fatal, a later resume would just upload some blocks again.
+        LogError("Failed saving upload progress");
+    }
+}
+
+// Puts the blocks uploaded by a previous attempt back in the block list and moves the source past them.
+static int skipUploadedBlocks(IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT* uploadContext, FILE* sourceFile, uint32_t uploadedBlockCount)
+{
+    int result = 0;
+    uint32_t blockNumber;
+
+    for (blockNumber = 0; blockNumber < uploadedBlockCount; blockNumber++)
+    {
+        if (Blob_AddUploadedBlockId(uploadContext->blockIdList, blockNumber) != BLOB_OK)
+        {
+            LogError("Failed adding ID of uploaded block %lu", (unsigned long)blockNumber);
+            result = MU_FAILURE;
+            break;
+        }
+    }
+
+    if (result == 0 && seekFile(sourceFile, (int64_t)uploadedBlockCount * FILE_UPLOAD_BLOCK_SIZE, SEEK_SET) != 0)
+    {
+        LogError("Failed seeking past the %lu blocks already uploaded", (unsigned long)uploadedBlockCount);
+        result = MU_FAILURE;
+    }
+
+    return result;
+}
+
+static bool uploadFileBlocks(IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT* uploadContext, FILE* sourceFile, UPLOAD_FILE_CHECKPOINT* checkpoint)
+{
+    bool uploadSucceeded;
+    uint32_t resumedBlockCount = checkpoint->uploadedBlockCount;
+
+    if (resumedBlockCount > 0 && skipUploadedBlocks(uploadContext, sourceFile, resumedBlockCount) != 0)
+    {
+        uploadSucceeded = false;
+    }
+    else
+    {
+        size_t bytesUploaded;
+        bool isError = false;
+
+        // Blocks are read from the file straight into the request body, so the file is never fully loaded in memory.
+        do
+        {
+            if (IoTHubClient_LL_UploadToBlob_PutBlockFromFile(uploadContext, checkpoint->uploadedBlockCount, sourceFile, FILE_UPLOAD_BLOCK_SIZE, &bytesUploaded) != IOTHUB_CLIENT_OK)
+            {
+                LogError("Failed uploading block %lu to Azure Blob Storage", (unsigned long)checkpoint->uploadedBlockCount);
+                isError = true;
+                break;
+            }
+            else if (bytesUploaded > 0)
+            {
+                checkpoint->uploadedBlockCount++;
+                updateUploadCheckpoint(checkpoint);
+            }
+            else
+            {
+                // Reached the end of the file.
+                break;
+            }
+        } while (true);
+
+        if (isError)
+        {
+            uploadSucceeded = false;
+        }
+        else if (checkpoint->uploadedBlockCount == 0)
+        {
+            // The file was truncated after its size was checked.
+            LogError("No data read from the file to upload");
+            uploadSucceeded = false;
+        }
+        else if (IoTHubClient_LL_UploadToBlob_PutBlockList(uploadContext) != IOTHUB_CLIENT_OK)
+        {
+            LogError("Failed completing upload to blob.");
+
+            if (resumedBlockCount > 0)
+            {
+                // Azure Storage discards uncommitted blocks after a while, so the next attempt should not rely on them.
+                checkpoint->uploadedBlockCount = 0;
+            }
+
+            uploadSucceeded = false;
+        }
+        else
+        {
+            uploadSucceeded = true;
+        }
+    }
+
+    return uploadSucceeded;
+}
+
+static IOTHUB_CLIENT_RESULT uploadFile(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle, FILE* sourceFile, UPLOAD_FILE_CHECKPOINT* checkpoint)
+{
+    IOTHUB_CLIENT_RESULT result;
+    char* uploadCorrelationId;
+    char* azureBlobSasUri;
+
+    // A new SAS is always requested, even when resuming, since the one used before the interruption may have expired.
+    // It points to the same blob, where the uncommitted blocks uploaded earlier are still available.
+    if (IoTHubClient_LL_UploadToBlob_InitializeUpload(handle, checkpoint->destinationFileName, &uploadCorrelationId, &azureBlobSasUri) != IOTHUB_CLIENT_OK)
+    {
+        LogError("Failed initializing upload in IoT Hub");
+        result = IOTHUB_CLIENT_ERROR;
+    }
+    else
+    {
+        bool uploadSucceeded;
+        IOTHUB_CLIENT_LL_UPLOADTOBLOB_CONTEXT_HANDLE uploadContext;
+
+        checkpoint->correlationId = uploadCorrelationId;
+        updateUploadCheckpoint(checkpoint);
+
+        if ((uploadContext = IoTHubClient_LL_UploadToBlob_CreateContext(handle, azureBlobSasUri)) == NULL)
+        {
+            LogError("Failed creating upload to blob context");
+            uploadSucceeded = false;
+        }
+        else
+        {
+            uploadSucceeded = uploadFileBlocks(uploadContext, sourceFile, checkpoint);
+            IoTHubClient_LL_UploadToBlob_DestroyContext(uploadContext);
+        }
+
+        if (IoTHubClient_LL_UploadToBlob_NotifyCompletion(
+                handle, uploadCorrelationId, uploadSucceeded, (uploadSucceeded ? HTTP_STATUS_CODE_OK : HTTP_STATUS_CODE_BAD_REQUEST), NULL) != IOTHUB_CLIENT_OK)
+        {
+            LogError("Failed completing upload to blob.");
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            checkpoint->correlationId = NULL;
+            result = (uploadSucceeded ? IOTHUB_CLIENT_OK : IOTHUB_CLIENT_ERROR);
+        }
+
+        if (checkpoint->checkpointFilePath != NULL)
+        {
+            if (result == IOTHUB_CLIENT_OK)
+            {
+                (void)remove(checkpoint->checkpointFilePath);
+            }
+            else
+            {
+                updateUploadCheckpoint(checkpoint);
+            }
+        }
+
+        checkpoint->correlationId = NULL;
+        free(uploadCorrelationId);
+        free(azureBlobSasUri);
+    }
+
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_UploadFile(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle, const char* destinationFileName, const char* sourceFilePath, const char* checkpointFilePath)
+{
+    IOTHUB_CLIENT_RESULT result;
+    FILE* sourceFile;
+
+    if (handle == NULL || destinationFileName == NULL || sourceFilePath == NULL)
+    {
+        LogError("invalid argument detected handle=%p destinationFileName=%p sourceFilePath=%p", handle, destinationFileName, sourceFilePath);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else if ((sourceFile = fopen(sourceFilePath, "rb")) == NULL)
+    {
+        LogError("Failed opening file to upload (%s)", sourceFilePath);
+        result = IOTHUB_CLIENT_ERROR;
+    }
+    else
+    {
+        UPLOAD_FILE_CHECKPOINT checkpoint;
+        (void)memset(&checkpoint, 0, sizeof(UPLOAD_FILE_CHECKPOINT));
+        checkpoint.checkpointFilePath = checkpointFilePath;
+        checkpoint.destinationFileName = destinationFileName;
+        checkpoint.sourceFilePath = sourceFilePath;
+
+        if (seekFile(sourceFile, 0, SEEK_END) != 0 ||
+            (checkpoint.sourceSize = tellFile(sourceFile)) < 0 ||
+            seekFile(sourceFile, 0, SEEK_SET) != 0)
+        {
+            LogError("Failed getting the size of the file to upload (%s)", sourceFilePath);
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else if (checkpoint.sourceSize == 0)
+        {
+            // Committing an empty block list would not create the blob, so an empty file cannot be uploaded this way.
+            LogError("File to upload is empty (%s)", sourceFilePath);
+            result = IOTHUB_CLIENT_INVALID_ARG;
+        }
+        else
+        {
+            if (checkpointFilePath != NULL)
+            {
+                loadUploadCheckpoint(&checkpoint);
+            }
+
+            if (checkpoint.correlationId != NULL)
+            {
+                // The previous attempt ended before notifying IoT Hub (e.g. the process restarted), release that upload.
+                if (IoTHubClient_LL_UploadToBlob_NotifyCompletion(handle, checkpoint.correlationId, false, HTTP_STATUS_CODE_BAD_REQUEST, NULL) != IOTHUB_CLIENT_OK)
+                {
+                    LogError("Failed releasing the interrupted upload, continuing anyway");
+                }
+
+                free(checkpoint.correlationId);
+                checkpoint.correlationId = NULL;
+            }
+
+            if (checkpoint.uploadedBlockCount > 0)
+            {
+                LogInfo("Resuming upload of %s after %lu blocks", sourceFilePath, (unsigned long)checkpoint.uploadedBlockCount);
+            }
+
+            result = uploadFile(handle, sourceFile, &checkpoint);
+        }
+
+        (void)fclose(sourceFile);
+    }
+
+    return result;
+}
+
+void IoTHubClient_LL_UploadToBlob_Destroy(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle)
+{
+    if (handle == NULL)
+    {
+        LogError("unexpected NULL argument");
+    }
+    else
+    {
+        IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* upload_data = (IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA*)handle;
+
+        if (upload_data->cred_type == IOTHUB_CREDENTIAL_TYPE_X509 || upload_data->cred_type == IOTHUB_CREDENTIAL_TYPE_X509_ECC)
+        {
+            free(upload_data->credentials.x509_credentials.x509certificate);
+            free(upload_data->credentials.x509_credentials.x509privatekey);
+            free(upload_data->credentials.x509_credentials.x509privatekeyType);
+            free(upload_data->credentials.x509_credentials.engine);
+        }
+        else if (upload_data->cred_type == IOTHUB_CREDENTIAL_TYPE_SAS_TOKEN)
+        {
+            free(upload_data->credentials.supplied_sas_token);
+        }
+
+        free((void*)upload_data->hostname);
+        if (upload_data->certificates != NULL)
+        {
+            free(upload_data->certificates);
+        }
         if (upload_data->http_proxy_options.host_address != NULL)
         {
             free((char *)upload_data->http_proxy_options.host_address);
@@ -1243,6 +2507,22 @@ void IoTHubClient_LL_UploadToBlob_Destroy(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h
         {
             free((char*)upload_data->networkInterface);
         }
+        if (upload_data->compression.contentEncoding != NULL)
+        {
+            free((char*)upload_data->compression.contentEncoding);
+        }
+        if (upload_data->sessionLock != NULL)
+        {
+            if (upload_data->iotHubSession.httpApiHandle != NULL)
+            {
+                destroyHttpSession(&upload_data->iotHubSession);
+            }
+            if (upload_data->blobStorageSession.httpApiHandle != NULL)
+            {
+                destroyHttpSession(&upload_data->blobStorageSession);
+            }
+            Lock_Deinit(upload_data->sessionLock);
+        }
         free(upload_data);
     }
 }
@@ -1494,10 +2774,92 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_SetOption(IOTHUB_CLIENT_LL_UPL
             upload_data->tls_renegotiation = *((bool*)(value));
             result = IOTHUB_CLIENT_OK;
         }
+        else if (strcmp(optionName, OPTION_BLOB_UPLOAD_PARALLELISM) == 0)
+        {
+            if (value == NULL || *(size_t*)value == 0 || *(size_t*)value > MAX_BLOB_UPLOAD_PARALLELISM)
+            {
+                LogError("invalid value for %s (must be between 1 and %d)", OPTION_BLOB_UPLOAD_PARALLELISM, MAX_BLOB_UPLOAD_PARALLELISM);
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else
+            {
+                upload_data->blob_upload_parallelism = *(size_t*)value;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        else if (strcmp(optionName, OPTION_BLOB_UPLOAD_REUSE_CONNECTIONS) == 0)
+        {
+            if (value == NULL)
+            {
+                LogError("NULL is not a valid value for %s", OPTION_BLOB_UPLOAD_REUSE_CONNECTIONS);
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else if (*(bool*)value && upload_data->sessionLock == NULL &&
+                (upload_data->sessionLock = Lock_Init()) == NULL)
+            {
+                LogError("failed creating lock for kept-alive connections");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                upload_data->reuse_connections = *(bool*)value;
+
+                if (!upload_data->reuse_connections)
+                {
+                    invalidateHttpSessions(upload_data);
+                }
+
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        else if (strcmp(optionName, OPTION_BLOB_UPLOAD_COMPRESSION) == 0)
+        {
+            const IOTHUB_CLIENT_FILE_UPLOAD_COMPRESSION* compression = (const IOTHUB_CLIENT_FILE_UPLOAD_COMPRESSION*)value;
+            char* contentEncoding = NULL;
+
+            if (compression != NULL &&
+                (compression->contentEncoding == NULL || compression->beginStream == NULL || compression->compress == NULL))
+            {
+                LogError("%s requires contentEncoding, beginStream and compress", OPTION_BLOB_UPLOAD_COMPRESSION);
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else if (compression != NULL && mallocAndStrcpy_s(&contentEncoding, compression->contentEncoding) != 0)
+            {
+                LogError("failure in mallocAndStrcpy_s");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                if (upload_data->compression.contentEncoding != NULL)
+                {
+                    free((char*)upload_data->compression.contentEncoding);
+                }
+
+                if (compression == NULL)
+                {
+                    (void)memset(&upload_data->compression, 0, sizeof(IOTHUB_CLIENT_FILE_UPLOAD_COMPRESSION));
+                }
+                else
+                {
+                    upload_data->compression = *compression;
+                    upload_data->compression.contentEncoding = contentEncoding;
+                }
+
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
         else
         {
             result = IOTHUB_CLIENT_INVALID_ARG;
         }
+
+        if (result == IOTHUB_CLIENT_OK &&
+            strcmp(optionName, OPTION_BLOB_UPLOAD_PARALLELISM) != 0 &&
+            strcmp(optionName, OPTION_BLOB_UPLOAD_REUSE_CONNECTIONS) != 0 &&
+            strcmp(optionName, OPTION_BLOB_UPLOAD_COMPRESSION) != 0)
+        {
+            invalidateHttpSessions(upload_data);
+        }
     }
     return result;
 }
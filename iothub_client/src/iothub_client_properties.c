@@ -1,13 +1,14 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
-#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/xlogging.h"
 
 #include "iothub_client_properties.h"
-#include "parson.h"
 
 typedef enum COMPONENT_PARSE_STATE_TAG
 {
@@ -22,25 +23,35 @@ typedef enum PROPERTY_PARSE_STATE_TAG
 } PROPERTY_PARSE_STATE;
 
 typedef struct IOTHUB_CLIENT_PROPERTIES_DESERIALIZER_TAG {
-    JSON_Value* rootValue;
-    JSON_Object* desiredObject;
-    JSON_Object* reportedObject;
+    // Copy of the payload, stored right after this structure.  Properties returned to the application point into it.
+    char* json;
+    // Opening brace of the desired and reported objects, or NULL if the payload has none.
+    char* desiredObject;
+    char* reportedObject;
     COMPONENT_PARSE_STATE componentParseState;
     PROPERTY_PARSE_STATE propertyParseState;
-    size_t currentComponentIndex;
-    size_t currentPropertyIndex;
+    // Next member to visit of the object being enumerated and of the component being enumerated, NULL when done.
+    char* currentProperty;
+    char* currentComponentProperty;
+    const char* currentComponentName;
     int propertiesVersion;
 } IOTHUB_CLIENT_PROPERTIES_DESERIALIZER;
 
-// sprintf format strings and string constants for writing properties.
-static const char PROPERTY_FORMAT_COMPONENT_START[] = "{\"%s\":{\"__t\":\"c\",";
-static const char PROPERTY_FORMAT_NAME_VALUE[] = "\"%s\":%s%s";
-static const char PROPERTY_FORMAT_WRITABLE_RESPONSE[] = "\"%s\":{\"value\":%s,\"ac\":%d,\"av\":%d}%s";
-static const char PROPERTY_FORMAT_WRITABLE_RESPONSE_WITH_DESCRIPTION[] = "\"%s\":{\"value\":%s,\"ac\":%d,\"av\":%d,\"ad\":\"%s\"}%s";
+// String constants for writing properties.  Payloads are assembled from these fragments and the application's
+// names and values with memcpy; lengths are computed up front so the output is allocated at its exact size.
 static const char PROPERTY_OPEN_BRACE[] = "{";
 static const char PROPERTY_CLOSE_BRACE[] = "}";
 static const char PROPERTY_COMMA[] = ",";
-static const char PROPERTY_EMPTY[] = "";
+static const char PROPERTY_QUOTE[] = "\"";
+static const char PROPERTY_NAME_END[] = "\":";
+static const char PROPERTY_COMPONENT_MARKER[] = "\":{\"__t\":\"c\",";
+static const char PROPERTY_WRITABLE_VALUE[] = "\":{\"value\":";
+static const char PROPERTY_WRITABLE_ACK_CODE[] = ",\"ac\":";
+static const char PROPERTY_WRITABLE_ACK_VERSION[] = ",\"av\":";
+static const char PROPERTY_WRITABLE_DESCRIPTION[] = ",\"ad\":\"";
+
+// Number of characters in one of the string constants above, not counting the null-terminator.
+#define PROPERTY_LITERAL_LENGTH(literal) (sizeof(literal) - 1)
 
 // metadata in underlying device twin
 static const char TWIN_DESIRED_OBJECT_NAME[] = "desired";
@@ -51,179 +62,233 @@ static const char TWIN_VERSION[] = "$version";
 static const char TWIN_COMPONENT_MARKER_NAME[] = "__t";
 static const char TWIN_COMPONENT_MARKER_VALUE[] = "c";
 
-// When writing a list of properties, whether to append a "," or nothing depends on whether more items are coming.
-static const char* AddCommaIfNeeded(bool lastItem)
+// WriteBytes copies length bytes to *currentWrite and advances it past them.
+static void WriteBytes(char** currentWrite, const char* bytes, size_t length)
+{
+    memcpy(*currentWrite, bytes, length);
+    *currentWrite += length;
+}
+
+// GetDecimalMagnitude returns the absolute value of value.  It is computed as unsigned so INT_MIN does not overflow.
+static unsigned int GetDecimalMagnitude(int value)
 {
-    return lastItem ? PROPERTY_EMPTY : PROPERTY_COMMA;
+    return (value < 0) ? (0U - (unsigned int)value) : (unsigned int)value;
 }
 
-// AdvanceCountersAfterWrite updates the traversal pointer and lengths after snprintf'ng JSON
-static void AdvanceCountersAfterWrite(int currentOutputBytes, char** currentWrite, size_t* requiredBytes, size_t* remainingBytes)
+// GetDecimalLength returns the number of characters needed to write value in decimal, including any '-'.
+static size_t GetDecimalLength(int value)
 {
-    // The number of bytes to be required is always updated by number the snprintf wrote to.
-    *requiredBytes += currentOutputBytes;
-    if (*currentWrite != NULL)
+    unsigned int magnitude = GetDecimalMagnitude(value);
+    size_t result = (value < 0) ? 2 : 1;
+
+    while (magnitude >= 10)
     {
-        // if *currentWrite is NULL, then we leave it as NULL since the caller is calculating the number of bytes needed.
-        // Otherwise we need to update it for the next write.
-        *currentWrite += currentOutputBytes;
-        *remainingBytes -= currentOutputBytes;
+        magnitude /= 10;
+        result++;
     }
+
+    return result;
 }
 
-// To correctly check snprintf for success, we need to check both it's not negative AND 
-// that the (number of bytes written ) != (sizeof buffer).
-static int PropertySnprintf(char* buffer, size_t count, const char* format, ...)
+// WriteDecimal writes value in decimal, the same as "%d" would.
+static void WriteDecimal(char** currentWrite, int value)
 {
-    va_list arg_list;
-    va_start(arg_list, format);
+    unsigned int magnitude = GetDecimalMagnitude(value);
+    size_t length = GetDecimalLength(value);
+    char* digit = *currentWrite + length;
 
-    int currentOutputBytes = vsnprintf(buffer, count, format, arg_list);
-    if ((currentOutputBytes < 0) || (currentOutputBytes == (int)count))
+    if (value < 0)
     {
-        return -1;
+        **currentWrite = '-';
     }
 
-    return currentOutputBytes;
+    do
+    {
+        *--digit = (char)('0' + (magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    *currentWrite += length;
 }
 
+// GetComponentLength returns the number of bytes the "componentName":{"__t":"c", ... } wrapping adds to a component's properties.
+static size_t GetComponentLength(const char* componentName)
+{
+    return (componentName == NULL) ? 0 :
+        PROPERTY_LITERAL_LENGTH(PROPERTY_QUOTE) + strlen(componentName) + PROPERTY_LITERAL_LENGTH(PROPERTY_COMPONENT_MARKER) + PROPERTY_LITERAL_LENGTH(PROPERTY_CLOSE_BRACE);
+}
 
-// WriteOpeningBrace adds opening brace for JSON to be generated, either a simple "{" or more complex format if componentName is specified.
-static bool WriteOpeningBrace(const char* componentName, char** currentWrite, size_t* requiredBytes, size_t* remainingBytes)
+static void WriteComponentStart(const char* componentName, char** currentWrite)
 {
-    int currentOutputBytes;
+    if (componentName != NULL)
+    {
+        WriteBytes(currentWrite, PROPERTY_QUOTE, PROPERTY_LITERAL_LENGTH(PROPERTY_QUOTE));
+        WriteBytes(currentWrite, componentName, strlen(componentName));
+        WriteBytes(currentWrite, PROPERTY_COMPONENT_MARKER, PROPERTY_LITERAL_LENGTH(PROPERTY_COMPONENT_MARKER));
+    }
+}
 
+static void WriteComponentEnd(const char* componentName, char** currentWrite)
+{
     if (componentName != NULL)
     {
-        if ((currentOutputBytes = PropertySnprintf(*currentWrite, *remainingBytes, PROPERTY_FORMAT_COMPONENT_START, componentName)) < 0)
-        {
-            LogError("Cannot write properties string");
-            return false;
-        }
+        WriteBytes(currentWrite, PROPERTY_CLOSE_BRACE, PROPERTY_LITERAL_LENGTH(PROPERTY_CLOSE_BRACE));
     }
-    else
+}
+
+// GetReportedPropertiesLength returns the number of bytes WriteReportedProperties writes.
+static size_t GetReportedPropertiesLength(const IOTHUB_CLIENT_PROPERTY_REPORTED* properties, size_t numProperties, const char* componentName)
+{
+    // Commas separating the properties
+    size_t result = GetComponentLength(componentName) + (numProperties - 1);
+
+    for (size_t i = 0; i < numProperties; i++)
     {
-        if ((currentOutputBytes = PropertySnprintf(*currentWrite, *remainingBytes, PROPERTY_OPEN_BRACE)) < 0)
-        {
-            LogError("Cannot write properties string");
-            return false;
-        }
+        result += PROPERTY_LITERAL_LENGTH(PROPERTY_QUOTE) + strlen(properties[i].name) + PROPERTY_LITERAL_LENGTH(PROPERTY_NAME_END) + strlen(properties[i].value);
     }
 
-    AdvanceCountersAfterWrite(currentOutputBytes, currentWrite, requiredBytes, remainingBytes);
-    return true;
+    return result;
 }
 
-// WriteOpeningBrace writes the required number of closing } while writing JSON
-static bool WriteClosingBrace(bool isComponent, char** currentWrite, size_t* requiredBytes, size_t* remainingBytes)
+// WriteReportedProperties writes the members of the reported properties JSON object, without its enclosing braces.
+static void WriteReportedProperties(const IOTHUB_CLIENT_PROPERTY_REPORTED* properties, size_t numProperties, const char* componentName, char** currentWrite)
 {
-    int currentOutputBytes;
-    size_t numberOfBraces = isComponent ? 2 : 1;
+    WriteComponentStart(componentName, currentWrite);
 
-    for (size_t i = 0; i < numberOfBraces; i++)
+    for (size_t i = 0; i < numProperties; i++)
     {
-        if ((currentOutputBytes = PropertySnprintf(*currentWrite, *remainingBytes, PROPERTY_CLOSE_BRACE)) < 0)
+        if (i != 0)
         {
-            LogError("Cannot write properties string");
-            return false;
+            WriteBytes(currentWrite, PROPERTY_COMMA, PROPERTY_LITERAL_LENGTH(PROPERTY_COMMA));
         }
-        AdvanceCountersAfterWrite(currentOutputBytes, currentWrite, requiredBytes, remainingBytes);
+        WriteBytes(currentWrite, PROPERTY_QUOTE, PROPERTY_LITERAL_LENGTH(PROPERTY_QUOTE));
+        WriteBytes(currentWrite, properties[i].name, strlen(properties[i].name));
+        WriteBytes(currentWrite, PROPERTY_NAME_END, PROPERTY_LITERAL_LENGTH(PROPERTY_NAME_END));
+        WriteBytes(currentWrite, properties[i].value, strlen(properties[i].value));
     }
 
-    return true;
+    WriteComponentEnd(componentName, currentWrite);
 }
 
-// WriteReportedProperties writes the actual serializedProperties string based 
-// on the properties.  If serializedProperties==NULL and serializedPropertiesLength==0, just like
-// analogous snprintf it will just calculate the amount of space caller needs to allocate.
-static bool WriteReportedProperties(const IOTHUB_CLIENT_PROPERTY_REPORTED* properties, size_t numProperties, const char* componentName, unsigned char* serializedProperties, size_t serializedPropertiesLength, size_t* requiredBytes)
+// GetWritableResponsePropertiesLength returns the number of bytes WriteWritableResponseProperties writes.
+static size_t GetWritableResponsePropertiesLength(const IOTHUB_CLIENT_PROPERTY_WRITABLE_RESPONSE* properties, size_t numProperties, const char* componentName)
 {
-    char* currentWrite = (char*)serializedProperties;
-    size_t remainingBytes = serializedPropertiesLength;
-
-    *requiredBytes = 0;
-
-    if (WriteOpeningBrace(componentName,  &currentWrite, requiredBytes, &remainingBytes) != true)
-    {
-        LogError("Cannot write properties string");
-        return false;
-    }
+    // Commas separating the properties
+    size_t result = GetComponentLength(componentName) + (numProperties - 1);
 
     for (size_t i = 0; i < numProperties; i++)
     {
-        bool lastProperty = (i == (numProperties - 1));
-        int currentOutputBytes;
+        result += PROPERTY_LITERAL_LENGTH(PROPERTY_QUOTE) + strlen(properties[i].name) +
+                  PROPERTY_LITERAL_LENGTH(PROPERTY_WRITABLE_VALUE) + strlen(properties[i].value) +
+                  PROPERTY_LITERAL_LENGTH(PROPERTY_WRITABLE_ACK_CODE) + GetDecimalLength(properties[i].result) +
+                  PROPERTY_LITERAL_LENGTH(PROPERTY_WRITABLE_ACK_VERSION) + GetDecimalLength(properties[i].ackVersion) +
+                  PROPERTY_LITERAL_LENGTH(PROPERTY_CLOSE_BRACE);
 
-        if ((currentOutputBytes = PropertySnprintf(currentWrite, remainingBytes, PROPERTY_FORMAT_NAME_VALUE, 
-                                                    properties[i].name, properties[i].value, AddCommaIfNeeded(lastProperty))) < 0)
+        if (properties[i].description != NULL)
         {
-            LogError("Cannot write properties string");
-            return false;
+            result += PROPERTY_LITERAL_LENGTH(PROPERTY_WRITABLE_DESCRIPTION) + strlen(properties[i].description) + PROPERTY_LITERAL_LENGTH(PROPERTY_QUOTE);
         }
-        AdvanceCountersAfterWrite(currentOutputBytes, &currentWrite, requiredBytes, &remainingBytes);
     }
 
-    if (WriteClosingBrace(componentName != NULL, &currentWrite, requiredBytes, &remainingBytes) != true)
+    return result;
+}
+
+// WriteWritableResponseProperties writes the members of the writable response JSON object, without its enclosing braces.
+static void WriteWritableResponseProperties(const IOTHUB_CLIENT_PROPERTY_WRITABLE_RESPONSE* properties, size_t numProperties, const char* componentName, char** currentWrite)
+{
+    WriteComponentStart(componentName, currentWrite);
+
+    for (size_t i = 0; i < numProperties; i++)
     {
-        LogError("Cannot write properties string");
-        return false;
+        if (i != 0)
+        {
+            WriteBytes(currentWrite, PROPERTY_COMMA, PROPERTY_LITERAL_LENGTH(PROPERTY_COMMA));
+        }
+        WriteBytes(currentWrite, PROPERTY_QUOTE, PROPERTY_LITERAL_LENGTH(PROPERTY_QUOTE));
+        WriteBytes(currentWrite, properties[i].name, strlen(properties[i].name));
+        WriteBytes(currentWrite, PROPERTY_WRITABLE_VALUE, PROPERTY_LITERAL_LENGTH(PROPERTY_WRITABLE_VALUE));
+        WriteBytes(currentWrite, properties[i].value, strlen(properties[i].value));
+        WriteBytes(currentWrite, PROPERTY_WRITABLE_ACK_CODE, PROPERTY_LITERAL_LENGTH(PROPERTY_WRITABLE_ACK_CODE));
+        WriteDecimal(currentWrite, properties[i].result);
+        WriteBytes(currentWrite, PROPERTY_WRITABLE_ACK_VERSION, PROPERTY_LITERAL_LENGTH(PROPERTY_WRITABLE_ACK_VERSION));
+        WriteDecimal(currentWrite, properties[i].ackVersion);
+
+        if (properties[i].description != NULL)
+        {
+            WriteBytes(currentWrite, PROPERTY_WRITABLE_DESCRIPTION, PROPERTY_LITERAL_LENGTH(PROPERTY_WRITABLE_DESCRIPTION));
+            WriteBytes(currentWrite, properties[i].description, strlen(properties[i].description));
+            WriteBytes(currentWrite, PROPERTY_QUOTE, PROPERTY_LITERAL_LENGTH(PROPERTY_QUOTE));
+        }
+
+        WriteBytes(currentWrite, PROPERTY_CLOSE_BRACE, PROPERTY_LITERAL_LENGTH(PROPERTY_CLOSE_BRACE));
     }
 
-    *requiredBytes = (*requiredBytes + 1);
-    return true;
+    WriteComponentEnd(componentName, currentWrite);
 }
 
-// WriteWritableResponseProperties is used to write serializedProperties string based 
-// on the writable response properties.  If serializedProperties==NULL and serializedPropertiesLength==0, just like
-// analogous snprintf it will just calculate the amount of space caller needs to allocate.
-static bool WriteWritableResponseProperties(const IOTHUB_CLIENT_PROPERTY_WRITABLE_RESPONSE* properties, size_t numProperties, const char* componentName, unsigned char* serializedProperties, size_t serializedPropertiesLength, size_t* requiredBytes)
+// StartAppend makes room for membersLength bytes of members in the JSON object held in serializedProperties,
+// returning where to write them.  When serializedPropertiesLength is 0 a new object is started; otherwise
+// the closing brace of the existing object is replaced by a comma.  Returns NULL if the buffer is too small.
+static char* StartAppend(unsigned char* serializedProperties, size_t serializedPropertiesSize, size_t serializedPropertiesLength, size_t membersLength)
 {
     char* currentWrite = (char*)serializedProperties;
-    size_t remainingBytes = serializedPropertiesLength;
-
-    *requiredBytes = 0;
+    bool needsComma = (serializedPropertiesLength != 0) && (serializedProperties[serializedPropertiesLength - 2] != PROPERTY_OPEN_BRACE[0]);
+    size_t requiredBytes;
 
-    if (WriteOpeningBrace(componentName,  &currentWrite, requiredBytes, &remainingBytes) != true)
+    if (serializedPropertiesLength == 0)
     {
-        LogError("Cannot write properties string");
-        return false;
+        // {members}
+        requiredBytes = PROPERTY_LITERAL_LENGTH(PROPERTY_OPEN_BRACE) + membersLength + PROPERTY_LITERAL_LENGTH(PROPERTY_CLOSE_BRACE);
     }
-
-    for (size_t i = 0; i < numProperties; i++)
+    else
     {
-        bool lastProperty = (i == (numProperties - 1));
-        int currentOutputBytes;
+        // The existing closing brace becomes a comma (unless the object is empty) and a new closing brace follows the members.
+        requiredBytes = serializedPropertiesLength + membersLength + (needsComma ? PROPERTY_LITERAL_LENGTH(PROPERTY_COMMA) : 0);
+    }
 
-        if (properties[i].description == NULL)
-        {
-            if ((currentOutputBytes = PropertySnprintf(currentWrite, remainingBytes, PROPERTY_FORMAT_WRITABLE_RESPONSE, properties[i].name, 
-                                                        properties[i].value, properties[i].result, properties[i].ackVersion, AddCommaIfNeeded(lastProperty))) < 0)
-            {
-                LogError("Cannot write properties string");
-                return false;
-            }
-        }
-        else
+    if ((requiredBytes < membersLength) || (requiredBytes > serializedPropertiesSize))
+    {
+        LogError("Serialized properties need %lu bytes but only %lu are available", (unsigned long)requiredBytes, (unsigned long)serializedPropertiesSize);
+        currentWrite = NULL;
+    }
+    else if (serializedPropertiesLength == 0)
+    {
+        WriteBytes(&currentWrite, PROPERTY_OPEN_BRACE, PROPERTY_LITERAL_LENGTH(PROPERTY_OPEN_BRACE));
+    }
+    else
+    {
+        currentWrite += serializedPropertiesLength - 1;
+        if (needsComma)
         {
-            if ((currentOutputBytes = PropertySnprintf(currentWrite, remainingBytes, PROPERTY_FORMAT_WRITABLE_RESPONSE_WITH_DESCRIPTION, properties[i].name, 
-                                                        properties[i].value, properties[i].result, properties[i].ackVersion, properties[i].description, AddCommaIfNeeded(lastProperty))) < 0)
-            {
-                LogError("Cannot write properties string");
-                return false;
-            }
+            WriteBytes(&currentWrite, PROPERTY_COMMA, PROPERTY_LITERAL_LENGTH(PROPERTY_COMMA));
         }
-
-        AdvanceCountersAfterWrite(currentOutputBytes, &currentWrite, requiredBytes, &remainingBytes);
     }
 
-    if (WriteClosingBrace(componentName != NULL, &currentWrite, requiredBytes, &remainingBytes) != true)
+    return currentWrite;
+}
+
+// VerifyAppendBuffer makes sure the buffer passed to the _Append APIs holds a JSON object to append to.
+static bool VerifyAppendBuffer(const unsigned char* serializedProperties, size_t serializedPropertiesSize, const size_t* serializedPropertiesLength)
+{
+    bool result;
+
+    if ((serializedProperties == NULL) || (serializedPropertiesLength == NULL) || (*serializedPropertiesLength > serializedPropertiesSize))
     {
-        LogError("Cannot write properties string");
-        return false;
+        LogError("Invalid serialized properties buffer");
+        result = false;
+    }
+    else if ((*serializedPropertiesLength != 0) &&
+             ((*serializedPropertiesLength < 2) || (serializedProperties[0] != PROPERTY_OPEN_BRACE[0]) || (serializedProperties[*serializedPropertiesLength - 1] != PROPERTY_CLOSE_BRACE[0])))
+    {
+        LogError("Serialized properties buffer does not hold a JSON object");
+        result = false;
+    }
+    else
+    {
+        result = true;
     }
 
-    *requiredBytes = (*requiredBytes + 1);
-    return true;
+    return result;
 }
 
 static bool VerifySerializeReportedProperties(const IOTHUB_CLIENT_PROPERTY_REPORTED* properties, size_t numProperties)
@@ -264,37 +329,65 @@ IOTHUB_CLIENT_RESULT IoTHubClient_Properties_Serializer_CreateReported(const IOT
         LogError("Invalid argument");
         result = IOTHUB_CLIENT_INVALID_ARG;
     }
-    else if (WriteReportedProperties(properties, numProperties, componentName, NULL, 0, &requiredBytes) != true)
-    {
-        LogError("Cannot determine required length of reported properties buffer");
-        result = IOTHUB_CLIENT_ERROR;
-    }
-    else if ((serializedPropertiesBuffer = calloc(1, requiredBytes)) == NULL)
-    {
-        LogError("Cannot allocate %lu bytes", (unsigned long)requiredBytes);
-        result = IOTHUB_CLIENT_ERROR;
-    }
-    else if (WriteReportedProperties(properties, numProperties, componentName, serializedPropertiesBuffer, requiredBytes, &requiredBytes) != true)
-    {
-        LogError("Cannot write properties buffer");
-        result = IOTHUB_CLIENT_ERROR;
-    }
     else
     {
-        result = IOTHUB_CLIENT_OK;
+        size_t membersLength = GetReportedPropertiesLength(properties, numProperties, componentName);
+        // Braces around the members, plus a null-terminator so the output can also be handled as a string.
+        requiredBytes = PROPERTY_LITERAL_LENGTH(PROPERTY_OPEN_BRACE) + membersLength + PROPERTY_LITERAL_LENGTH(PROPERTY_CLOSE_BRACE) + 1;
+
+        if ((serializedPropertiesBuffer = calloc(1, requiredBytes)) == NULL)
+        {
+            LogError("Cannot allocate %lu bytes", (unsigned long)requiredBytes);
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            char* currentWrite = StartAppend(serializedPropertiesBuffer, requiredBytes - 1, 0, membersLength);
+            WriteReportedProperties(properties, numProperties, componentName, &currentWrite);
+            WriteBytes(&currentWrite, PROPERTY_CLOSE_BRACE, PROPERTY_LITERAL_LENGTH(PROPERTY_CLOSE_BRACE));
+            result = IOTHUB_CLIENT_OK;
+        }
     }
 
     if (result == IOTHUB_CLIENT_OK)
     {
         *serializedProperties = serializedPropertiesBuffer;
-        // We allocated an additional byte than we technically need so snprintf() could output null-terminator.
+        // We allocated an additional byte than we technically need for the null-terminator.
         // The APIs this output pairs up with (e.g. IoTHubDeviceClient_LL_SendPropertiesAsync()) do not want
         // this null-terminator since the bytes are memcpy'd directly to network.  So account for this here.
         *serializedPropertiesLength = requiredBytes - 1;
     }
-    else if (serializedPropertiesBuffer != NULL)
+
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_Properties_Serializer_AppendReported(
+    const IOTHUB_CLIENT_PROPERTY_REPORTED* properties,
+    size_t numProperties,
+    const char* componentName,
+    unsigned char* serializedProperties,
+    size_t serializedPropertiesSize,
+    size_t* serializedPropertiesLength)
+{
+    IOTHUB_CLIENT_RESULT result;
+    char* currentWrite;
+
+    if ((VerifySerializeReportedProperties(properties, numProperties) == false) || (VerifyAppendBuffer(serializedProperties, serializedPropertiesSize, serializedPropertiesLength) == false))
+    {
+        LogError("Invalid argument");
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else if ((currentWrite = StartAppend(serializedProperties, serializedPropertiesSize, *serializedPropertiesLength, GetReportedPropertiesLength(properties, numProperties, componentName))) == NULL)
     {
-        free(serializedPropertiesBuffer);
+        LogError("Cannot append reported properties");
+        result = IOTHUB_CLIENT_INVALID_SIZE;
+    }
+    else
+    {
+        WriteReportedProperties(properties, numProperties, componentName, &currentWrite);
+        WriteBytes(&currentWrite, PROPERTY_CLOSE_BRACE, PROPERTY_LITERAL_LENGTH(PROPERTY_CLOSE_BRACE));
+        *serializedPropertiesLength = (size_t)((unsigned char*)currentWrite - serializedProperties);
+        result = IOTHUB_CLIENT_OK;
     }
 
     return result;
@@ -344,24 +437,24 @@ IOTHUB_CLIENT_RESULT IoTHubClient_Properties_Serializer_CreateWritableResponse(
         LogError("Invalid argument");
         result = IOTHUB_CLIENT_INVALID_ARG;
     }
-    else if (WriteWritableResponseProperties(properties, numProperties, componentName, NULL, 0, &requiredBytes) != true)
-    {
-        LogError("Cannot determine required length of reported properties buffer");
-        result = IOTHUB_CLIENT_ERROR;
-    }
-    else if ((serializedPropertiesBuffer = calloc(1, requiredBytes)) == NULL)
-    {
-        LogError("Cannot allocate %lu bytes", (unsigned long)requiredBytes);
-        result = IOTHUB_CLIENT_ERROR;
-    }
-    else if (WriteWritableResponseProperties(properties, numProperties, componentName, serializedPropertiesBuffer, requiredBytes, &requiredBytes) != true)
-    {
-        LogError("Cannot write properties buffer");
-        result = IOTHUB_CLIENT_ERROR;
-    }
     else
     {
-        result = IOTHUB_CLIENT_OK;
+        size_t membersLength = GetWritableResponsePropertiesLength(properties, numProperties, componentName);
+        // See comments in IoTHubClient_Properties_Serializer_CreateReported for the extra bytes.
+        requiredBytes = PROPERTY_LITERAL_LENGTH(PROPERTY_OPEN_BRACE) + membersLength + PROPERTY_LITERAL_LENGTH(PROPERTY_CLOSE_BRACE) + 1;
+
+        if ((serializedPropertiesBuffer = calloc(1, requiredBytes)) == NULL)
+        {
+            LogError("Cannot allocate %lu bytes", (unsigned long)requiredBytes);
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            char* currentWrite = StartAppend(serializedPropertiesBuffer, requiredBytes - 1, 0, membersLength);
+            WriteWritableResponseProperties(properties, numProperties, componentName, &currentWrite);
+            WriteBytes(&currentWrite, PROPERTY_CLOSE_BRACE, PROPERTY_LITERAL_LENGTH(PROPERTY_CLOSE_BRACE));
+            result = IOTHUB_CLIENT_OK;
+        }
     }
 
     if (result == IOTHUB_CLIENT_OK)
@@ -370,9 +463,37 @@ IOTHUB_CLIENT_RESULT IoTHubClient_Properties_Serializer_CreateWritableResponse(
         // See comments in IoTHubClient_Properties_Serializer_CreateReported for background on why we substract one.
         *serializedPropertiesLength = requiredBytes - 1;
     }
-    else if (serializedPropertiesBuffer != NULL)
+
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_Properties_Serializer_AppendWritableResponse(
+    const IOTHUB_CLIENT_PROPERTY_WRITABLE_RESPONSE* properties,
+    size_t numProperties,
+    const char* componentName,
+    unsigned char* serializedProperties,
+    size_t serializedPropertiesSize,
+    size_t* serializedPropertiesLength)
+{
+    IOTHUB_CLIENT_RESULT result;
+    char* currentWrite;
+
+    if ((VerifySerializeWritableReportedProperties(properties, numProperties) == false) || (VerifyAppendBuffer(serializedProperties, serializedPropertiesSize, serializedPropertiesLength) == false))
+    {
+        LogError("Invalid argument");
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else if ((currentWrite = StartAppend(serializedProperties, serializedPropertiesSize, *serializedPropertiesLength, GetWritableResponsePropertiesLength(properties, numProperties, componentName))) == NULL)
     {
-        free(serializedPropertiesBuffer);
+        LogError("Cannot append writable response properties");
+        result = IOTHUB_CLIENT_INVALID_SIZE;
+    }
+    else
+    {
+        WriteWritableResponseProperties(properties, numProperties, componentName, &currentWrite);
+        WriteBytes(&currentWrite, PROPERTY_CLOSE_BRACE, PROPERTY_LITERAL_LENGTH(PROPERTY_CLOSE_BRACE));
+        *serializedPropertiesLength = (size_t)((unsigned char*)currentWrite - serializedProperties);
+        result = IOTHUB_CLIENT_OK;
     }
 
     return result;
@@ -393,43 +514,413 @@ void IoTHubClient_Properties_Serializer_Destroy(unsigned char* serializedPropert
 }
 
 //
-// CopyPayloadToString creates a null-terminated string from the payload buffer.
-// payload is not guaranteed to be null-terminated by the IoT Hub device SDK.
+// The deserializer walks the JSON text in place instead of building a DOM.  IoTHubClient_Properties_Deserializer_Create
+// copies the payload once (it is not guaranteed to be null-terminated by the IoT Hub device SDK) and validates it;
+// IoTHubClient_Properties_Deserializer_GetNext then moves a cursor forward through the desired and reported objects.
+// Property names and values handed to the application point into the copy.  They are null-terminated in place by
+// overwriting the character that follows them, which is only done once the cursor has moved past that character.
 //
-static char* CopyPayloadToString(const unsigned char* payload, size_t size)
+
+// Deepest JSON nesting accepted.  IoT Hub limits twin properties to far fewer levels; this only bounds the recursion.
+#define JSON_MAX_NESTING_DEPTH 64
+// Longest escaped form of the reserved names compared with JsonStringEquals.
+#define JSON_MAX_ESCAPED_NAME_LENGTH 64
+
+static const char JSON_LITERAL_TRUE[] = "true";
+static const char JSON_LITERAL_FALSE[] = "false";
+static const char JSON_LITERAL_NULL[] = "null";
+
+static char* SkipJsonWhitespace(const char* json)
 {
-    char* jsonStr;
-    size_t sizeToAllocate = size + 1;
+    while ((*json == ' ') || (*json == '\t') || (*json == '\n') || (*json == '\r'))
+    {
+        json++;
+    }
+    return (char*)json;
+}
 
-    // If the result of sizeToAllocate is zero it means it had a type overflow (size_t is an unsigned type).
-    // It is very unlikely but could happen.
-    if (sizeToAllocate == 0)
+static bool IsHexDigit(char c)
+{
+    return ((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'f')) || ((c >= 'A') && (c <= 'F'));
+}
+
+static bool IsDigit(char c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+// FindJsonStringEnd returns the closing quote of the JSON string whose opening quote is at json, or NULL if it is not a valid string.
+static char* FindJsonStringEnd(const char* json)
+{
+    char* result = NULL;
+    bool valid = true;
+
+    json++;
+    while (valid && (*json != '"'))
     {
-        LogError("Payload size exceeds maximum allocation");
-        jsonStr = NULL;
+        if ((unsigned char)*json < 0x20)
+        {
+            // Control characters must be escaped; this also stops at the null-terminator.
+            valid = false;
+        }
+        else if (*json == '\\')
+        {
+            json++;
+            if (*json == 'u')
+            {
+                valid = IsHexDigit(json[1]) && IsHexDigit(json[2]) && IsHexDigit(json[3]) && IsHexDigit(json[4]);
+                json += 5;
+            }
+            else if ((*json != '\0') && (strchr("\"\\/bfnrt", *json) != NULL))
+            {
+                json++;
+            }
+            else
+            {
+                valid = false;
+            }
+        }
+        else
+        {
+            json++;
+        }
+    }
+
+    if (valid)
+    {
+        result = (char*)json;
+    }
+
+    return result;
+}
+
+static char* SkipJsonNumber(const char* json)
+{
+    char* result = NULL;
+
+    if (*json == '-')
+    {
+        json++;
+    }
+
+    if (*json == '0')
+    {
+        json++;
+    }
+    else if (IsDigit(*json))
+    {
+        while (IsDigit(*json))
+        {
+            json++;
+        }
+    }
+    else
+    {
+        return NULL;
+    }
+
+    if (*json == '.')
+    {
+        json++;
+        if (!IsDigit(*json))
+        {
+            return NULL;
+        }
+        while (IsDigit(*json))
+        {
+            json++;
+        }
+    }
+
+    if ((*json == 'e') || (*json == 'E'))
+    {
+        json++;
+        if ((*json == '+') || (*json == '-'))
+        {
+            json++;
+        }
+        if (!IsDigit(*json))
+        {
+            return NULL;
+        }
+        while (IsDigit(*json))
+        {
+            json++;
+        }
     }
-    else if ((jsonStr = (char*)calloc(1, sizeToAllocate)) == NULL)
+
+    result = (char*)json;
+    return result;
+}
+
+static char* SkipJsonValue(const char* json, size_t depth);
+
+// SkipJsonContainer validates the object or array at json, returning the character following its closing brace/bracket.
+static char* SkipJsonContainer(const char* json, size_t depth)
+{
+    char* result = NULL;
+    bool isObject = (*json == '{');
+    char closing = isObject ? '}' : ']';
+    bool valid = true;
+
+    json = SkipJsonWhitespace(json + 1);
+
+    if (*json != closing)
+    {
+        while (valid)
+        {
+            if (isObject)
+            {
+                if ((*json != '"') || ((json = FindJsonStringEnd(json)) == NULL))
+                {
+                    valid = false;
+                    break;
+                }
+                json = SkipJsonWhitespace(json + 1);
+                if (*json != ':')
+                {
+                    valid = false;
+                    break;
+                }
+                json = SkipJsonWhitespace(json + 1);
+            }
+
+            if ((json = SkipJsonValue(json, depth + 1)) == NULL)
+            {
+                valid = false;
+                break;
+            }
+
+            json = SkipJsonWhitespace(json);
+            if (*json == ',')
+            {
+                json = SkipJsonWhitespace(json + 1);
+            }
+            else if (*json == closing)
+            {
+                break;
+            }
+            else
+            {
+                valid = false;
+            }
+        }
+    }
+
+    if (valid)
+    {
+        result = (char*)json + 1;
+    }
+
+    return result;
+}
+
+// SkipJsonValue validates the JSON value at json, returning the character that follows it or NULL if the value is not valid JSON.
+static char* SkipJsonValue(const char* json, size_t depth)
+{
+    char* result;
+    char* stringEnd;
+
+    if (depth > JSON_MAX_NESTING_DEPTH)
+    {
+        LogError("JSON nesting exceeds %d levels", JSON_MAX_NESTING_DEPTH);
+        result = NULL;
+    }
+    else if ((*json == '{') || (*json == '['))
+    {
+        result = SkipJsonContainer(json, depth);
+    }
+    else if (*json == '"')
+    {
+        result = ((stringEnd = FindJsonStringEnd(json)) == NULL) ? NULL : stringEnd + 1;
+    }
+    else if (strncmp(json, JSON_LITERAL_TRUE, sizeof(JSON_LITERAL_TRUE) - 1) == 0)
+    {
+        result = (char*)json + sizeof(JSON_LITERAL_TRUE) - 1;
+    }
+    else if (strncmp(json, JSON_LITERAL_FALSE, sizeof(JSON_LITERAL_FALSE) - 1) == 0)
+    {
+        result = (char*)json + sizeof(JSON_LITERAL_FALSE) - 1;
+    }
+    else if (strncmp(json, JSON_LITERAL_NULL, sizeof(JSON_LITERAL_NULL) - 1) == 0)
+    {
+        result = (char*)json + sizeof(JSON_LITERAL_NULL) - 1;
+    }
+    else
+    {
+        result = SkipJsonNumber(json);
+    }
+
+    return result;
+}
+
+static void WriteUtf8(uint32_t codePoint, char** destination)
+{
+    char* write = *destination;
+
+    if (codePoint < 0x80)
+    {
+        *write++ = (char)codePoint;
+    }
+    else if (codePoint < 0x800)
+    {
+        *write++ = (char)(0xC0 | (codePoint >> 6));
+        *write++ = (char)(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000)
+    {
+        *write++ = (char)(0xE0 | (codePoint >> 12));
+        *write++ = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        *write++ = (char)(0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+        *write++ = (char)(0xF0 | (codePoint >> 18));
+        *write++ = (char)(0x80 | ((codePoint >> 12) & 0x3F));
+        *write++ = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        *write++ = (char)(0x80 | (codePoint & 0x3F));
+    }
+
+    *destination = write;
+}
+
+// ParseJsonHex4 returns the value of the four (already validated) hex digits of a \\u escape.
+static uint32_t ParseJsonHex4(const char* hex)
+{
+    uint32_t result = 0;
+    size_t i;
+
+    for (i = 0; i < 4; i++)
+    {
+        char c = hex[i];
+        result = (result << 4) | (uint32_t)((c <= '9') ? (c - '0') : ((c | 0x20) - 'a' + 10));
+    }
+
+    return result;
+}
+
+// DecodeJsonString unescapes the (already validated) JSON string contents [start, end) into destination and null-terminates it.
+// The decoded text is never longer than its escaped form, so destination may be start itself.
+static void DecodeJsonString(const char* start, const char* end, char* destination)
+{
+    while (start < end)
+    {
+        if (*start != '\\')
+        {
+            *destination++ = *start++;
+        }
+        else if (start[1] == 'u')
+        {
+            uint32_t codePoint = ParseJsonHex4(start + 2);
+            start += 6;
+
+            if ((codePoint >= 0xD800) && (codePoint <= 0xDBFF) && (start + 6 <= end) && (start[0] == '\\') && (start[1] == 'u'))
+            {
+                uint32_t lowSurrogate = ParseJsonHex4(start + 2);
+                if ((lowSurrogate >= 0xDC00) && (lowSurrogate <= 0xDFFF))
+                {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                    start += 6;
+                }
+            }
+
+            WriteUtf8(codePoint, &destination);
+        }
+        else
+        {
+            switch (start[1])
+            {
+                case 'b': *destination++ = '\b'; break;
+                case 'f': *destination++ = '\f'; break;
+                case 'n': *destination++ = '\n'; break;
+                case 'r': *destination++ = '\r'; break;
+                case 't': *destination++ = '\t'; break;
+                default: *destination++ = start[1]; break;
+            }
+            start += 2;
+        }
+    }
+
+    *destination = '\0';
+}
+
+// JsonStringEquals compares the JSON string contents [start, end) with text, without modifying the JSON.
+static bool JsonStringEquals(const char* start, const char* end, const char* text)
+{
+    bool result;
+    size_t length = (size_t)(end - start);
+
+    if (memchr(start, '\\', length) == NULL)
     {
-        LogError("Unable to allocate %lu size buffer", (unsigned long)(sizeToAllocate));
+        result = (strlen(text) == length) && (memcmp(start, text, length) == 0);
+    }
+    else if (length >= JSON_MAX_ESCAPED_NAME_LENGTH)
+    {
+        result = false;
     }
     else
     {
-        memcpy(jsonStr, payload, size);
-        jsonStr[size] = '\0';
+        char decoded[JSON_MAX_ESCAPED_NAME_LENGTH];
+        DecodeJsonString(start, end, decoded);
+        result = (strcmp(decoded, text) == 0);
+    }
+
+    return result;
+}
+
+// GetFirstJsonMember returns the opening quote of the first member name of the object at jsonObject, or NULL if it is empty.
+static char* GetFirstJsonMember(char* jsonObject)
+{
+    char* result = SkipJsonWhitespace(jsonObject + 1);
+    return (*result == '"') ? result : NULL;
+}
+
+// ReadJsonMember locates the name and value of the object member at member (on the opening quote of its name), and returns
+// the member that follows it or NULL if it is the last one.  The JSON was validated when the deserializer was created.
+static char* ReadJsonMember(char* member, char** nameEnd, char** value, char** valueEnd)
+{
+    char* next;
+
+    *nameEnd = FindJsonStringEnd(member);
+    *value = SkipJsonWhitespace(SkipJsonWhitespace(*nameEnd + 1) + 1);
+    *valueEnd = SkipJsonValue(*value, 0);
+
+    next = SkipJsonWhitespace(*valueEnd);
+    return (*next == ',') ? SkipJsonWhitespace(next + 1) : NULL;
+}
+
+// FindJsonMember returns the value of the member called name in the object at jsonObject, or NULL if there is none.
+static char* FindJsonMember(char* jsonObject, const char* name, char** valueEnd)
+{
+    char* result = NULL;
+    char* member = GetFirstJsonMember(jsonObject);
+
+    while (member != NULL)
+    {
+        char* nameEnd;
+        char* value;
+        char* next = ReadJsonMember(member, &nameEnd, &value, valueEnd);
+
+        if (JsonStringEquals(member + 1, nameEnd, name))
+        {
+            result = value;
+            break;
+        }
+        member = next;
     }
 
-    return jsonStr;
+    return result;
 }
 
-// GetDesiredAndReportedTwinJson retrieves the desired and (if available) the reported sections of IoT Hub twin as JSON_Objects for later use.
-// When a full twin is sent, the JSON consists of {"desired":{...}, "reported":{...}}".  If we're processing an update patch, 
+// GetDesiredAndReportedTwinJson locates the desired and (if available) the reported sections of IoT Hub twin for later use.
+// When a full twin is sent, the JSON consists of {"desired":{...}, "reported":{...}}".  If we're processing an update patch,
 // IoT Hub does not send us the "reported" and the "desired" is by convention taken to be the root of the JSON document received.
 static IOTHUB_CLIENT_RESULT GetDesiredAndReportedTwinJson(IOTHUB_CLIENT_PROPERTY_PAYLOAD_TYPE payloadType, IOTHUB_CLIENT_PROPERTIES_DESERIALIZER* propertiesDeserializer)
 {
     IOTHUB_CLIENT_RESULT result;
-    JSON_Object* rootObject;
+    char* rootObject = SkipJsonWhitespace(propertiesDeserializer->json);
 
-    if ((rootObject = json_value_get_object(propertiesDeserializer->rootValue)) == NULL)
+    if (*rootObject != '{')
     {
         LogError("Unable to get root object of JSON");
         result = IOTHUB_CLIENT_ERROR;
@@ -438,13 +929,24 @@ static IOTHUB_CLIENT_RESULT GetDesiredAndReportedTwinJson(IOTHUB_CLIENT_PROPERTY
     {
         if (payloadType == IOTHUB_CLIENT_PROPERTY_PAYLOAD_ALL)
         {
+            char* valueEnd;
+
             // NULL values are NOT errors, as the JSON may legitimately not have these fields.
-            propertiesDeserializer->desiredObject = json_object_get_object(rootObject, TWIN_DESIRED_OBJECT_NAME);
-            propertiesDeserializer->reportedObject = json_object_get_object(rootObject, TWIN_REPORTED_OBJECT_NAME);
+            propertiesDeserializer->desiredObject = FindJsonMember(rootObject, TWIN_DESIRED_OBJECT_NAME, &valueEnd);
+            propertiesDeserializer->reportedObject = FindJsonMember(rootObject, TWIN_REPORTED_OBJECT_NAME, &valueEnd);
+
+            if ((propertiesDeserializer->desiredObject != NULL) && (*propertiesDeserializer->desiredObject != '{'))
+            {
+                propertiesDeserializer->desiredObject = NULL;
+            }
+            if ((propertiesDeserializer->reportedObject != NULL) && (*propertiesDeserializer->reportedObject != '{'))
+            {
+                propertiesDeserializer->reportedObject = NULL;
+            }
         }
         else
         {
-            // For a patch update, IoTHub does not explicitly put a "desired:" JSON envelope.  The "desired-ness" is implicit 
+            // For a patch update, IoTHub does not explicitly put a "desired:" JSON envelope.  The "desired-ness" is implicit
             // in this case, so here we simply need the root of the JSON itself.
             propertiesDeserializer->desiredObject = rootObject;
             propertiesDeserializer->reportedObject = NULL;
@@ -455,46 +957,48 @@ static IOTHUB_CLIENT_RESULT GetDesiredAndReportedTwinJson(IOTHUB_CLIENT_PROPERTY
     return result;
 }
 
-// GetTwinVersion retrieves the $version field from JSON document received from IoT Hub.  
+// GetTwinVersion retrieves the $version field from JSON document received from IoT Hub.
 // The application needs this value when acknowledging writable properties received from the service.
 static IOTHUB_CLIENT_RESULT GetTwinVersion(IOTHUB_CLIENT_PROPERTIES_DESERIALIZER* propertiesDeserializer)
 {
     IOTHUB_CLIENT_RESULT result;
-    JSON_Value* versionValue = NULL;
+    char* versionValue = NULL;
+    char* versionValueEnd;
 
-    if ((versionValue = json_object_get_value(propertiesDeserializer->desiredObject, TWIN_VERSION)) == NULL)
+    if ((propertiesDeserializer->desiredObject == NULL) ||
+        ((versionValue = FindJsonMember(propertiesDeserializer->desiredObject, TWIN_VERSION, &versionValueEnd)) == NULL))
     {
         LogError("Cannot retrieve %s field for twin", TWIN_VERSION);
         result = IOTHUB_CLIENT_ERROR;
     }
-    else if (json_value_get_type(versionValue) != JSONNumber)
+    else if ((*versionValue != '-') && !IsDigit(*versionValue))
     {
         LogError("JSON field %s is not a number", TWIN_VERSION);
         result = IOTHUB_CLIENT_ERROR;
     }
     else
     {
-        propertiesDeserializer->propertiesVersion = (int)json_value_get_number(versionValue);
+        propertiesDeserializer->propertiesVersion = (int)strtod(versionValue, NULL);
         result = IOTHUB_CLIENT_OK;
     }
 
     return result;
 }
 
-// IsJsonObjectAComponent indicates whether the current containerObject we're visiting corresponds to
-// a PnP component (indicated by a "__t":"c" field as a containerObject child) or not.
-static bool IsJsonObjectAComponent(IOTHUB_CLIENT_PROPERTIES_DESERIALIZER* propertiesDeserializer, JSON_Object* containerObject)
+// IsJsonObjectAComponent indicates whether the value of the member we're visiting corresponds to
+// a PnP component (indicated by a "__t":"c" field as a child of that object) or not.
+static bool IsJsonObjectAComponent(char* propertyValue)
 {
-    bool result;
-
-    // First retrieve the JSON Object (assuming its an object) at the current place we're iterating.
-    JSON_Value* jsonValue = json_object_get_value_at(containerObject, propertiesDeserializer->currentPropertyIndex);
-    JSON_Object* jsonObject = json_value_get_object(jsonValue);
+    bool result = false;
+    char* componentMarkerValue;
+    char* componentMarkerValueEnd;
 
-    // Examine it's object to see if the "__t:c" has been set.  If jsonObject isn't actually of type JSON_Object,
-    // parson will gracefully return NULL for a string lookup.
-    const char* componentMarkerValue = json_object_get_string(jsonObject, TWIN_COMPONENT_MARKER_NAME);
-    result = (componentMarkerValue != NULL) && (strcmp(componentMarkerValue, TWIN_COMPONENT_MARKER_VALUE) == 0);
+    if ((*propertyValue == '{') &&
+        ((componentMarkerValue = FindJsonMember(propertyValue, TWIN_COMPONENT_MARKER_NAME, &componentMarkerValueEnd)) != NULL) &&
+        (*componentMarkerValue == '"'))
+    {
+        result = JsonStringEquals(componentMarkerValue + 1, componentMarkerValueEnd - 1, TWIN_COMPONENT_MARKER_VALUE);
+    }
 
     return result;
 }
@@ -526,151 +1030,135 @@ static IOTHUB_CLIENT_RESULT ValidateDeserializerInputs(
     return result;
 }
 
-// FillProperty retrieves properties that are children of jsonObject and puts them into properties 'property' to be returned to the application.
-static IOTHUB_CLIENT_RESULT FillProperty(IOTHUB_CLIENT_PROPERTIES_DESERIALIZER* propertiesDeserializer, const char* componentName, JSON_Value* propertyValue, const char* propertyName, IOTHUB_CLIENT_PROPERTY_PARSED* property)
+// TerminateJsonValue null-terminates the value ending at valueEnd.  Only called once the cursor is past valueEnd.
+static void TerminateJsonValue(char* valueEnd)
 {
-    IOTHUB_CLIENT_RESULT result = IOTHUB_CLIENT_ERROR;
-    const char* propertyStringJson;
-
-    if ((propertyStringJson = json_serialize_to_string(propertyValue)) == NULL)
-    {
-        LogError("Unable to retrieve JSON string for property value");
-        result = IOTHUB_CLIENT_ERROR;
-    }
-    else
-    {
-        // Note that most fields in the returned IOTHUB_CLIENT_PROPERTY_PARSED are shallow copies.  This memory remains valid until
-        // the application calls IoTHubClient_Properties_Deserializer_Destroy.
-        property->propertyType = (propertiesDeserializer->propertyParseState == PROPERTY_PARSE_STATE_DESIRED) ? 
-                                 IOTHUB_CLIENT_PROPERTY_TYPE_WRITABLE : IOTHUB_CLIENT_PROPERTY_TYPE_REPORTED_FROM_CLIENT;
-        property->componentName = componentName;
-        property->name = propertyName;
-        property->valueType = IOTHUB_CLIENT_PROPERTY_VALUE_STRING;
-        property->value.str = propertyStringJson;
-        property->valueLength = strlen(propertyStringJson);
-        result = IOTHUB_CLIENT_OK;
-    }
+    *valueEnd = '\0';
+}
 
-    return result;
+// TerminateJsonName unescapes in place and null-terminates the member name whose opening quote is at member.
+static const char* TerminateJsonName(char* member, char* nameEnd)
+{
+    DecodeJsonString(member + 1, nameEnd, member + 1);
+    return member + 1;
 }
 
-// IsReservedPropertyKeyword returns true if the given objectName is part of reserved PnP/Twin metadata for properties, false otherwise.
-static bool IsReservedPropertyKeyword(const char* objectName)
+// FillProperty puts the property into 'property' to be returned to the application.
+static void FillProperty(IOTHUB_CLIENT_PROPERTIES_DESERIALIZER* propertiesDeserializer, const char* componentName, const char* propertyName, char* propertyValue, char* propertyValueEnd, IOTHUB_CLIENT_PROPERTY_PARSED* property)
 {
-    return ((objectName == NULL) || (strcmp(objectName, TWIN_VERSION) == 0));
+    TerminateJsonValue(propertyValueEnd);
+
+    // Note that all fields in the returned IOTHUB_CLIENT_PROPERTY_PARSED point into the deserializer's copy of the payload.
+    // This memory remains valid until the application calls IoTHubClient_Properties_Deserializer_Destroy.
+    property->propertyType = (propertiesDeserializer->propertyParseState == PROPERTY_PARSE_STATE_DESIRED) ?
+                             IOTHUB_CLIENT_PROPERTY_TYPE_WRITABLE : IOTHUB_CLIENT_PROPERTY_TYPE_REPORTED_FROM_CLIENT;
+    property->componentName = componentName;
+    property->name = propertyName;
+    property->valueType = IOTHUB_CLIENT_PROPERTY_VALUE_STRING;
+    property->value.str = propertyValue;
+    property->valueLength = (size_t)(propertyValueEnd - propertyValue);
 }
 
-// IsReservedPropertyKeyword returns true if the given objectName is part of reserved PnP/Twin metadata for components, false otherwise.
-static bool IsReservedComponentKeyword(const char* objectName)
+// IsReservedPropertyKeyword returns true if the given member name is part of reserved PnP/Twin metadata for properties, false otherwise.
+static bool IsReservedPropertyKeyword(const char* member, const char* nameEnd)
 {
-    return ((objectName == NULL) || (strcmp(objectName, TWIN_COMPONENT_MARKER_NAME) == 0));
+    return JsonStringEquals(member + 1, nameEnd, TWIN_VERSION);
 }
 
-// GetNextComponentProperty advances through a given component's properties, returning either the next to be enumerated or that there's nothing left to traverse.
-static bool GetNextComponentProperty(IOTHUB_CLIENT_PROPERTIES_DESERIALIZER* propertiesDeserializer, JSON_Object* containerObject, const char** propertyName, JSON_Value** propertyValue)
+// IsReservedComponentKeyword returns true if the given member name is part of reserved PnP/Twin metadata for components, false otherwise.
+static bool IsReservedComponentKeyword(const char* member, const char* nameEnd)
 {
-    JSON_Value* componentValue = json_object_get_value_at(containerObject, propertiesDeserializer->currentPropertyIndex);
-    JSON_Object* componentObject = json_value_get_object(componentValue);
+    return JsonStringEquals(member + 1, nameEnd, TWIN_COMPONENT_MARKER_NAME);
+}
 
-    *propertyName = NULL;
-    *propertyValue = NULL;
+// GetNextComponentProperty advances through the current component's properties, returning either the next to be enumerated or that there's nothing left to traverse.
+static bool GetNextComponentProperty(IOTHUB_CLIENT_PROPERTIES_DESERIALIZER* propertiesDeserializer, IOTHUB_CLIENT_PROPERTY_PARSED* property)
+{
+    bool result = false;
 
-    if (componentObject == NULL)
+    while (propertiesDeserializer->currentComponentProperty != NULL)
     {
-        // This isn't a JSON Object so nothing to traverse
-        ;
-    }
-    else
-    {
-        size_t numComponentChildren = json_object_get_count(componentObject);
+        char* member = propertiesDeserializer->currentComponentProperty;
+        char* nameEnd;
+        char* value;
+        char* valueEnd;
 
-        while (propertiesDeserializer->currentComponentIndex < numComponentChildren)
+        propertiesDeserializer->currentComponentProperty = ReadJsonMember(member, &nameEnd, &value, &valueEnd);
+
+        if (IsReservedComponentKeyword(member, nameEnd))
         {
-            const char* objectName = json_object_get_name(componentObject, propertiesDeserializer->currentComponentIndex);
-            
-            if (IsReservedComponentKeyword(objectName))
-            {
-                // This objectName corresponds to twin/property metadata that is not passed to application
-                propertiesDeserializer->currentComponentIndex++;
-            }
-            else
-            {
-                *propertyName = objectName;
-                *propertyValue = json_object_get_value_at(componentObject, propertiesDeserializer->currentComponentIndex);
-                propertiesDeserializer->currentComponentIndex++;
-                break;
-            }
+            // This member corresponds to twin/property metadata that is not passed to application
+            continue;
+        }
+        else
+        {
+            FillProperty(propertiesDeserializer, propertiesDeserializer->currentComponentName, TerminateJsonName(member, nameEnd), value, valueEnd, property);
+            result = true;
+            break;
         }
     }
 
-    return (*propertyValue != NULL);
+    return result;
 }
 
 // GetNextPropertyToEnumerate advances through a property list, returning either the next property to be enumerated or that there's nothing left to traverse.
-static bool GetNextPropertyToEnumerate(IOTHUB_CLIENT_PROPERTIES_DESERIALIZER* propertiesDeserializer, const char** componentName, const char** propertyName, JSON_Value** propertyValue)
+static bool GetNextPropertyToEnumerate(IOTHUB_CLIENT_PROPERTIES_DESERIALIZER* propertiesDeserializer, IOTHUB_CLIENT_PROPERTY_PARSED* property)
 {
-    JSON_Object* containerObject;
-    *propertyName = NULL;
-    *propertyValue = NULL;
-
-    if (propertiesDeserializer->propertyParseState == PROPERTY_PARSE_STATE_DESIRED)
-    {
-        containerObject = propertiesDeserializer->desiredObject;
-    }
-    else
-    {
-        containerObject = propertiesDeserializer->reportedObject;
-    }
-
-    size_t numChildren = json_object_get_count(containerObject);
+    bool result = false;
 
-    while (propertiesDeserializer->currentPropertyIndex < numChildren)
+    while (true)
     {
-        const char* objectName = json_object_get_name(containerObject, propertiesDeserializer->currentPropertyIndex);
-
         if (propertiesDeserializer->componentParseState == COMPONENT_PARSE_STATE_SUB_COMPONENT)
         {
-            // The propertiesDeserializer->currentPropertyIndex corresponds to a subcomponent we're traversing.
-            if (GetNextComponentProperty(propertiesDeserializer, containerObject, propertyName, propertyValue) == true)
+            if (GetNextComponentProperty(propertiesDeserializer, property) == true)
             {
                 // The component has additional properties to return to application.
-                *componentName = objectName;
+                result = true;
                 break;
             }
             else
             {
                 // We've parsed all the properties of this component.  Move onto the next top-level JSON element
                 propertiesDeserializer->componentParseState = COMPONENT_PARSE_STATE_ROOT;
-                propertiesDeserializer->currentPropertyIndex++;
-                propertiesDeserializer->currentComponentIndex = 0;
-                continue;
             }
         }
 
-        if (IsJsonObjectAComponent(propertiesDeserializer, containerObject))
-        {
-            // This top-level property is the name of a component.  
-            propertiesDeserializer->componentParseState = COMPONENT_PARSE_STATE_SUB_COMPONENT;
-            continue;
-        }
-        else if (IsReservedPropertyKeyword(objectName))
+        if (propertiesDeserializer->currentProperty == NULL)
         {
-            // This objectName corresponds to twin/property metadata that is not passed to application
-            propertiesDeserializer->currentPropertyIndex++;
-            continue;
+            break;
         }
         else
         {
-            // We've found a property of the root component.
-            *componentName = NULL;
-            *propertyName = objectName;
-            *propertyValue = json_object_get_value_at(containerObject, propertiesDeserializer->currentPropertyIndex);
-            propertiesDeserializer->currentPropertyIndex++;
-            break;
+            char* member = propertiesDeserializer->currentProperty;
+            char* nameEnd;
+            char* value;
+            char* valueEnd;
+
+            propertiesDeserializer->currentProperty = ReadJsonMember(member, &nameEnd, &value, &valueEnd);
+
+            if (IsJsonObjectAComponent(value))
+            {
+                // This top-level property is the name of a component.
+                propertiesDeserializer->componentParseState = COMPONENT_PARSE_STATE_SUB_COMPONENT;
+                propertiesDeserializer->currentComponentName = TerminateJsonName(member, nameEnd);
+                propertiesDeserializer->currentComponentProperty = GetFirstJsonMember(value);
+            }
+            else if (IsReservedPropertyKeyword(member, nameEnd))
+            {
+                // This member corresponds to twin/property metadata that is not passed to application
+                ;
+            }
+            else
+            {
+                // We've found a property of the root component.
+                FillProperty(propertiesDeserializer, NULL, TerminateJsonName(member, nameEnd), value, valueEnd, property);
+                result = true;
+                break;
+            }
         }
     }
 
-    return (*propertyValue != NULL);
+    return result;
 }
 
 
@@ -681,27 +1169,33 @@ IOTHUB_CLIENT_RESULT IoTHubClient_Properties_Deserializer_Create(
     IOTHUB_CLIENT_PROPERTIES_DESERIALIZER_HANDLE* propertiesDeserializerHandle)
 {
     IOTHUB_CLIENT_RESULT result;
-    char* jsonStr = NULL;
-
     IOTHUB_CLIENT_PROPERTIES_DESERIALIZER* propertiesDeserializer = NULL;
+    size_t sizeToAllocate = sizeof(IOTHUB_CLIENT_PROPERTIES_DESERIALIZER) + payloadLength + 1;
 
     if ((result = ValidateDeserializerInputs(payloadType, payload, payloadLength, propertiesDeserializerHandle)) != IOTHUB_CLIENT_OK)
     {
         LogError("Invalid argument");
     }
-    else if ((propertiesDeserializer = (IOTHUB_CLIENT_PROPERTIES_DESERIALIZER*)calloc(1, sizeof(IOTHUB_CLIENT_PROPERTIES_DESERIALIZER))) == NULL)
+    // If sizeToAllocate wrapped around it means it had a type overflow (size_t is an unsigned type).
+    // It is very unlikely but could happen.
+    else if (sizeToAllocate <= payloadLength)
+    {
+        LogError("Payload size exceeds maximum allocation");
+        result = IOTHUB_CLIENT_ERROR;
+    }
+    // The deserializer and its copy of the payload are a single allocation.
+    else if ((propertiesDeserializer = (IOTHUB_CLIENT_PROPERTIES_DESERIALIZER*)calloc(1, sizeToAllocate)) == NULL)
     {
         LogError("Cannot allocate IOTHUB_CLIENT_PROPERTIES_DESERIALIZER");
         result = IOTHUB_CLIENT_ERROR;
     }
     else
     {
-        if ((jsonStr = CopyPayloadToString(payload, payloadLength)) == NULL)
-        {
-            LogError("Unable to allocate twin buffer");
-            result = IOTHUB_CLIENT_ERROR;
-        }
-        else if ((propertiesDeserializer->rootValue = json_parse_string(jsonStr)) == NULL)
+        propertiesDeserializer->json = (char*)(propertiesDeserializer + 1);
+        memcpy(propertiesDeserializer->json, payload, payloadLength);
+        propertiesDeserializer->json[payloadLength] = '\0';
+
+        if (SkipJsonValue(SkipJsonWhitespace(propertiesDeserializer->json), 0) == NULL)
         {
             LogError("Unable to parse device twin JSON");
             result = IOTHUB_CLIENT_ERROR;
@@ -722,13 +1216,12 @@ IOTHUB_CLIENT_RESULT IoTHubClient_Properties_Deserializer_Create(
         {
             propertiesDeserializer->propertyParseState = PROPERTY_PARSE_STATE_DESIRED;
             propertiesDeserializer->componentParseState = COMPONENT_PARSE_STATE_ROOT;
+            propertiesDeserializer->currentProperty = GetFirstJsonMember(propertiesDeserializer->desiredObject);
             *propertiesDeserializerHandle = propertiesDeserializer;
             result = IOTHUB_CLIENT_OK;
         }
     }
 
-    free(jsonStr);
-
     if (result != IOTHUB_CLIENT_OK)
     {
         IoTHubClient_Properties_Deserializer_Destroy(propertiesDeserializer);
@@ -765,10 +1258,7 @@ IOTHUB_CLIENT_RESULT IoTHubClient_Properties_Deserializer_GetNext(
 {
     IOTHUB_CLIENT_PROPERTIES_DESERIALIZER* propertiesDeserializer = (IOTHUB_CLIENT_PROPERTIES_DESERIALIZER*)propertiesDeserializerHandle;
     IOTHUB_CLIENT_RESULT result;
-
-    JSON_Value* propertyValue = NULL;
-    const char* propertyName = NULL;
-    const char* componentName = NULL;
+    bool propertyFound = false;
 
     if ((propertiesDeserializerHandle == NULL) || (property == NULL) || (propertySpecified == NULL) || (property->structVersion != IOTHUB_CLIENT_PROPERTY_PARSED_STRUCT_VERSION_1))
     {
@@ -779,36 +1269,21 @@ IOTHUB_CLIENT_RESULT IoTHubClient_Properties_Deserializer_GetNext(
     {
         if (propertiesDeserializer->propertyParseState == PROPERTY_PARSE_STATE_DESIRED)
         {
-            if ((GetNextPropertyToEnumerate(propertiesDeserializer, &componentName, &propertyName, &propertyValue)) == false)
+            if ((propertyFound = GetNextPropertyToEnumerate(propertiesDeserializer, property)) == false)
             {
                 // If we can't find another desired object, then transition to start searching through reported.
-                propertiesDeserializer->currentPropertyIndex = 0;
+                propertiesDeserializer->currentProperty = (propertiesDeserializer->reportedObject == NULL) ? NULL : GetFirstJsonMember(propertiesDeserializer->reportedObject);
                 propertiesDeserializer->propertyParseState = PROPERTY_PARSE_STATE_REPORTED;
             }
         }
 
         if (propertiesDeserializer->propertyParseState == PROPERTY_PARSE_STATE_REPORTED)
         {
-            GetNextPropertyToEnumerate(propertiesDeserializer, &componentName, &propertyName, &propertyValue);
+            propertyFound = GetNextPropertyToEnumerate(propertiesDeserializer, property);
         }
 
-        if (propertyValue != NULL)
-        {
-            // Fills in IOTHUB_CLIENT_PROPERTY_PARSED based on where we're at in the traversal.
-            if ((result = FillProperty(propertiesDeserializer, componentName, propertyValue, propertyName, property)) != IOTHUB_CLIENT_OK)
-            {
-                LogError("Cannot Fill Properties");
-            }
-            else
-            {
-                *propertySpecified = true;
-            }
-        }
-        else
-        {
-            *propertySpecified = false;
-            result = IOTHUB_CLIENT_OK;
-        }
+        *propertySpecified = propertyFound;
+        result = IOTHUB_CLIENT_OK;
     }
 
     return result;
@@ -817,21 +1292,16 @@ IOTHUB_CLIENT_RESULT IoTHubClient_Properties_Deserializer_GetNext(
 void IoTHubClient_Properties_DeserializerProperty_Destroy(
     IOTHUB_CLIENT_PROPERTY_PARSED* property)
 {
-    if (property != NULL)
-    {
-        // The only field in IOTHUB_CLIENT_PROPERTY_PARSED that is allocated when filling
-        // the structure is the JSON representation.  The remaining fields are shallow copies pointing
-        // into the parsed JSON fields which are freed by IoTHubClient_Properties_Deserializer_Destroy.
-        json_free_serialized_string((char*)property->value.str);
-    }
+    // Nothing in IOTHUB_CLIENT_PROPERTY_PARSED is allocated when filling the structure; all fields point into
+    // the deserializer's copy of the payload, which is freed by IoTHubClient_Properties_Deserializer_Destroy.
+    // Applications are still required to call this, so that future value types can allocate.
+    (void)property;
 }
 
 void IoTHubClient_Properties_Deserializer_Destroy(IOTHUB_CLIENT_PROPERTIES_DESERIALIZER_HANDLE propertiesDeserializerHandle)
 {
     if (propertiesDeserializerHandle != NULL)
     {
-        IOTHUB_CLIENT_PROPERTIES_DESERIALIZER* propertiesDeserializer = (IOTHUB_CLIENT_PROPERTIES_DESERIALIZER*)propertiesDeserializerHandle;
-        json_value_free(propertiesDeserializer->rootValue);
-        free(propertiesDeserializer);
+        free(propertiesDeserializerHandle);
     }
 }
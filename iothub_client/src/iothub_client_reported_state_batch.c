@@ -0,0 +1,403 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#include "internal/iothub_client_reported_state_batch.h"
+#include "parson.h"
+
+typedef struct REPORTED_STATE_CALLBACK_ENTRY_TAG
+{
+    IOTHUB_CLIENT_REPORTED_STATE_CALLBACK callback;
+    void* context;
+} REPORTED_STATE_CALLBACK_ENTRY;
+
+// Callers of a flushed patch, owned by the IOTHUB_DEVICE_TWIN item that carries it.
+typedef struct REPORTED_STATE_BATCH_COMPLETION_TAG
+{
+    REPORTED_STATE_CALLBACK_ENTRY* entries;
+    size_t count;
+} REPORTED_STATE_BATCH_COMPLETION;
+
+typedef struct REPORTED_STATE_BATCH_INSTANCE_TAG
+{
+    // Merged reported properties patch.  NULL while nothing is pending.
+    JSON_Value* pending;
+    REPORTED_STATE_CALLBACK_ENTRY* entries;
+    size_t count;
+    size_t capacity;
+    char* serialized;
+} REPORTED_STATE_BATCH_INSTANCE;
+
+static JSON_Value* parse_reported_state(const unsigned char* reportedState, size_t size)
+{
+    JSON_Value* result;
+    char* json_string;
+
+    // The reported state handed to SendReportedState is not NULL-terminated
+    if ((json_string = (char*)malloc(size + 1)) == NULL)
+    {
+        LogError("Failed allocating %lu bytes for the reported state", (unsigned long)(size + 1));
+        result = NULL;
+    }
+    else
+    {
+        (void)memcpy(json_string, reportedState, size);
+        json_string[size] = '\0';
+
+        if ((result = json_parse_string(json_string)) == NULL)
+        {
+            LogError("Failed parsing the reported state");
+        }
+        else if (json_value_get_type(result) != JSONObject)
+        {
+            LogError("Reported state is not a JSON object");
+            json_value_free(result);
+            result = NULL;
+        }
+
+        free(json_string);
+    }
+
+    return result;
+}
+
+// Applies patch onto target the way IoT Hub applies reported properties patches, except that null values are
+// kept (they are what removes the property on the service side).  Sending the result has the same effect as
+// sending target then patch, unless conflicts_with_reported_state says otherwise.
+static int merge_reported_state(JSON_Object* target, const JSON_Object* patch)
+{
+    int result = 0;
+    size_t count = json_object_get_count(patch);
+    size_t index;
+
+    for (index = 0; index < count && result == 0; index++)
+    {
+        const char* name = json_object_get_name(patch, index);
+        JSON_Value* patch_value = json_object_get_value_at(patch, index);
+        JSON_Object* target_object;
+
+        if (json_value_get_type(patch_value) == JSONObject && (target_object = json_object_get_object(target, name)) != NULL)
+        {
+            result = merge_reported_state(target_object, json_value_get_object(patch_value));
+        }
+        else
+        {
+            JSON_Value* copy = json_value_deep_copy(patch_value);
+
+            if (copy == NULL || json_object_set_value(target, name, copy) != JSONSuccess)
+            {
+                LogError("Failed merging reported property %s", name);
+                json_value_free(copy);
+                result = MU_FAILURE;
+            }
+        }
+    }
+
+    return result;
+}
+
+// IoT Hub merges an object into the current value of the property, but replaces anything else.  So where one patch
+// has an object and the other does not (e.g. null, which removes the property), at any depth, the merged patch
+// would not have the same effect as the two patches in turn: {"a":null} then {"a":{"b":1}} drops the other
+// properties of "a", while {"a":{"b":1}} keeps them.
+static bool conflicts_with_reported_state(const JSON_Object* target, const JSON_Object* patch)
+{
+    bool result = false;
+    size_t count = json_object_get_count(patch);
+    size_t index;
+
+    for (index = 0; index < count && !result; index++)
+    {
+        JSON_Value* target_value = json_object_get_value(target, json_object_get_name(patch, index));
+
+        if (target_value != NULL)
+        {
+            JSON_Value* patch_value = json_object_get_value_at(patch, index);
+            bool target_is_object = (json_value_get_type(target_value) == JSONObject);
+            bool patch_is_object = (json_value_get_type(patch_value) == JSONObject);
+
+            if (target_is_object && patch_is_object)
+            {
+                result = conflicts_with_reported_state(json_value_get_object(target_value), json_value_get_object(patch_value));
+            }
+            else
+            {
+                result = (target_is_object != patch_is_object);
+            }
+        }
+    }
+
+    return result;
+}
+
+static int add_callback_entry(REPORTED_STATE_BATCH_INSTANCE* batch, IOTHUB_CLIENT_REPORTED_STATE_CALLBACK reportedStateCallback, void* userContextCallback)
+{
+    int result;
+
+    if (batch->count == batch->capacity)
+    {
+        size_t new_capacity = (batch->capacity == 0) ? 4 : batch->capacity * 2;
+        REPORTED_STATE_CALLBACK_ENTRY* new_entries = (REPORTED_STATE_CALLBACK_ENTRY*)realloc(batch->entries, new_capacity * sizeof(REPORTED_STATE_CALLBACK_ENTRY));
+
+        if (new_entries == NULL)
+        {
+            LogError("Failed growing the reported state callbacks to %lu entries", (unsigned long)new_capacity);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            batch->entries = new_entries;
+            batch->capacity = new_capacity;
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result == 0)
+    {
+        batch->entries[batch->count].callback = reportedStateCallback;
+        batch->entries[batch->count].context = userContextCallback;
+        batch->count++;
+    }
+
+    return result;
+}
+
+REPORTED_STATE_BATCH_HANDLE reported_state_batch_create(void)
+{
+    REPORTED_STATE_BATCH_INSTANCE* result;
+
+    if ((result = (REPORTED_STATE_BATCH_INSTANCE*)malloc(sizeof(REPORTED_STATE_BATCH_INSTANCE))) == NULL)
+    {
+        LogError("Failed allocating the reported state batch");
+    }
+    else
+    {
+        memset(result, 0, sizeof(REPORTED_STATE_BATCH_INSTANCE));
+    }
+
+    return result;
+}
+
+void reported_state_batch_destroy(REPORTED_STATE_BATCH_HANDLE batch)
+{
+    if (batch != NULL)
+    {
+        json_value_free(batch->pending);
+        json_free_serialized_string(batch->serialized);
+        free(batch->entries);
+        free(batch);
+    }
+}
+
+int reported_state_batch_add(REPORTED_STATE_BATCH_HANDLE batch, const unsigned char* reportedState, size_t size, IOTHUB_CLIENT_REPORTED_STATE_CALLBACK reportedStateCallback, void* userContextCallback)
+{
+    int result;
+    JSON_Value* patch;
+
+    if (batch == NULL || reportedState == NULL || size == 0)
+    {
+        LogError("Invalid argument (batch=%p, reportedState=%p, size=%lu)", batch, reportedState, (unsigned long)size);
+        result = MU_FAILURE;
+    }
+    else if ((patch = parse_reported_state(reportedState, size)) == NULL)
+    {
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if (add_callback_entry(batch, reportedStateCallback, userContextCallback) != 0)
+        {
+            json_value_free(patch);
+            result = MU_FAILURE;
+        }
+        else if (batch->pending == NULL)
+        {
+            batch->pending = patch;
+            result = 0;
+        }
+        else
+        {
+            // A failed merge may have applied part of the patch; the caller is told it was not accepted, and the
+            // properties already merged are sent with the other ones.
+            if (merge_reported_state(json_value_get_object(batch->pending), json_value_get_object(patch)) != 0)
+            {
+                batch->count--;
+                result = MU_FAILURE;
+            }
+            else
+            {
+                result = 0;
+            }
+
+            json_value_free(patch);
+        }
+    }
+
+    return result;
+}
+
+bool reported_state_batch_conflicts(REPORTED_STATE_BATCH_HANDLE batch, const unsigned char* reportedState, size_t size)
+{
+    bool result;
+    JSON_Value* patch;
+
+    if (batch == NULL || reportedState == NULL || size == 0)
+    {
+        LogError("Invalid argument (batch=%p, reportedState=%p, size=%lu)", batch, reportedState, (unsigned long)size);
+        result = false;
+    }
+    else if (batch->pending == NULL)
+    {
+        result = false;
+    }
+    else if ((patch = parse_reported_state(reportedState, size)) == NULL)
+    {
+        // Not a conflict, reported_state_batch_add rejects it
+        result = false;
+    }
+    else
+    {
+        result = conflicts_with_reported_state(json_value_get_object(batch->pending), json_value_get_object(patch));
+        json_value_free(patch);
+    }
+
+    return result;
+}
+
+size_t reported_state_batch_get_count(REPORTED_STATE_BATCH_HANDLE batch)
+{
+    return (batch == NULL) ? 0 : batch->count;
+}
+
+size_t reported_state_batch_get_size(REPORTED_STATE_BATCH_HANDLE batch)
+{
+    size_t result;
+
+    if (batch == NULL || batch->pending == NULL || (result = json_serialization_size(batch->pending)) == 0)
+    {
+        result = 0;
+    }
+    else
+    {
+        // Does not count the NULL-terminator
+        result--;
+    }
+
+    return result;
+}
+
+int reported_state_batch_flush(REPORTED_STATE_BATCH_HANDLE batch, const unsigned char** reportedState, size_t* size, void** completionContext)
+{
+    int result;
+    REPORTED_STATE_BATCH_COMPLETION* completion;
+
+    if (batch == NULL || reportedState == NULL || size == NULL || completionContext == NULL)
+    {
+        LogError("Invalid argument (batch=%p, reportedState=%p, size=%p, completionContext=%p)", batch, reportedState, size, completionContext);
+        result = MU_FAILURE;
+    }
+    else if (batch->pending == NULL)
+    {
+        LogError("No reported state pending");
+        result = MU_FAILURE;
+    }
+    else if ((completion = (REPORTED_STATE_BATCH_COMPLETION*)malloc(sizeof(REPORTED_STATE_BATCH_COMPLETION))) == NULL)
+    {
+        LogError("Failed allocating the reported state completion");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        json_free_serialized_string(batch->serialized);
+
+        if ((batch->serialized = json_serialize_to_string(batch->pending)) == NULL)
+        {
+            LogError("Failed serializing the reported state");
+            free(completion);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            // The callbacks move to the completion; the next patch starts from an empty list
+            completion->entries = batch->entries;
+            completion->count = batch->count;
+            batch->entries = NULL;
+            batch->count = 0;
+            batch->capacity = 0;
+
+            json_value_free(batch->pending);
+            batch->pending = NULL;
+
+            *reportedState = (const unsigned char*)batch->serialized;
+            *size = strlen(batch->serialized);
+            *completionContext = completion;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+void reported_state_batch_complete(int status_code, void* completionContext)
+{
+    if (completionContext == NULL)
+    {
+        LogError("Invalid argument (completionContext=NULL)");
+    }
+    else
+    {
+        REPORTED_STATE_BATCH_COMPLETION* completion = (REPORTED_STATE_BATCH_COMPLETION*)completionContext;
+        size_t index;
+
+        for (index = 0; index < completion->count; index++)
+        {
+            if (completion->entries[index].callback != NULL)
+            {
+                completion->entries[index].callback(status_code, completion->entries[index].context);
+            }
+        }
+
+        free(completion->entries);
+        free(completion);
+    }
+}
+
+void reported_state_batch_abandon(REPORTED_STATE_BATCH_HANDLE batch, int status_code)
+{
+    if (batch == NULL)
+    {
+        LogError("Invalid argument (batch=NULL)");
+    }
+    else
+    {
+        // Detach the callers first, so the batch is already empty while they are called back
+        REPORTED_STATE_CALLBACK_ENTRY* entries = batch->entries;
+        size_t count = batch->count;
+        size_t index;
+
+        batch->entries = NULL;
+        batch->count = 0;
+        batch->capacity = 0;
+        json_value_free(batch->pending);
+        batch->pending = NULL;
+
+        for (index = 0; index < count; index++)
+        {
+            if (entries[index].callback != NULL)
+            {
+                entries[index].callback(status_code, entries[index].context);
+            }
+        }
+
+        free(entries);
+    }
+}
@@ -4,16 +4,21 @@
 #include "internal/iothub_client_retry_control.h"
 
 #include <math.h>
+#include <stdint.h>
 
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/agenttime.h"
 #include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/lock.h"
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/xlogging.h"
 
 #define RESULT_OK                 0
 #define INDEFINITE_TIME           ((time_t)-1)
+#define INDEFINITE_TICK           ((tickcounter_ms_t)-1)
+#define MILLISECONDS_PER_SECOND   1000
 #define DEFAULT_MAX_DELAY_IN_SECS 30
+#define DECORRELATED_JITTER_GROWTH_FACTOR 3
 
 typedef struct RETRY_CONTROL_INSTANCE_TAG
 {
@@ -26,11 +31,24 @@ typedef struct RETRY_CONTROL_INSTANCE_TAG
 
     unsigned int retry_count;
     TICK_COUNTER_HANDLE tick_counter;
-    time_t first_retry_tick_seconds;
-    time_t last_retry_tick_seconds;
-    unsigned int current_wait_time_in_secs;
+    tickcounter_ms_t first_retry_tick_ms;
+    tickcounter_ms_t last_retry_tick_ms;
+    tickcounter_ms_t current_wait_time_in_ms;
+    uint64_t random_state;
 } RETRY_CONTROL_INSTANCE;
 
+// Process-wide cap on how many (re)connection attempts may start per second, shared by every retry control instance.
+// The lock is created by IoTHub_Init and freed by IoTHub_Deinit; every other field is only accessed under it.
+typedef struct RETRY_BUDGET_TAG
+{
+    LOCK_HANDLE lock;
+    unsigned int attempts_per_second;
+    unsigned int available_attempts;
+    time_t last_refill_time;
+} RETRY_BUDGET;
+
+static RETRY_BUDGET g_retry_budget = { NULL, 0, 0, INDEFINITE_TIME };
+
 typedef int (*RETRY_ACTION_EVALUATION_FUNCTION)(RETRY_CONTROL_INSTANCE* retry_state, RETRY_ACTION* retry_action);
 
 
@@ -92,20 +110,90 @@ static void retry_control_destroy_option(const char* name, const void* value)
 
 // ========== _should_retry() Auxiliary Functions ========== //
 
-static time_t retry_get_tick_seconds(RETRY_CONTROL_INSTANCE* retry_control)
+// splitmix64, used to spread seeds that differ in only a few bits (addresses, tick counts) over the whole state
+static uint64_t mix_random_seed(uint64_t seed)
 {
-    time_t result = INDEFINITE_TIME;
-    int tick_result;
-    tickcounter_ms_t tick = 0;
+    seed += 0x9E3779B97F4A7C15ULL;
+    seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+    seed = seed ^ (seed >> 31);
+    return (seed == 0 ? 0x9E3779B97F4A7C15ULL : seed);
+}
+
+// xorshift64*; the state is per instance, so unlike rand() it needs no locking and clients do not share a sequence
+static uint64_t get_next_random(RETRY_CONTROL_INSTANCE* retry_control)
+{
+    uint64_t x = retry_control->random_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    retry_control->random_state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
 
-    if (retry_control != NULL && retry_control->tick_counter != NULL)
+// Returns a value in the range [0, 1]
+static double get_random_ratio(RETRY_CONTROL_INSTANCE* retry_control)
+{
+    return (double)(get_next_random(retry_control) >> 11) / (double)((1ULL << 53) - 1);
+}
+
+static bool take_retry_budget(void)
+{
+    bool result;
+
+    if (g_retry_budget.lock == NULL)
+    {
+        // IoTHub_Init was not called, so no budget can have been set
+        result = true;
+    }
+    else if (Lock(g_retry_budget.lock) != LOCK_OK)
+    {
+        LogError("Failed to lock the retry budget; allowing the attempt");
+        result = true;
+    }
+    else
     {
-        tick_result = tickcounter_get_current_ms(retry_control->tick_counter, &tick);
-        if (tick_result == 0 && INDEFINITE_TIME != tick)
+        if (g_retry_budget.attempts_per_second == 0)
+        {
+            result = true;
+        }
+        else
         {
-            // convert tick ms into secs
-            result = (time_t)(tick / 1000); 
+            time_t current_time = get_time(NULL);
+
+            if (current_time != INDEFINITE_TIME &&
+                (g_retry_budget.last_refill_time == INDEFINITE_TIME || get_difftime(current_time, g_retry_budget.last_refill_time) >= 1.0))
+            {
+                g_retry_budget.available_attempts = g_retry_budget.attempts_per_second;
+                g_retry_budget.last_refill_time = current_time;
+            }
+
+            if (g_retry_budget.available_attempts > 0)
+            {
+                g_retry_budget.available_attempts--;
+                result = true;
+            }
+            else
+            {
+                result = false;
+            }
         }
+
+        (void)Unlock(g_retry_budget.lock);
+    }
+
+    return result;
+}
+
+static tickcounter_ms_t retry_get_tick_ms(RETRY_CONTROL_INSTANCE* retry_control)
+{
+    tickcounter_ms_t result = INDEFINITE_TICK;
+    tickcounter_ms_t tick = 0;
+
+    if (retry_control != NULL && retry_control->tick_counter != NULL &&
+        tickcounter_get_current_ms(retry_control->tick_counter, &tick) == 0)
+    {
+        result = tick;
     }
 
     return result;
@@ -120,23 +208,23 @@ static int evaluate_retry_action(RETRY_CONTROL_INSTANCE* retry_control, RETRY_AC
         *retry_action = RETRY_ACTION_RETRY_NOW;
         result = RESULT_OK;
     }
-    else if (retry_control->last_retry_tick_seconds == INDEFINITE_TIME &&
+    else if (retry_control->last_retry_tick_ms == INDEFINITE_TICK &&
              retry_control->policy != IOTHUB_CLIENT_RETRY_IMMEDIATE)
     {
-        LogError("Failed to evaluate retry action (last_retry_tick_second is INDEFINITE_TIME)");
+        LogError("Failed to evaluate retry action (last_retry_tick_ms is INDEFINITE_TICK)");
         result = MU_FAILURE;
     }
     else
     {
-        time_t current_tick_seconds;
+        tickcounter_ms_t current_tick_ms;
 
-        if ((current_tick_seconds = retry_get_tick_seconds(retry_control)) == INDEFINITE_TIME)
+        if ((current_tick_ms = retry_get_tick_ms(retry_control)) == INDEFINITE_TICK)
         {
-            LogError("Failed to evaluate retry action (retry_get_tick_seconds() failed)");
+            LogError("Failed to evaluate retry action (retry_get_tick_ms() failed)");
             result = MU_FAILURE;
         }
         else if (retry_control->max_retry_time_in_secs > 0 &&
-            get_difftime(current_tick_seconds, retry_control->first_retry_tick_seconds) >= retry_control->max_retry_time_in_secs)
+            current_tick_ms - retry_control->first_retry_tick_ms >= (tickcounter_ms_t)retry_control->max_retry_time_in_secs * MILLISECONDS_PER_SECOND)
         {
             *retry_action = RETRY_ACTION_STOP_RETRYING;
 
@@ -148,7 +236,7 @@ static int evaluate_retry_action(RETRY_CONTROL_INSTANCE* retry_control, RETRY_AC
 
             result = RESULT_OK;
         }
-        else if (get_difftime(current_tick_seconds, retry_control->last_retry_tick_seconds) < retry_control->current_wait_time_in_secs)
+        else if (current_tick_ms - retry_control->last_retry_tick_ms < retry_control->current_wait_time_in_ms)
         {
             *retry_action = RETRY_ACTION_RETRY_LATER;
 
@@ -165,7 +253,7 @@ static int evaluate_retry_action(RETRY_CONTROL_INSTANCE* retry_control, RETRY_AC
     return result;
 }
 
-static unsigned int calculate_next_wait_time(RETRY_CONTROL_INSTANCE* retry_control)
+static unsigned int calculate_next_wait_time_in_secs(RETRY_CONTROL_INSTANCE* retry_control)
 {
     unsigned int result;
 
@@ -197,7 +285,7 @@ static unsigned int calculate_next_wait_time(RETRY_CONTROL_INSTANCE* retry_contr
     }
     else if (retry_control->policy == IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER)
     {
-        double jitter_percent = (retry_control->max_jitter_percent / 100.0) * (rand() / ((double)RAND_MAX));
+        double jitter_percent = (retry_control->max_jitter_percent / 100.0) * get_random_ratio(retry_control);
 
         double base_delay = pow(2, retry_control->retry_count - 1) * retry_control->initial_wait_time_in_secs;
 
@@ -210,7 +298,7 @@ static unsigned int calculate_next_wait_time(RETRY_CONTROL_INSTANCE* retry_contr
     }
     else if (retry_control->policy == IOTHUB_CLIENT_RETRY_RANDOM)
     {
-        double random_percent = ((double)rand() / (double)RAND_MAX);
+        double random_percent = get_random_ratio(retry_control);
         result = (unsigned int)(retry_control->initial_wait_time_in_secs * random_percent);
     }
     else
@@ -223,6 +311,49 @@ static unsigned int calculate_next_wait_time(RETRY_CONTROL_INSTANCE* retry_contr
     return result;
 }
 
+// Decorrelated jitter: random between the base delay and three times the previous delay, capped.
+// Clients that failed together drift apart on every attempt instead of retrying in lockstep.
+static tickcounter_ms_t calculate_decorrelated_jitter_wait_time_in_ms(RETRY_CONTROL_INSTANCE* retry_control)
+{
+    tickcounter_ms_t result;
+    tickcounter_ms_t base_delay_ms = (tickcounter_ms_t)retry_control->initial_wait_time_in_secs * MILLISECONDS_PER_SECOND;
+    tickcounter_ms_t max_delay_ms = (tickcounter_ms_t)retry_control->max_delay_in_secs * MILLISECONDS_PER_SECOND;
+    tickcounter_ms_t previous_delay_ms = (retry_control->current_wait_time_in_ms < base_delay_ms ? base_delay_ms : retry_control->current_wait_time_in_ms);
+    tickcounter_ms_t upper_delay_ms = previous_delay_ms * DECORRELATED_JITTER_GROWTH_FACTOR;
+
+    if (upper_delay_ms > max_delay_ms)
+    {
+        upper_delay_ms = max_delay_ms;
+    }
+
+    if (upper_delay_ms <= base_delay_ms)
+    {
+        result = upper_delay_ms;
+    }
+    else
+    {
+        result = base_delay_ms + (tickcounter_ms_t)(get_next_random(retry_control) % (upper_delay_ms - base_delay_ms + 1));
+    }
+
+    return result;
+}
+
+static tickcounter_ms_t calculate_next_wait_time(RETRY_CONTROL_INSTANCE* retry_control)
+{
+    tickcounter_ms_t result;
+
+    if (retry_control->policy == IOTHUB_CLIENT_RETRY_DECORRELATED_JITTER)
+    {
+        result = calculate_decorrelated_jitter_wait_time_in_ms(retry_control);
+    }
+    else
+    {
+        result = (tickcounter_ms_t)calculate_next_wait_time_in_secs(retry_control) * MILLISECONDS_PER_SECOND;
+    }
+
+    return result;
+}
+
 
 // ========== Public API ========== //
 
@@ -278,49 +409,48 @@ void retry_control_reset(RETRY_CONTROL_HANDLE retry_control_handle)
         RETRY_CONTROL_INSTANCE* retry_control = (RETRY_CONTROL_INSTANCE*)retry_control_handle;
 
         retry_control->retry_count = 0;
-        retry_control->current_wait_time_in_secs = 0;
-        retry_control->first_retry_tick_seconds = INDEFINITE_TIME;
-        retry_control->last_retry_tick_seconds = INDEFINITE_TIME;
+        retry_control->current_wait_time_in_ms = 0;
+        retry_control->first_retry_tick_ms = INDEFINITE_TICK;
+        retry_control->last_retry_tick_ms = INDEFINITE_TICK;
     }
 }
 
-RETRY_CONTROL_HANDLE retry_control_create(IOTHUB_CLIENT_RETRY_POLICY policy, unsigned int max_retry_time_in_secs)
+RETRY_CONTROL_HANDLE retry_control_create(IOTHUB_CLIENT_RETRY_POLICY policy, unsigned int max_retry_time_in_secs, TICK_COUNTER_HANDLE tick_counter)
 {
     RETRY_CONTROL_INSTANCE* retry_control;
 
-    if ((retry_control = (RETRY_CONTROL_INSTANCE*)malloc(sizeof(RETRY_CONTROL_INSTANCE))) == NULL)
+    if (tick_counter == NULL)
+    {
+        LogError("Failed creating the retry control (tick_counter is NULL)");
+        retry_control = NULL;
+    }
+    else if ((retry_control = (RETRY_CONTROL_INSTANCE*)malloc(sizeof(RETRY_CONTROL_INSTANCE))) == NULL)
     {
         LogError("Failed creating the retry control (malloc failed)");
     }
     else
     {
         memset(retry_control, 0, sizeof(RETRY_CONTROL_INSTANCE));
-        if ((retry_control->tick_counter = tickcounter_create()) == NULL)
+        retry_control->tick_counter = tick_counter;
+        retry_control->policy = policy;
+        retry_control->max_retry_time_in_secs = max_retry_time_in_secs;
+
+        if (retry_control->policy == IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF ||
+            retry_control->policy == IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER ||
+            retry_control->policy == IOTHUB_CLIENT_RETRY_DECORRELATED_JITTER)
         {
-            LogError("Failed creating the retry controller (tickcounter_create failed)");
-            free(retry_control);
-            retry_control = NULL;
+            retry_control->initial_wait_time_in_secs = 1;
         }
         else
         {
-            retry_control->policy = policy;
-            retry_control->max_retry_time_in_secs = max_retry_time_in_secs;
-
-            if (retry_control->policy == IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF ||
-                retry_control->policy == IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER)
-            {
-                retry_control->initial_wait_time_in_secs = 1;
-            }
-            else
-            {
-                retry_control->initial_wait_time_in_secs = 5;
-            }
+            retry_control->initial_wait_time_in_secs = 5;
+        }
 
-            retry_control->max_jitter_percent = 5;
-            retry_control->max_delay_in_secs = DEFAULT_MAX_DELAY_IN_SECS;
+        retry_control->max_jitter_percent = 5;
+        retry_control->max_delay_in_secs = DEFAULT_MAX_DELAY_IN_SECS;
+        retry_control->random_state = mix_random_seed((uint64_t)(uintptr_t)retry_control);
 
-            retry_control_reset(retry_control);
-        }
+        retry_control_reset(retry_control);
     }
 
     return (RETRY_CONTROL_HANDLE)retry_control;
@@ -334,7 +464,6 @@ void retry_control_destroy(RETRY_CONTROL_HANDLE retry_control_handle)
     }
     else
     {
-        tickcounter_destroy(retry_control_handle->tick_counter);
         free(retry_control_handle);
     }
 }
@@ -357,9 +486,9 @@ int retry_control_should_retry(RETRY_CONTROL_HANDLE retry_control_handle, RETRY_
             *retry_action = RETRY_ACTION_STOP_RETRYING;
             result = RESULT_OK;
         }
-        else if (retry_control->first_retry_tick_seconds == INDEFINITE_TIME && (retry_control->first_retry_tick_seconds = retry_get_tick_seconds(retry_control_handle)) == INDEFINITE_TIME)
+        else if (retry_control->first_retry_tick_ms == INDEFINITE_TICK && (retry_control->first_retry_tick_ms = retry_get_tick_ms(retry_control_handle)) == INDEFINITE_TICK)
         {
-            LogError("Failed to evaluate if retry should be attempted (retry_get_tick_seconds() failed)");
+            LogError("Failed to evaluate if retry should be attempted (retry_get_tick_ms() failed)");
             result = MU_FAILURE;
         }
         else if (evaluate_retry_action(retry_control, retry_action) != RESULT_OK)
@@ -369,15 +498,30 @@ int retry_control_should_retry(RETRY_CONTROL_HANDLE retry_control_handle, RETRY_
         }
         else
         {
+            if (retry_control->retry_count == 0)
+            {
+                // Devices in a fleet share neither addresses nor uptime, so fold the tick of the first attempt into the seed
+                retry_control->random_state ^= mix_random_seed(retry_control->first_retry_tick_ms);
+                if (retry_control->random_state == 0)
+                {
+                    retry_control->random_state = mix_random_seed(0);
+                }
+            }
+
+            if (*retry_action == RETRY_ACTION_RETRY_NOW && !take_retry_budget())
+            {
+                *retry_action = RETRY_ACTION_RETRY_LATER;
+            }
+
             if (*retry_action == RETRY_ACTION_RETRY_NOW)
             {
                 retry_control->retry_count++;
 
                 if (retry_control->policy != IOTHUB_CLIENT_RETRY_IMMEDIATE)
                 {
-                    retry_control->last_retry_tick_seconds = retry_get_tick_seconds(retry_control_handle);
+                    retry_control->last_retry_tick_ms = retry_get_tick_ms(retry_control_handle);
 
-                    retry_control->current_wait_time_in_secs = calculate_next_wait_time(retry_control);
+                    retry_control->current_wait_time_in_ms = calculate_next_wait_time(retry_control);
                 }
             }
 
@@ -507,3 +651,67 @@ OPTIONHANDLER_HANDLE retry_control_retrieve_options(RETRY_CONTROL_HANDLE retry_c
 
     return result;
 }
+
+int retry_control_budget_init(void)
+{
+    int result;
+
+    if (g_retry_budget.lock != NULL)
+    {
+        result = RESULT_OK;
+    }
+    else if ((g_retry_budget.lock = Lock_Init()) == NULL)
+    {
+        LogError("Failed to initialize the retry budget (Lock_Init failed)");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        g_retry_budget.attempts_per_second = 0;
+        g_retry_budget.available_attempts = 0;
+        g_retry_budget.last_refill_time = INDEFINITE_TIME;
+
+        result = RESULT_OK;
+    }
+
+    return result;
+}
+
+void retry_control_budget_deinit(void)
+{
+    if (g_retry_budget.lock != NULL)
+    {
+        (void)Lock_Deinit(g_retry_budget.lock);
+        g_retry_budget.lock = NULL;
+        g_retry_budget.attempts_per_second = 0;
+        g_retry_budget.available_attempts = 0;
+        g_retry_budget.last_refill_time = INDEFINITE_TIME;
+    }
+}
+
+int retry_control_set_global_budget(unsigned int attempts_per_second)
+{
+    int result;
+
+    if (g_retry_budget.lock == NULL)
+    {
+        LogError("Failed to set the retry budget (IoTHub_Init was not called)");
+        result = MU_FAILURE;
+    }
+    else if (Lock(g_retry_budget.lock) != LOCK_OK)
+    {
+        LogError("Failed to set the retry budget (Lock failed)");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        g_retry_budget.attempts_per_second = attempts_per_second;
+        g_retry_budget.available_attempts = attempts_per_second;
+        g_retry_budget.last_refill_time = INDEFINITE_TIME;
+        (void)Unlock(g_retry_budget.lock);
+
+        result = RESULT_OK;
+    }
+
+    return result;
+}
@@ -0,0 +1,361 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#include "internal/iothub_client_twin_cache.h"
+#include "parson.h"
+
+static const char TWIN_DESIRED_OBJECT_NAME[] = "desired";
+static const char TWIN_VERSION[] = "$version";
+
+typedef struct TWIN_CACHE_INSTANCE_TAG
+{
+    // Desired properties as last known, including their $version.  NULL until the first full twin document.
+    JSON_Value* desired;
+    int64_t desired_version;
+    // Set when a patch skipped versions; the next full document is then diffed even if its $version matches.
+    bool out_of_sync;
+    char* patch;
+} TWIN_CACHE_INSTANCE;
+
+static JSON_Value* parse_payload(const unsigned char* payload, size_t size)
+{
+    JSON_Value* result;
+    char* json_string;
+
+    // The payload received from the transport is not NULL-terminated
+    if ((json_string = (char*)malloc(size + 1)) == NULL)
+    {
+        LogError("Failed allocating %lu bytes for the twin document", (unsigned long)(size + 1));
+        result = NULL;
+    }
+    else
+    {
+        (void)memcpy(json_string, payload, size);
+        json_string[size] = '\0';
+
+        if ((result = json_parse_string(json_string)) == NULL)
+        {
+            LogError("Failed parsing the twin document");
+        }
+
+        free(json_string);
+    }
+
+    return result;
+}
+
+static bool get_version(const JSON_Object* object, int64_t* version)
+{
+    bool result;
+    JSON_Value* version_value = json_object_get_value(object, TWIN_VERSION);
+
+    if (version_value == NULL || json_value_get_type(version_value) != JSONNumber)
+    {
+        result = false;
+    }
+    else
+    {
+        *version = (int64_t)json_value_get_number(version_value);
+        result = true;
+    }
+
+    return result;
+}
+
+// Applies a JSON merge patch (the format IoT Hub uses for desired properties patches) onto target.
+static int merge_patch(JSON_Object* target, const JSON_Object* patch)
+{
+    int result = 0;
+    size_t count = json_object_get_count(patch);
+    size_t index;
+
+    for (index = 0; index < count && result == 0; index++)
+    {
+        const char* name = json_object_get_name(patch, index);
+        JSON_Value* patch_value = json_object_get_value_at(patch, index);
+        JSON_Object* target_object;
+
+        if (json_value_get_type(patch_value) == JSONNull)
+        {
+            (void)json_object_remove(target, name);
+        }
+        else if (json_value_get_type(patch_value) == JSONObject && (target_object = json_object_get_object(target, name)) != NULL)
+        {
+            result = merge_patch(target_object, json_value_get_object(patch_value));
+        }
+        else
+        {
+            JSON_Value* copy = json_value_deep_copy(patch_value);
+
+            if (copy == NULL || json_object_set_value(target, name, copy) != JSONSuccess)
+            {
+                LogError("Failed merging desired property %s", name);
+                json_value_free(copy);
+                result = MU_FAILURE;
+            }
+        }
+    }
+
+    return result;
+}
+
+// Builds into patch the JSON merge patch that turns previous into current.
+static int create_patch(const JSON_Object* previous, const JSON_Object* current, JSON_Object* patch)
+{
+    int result = 0;
+    size_t count = json_object_get_count(current);
+    size_t index;
+
+    for (index = 0; index < count && result == 0; index++)
+    {
+        const char* name = json_object_get_name(current, index);
+        JSON_Value* current_value = json_object_get_value_at(current, index);
+        JSON_Value* previous_value = json_object_get_value(previous, name);
+
+        if (previous_value != NULL && json_value_equals(previous_value, current_value))
+        {
+            continue;
+        }
+        else if (previous_value != NULL && json_value_get_type(previous_value) == JSONObject && json_value_get_type(current_value) == JSONObject)
+        {
+            JSON_Value* nested = json_value_init_object();
+
+            if (nested == NULL)
+            {
+                LogError("Failed creating patch for desired property %s", name);
+                result = MU_FAILURE;
+            }
+            else if (create_patch(json_value_get_object(previous_value), json_value_get_object(current_value), json_value_get_object(nested)) != 0 ||
+                json_object_set_value(patch, name, nested) != JSONSuccess)
+            {
+                LogError("Failed creating patch for desired property %s", name);
+                json_value_free(nested);
+                result = MU_FAILURE;
+            }
+        }
+        else
+        {
+            JSON_Value* copy = json_value_deep_copy(current_value);
+
+            if (copy == NULL || json_object_set_value(patch, name, copy) != JSONSuccess)
+            {
+                LogError("Failed creating patch for desired property %s", name);
+                json_value_free(copy);
+                result = MU_FAILURE;
+            }
+        }
+    }
+
+    count = json_object_get_count(previous);
+
+    for (index = 0; index < count && result == 0; index++)
+    {
+        const char* name = json_object_get_name(previous, index);
+
+        if (json_object_get_value(current, name) == NULL && json_object_set_null(patch, name) != JSONSuccess)
+        {
+            LogError("Failed creating patch for removed desired property %s", name);
+            result = MU_FAILURE;
+        }
+    }
+
+    return result;
+}
+
+static TWIN_CACHE_UPDATE_RESULT update_with_document(TWIN_CACHE_INSTANCE* twin_cache, JSON_Value* document)
+{
+    TWIN_CACHE_UPDATE_RESULT result;
+    JSON_Object* desired = json_object_get_object(json_value_get_object(document), TWIN_DESIRED_OBJECT_NAME);
+    int64_t version;
+    JSON_Value* desired_copy;
+
+    if (desired == NULL || !get_version(desired, &version))
+    {
+        LogError("Twin document has no desired properties version");
+        result = TWIN_CACHE_UPDATE_ERROR;
+    }
+    else if (twin_cache->desired != NULL && !twin_cache->out_of_sync && version == twin_cache->desired_version)
+    {
+        result = TWIN_CACHE_UPDATE_UNCHANGED;
+    }
+    else if ((desired_copy = json_value_deep_copy(json_object_get_wrapping_value(desired))) == NULL)
+    {
+        LogError("Failed copying the desired properties");
+        result = TWIN_CACHE_UPDATE_ERROR;
+    }
+    else if (twin_cache->desired == NULL)
+    {
+        twin_cache->desired = desired_copy;
+        twin_cache->desired_version = version;
+        result = TWIN_CACHE_UPDATE_DELIVER;
+    }
+    else
+    {
+        JSON_Value* patch = json_value_init_object();
+
+        if (patch == NULL ||
+            create_patch(json_value_get_object(twin_cache->desired), desired, json_value_get_object(patch)) != 0)
+        {
+            LogError("Failed computing the desired properties patch");
+            json_value_free(desired_copy);
+            result = TWIN_CACHE_UPDATE_ERROR;
+        }
+        else
+        {
+            json_value_free(twin_cache->desired);
+            twin_cache->desired = desired_copy;
+            twin_cache->desired_version = version;
+            twin_cache->out_of_sync = false;
+
+            if (json_object_get_count(json_value_get_object(patch)) == 0)
+            {
+                result = TWIN_CACHE_UPDATE_UNCHANGED;
+            }
+            else if ((twin_cache->patch = json_serialize_to_string(patch)) == NULL)
+            {
+                LogError("Failed serializing the desired properties patch");
+                result = TWIN_CACHE_UPDATE_ERROR;
+            }
+            else
+            {
+                result = TWIN_CACHE_UPDATE_DELIVER_PATCH;
+            }
+        }
+
+        json_value_free(patch);
+    }
+
+    return result;
+}
+
+static TWIN_CACHE_UPDATE_RESULT update_with_patch(TWIN_CACHE_INSTANCE* twin_cache, JSON_Value* patch)
+{
+    TWIN_CACHE_UPDATE_RESULT result;
+    JSON_Object* patch_object = json_value_get_object(patch);
+    int64_t version;
+
+    if (patch_object == NULL || !get_version(patch_object, &version))
+    {
+        LogError("Desired properties patch has no version");
+        result = TWIN_CACHE_UPDATE_ERROR;
+    }
+    else if (twin_cache->desired == NULL)
+    {
+        // Nothing to merge into until the first full document arrives
+        result = TWIN_CACHE_UPDATE_DELIVER;
+    }
+    else if (version <= twin_cache->desired_version)
+    {
+        result = TWIN_CACHE_UPDATE_UNCHANGED;
+    }
+    else if (merge_patch(json_value_get_object(twin_cache->desired), patch_object) != 0)
+    {
+        // The cached copy can no longer be trusted; resynchronize from a full document
+        twin_cache->out_of_sync = true;
+        result = TWIN_CACHE_UPDATE_OUT_OF_SYNC;
+    }
+    else
+    {
+        if (!twin_cache->out_of_sync && version != twin_cache->desired_version + 1)
+        {
+            LogInfo("Desired properties jumped from version %" PRId64 " to %" PRId64 "; requesting the full twin", twin_cache->desired_version, version);
+            twin_cache->out_of_sync = true;
+            result = TWIN_CACHE_UPDATE_OUT_OF_SYNC;
+        }
+        else
+        {
+            result = TWIN_CACHE_UPDATE_DELIVER;
+        }
+
+        twin_cache->desired_version = version;
+    }
+
+    return result;
+}
+
+TWIN_CACHE_HANDLE twin_cache_create(void)
+{
+    TWIN_CACHE_INSTANCE* result;
+
+    if ((result = (TWIN_CACHE_INSTANCE*)malloc(sizeof(TWIN_CACHE_INSTANCE))) == NULL)
+    {
+        LogError("Failed allocating the twin cache");
+    }
+    else
+    {
+        memset(result, 0, sizeof(TWIN_CACHE_INSTANCE));
+    }
+
+    return result;
+}
+
+void twin_cache_reset(TWIN_CACHE_HANDLE twin_cache)
+{
+    if (twin_cache != NULL)
+    {
+        json_value_free(twin_cache->desired);
+        twin_cache->desired = NULL;
+        twin_cache->desired_version = 0;
+        twin_cache->out_of_sync = false;
+        json_free_serialized_string(twin_cache->patch);
+        twin_cache->patch = NULL;
+    }
+}
+
+void twin_cache_destroy(TWIN_CACHE_HANDLE twin_cache)
+{
+    if (twin_cache != NULL)
+    {
+        twin_cache_reset(twin_cache);
+        free(twin_cache);
+    }
+}
+
+TWIN_CACHE_UPDATE_RESULT twin_cache_update(TWIN_CACHE_HANDLE twin_cache, DEVICE_TWIN_UPDATE_STATE update_state, const unsigned char* payload, size_t size, const unsigned char** patch, size_t* patch_size)
+{
+    TWIN_CACHE_UPDATE_RESULT result;
+    JSON_Value* document;
+
+    if (twin_cache == NULL || payload == NULL || size == 0 || patch == NULL || patch_size == NULL)
+    {
+        LogError("Invalid argument (twin_cache=%p, payload=%p, size=%lu, patch=%p, patch_size=%p)", twin_cache, payload, (unsigned long)size, patch, patch_size);
+        result = TWIN_CACHE_UPDATE_ERROR;
+    }
+    else if ((document = parse_payload(payload, size)) == NULL)
+    {
+        result = TWIN_CACHE_UPDATE_ERROR;
+    }
+    else
+    {
+        json_free_serialized_string(twin_cache->patch);
+        twin_cache->patch = NULL;
+
+        if (update_state == DEVICE_TWIN_UPDATE_COMPLETE)
+        {
+            result = update_with_document(twin_cache, document);
+        }
+        else
+        {
+            result = update_with_patch(twin_cache, document);
+        }
+
+        if (result == TWIN_CACHE_UPDATE_DELIVER_PATCH)
+        {
+            *patch = (const unsigned char*)twin_cache->patch;
+            *patch_size = strlen(twin_cache->patch);
+        }
+
+        json_value_free(document);
+    }
+
+    return result;
+}
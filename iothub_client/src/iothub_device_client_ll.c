@@ -132,6 +132,16 @@ IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_UploadToBlob(IOTHUB_DEVICE_CLIENT_LL_
     return IoTHubClientCore_LL_UploadToBlob((IOTHUB_CLIENT_CORE_LL_HANDLE)iotHubClientHandle, destinationFileName, source, size);
 }
 
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_UploadFileToBlob(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, const char* destinationFileName, const char* sourceFilePath)
+{
+    return IoTHubClientCore_LL_UploadFileToBlob((IOTHUB_CLIENT_CORE_LL_HANDLE)iotHubClientHandle, destinationFileName, sourceFilePath);
+}
+
+IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_UploadFileToBlobResumable(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, const char* destinationFileName, const char* sourceFilePath, const char* checkpointFilePath)
+{
+    return IoTHubClientCore_LL_UploadFileToBlobResumable((IOTHUB_CLIENT_CORE_LL_HANDLE)iotHubClientHandle, destinationFileName, sourceFilePath, checkpointFilePath);
+}
+
 IOTHUB_CLIENT_RESULT IoTHubDeviceClient_LL_UploadMultipleBlocksToBlob(IOTHUB_DEVICE_CLIENT_LL_HANDLE iotHubClientHandle, const char* destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
 {
     return IoTHubClientCore_LL_UploadMultipleBlocksToBlobEx((IOTHUB_CLIENT_CORE_LL_HANDLE)iotHubClientHandle, destinationFileName, getDataCallbackEx, context);
@@ -3,6 +3,7 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <time.h>
 #include <limits.h>
@@ -18,7 +19,9 @@
 #include "azure_c_shared_utility/urlencode.h"
 #include "azure_c_shared_utility/tlsio.h"
 #include "azure_c_shared_utility/optionhandler.h"
+#include "azure_c_shared_utility/safe_math.h"
 #include "azure_c_shared_utility/shared_util_options.h"
+#include "azure_c_shared_utility/tickcounter.h"
 #include "azure_macro_utils/macro_utils.h"
 
 #include "azure_uamqp_c/cbs.h"
@@ -113,6 +116,10 @@ typedef struct AMQP_TRANSPORT_INSTANCE_TAG
     OPTIONHANDLER_HANDLE saved_tls_options;                             // Here are the options from the xio layer if any is saved.
     AMQP_TRANSPORT_STATE state;                                         // Current state of the transport.
     RETRY_CONTROL_HANDLE connection_retry_control;                      // Controls when the re-connection attempt should occur.
+    TICK_COUNTER_HANDLE tick_counter;                                   // Shared by everything this transport times (e.g., the connection retry control).
+    tickcounter_ms_t connection_start_time;                             // When the current amqp_connection was created.
+    tickcounter_ms_t last_connect_duration;                             // Time from amqp_connection creation to OPENED, for the last connection.
+    bool has_connected;                                                 // Set once last_connect_duration holds a measurement.
     size_t svc2cl_keep_alive_timeout_secs;                       // Service to device keep alive frequency
     double cl2svc_keep_alive_send_ratio;                                    // Client to service keep alive frequency
 
@@ -122,7 +129,10 @@ typedef struct AMQP_TRANSPORT_INSTANCE_TAG
     char* http_proxy_password;
 
     size_t option_cbs_request_timeout_secs;                             // Device-specific option.
-    size_t option_send_event_timeout_secs;                              // Device-specific option.
+    size_t option_send_event_timeout_ms;                                // Device-specific option.
+    size_t option_receiver_link_credit;                                 // Device-specific option.
+    size_t option_max_devices_per_session;                              // Applied when the amqp_connection is (re)created; 0 means all devices share one session.
+    size_t connection_max_devices_per_session;                          // Value of option_max_devices_per_session the current amqp_connection was created with.
 
                                                                         // Auth module used to generating handle authorization
     IOTHUB_AUTHORIZATION_HANDLE authorization_module;                   // with either SAS Token, x509 Certs, and Device SAS Token
@@ -144,6 +154,7 @@ typedef struct AMQP_TRANSPORT_DEVICE_INSTANCE_TAG
     unsigned int max_state_change_timeout_secs;                         // Maximum number of seconds allowed for device_handle to complete start and stop state changes.
     // the methods portion
     IOTHUBTRANSPORT_AMQP_METHODS_HANDLE methods_handle;                 // Handle to instance of module that deals with device methods for AMQP.
+    SESSION_HANDLE session_handle;                                      // Session acquired from the amqp_connection when option_max_devices_per_session is set; NULL otherwise.
     // is subscription for methods needed?
     bool subscribe_methods_needed;                                       // Indicates if should subscribe for device methods.
     // is the transport subscribed for methods?
@@ -237,6 +248,12 @@ static void internal_destroy_amqp_device_instance(AMQP_TRANSPORT_DEVICE_INSTANCE
         amqp_device_destroy(trdev_inst->device_handle);
     }
 
+    // The device links are gone by now, so its session can be handed to another device (or destroyed).
+    if (trdev_inst->session_handle != NULL && trdev_inst->transport_instance->amqp_connection != NULL)
+    {
+        amqp_connection_release_session_handle(trdev_inst->transport_instance->amqp_connection, trdev_inst->session_handle);
+    }
+
     if (trdev_inst->device_id != NULL)
     {
         STRING_delete(trdev_inst->device_id);
@@ -556,6 +573,33 @@ static bool can_subscribe_methods(AMQP_TRANSPORT_DEVICE_INSTANCE* registered_dev
     return result;
 }
 
+// @brief
+//     Gets the session the device must create its links on. By default all devices share the amqp_connection session;
+//     if the amqp_connection was created with OPTION_AMQP_MAX_DEVICES_PER_SESSION set, the device acquires a session from the amqp_connection and keeps it until unregistered or the connection is reset.
+// @returns
+//     0 if the function succeeds, non-zero otherwise.
+static int get_device_session_handle(AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device, SESSION_HANDLE* session_handle)
+{
+    int result;
+
+    if (registered_device->transport_instance->connection_max_devices_per_session == 0)
+    {
+        result = amqp_connection_get_session_handle(registered_device->transport_instance->amqp_connection, session_handle);
+    }
+    else if (registered_device->session_handle == NULL &&
+        amqp_connection_acquire_session_handle(registered_device->transport_instance->amqp_connection, &registered_device->session_handle) != RESULT_OK)
+    {
+        result = MU_FAILURE;
+    }
+    else
+    {
+        *session_handle = registered_device->session_handle;
+        result = RESULT_OK;
+    }
+
+    return result;
+}
+
 static int subscribe_methods(AMQP_TRANSPORT_DEVICE_INSTANCE* deviceState)
 {
     int result;
@@ -568,7 +612,7 @@ static int subscribe_methods(AMQP_TRANSPORT_DEVICE_INSTANCE* deviceState)
     {
         SESSION_HANDLE session_handle;
 
-        if ((amqp_connection_get_session_handle(deviceState->transport_instance->amqp_connection, &session_handle)) != RESULT_OK)
+        if (get_device_session_handle(deviceState, &session_handle) != RESULT_OK)
         {
             const char* device_id = STRING_c_str(deviceState->device_id); // advoid MU_P_OR_NULL double call
             LogError("Device '%s' failed subscribing for methods (failed getting session handle)", MU_P_OR_NULL(device_id));
@@ -808,6 +852,19 @@ static void on_amqp_connection_state_changed(const void* context, AMQP_CONNECTIO
         }
         else if (new_state == AMQP_CONNECTION_STATE_OPENED)
         {
+            tickcounter_ms_t current_ms;
+
+            if (tickcounter_get_current_ms(transport_instance->tick_counter, &current_ms) != 0)
+            {
+                LogError("Failure getting the current time, connection establishment time not recorded");
+            }
+            else
+            {
+                transport_instance->last_connect_duration = current_ms - transport_instance->connection_start_time;
+                transport_instance->has_connected = true;
+                LogInfo("AMQP connection established in %" PRIu64 " ms", (uint64_t)transport_instance->last_connect_duration);
+            }
+
             update_state(transport_instance, AMQP_TRANSPORT_STATE_CONNECTED);
         }
         else if (new_state == AMQP_CONNECTION_STATE_CLOSED && previous_state == AMQP_CONNECTION_STATE_OPENED && transport_instance->state != AMQP_TRANSPORT_STATE_BEING_DESTROYED)
@@ -844,6 +901,8 @@ static int establish_amqp_connection(AMQP_TRANSPORT_INSTANCE* transport_instance
         amqp_connection_config.on_state_changed_context = transport_instance;
         amqp_connection_config.svc2cl_keep_alive_timeout_secs = transport_instance->svc2cl_keep_alive_timeout_secs;
         amqp_connection_config.cl2svc_keep_alive_send_ratio = transport_instance->cl2svc_keep_alive_send_ratio;
+        amqp_connection_config.max_devices_per_session = transport_instance->option_max_devices_per_session;
+        transport_instance->connection_max_devices_per_session = transport_instance->option_max_devices_per_session;
 
         if (transport_instance->preferred_authentication_mode == AMQP_TRANSPORT_AUTHENTICATION_MODE_CBS)
         {
@@ -868,6 +927,11 @@ static int establish_amqp_connection(AMQP_TRANSPORT_INSTANCE* transport_instance
             update_state(transport_instance, AMQP_TRANSPORT_STATE_CONNECTING);
         }
 
+        if (tickcounter_get_current_ms(transport_instance->tick_counter, &transport_instance->connection_start_time) != 0)
+        {
+            LogError("Failure getting the current time, connection establishment time will not be accurate");
+        }
+
         if ((transport_instance->amqp_connection = amqp_connection_create(&amqp_connection_config)) == NULL)
         {
             LogError("Failed establishing connection (failed to create the amqp_connection instance).");
@@ -888,6 +952,7 @@ static void prepare_device_for_connection_retry(AMQP_TRANSPORT_DEVICE_INSTANCE*
     registered_device->subscribed_for_methods = 0;
     registered_device->methods_resubscribe_needed = false;
     registered_device->time_of_last_methods_failure = INDEFINITE_TIME;
+    registered_device->session_handle = NULL; // Destroyed along with the amqp_connection.
 
     if (registered_device->device_state != DEVICE_STATE_STOPPED)
     {
@@ -1102,7 +1167,7 @@ static int IoTHubTransport_AMQP_Common_Device_DoWork(AMQP_TRANSPORT_DEVICE_INSTA
             SESSION_HANDLE session_handle;
             CBS_HANDLE cbs_handle = NULL;
 
-            if (amqp_connection_get_session_handle(registered_device->transport_instance->amqp_connection, &session_handle) != RESULT_OK)
+            if (get_device_session_handle(registered_device, &session_handle) != RESULT_OK)
             {
                 const char* device_id = STRING_c_str(registered_device->device_id); // advoid MU_P_OR_NULL double call
                 LogError("Failed performing DoWork for device '%s' (failed to get the amqp_connection session_handle)", MU_P_OR_NULL(device_id));
@@ -1216,11 +1281,21 @@ static int replicate_device_options_to(AMQP_TRANSPORT_DEVICE_INSTANCE* dev_insta
 
     if (amqp_device_set_option(
         dev_instance->device_handle,
-        DEVICE_OPTION_EVENT_SEND_TIMEOUT_SECS,
-        &dev_instance->transport_instance->option_send_event_timeout_secs) != RESULT_OK)
+        DEVICE_OPTION_EVENT_SEND_TIMEOUT_MS,
+        &dev_instance->transport_instance->option_send_event_timeout_ms) != RESULT_OK)
     {
         const char* device_id = STRING_c_str(dev_instance->device_id); // advoid MU_P_OR_NULL double call
-        LogError("Failed to apply option DEVICE_OPTION_EVENT_SEND_TIMEOUT_SECS to device '%s' (amqp_device_set_option failed)", MU_P_OR_NULL(device_id));
+        LogError("Failed to apply option DEVICE_OPTION_EVENT_SEND_TIMEOUT_MS to device '%s' (amqp_device_set_option failed)", MU_P_OR_NULL(device_id));
+        result = MU_FAILURE;
+    }
+    else if (dev_instance->transport_instance->option_receiver_link_credit > 0 &&
+        amqp_device_set_option(
+            dev_instance->device_handle,
+            DEVICE_OPTION_RECEIVER_LINK_CREDIT,
+            &dev_instance->transport_instance->option_receiver_link_credit) != RESULT_OK)
+    {
+        const char* device_id = STRING_c_str(dev_instance->device_id); // advoid MU_P_OR_NULL double call
+        LogError("Failed to apply option DEVICE_OPTION_RECEIVER_LINK_CREDIT to device '%s' (amqp_device_set_option failed)", MU_P_OR_NULL(device_id));
         result = MU_FAILURE;
     }
     else if (auth_mode == DEVICE_AUTH_MODE_CBS)
@@ -1261,6 +1336,14 @@ static const char* get_device_option_name_from(const char* iothubclient_option_n
     {
         device_option_name = DEVICE_OPTION_EVENT_SEND_TIMEOUT_SECS;
     }
+    else if (strcmp(OPTION_EVENT_SEND_TIMEOUT_MS, iothubclient_option_name) == 0)
+    {
+        device_option_name = DEVICE_OPTION_EVENT_SEND_TIMEOUT_MS;
+    }
+    else if (strcmp(OPTION_AMQP_RECEIVER_LINK_CREDIT, iothubclient_option_name) == 0)
+    {
+        device_option_name = DEVICE_OPTION_RECEIVER_LINK_CREDIT;
+    }
     else
     {
         device_option_name = NULL;
@@ -1345,6 +1428,11 @@ static void internal_destroy_instance(AMQP_TRANSPORT_INSTANCE* instance)
         destroy_underlying_io_transport_options(instance);
         retry_control_destroy(instance->connection_retry_control);
 
+        if (instance->tick_counter != NULL)
+        {
+            tickcounter_destroy(instance->tick_counter);
+        }
+
         STRING_delete(instance->iothub_host_fqdn);
 
         /* SRS_IOTHUBTRANSPORT_AMQP_COMMON_01_043: [ `IoTHubTransport_AMQP_Common_Destroy` shall free the stored proxy options. ]*/
@@ -1393,7 +1481,12 @@ TRANSPORT_LL_HANDLE IoTHubTransport_AMQP_Common_Create(const IOTHUBTRANSPORT_CON
             instance->state = AMQP_TRANSPORT_STATE_NOT_CONNECTED;
             instance->authorization_module = config->auth_module_handle;
 
-            if ((instance->connection_retry_control = retry_control_create(DEFAULT_RETRY_POLICY, DEFAULT_MAX_RETRY_TIME_IN_SECS)) == NULL)
+            if ((instance->tick_counter = tickcounter_create()) == NULL)
+            {
+                LogError("Failed to create the transport tick counter.");
+                result = NULL;
+            }
+            else if ((instance->connection_retry_control = retry_control_create(DEFAULT_RETRY_POLICY, DEFAULT_MAX_RETRY_TIME_IN_SECS, instance->tick_counter)) == NULL)
             {
                 LogError("Failed to create the connection retry control.");
                 result = NULL;
@@ -1413,7 +1506,7 @@ TRANSPORT_LL_HANDLE IoTHubTransport_AMQP_Common_Create(const IOTHUBTRANSPORT_CON
                 instance->underlying_io_transport_provider = get_io_transport;
                 instance->is_trace_on = false;
                 instance->option_cbs_request_timeout_secs = DEFAULT_CBS_REQUEST_TIMEOUT_SECS;
-                instance->option_send_event_timeout_secs = DEFAULT_EVENT_SEND_TIMEOUT_SECS;
+                instance->option_send_event_timeout_ms = DEFAULT_EVENT_SEND_TIMEOUT_SECS * 1000;
                 instance->svc2cl_keep_alive_timeout_secs = DEFAULT_SERVICE_KEEP_ALIVE_FREQ_SECS;
                 instance->cl2svc_keep_alive_send_ratio = DEFAULT_REMOTE_IDLE_PING_RATIO;
 
@@ -1901,6 +1994,34 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_GetSendStatus(IOTHUB_DEVICE_HAN
     return result;
 }
 
+IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_GetLastConnectDuration(TRANSPORT_LL_HANDLE handle, tickcounter_ms_t* connectDuration)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    if (handle == NULL || connectDuration == NULL)
+    {
+        result = IOTHUB_CLIENT_INVALID_ARG;
+        LogError("Failed retrieving the connection establishment time (either handle (%p) or connectDuration (%p) are NULL)", handle, connectDuration);
+    }
+    else
+    {
+        AMQP_TRANSPORT_INSTANCE* transport_instance = (AMQP_TRANSPORT_INSTANCE*)handle;
+
+        if (!transport_instance->has_connected)
+        {
+            LogError("Failed retrieving the connection establishment time (no connection established yet)");
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            *connectDuration = transport_instance->last_connect_duration;
+            result = IOTHUB_CLIENT_OK;
+        }
+    }
+
+    return result;
+}
+
 IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_SetOption(TRANSPORT_LL_HANDLE handle, const char* option, const void* value)
 {
     IOTHUB_CLIENT_RESULT result;
@@ -1914,8 +2035,16 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_SetOption(TRANSPORT_LL_HANDLE h
     {
         AMQP_TRANSPORT_INSTANCE* transport_instance = (AMQP_TRANSPORT_INSTANCE*)handle;
         bool is_device_specific_option;
+        bool is_value_valid = true;
 
-        if (strcmp(OPTION_CBS_REQUEST_TIMEOUT, option) == 0)
+        if (strcmp(OPTION_EVENT_SEND_TIMEOUT_SECS, option) == 0 &&
+            safe_multiply_size_t(*(size_t*)value, 1000) == SIZE_MAX)
+        {
+            LogError("Invalid value for option '%s' (%lu seconds cannot be represented in milliseconds)", option, (unsigned long)*(size_t*)value);
+            is_device_specific_option = false;
+            is_value_valid = false;
+        }
+        else if (strcmp(OPTION_CBS_REQUEST_TIMEOUT, option) == 0)
         {
             is_device_specific_option = true;
             transport_instance->option_cbs_request_timeout_secs = *(size_t*)value;
@@ -1923,14 +2052,28 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_SetOption(TRANSPORT_LL_HANDLE h
         else if (strcmp(OPTION_EVENT_SEND_TIMEOUT_SECS, option) == 0)
         {
             is_device_specific_option = true;
-            transport_instance->option_send_event_timeout_secs = *(size_t*)value;
+            transport_instance->option_send_event_timeout_ms = safe_multiply_size_t(*(size_t*)value, 1000);
+        }
+        else if (strcmp(OPTION_EVENT_SEND_TIMEOUT_MS, option) == 0)
+        {
+            is_device_specific_option = true;
+            transport_instance->option_send_event_timeout_ms = *(size_t*)value;
+        }
+        else if (strcmp(OPTION_AMQP_RECEIVER_LINK_CREDIT, option) == 0)
+        {
+            is_device_specific_option = true;
+            transport_instance->option_receiver_link_credit = *(size_t*)value;
         }
         else
         {
             is_device_specific_option = false;
         }
 
-        if (is_device_specific_option)
+        if (!is_value_valid)
+        {
+            result = IOTHUB_CLIENT_INVALID_ARG;
+        }
+        else if (is_device_specific_option)
         {
             if (IoTHubTransport_AMQP_Common_Device_SetOption(handle, option, (void*)value) != RESULT_OK)
             {
@@ -1966,6 +2109,23 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_SetOption(TRANSPORT_LL_HANDLE h
                 result = IOTHUB_CLIENT_OK;
             }
         }
+        else if (strcmp(OPTION_RETRY_BUDGET_PER_SEC, option) == 0)
+        {
+            if (retry_control_set_global_budget(*(const unsigned int*)value) != 0)
+            {
+                LogError("Failure setting retry budget option");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        else if (strcmp(OPTION_AMQP_MAX_DEVICES_PER_SESSION, option) == 0)
+        {
+            transport_instance->option_max_devices_per_session = *(size_t*)value;
+            result = IOTHUB_CLIENT_OK;
+        }
         else if ((strcmp(OPTION_SERVICE_SIDE_KEEP_ALIVE_FREQ_SECS, option) == 0) || (strcmp(OPTION_C2D_KEEP_ALIVE_FREQ_SECS, option) == 0))
         {
             transport_instance->svc2cl_keep_alive_timeout_secs = *(size_t*)value;
@@ -2183,6 +2343,7 @@ IOTHUB_DEVICE_HANDLE IoTHubTransport_AMQP_Common_Register(TRANSPORT_LL_HANDLE ha
                     device_config.on_state_changed_context = amqp_device_instance;
                     device_config.prod_info_cb = transport_instance->transport_callbacks.prod_info_cb;
                     device_config.prod_info_ctx = transport_instance->transport_ctx;
+                    device_config.tick_counter = device->tick_counter;
 
                     if ((amqp_device_instance->device_handle = amqp_device_create(&device_config)) == NULL)
                     {
@@ -2305,16 +2466,16 @@ int IoTHubTransport_AMQP_Common_SetRetryPolicy(TRANSPORT_LL_HANDLE handle, IOTHU
     }
     else
     {
+        AMQP_TRANSPORT_INSTANCE* transport_instance = (AMQP_TRANSPORT_INSTANCE*)handle;
         RETRY_CONTROL_HANDLE new_retry_control;
 
-        if ((new_retry_control = retry_control_create(retryPolicy, (unsigned int)retryTimeoutLimitInSeconds)) == NULL)
+        if ((new_retry_control = retry_control_create(retryPolicy, (unsigned int)retryTimeoutLimitInSeconds, transport_instance->tick_counter)) == NULL)
         {
             LogError("Cannot set retry policy (retry_control_create failed)");
             result = MU_FAILURE;
         }
         else
         {
-            AMQP_TRANSPORT_INSTANCE* transport_instance = (AMQP_TRANSPORT_INSTANCE*)handle;
             RETRY_CONTROL_HANDLE previous_retry_control = transport_instance->connection_retry_control;
 
             transport_instance->connection_retry_control = new_retry_control;
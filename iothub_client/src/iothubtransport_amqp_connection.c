@@ -21,6 +21,13 @@
 #define SASL_IO_OPTION_LOG_TRACE             "logtrace"
 #define DEFAULT_UNIQUE_ID_LENGTH             40
 
+typedef struct AMQP_SESSION_SLOT_TAG
+{
+    SESSION_HANDLE session_handle;
+    size_t device_count;
+    struct AMQP_SESSION_SLOT_TAG* next;
+} AMQP_SESSION_SLOT;
+
 typedef struct AMQP_CONNECTION_INSTANCE_TAG
 {
     STRING_HANDLE iothub_fqdn;
@@ -38,6 +45,9 @@ typedef struct AMQP_CONNECTION_INSTANCE_TAG
     const void* on_state_changed_context;
     uint32_t svc2cl_keep_alive_timeout_secs;
     double cl2svc_keep_alive_send_ratio;
+    size_t max_devices_per_session;
+    size_t session_device_count;                // Devices attached to session_handle (only tracked if max_devices_per_session > 0).
+    AMQP_SESSION_SLOT* additional_sessions;     // Sessions created once session_handle is full.
 } AMQP_CONNECTION_INSTANCE;
 
 
@@ -211,33 +221,71 @@ static int create_connection_handle(AMQP_CONNECTION_INSTANCE* instance)
     return result;
 }
 
-static int create_session_handle(AMQP_CONNECTION_INSTANCE* instance)
+static SESSION_HANDLE create_configured_session(AMQP_CONNECTION_INSTANCE* instance)
 {
-    int result;
+    SESSION_HANDLE result;
 
-    if ((instance->session_handle = session_create(instance->connection_handle, NULL, NULL)) == NULL)
+    if ((result = session_create(instance->connection_handle, NULL, NULL)) == NULL)
     {
-        result = MU_FAILURE;
-        LogError("Failed creating the AMQP connection (connection_create2 failed)");
+        LogError("Failed creating the AMQP session (session_create failed)");
     }
     else
     {
-        if (session_set_incoming_window(instance->session_handle, (uint32_t)DEFAULT_INCOMING_WINDOW_SIZE) != 0)
+        if (session_set_incoming_window(result, (uint32_t)DEFAULT_INCOMING_WINDOW_SIZE) != 0)
         {
             LogError("Failed to set the AMQP session incoming window size.");
         }
 
-        if (session_set_outgoing_window(instance->session_handle, DEFAULT_OUTGOING_WINDOW_SIZE) != 0)
+        if (session_set_outgoing_window(result, DEFAULT_OUTGOING_WINDOW_SIZE) != 0)
         {
             LogError("Failed to set the AMQP session outgoing window size.");
         }
+    }
+
+    return result;
+}
+
+static int create_session_handle(AMQP_CONNECTION_INSTANCE* instance)
+{
+    int result;
 
+    if ((instance->session_handle = create_configured_session(instance)) == NULL)
+    {
+        result = MU_FAILURE;
+        LogError("Failed creating the AMQP connection (connection_create2 failed)");
+    }
+    else
+    {
         result = RESULT_OK;
     }
 
     return result;
 }
 
+static AMQP_SESSION_SLOT* add_session_slot(AMQP_CONNECTION_INSTANCE* instance)
+{
+    AMQP_SESSION_SLOT* result;
+
+    if ((result = (AMQP_SESSION_SLOT*)malloc(sizeof(AMQP_SESSION_SLOT))) == NULL)
+    {
+        LogError("Failed adding AMQP session (malloc failed)");
+    }
+    else if ((result->session_handle = create_configured_session(instance)) == NULL)
+    {
+        LogError("Failed adding AMQP session (failed creating session)");
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        result->device_count = 0;
+        result->next = instance->additional_sessions;
+        instance->additional_sessions = result;
+    }
+
+    return result;
+}
+
 static int create_cbs_handle(AMQP_CONNECTION_INSTANCE* instance)
 {
     int result;
@@ -274,6 +322,14 @@ void amqp_connection_destroy(AMQP_CONNECTION_HANDLE conn_handle)
             cbs_destroy(instance->cbs_handle);
         }
 
+        while (instance->additional_sessions != NULL)
+        {
+            AMQP_SESSION_SLOT* slot = instance->additional_sessions;
+            instance->additional_sessions = slot->next;
+            session_destroy(slot->session_handle);
+            free(slot);
+        }
+
         if (instance->session_handle != NULL)
         {
             session_destroy(instance->session_handle);
@@ -351,6 +407,7 @@ AMQP_CONNECTION_HANDLE amqp_connection_create(AMQP_CONNECTION_CONFIG* config)
 
                 instance->svc2cl_keep_alive_timeout_secs = (uint32_t)config->svc2cl_keep_alive_timeout_secs;
                 instance->cl2svc_keep_alive_send_ratio = (double)config->cl2svc_keep_alive_send_ratio;
+                instance->max_devices_per_session = config->max_devices_per_session;
 
                 instance->current_state = AMQP_CONNECTION_STATE_CLOSED;
 
@@ -426,6 +483,106 @@ int amqp_connection_get_session_handle(AMQP_CONNECTION_HANDLE conn_handle, SESSI
     return result;
 }
 
+int amqp_connection_acquire_session_handle(AMQP_CONNECTION_HANDLE conn_handle, SESSION_HANDLE* session_handle)
+{
+    int result;
+
+    if (conn_handle == NULL)
+    {
+        result = MU_FAILURE;
+        LogError("amqp_connection_acquire_session_handle failed (conn_handle is NULL)");
+    }
+    else if (session_handle == NULL)
+    {
+        result = MU_FAILURE;
+        LogError("amqp_connection_acquire_session_handle failed (session_handle is NULL)");
+    }
+    else
+    {
+        AMQP_CONNECTION_INSTANCE* instance = (AMQP_CONNECTION_INSTANCE*)conn_handle;
+
+        if (instance->max_devices_per_session == 0)
+        {
+            *session_handle = instance->session_handle;
+            result = RESULT_OK;
+        }
+        else if (instance->session_device_count < instance->max_devices_per_session)
+        {
+            instance->session_device_count++;
+            *session_handle = instance->session_handle;
+            result = RESULT_OK;
+        }
+        else
+        {
+            AMQP_SESSION_SLOT* slot = instance->additional_sessions;
+
+            while (slot != NULL && slot->device_count >= instance->max_devices_per_session)
+            {
+                slot = slot->next;
+            }
+
+            if (slot == NULL && (slot = add_session_slot(instance)) == NULL)
+            {
+                result = MU_FAILURE;
+                LogError("amqp_connection_acquire_session_handle failed (failed adding a new session)");
+            }
+            else
+            {
+                slot->device_count++;
+                *session_handle = slot->session_handle;
+                result = RESULT_OK;
+            }
+        }
+    }
+
+    return result;
+}
+
+void amqp_connection_release_session_handle(AMQP_CONNECTION_HANDLE conn_handle, SESSION_HANDLE session_handle)
+{
+    if (conn_handle == NULL || session_handle == NULL)
+    {
+        LogError("amqp_connection_release_session_handle failed (conn_handle=%p, session_handle=%p)", conn_handle, session_handle);
+    }
+    else
+    {
+        AMQP_CONNECTION_INSTANCE* instance = (AMQP_CONNECTION_INSTANCE*)conn_handle;
+
+        if (instance->max_devices_per_session == 0)
+        {
+            // Nothing to do; all devices share the default session.
+        }
+        else if (session_handle == instance->session_handle)
+        {
+            if (instance->session_device_count > 0)
+            {
+                instance->session_device_count--;
+            }
+        }
+        else
+        {
+            AMQP_SESSION_SLOT** slot_ref = &instance->additional_sessions;
+
+            while (*slot_ref != NULL && (*slot_ref)->session_handle != session_handle)
+            {
+                slot_ref = &(*slot_ref)->next;
+            }
+
+            if (*slot_ref == NULL)
+            {
+                LogError("amqp_connection_release_session_handle failed (session_handle %p does not belong to this connection)", session_handle);
+            }
+            else if (--(*slot_ref)->device_count == 0)
+            {
+                AMQP_SESSION_SLOT* slot = *slot_ref;
+                *slot_ref = slot->next;
+                session_destroy(slot->session_handle);
+                free(slot);
+            }
+        }
+    }
+}
+
 int amqp_connection_get_cbs_handle(AMQP_CONNECTION_HANDLE conn_handle, CBS_HANDLE* cbs_handle)
 {
     int result;
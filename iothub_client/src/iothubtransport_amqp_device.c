@@ -58,7 +58,6 @@ typedef struct DEVICE_INSTANCE_TAG
     DEVICE_TWIN_UPDATE_RECEIVED_CALLBACK on_device_twin_update_received_callback;
     void* on_device_twin_update_received_context;
 
-    TICK_COUNTER_HANDLE tick_counter_handle;
     tickcounter_ms_t last_stop_request_time;
     size_t stop_delay_ms;
 } AMQP_DEVICE_INSTANCE;
@@ -507,6 +506,7 @@ static AMQP_DEVICE_CONFIG* clone_device_config(AMQP_DEVICE_CONFIG *config)
             new_config->module_id = IoTHubClient_Auth_Get_ModuleId(config->authorization_module);
             new_config->prod_info_cb = config->prod_info_cb;
             new_config->prod_info_ctx = config->prod_info_ctx;
+            new_config->tick_counter = config->tick_counter;
             result = RESULT_OK;
         }
 
@@ -554,7 +554,6 @@ static void internal_destroy_device(AMQP_DEVICE_INSTANCE* instance)
             authentication_destroy(instance->authentication_handle);
         }
 
-        tickcounter_destroy(instance->tick_counter_handle);
         destroy_device_config(instance->config);
         free(instance);
     }
@@ -590,6 +589,7 @@ static int create_telemetry_messenger_instance(AMQP_DEVICE_INSTANCE* instance, p
     messenger_config.iothub_host_fqdn = instance->config->iothub_host_fqdn;
     messenger_config.on_state_changed_callback = on_messenger_state_changed_callback;
     messenger_config.on_state_changed_context = instance;
+    messenger_config.tick_counter = instance->config->tick_counter;
 
     if ((instance->messenger_handle = telemetry_messenger_create(&messenger_config, prod_info_cb, prod_info_ctx)) == NULL)
     {
@@ -616,6 +616,7 @@ static int create_twin_messenger(AMQP_DEVICE_INSTANCE* instance)
     twin_msgr_config.iothub_host_fqdn = instance->config->iothub_host_fqdn;
     twin_msgr_config.on_state_changed_callback = on_twin_messenger_state_changed_callback;
     twin_msgr_config.on_state_changed_context = (void*)instance;
+    twin_msgr_config.tick_counter = instance->config->tick_counter;
 
     if ((instance->twin_messenger_handle = twin_messenger_create(&twin_msgr_config)) == NULL)
     {
@@ -708,6 +709,11 @@ AMQP_DEVICE_HANDLE amqp_device_create(AMQP_DEVICE_CONFIG *config)
         LogError("Failed creating the device instance (config->authorization_module is NULL)");
         instance = NULL;
     }
+    else if (config->tick_counter == NULL)
+    {
+        LogError("Failed creating the device instance (config->tick_counter is NULL)");
+        instance = NULL;
+    }
     else if ((instance = (AMQP_DEVICE_INSTANCE*)malloc(sizeof(AMQP_DEVICE_INSTANCE))) == NULL)
     {
         LogError("Failed creating the device instance (malloc failed)");
@@ -723,11 +729,6 @@ AMQP_DEVICE_HANDLE amqp_device_create(AMQP_DEVICE_CONFIG *config)
             LogError("Failed creating the device instance for device '%s' (failed copying the configuration)", config->device_id);
             result = MU_FAILURE;
         }
-        else if ((instance->tick_counter_handle = tickcounter_create()) == NULL)
-        {
-            LogError("Failed creating the internal tick counter for device '%s'", instance->config->device_id);
-            result = MU_FAILURE;
-        }
         else if (instance->config->authentication_mode == DEVICE_AUTH_MODE_CBS &&
                  create_authentication_instance(instance) != RESULT_OK)
         {
@@ -915,7 +916,7 @@ int amqp_device_delayed_stop(AMQP_DEVICE_HANDLE handle, size_t delay_secs)
             LogError("Failed stopping device '%s' (device is already stopped or stopping)", instance->config->device_id);
             result = MU_FAILURE;
         }
-        else if (tickcounter_get_current_ms(instance->tick_counter_handle, &instance->last_stop_request_time) != 0)
+        else if (tickcounter_get_current_ms(instance->config->tick_counter, &instance->last_stop_request_time) != 0)
         {
             LogError("Failed stopping device '%s' (could not get tickcounter time)", instance->config->device_id);
             result = MU_FAILURE;
@@ -946,7 +947,7 @@ void amqp_device_do_work(AMQP_DEVICE_HANDLE handle)
         {
             tickcounter_ms_t current_time_ms;
 
-            if (tickcounter_get_current_ms(instance->tick_counter_handle, &current_time_ms) != 0)
+            if (tickcounter_get_current_ms(instance->config->tick_counter, &current_time_ms) != 0)
             {
                 LogError("Failed stopping device '%s' (could not get tickcounter time)", instance->config->device_id);
                 update_state(instance, DEVICE_STATE_ERROR_MSG);
@@ -1409,6 +1410,30 @@ int amqp_device_set_option(AMQP_DEVICE_HANDLE handle, const char* name, void* va
                 result = RESULT_OK;
             }
         }
+        else if (strcmp(DEVICE_OPTION_EVENT_SEND_TIMEOUT_MS, name) == 0)
+        {
+            if (telemetry_messenger_set_option(instance->messenger_handle, TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_MS, value) != RESULT_OK)
+            {
+                LogError("failed setting option for device '%s' (failed setting messenger option '%s')", instance->config->device_id, name);
+                result = MU_FAILURE;
+            }
+            else
+            {
+                result = RESULT_OK;
+            }
+        }
+        else if (strcmp(DEVICE_OPTION_RECEIVER_LINK_CREDIT, name) == 0)
+        {
+            if (telemetry_messenger_set_option(instance->messenger_handle, TELEMETRY_MESSENGER_OPTION_RECEIVER_LINK_CREDIT, value) != RESULT_OK)
+            {
+                LogError("failed setting option for device '%s' (failed setting messenger option '%s')", instance->config->device_id, name);
+                result = MU_FAILURE;
+            }
+            else
+            {
+                result = RESULT_OK;
+            }
+        }
         else if (strcmp(DEVICE_OPTION_SAVED_AUTH_OPTIONS, name) == 0)
         {
             if (instance->authentication_handle == NULL)
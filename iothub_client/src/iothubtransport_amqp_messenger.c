@@ -135,11 +135,12 @@ static bool is_valid_configuration(const AMQP_MESSENGER_CONFIG* config)
         config->device_id == NULL ||
         config->iothub_host_fqdn == NULL ||
         config->receive_link.source_suffix == NULL ||
-        config->send_link.target_suffix == NULL)
+        config->send_link.target_suffix == NULL ||
+        config->tick_counter == NULL)
     {
-        LogError("Invalid configuration (prod_info_cb=%p, device_id=%p, iothub_host_fqdn=%p, receive_link (source_suffix=%p), send_link (target_suffix=%p))",
+        LogError("Invalid configuration (prod_info_cb=%p, device_id=%p, iothub_host_fqdn=%p, receive_link (source_suffix=%p), send_link (target_suffix=%p), tick_counter=%p)",
             config->prod_info_cb, config->device_id, config->iothub_host_fqdn,
-            config->receive_link.source_suffix, config->send_link.target_suffix);
+            config->receive_link.source_suffix, config->send_link.target_suffix, config->tick_counter);
         result = false;
     }
     else
@@ -282,6 +283,7 @@ static AMQP_MESSENGER_CONFIG* clone_configuration(const AMQP_MESSENGER_CONFIG* c
             result->on_state_changed_context = config->on_state_changed_context;
             result->on_subscription_changed_callback = config->on_subscription_changed_callback;
             result->on_subscription_changed_context = config->on_subscription_changed_context;
+            result->tick_counter = config->tick_counter;
         }
     }
 
@@ -1454,9 +1456,10 @@ AMQP_MESSENGER_HANDLE amqp_messenger_create(const AMQP_MESSENGER_CONFIG* messeng
             {
                 MESSAGE_QUEUE_CONFIG mq_config;
                 mq_config.max_retry_count = DEFAULT_EVENT_SEND_RETRY_LIMIT;
-                mq_config.max_message_enqueued_time_secs = DEFAULT_EVENT_SEND_TIMEOUT_SECS;
-                mq_config.max_message_processing_time_secs = 0;
+                mq_config.max_message_enqueued_time_ms = DEFAULT_EVENT_SEND_TIMEOUT_SECS * 1000;
+                mq_config.max_message_processing_time_ms = 0;
                 mq_config.on_process_message_callback = on_process_message_callback;
+                mq_config.tick_counter = instance->config->tick_counter;
 
                 if ((instance->send_queue = message_queue_create(&mq_config)) == NULL)
                 {
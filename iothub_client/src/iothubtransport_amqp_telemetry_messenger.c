@@ -7,7 +7,7 @@
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/gballoc.h"
-#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/tickcounter.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/uniqueid.h"
 #include "azure_c_shared_utility/singlylinkedlist.h"
@@ -22,7 +22,7 @@
 #include "internal/iothubtransport_amqp_telemetry_messenger.h"
 
 #define RESULT_OK 0
-#define INDEFINITE_TIME ((time_t)(-1))
+#define INDEFINITE_TIME ((tickcounter_ms_t)(-1))
 
 #define IOTHUB_DEVICES_PATH_FMT                         "%s/devices/%s"
 #define IOTHUB_DEVICES_MODULE_PATH_FMT                  "%s/devices/%s/modules/%s"
@@ -37,6 +37,7 @@
 #define DEFAULT_EVENT_SEND_TIMEOUT_SECS                 600
 #define MAX_MESSAGE_SENDER_STATE_CHANGE_TIMEOUT_SECS    300
 #define MAX_MESSAGE_RECEIVER_STATE_CHANGE_TIMEOUT_SECS  300
+#define MILLISECONDS_PER_SECOND                         1000
 #define UNIQUE_ID_BUFFER_SIZE                           37
 #define STRING_NULL_TERMINATOR                          '\0'
 
@@ -73,9 +74,11 @@ typedef struct TELEMETRY_MESSENGER_INSTANCE_TAG
 
     size_t event_send_retry_limit;
     size_t event_send_error_count;
-    size_t event_send_timeout_secs;
-    time_t last_message_sender_state_change_time;
-    time_t last_message_receiver_state_change_time;
+    size_t event_send_timeout_ms;
+    size_t receiver_link_credit;
+    TICK_COUNTER_HANDLE tick_counter;
+    tickcounter_ms_t last_message_sender_state_change_time;
+    tickcounter_ms_t last_message_receiver_state_change_time;
 } TELEMETRY_MESSENGER_INSTANCE;
 
 // MESSENGER_SEND_EVENT_CALLER_INFORMATION corresponds to a message sent from the API, including
@@ -92,19 +95,36 @@ typedef struct MESSENGER_SEND_EVENT_CALLER_INFORMATION_TAG
 typedef struct MESSENGER_SEND_EVENT_TASK_TAG
 {
     SINGLYLINKEDLIST_HANDLE callback_list;  // List of MESSENGER_SEND_EVENT_CALLER_INFORMATION's
-    time_t send_time;
+    tickcounter_ms_t send_time;
     TELEMETRY_MESSENGER_INSTANCE *messenger;
     bool is_timed_out;
 } MESSENGER_SEND_EVENT_TASK;
 
 
 // @brief
-//     Evaluates if the ammount of time since start_time is greater or lesser than timeout_in_secs.
+//     Reads the messenger tick counter.
+// @returns
+//     The current time in milliseconds, or INDEFINITE_TIME if the tick counter could not be read.
+static tickcounter_ms_t get_current_time_ms(TELEMETRY_MESSENGER_INSTANCE* instance)
+{
+    tickcounter_ms_t current_time;
+
+    if (tickcounter_get_current_ms(instance->tick_counter, &current_time) != 0)
+    {
+        LogError("Failed reading the messenger tick counter");
+        current_time = INDEFINITE_TIME;
+    }
+
+    return current_time;
+}
+
+// @brief
+//     Evaluates if the ammount of time since start_time is greater or lesser than timeout_in_ms.
 // @param is_timed_out
 //     Set to 1 if a timeout has been reached, 0 otherwise. Not set if any failure occurs.
 // @returns
 //     0 if no failures occur, non-zero otherwise.
-static int is_timeout_reached(time_t start_time, size_t timeout_in_secs, int *is_timed_out)
+static int is_timeout_reached(TELEMETRY_MESSENGER_INSTANCE* instance, tickcounter_ms_t start_time, size_t timeout_in_ms, int *is_timed_out)
 {
     int result;
 
@@ -115,16 +135,16 @@ static int is_timeout_reached(time_t start_time, size_t timeout_in_secs, int *is
     }
     else
     {
-        time_t current_time;
+        tickcounter_ms_t current_time;
 
-        if ((current_time = get_time(NULL)) == INDEFINITE_TIME)
+        if ((current_time = get_current_time_ms(instance)) == INDEFINITE_TIME)
         {
-            LogError("Failed to verify timeout (get_time failed)");
+            LogError("Failed to verify timeout (tickcounter_get_current_ms failed)");
             result = MU_FAILURE;
         }
         else
         {
-            if (get_difftime(current_time, start_time) >= timeout_in_secs)
+            if (current_time - start_time >= timeout_in_ms)
             {
                 *is_timed_out = 1;
             }
@@ -388,7 +408,7 @@ static void on_event_sender_state_changed_callback(void* context, MESSAGE_SENDER
             TELEMETRY_MESSENGER_INSTANCE* instance = (TELEMETRY_MESSENGER_INSTANCE*)context;
             instance->message_sender_current_state = new_state;
             instance->message_sender_previous_state = previous_state;
-            instance->last_message_sender_state_change_time = get_time(NULL);
+            instance->last_message_sender_state_change_time = get_current_time_ms(instance);
         }
     }
 }
@@ -523,7 +543,7 @@ static void on_message_receiver_state_changed_callback(const void* context, MESS
             TELEMETRY_MESSENGER_INSTANCE* instance = (TELEMETRY_MESSENGER_INSTANCE*)context;
             instance->message_receiver_current_state = new_state;
             instance->message_receiver_previous_state = previous_state;
-            instance->last_message_receiver_state_change_time = get_time(NULL);
+            instance->last_message_receiver_state_change_time = get_current_time_ms(instance);
         }
     }
 }
@@ -700,6 +720,12 @@ static int create_message_receiver(TELEMETRY_MESSENGER_INSTANCE* instance)
             LogError("Failed setting message receiver link max message size.");
         }
 
+        if (instance->receiver_link_credit > 0 &&
+            link_set_max_link_credit(instance->receiver_link, (uint32_t)instance->receiver_link_credit) != RESULT_OK)
+        {
+            LogError("Failed setting message receiver link credit.");
+        }
+
         attach_device_client_type_to_link(instance->receiver_link, instance->prod_info_cb, instance->prod_info_ctx);
 
         if ((instance->message_receiver = messagereceiver_create(instance->receiver_link, on_message_receiver_state_changed_callback, (void*)instance)) == NULL)
@@ -1124,7 +1150,7 @@ static int send_batched_message_and_reset_state(TELEMETRY_MESSENGER_INSTANCE* in
     }
     else
     {
-        send_pending_events_state->task->send_time = get_time(NULL);
+        send_pending_events_state->task->send_time = get_current_time_ms(instance);
         result = RESULT_OK;
     }
 
@@ -1294,7 +1320,7 @@ static int process_event_send_timeouts(TELEMETRY_MESSENGER_INSTANCE* instance)
 {
     int result = RESULT_OK;
 
-    if (instance->event_send_timeout_secs > 0)
+    if (instance->event_send_timeout_ms > 0)
     {
         LIST_ITEM_HANDLE list_item = singlylinkedlist_get_head_item(instance->in_progress_list);
 
@@ -1306,7 +1332,7 @@ static int process_event_send_timeouts(TELEMETRY_MESSENGER_INSTANCE* instance)
             {
                 int is_timed_out;
 
-                if (is_timeout_reached(task->send_time, instance->event_send_timeout_secs, &is_timed_out) == RESULT_OK)
+                if (is_timeout_reached(instance, task->send_time, instance->event_send_timeout_ms, &is_timed_out) == RESULT_OK)
                 {
                     if (is_timed_out)
                     {
@@ -1370,6 +1396,8 @@ static void* telemetry_messenger_clone_option(const char* name, const void* valu
     else
     {
         if (strcmp(TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_SECS, name) == 0 ||
+            strcmp(TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_MS, name) == 0 ||
+            strcmp(TELEMETRY_MESSENGER_OPTION_RECEIVER_LINK_CREDIT, name) == 0 ||
             strcmp(TELEMETRY_MESSENGER_OPTION_SAVED_OPTIONS, name) == 0)
         {
             result = (void*)value;
@@ -1712,7 +1740,7 @@ static void process_state_changes(TELEMETRY_MESSENGER_INSTANCE* instance)
             if (instance->message_receiver_current_state == MESSAGE_RECEIVER_STATE_OPENING)
             {
                 int is_timed_out;
-                if (is_timeout_reached(instance->last_message_receiver_state_change_time, MAX_MESSAGE_RECEIVER_STATE_CHANGE_TIMEOUT_SECS, &is_timed_out) != RESULT_OK)
+                if (is_timeout_reached(instance, instance->last_message_receiver_state_change_time, MAX_MESSAGE_RECEIVER_STATE_CHANGE_TIMEOUT_SECS * MILLISECONDS_PER_SECOND, &is_timed_out) != RESULT_OK)
                 {
                     LogError("messenger got an error (failed to verify messagereceiver start timeout)");
                     update_messenger_state(instance, TELEMETRY_MESSENGER_STATE_ERROR);
@@ -1742,7 +1770,7 @@ static void process_state_changes(TELEMETRY_MESSENGER_INSTANCE* instance)
             else if (instance->message_sender_current_state == MESSAGE_SENDER_STATE_OPENING)
             {
                 int is_timed_out;
-                if (is_timeout_reached(instance->last_message_sender_state_change_time, MAX_MESSAGE_SENDER_STATE_CHANGE_TIMEOUT_SECS, &is_timed_out) != RESULT_OK)
+                if (is_timeout_reached(instance, instance->last_message_sender_state_change_time, MAX_MESSAGE_SENDER_STATE_CHANGE_TIMEOUT_SECS * MILLISECONDS_PER_SECOND, &is_timed_out) != RESULT_OK)
                 {
                     LogError("messenger failed to start (failed to verify messagesender start timeout)");
                     update_messenger_state(instance, TELEMETRY_MESSENGER_STATE_ERROR);
@@ -1902,6 +1930,11 @@ TELEMETRY_MESSENGER_HANDLE telemetry_messenger_create(const TELEMETRY_MESSENGER_
         handle = NULL;
         LogError("telemetry_messenger_create failed (messenger_config->iothub_host_fqdn is NULL)");
     }
+    else if (messenger_config->tick_counter == NULL)
+    {
+        handle = NULL;
+        LogError("telemetry_messenger_create failed (messenger_config->tick_counter is NULL)");
+    }
     else
     {
         TELEMETRY_MESSENGER_INSTANCE* instance;
@@ -1920,7 +1953,7 @@ TELEMETRY_MESSENGER_HANDLE telemetry_messenger_create(const TELEMETRY_MESSENGER_
             instance->message_receiver_current_state = MESSAGE_RECEIVER_STATE_IDLE;
             instance->message_receiver_previous_state = MESSAGE_RECEIVER_STATE_IDLE;
             instance->event_send_retry_limit = DEFAULT_EVENT_SEND_RETRY_LIMIT;
-            instance->event_send_timeout_secs = DEFAULT_EVENT_SEND_TIMEOUT_SECS;
+            instance->event_send_timeout_ms = DEFAULT_EVENT_SEND_TIMEOUT_SECS * MILLISECONDS_PER_SECOND;
             instance->last_message_sender_state_change_time = INDEFINITE_TIME;
             instance->last_message_receiver_state_change_time = INDEFINITE_TIME;
 
@@ -1951,6 +1984,8 @@ TELEMETRY_MESSENGER_HANDLE telemetry_messenger_create(const TELEMETRY_MESSENGER_
             }
             else
             {
+                instance->tick_counter = messenger_config->tick_counter;
+
                 instance->on_state_changed_callback = messenger_config->on_state_changed_callback;
 
                 instance->on_state_changed_context = messenger_config->on_state_changed_context;
@@ -1987,9 +2022,38 @@ int telemetry_messenger_set_option(TELEMETRY_MESSENGER_HANDLE messenger_handle,
 
         if (strcmp(TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_SECS, name) == 0)
         {
-            instance->event_send_timeout_secs = *((size_t*)value);
+            size_t timeout_ms = safe_multiply_size_t(*((size_t*)value), MILLISECONDS_PER_SECOND);
+
+            if (timeout_ms == SIZE_MAX)
+            {
+                LogError("telemetry_messenger_set_option failed (value of option '%s' is too large)", name);
+                result = MU_FAILURE;
+            }
+            else
+            {
+                instance->event_send_timeout_ms = timeout_ms;
+                result = RESULT_OK;
+            }
+        }
+        else if (strcmp(TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_MS, name) == 0)
+        {
+            instance->event_send_timeout_ms = *((size_t*)value);
             result = RESULT_OK;
         }
+        else if (strcmp(TELEMETRY_MESSENGER_OPTION_RECEIVER_LINK_CREDIT, name) == 0)
+        {
+            if (*((size_t*)value) > UINT32_MAX)
+            {
+                LogError("telemetry_messenger_set_option failed (value of option '%s' exceeds the maximum link credit)", name);
+                result = MU_FAILURE;
+            }
+            else
+            {
+                // Applied when the message receiver link is (re)created.
+                instance->receiver_link_credit = *((size_t*)value);
+                result = RESULT_OK;
+            }
+        }
         else if (strcmp(TELEMETRY_MESSENGER_OPTION_SAVED_OPTIONS, name) == 0)
         {
             if (OptionHandler_FeedOptions((OPTIONHANDLER_HANDLE)value, messenger_handle) != OPTIONHANDLER_OK)
@@ -2034,9 +2098,15 @@ OPTIONHANDLER_HANDLE telemetry_messenger_retrieve_options(TELEMETRY_MESSENGER_HA
         {
             TELEMETRY_MESSENGER_INSTANCE* instance = (TELEMETRY_MESSENGER_INSTANCE*)messenger_handle;
 
-            if (OptionHandler_AddOption(options, TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_SECS, (void*)&instance->event_send_timeout_secs) != OPTIONHANDLER_OK)
+            if (OptionHandler_AddOption(options, TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_MS, (void*)&instance->event_send_timeout_ms) != OPTIONHANDLER_OK)
+            {
+                LogError("Failed to retrieve options from messenger instance (OptionHandler_Create failed for option '%s')", TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_MS);
+                result = NULL;
+            }
+            else if (instance->receiver_link_credit > 0 &&
+                OptionHandler_AddOption(options, TELEMETRY_MESSENGER_OPTION_RECEIVER_LINK_CREDIT, (void*)&instance->receiver_link_credit) != OPTIONHANDLER_OK)
             {
-                LogError("Failed to retrieve options from messenger instance (OptionHandler_Create failed for option '%s')", TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_SECS);
+                LogError("Failed to retrieve options from messenger instance (OptionHandler_Create failed for option '%s')", TELEMETRY_MESSENGER_OPTION_RECEIVER_LINK_CREDIT);
                 result = NULL;
             }
             else
@@ -11,6 +11,7 @@
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/uniqueid.h"
 #include "azure_c_shared_utility/singlylinkedlist.h"
+#include "azure_c_shared_utility/doublylinkedlist.h"
 #include "azure_c_shared_utility/safe_math.h"
 #include "azure_uamqp_c/amqp_definitions_fields.h"
 #include "azure_uamqp_c/messaging.h"
@@ -32,6 +33,10 @@ MU_DEFINE_ENUM_STRINGS_WITHOUT_INVALID(TWIN_UPDATE_TYPE, TWIN_UPDATE_TYPE_VALUES
 
 #define UNIQUE_ID_BUFFER_SIZE                           37
 
+// Operation correlation-ids are the hexadecimal representation of a per-messenger 64-bit counter.
+#define TWIN_OPERATION_CORRELATION_ID_BUFFER_SIZE       17
+#define TWIN_OPERATION_INDEX_INITIAL_BUCKET_COUNT       16
+
 #define EMPTY_TWIN_BODY_DATA                            ((const unsigned char*)" ")
 #define EMPTY_TWIN_BODY_SIZE                            1
 
@@ -99,7 +104,15 @@ typedef struct TWIN_MESSENGER_INSTANCE_TAG
     TWIN_MESSENGER_STATE state;
 
     SINGLYLINKEDLIST_HANDLE pending_patches;
-    SINGLYLINKEDLIST_HANDLE operations;
+
+    // In-flight operations, in the order they were sent. Since all operations share the same timeout
+    // this is also the order in which they expire.
+    DLIST_ENTRY operations;
+    // Index of the in-flight operations by correlation-id (chained hash buckets).
+    DLIST_ENTRY* operations_index;
+    size_t operations_index_bucket_count;
+    size_t operations_count;
+    uint64_t next_operation_correlation_id;
 
     TWIN_MESSENGER_STATE_CHANGED_CALLBACK on_state_changed_callback;
     void* on_state_changed_context;
@@ -124,9 +137,11 @@ typedef struct TWIN_PATCH_OPERATION_CONTEXT_TAG
 
 typedef struct TWIN_OPERATION_CONTEXT_TAG
 {
+    DLIST_ENTRY entry;
+    DLIST_ENTRY index_entry;
     TWIN_OPERATION_TYPE type;
     TWIN_MESSENGER_INSTANCE* msgr;
-    char* correlation_id;
+    char correlation_id[TWIN_OPERATION_CORRELATION_ID_BUFFER_SIZE];
     union {
         struct REPORTED_PROPERTIES_TAG
         {
@@ -395,6 +410,101 @@ static char* generate_twin_correlation_id(void)
     return result;
 }
 
+static void format_twin_operation_correlation_id(uint64_t value, char* buffer)
+{
+    static const char hex_digits[] = "0123456789abcdef";
+    char digits[TWIN_OPERATION_CORRELATION_ID_BUFFER_SIZE - 1];
+    size_t digit_count = 0;
+    size_t i;
+
+    do
+    {
+        digits[digit_count++] = hex_digits[value & 0xF];
+        value >>= 4;
+    } while (value != 0);
+
+    for (i = 0; i < digit_count; i++)
+    {
+        buffer[i] = digits[digit_count - i - 1];
+    }
+
+    buffer[digit_count] = '\0';
+}
+
+static size_t get_twin_operation_index_bucket(TWIN_MESSENGER_INSTANCE* twin_msgr, const char* correlation_id)
+{
+    // FNV-1a; bucket count is always a power of two.
+    uint32_t hash = 2166136261u;
+
+    while (*correlation_id != '\0')
+    {
+        hash ^= (unsigned char)(*correlation_id);
+        hash *= 16777619u;
+        correlation_id++;
+    }
+
+    return (size_t)hash & (twin_msgr->operations_index_bucket_count - 1);
+}
+
+static DLIST_ENTRY* create_twin_operation_index(size_t bucket_count)
+{
+    DLIST_ENTRY* result;
+    size_t malloc_size = safe_multiply_size_t(sizeof(DLIST_ENTRY), bucket_count);
+
+    if (malloc_size == SIZE_MAX ||
+        (result = (DLIST_ENTRY*)malloc(malloc_size)) == NULL)
+    {
+        LogError("Failed allocating TWIN operations index, size:%zu", malloc_size);
+        result = NULL;
+    }
+    else
+    {
+        size_t i;
+
+        for (i = 0; i < bucket_count; i++)
+        {
+            DList_InitializeListHead(&result[i]);
+        }
+    }
+
+    return result;
+}
+
+static int grow_twin_operation_index(TWIN_MESSENGER_INSTANCE* twin_msgr)
+{
+    int result;
+    size_t new_bucket_count = safe_multiply_size_t(twin_msgr->operations_index_bucket_count, 2);
+    DLIST_ENTRY* new_index;
+
+    if (new_bucket_count == SIZE_MAX ||
+        (new_index = create_twin_operation_index(new_bucket_count)) == NULL)
+    {
+        LogError("Failed growing TWIN operations index (%s)", twin_msgr->device_id);
+        result = MU_FAILURE;
+    }
+    else
+    {
+        PDLIST_ENTRY list_entry = twin_msgr->operations.Flink;
+
+        free(twin_msgr->operations_index);
+        twin_msgr->operations_index = new_index;
+        twin_msgr->operations_index_bucket_count = new_bucket_count;
+
+        while (list_entry != &twin_msgr->operations)
+        {
+            TWIN_OPERATION_CONTEXT* twin_op_ctx = containingRecord(list_entry, TWIN_OPERATION_CONTEXT, entry);
+            size_t bucket = get_twin_operation_index_bucket(twin_msgr, twin_op_ctx->correlation_id);
+
+            DList_InsertTailList(&twin_msgr->operations_index[bucket], &twin_op_ctx->index_entry);
+            list_entry = list_entry->Flink;
+        }
+
+        result = RESULT_OK;
+    }
+
+    return result;
+}
+
 static TWIN_OPERATION_CONTEXT* create_twin_operation_context(TWIN_MESSENGER_INSTANCE* twin_msgr, TWIN_OPERATION_TYPE type)
 {
     TWIN_OPERATION_CONTEXT* result;
@@ -407,78 +517,97 @@ static TWIN_OPERATION_CONTEXT* create_twin_operation_context(TWIN_MESSENGER_INST
     {
         memset(result, 0, sizeof(TWIN_OPERATION_CONTEXT));
 
-        if ((result->correlation_id = generate_unique_id()) == NULL)
-        {
-            LogError("Failed setting context correlation-id (%s, %s)", MU_ENUM_TO_STRING(TWIN_OPERATION_TYPE, type), twin_msgr->device_id);
-            free(result);
-            result = NULL;
-        }
-        else
-        {
-            result->type = type;
-            result->msgr = twin_msgr;
-        }
+        DList_InitializeListHead(&result->entry);
+        DList_InitializeListHead(&result->index_entry);
+        format_twin_operation_correlation_id(twin_msgr->next_operation_correlation_id++, result->correlation_id);
+        result->type = type;
+        result->msgr = twin_msgr;
     }
 
     return result;
 }
 
-static bool find_twin_operation_by_correlation_id(LIST_ITEM_HANDLE list_item, const void* match_context)
+static TWIN_OPERATION_CONTEXT* find_twin_operation_by_correlation_id(TWIN_MESSENGER_INSTANCE* twin_msgr, const char* correlation_id)
 {
-    TWIN_OPERATION_CONTEXT* twin_op_ctx = (TWIN_OPERATION_CONTEXT*)singlylinkedlist_item_get_value(list_item);
-    return (twin_op_ctx == NULL) ? false : (strcmp(twin_op_ctx->correlation_id, (const char*)match_context) == 0);
+    TWIN_OPERATION_CONTEXT* result = NULL;
+    PDLIST_ENTRY bucket = &twin_msgr->operations_index[get_twin_operation_index_bucket(twin_msgr, correlation_id)];
+    PDLIST_ENTRY list_entry = bucket->Flink;
+
+    while (list_entry != bucket)
+    {
+        TWIN_OPERATION_CONTEXT* twin_op_ctx = containingRecord(list_entry, TWIN_OPERATION_CONTEXT, index_entry);
+
+        if (strcmp(twin_op_ctx->correlation_id, correlation_id) == 0)
+        {
+            result = twin_op_ctx;
+            break;
+        }
+
+        list_entry = list_entry->Flink;
+    }
+
+    return result;
 }
 
-static bool find_twin_operation_by_type(LIST_ITEM_HANDLE list_item, const void* match_context)
+static bool has_twin_operation_of_type(TWIN_MESSENGER_INSTANCE* twin_msgr, TWIN_OPERATION_TYPE type)
 {
-    TWIN_OPERATION_CONTEXT* twin_op_ctx = (TWIN_OPERATION_CONTEXT*)singlylinkedlist_item_get_value(list_item);
-    return (twin_op_ctx == NULL) ? false : (twin_op_ctx->type == *(TWIN_OPERATION_TYPE*)match_context);
+    bool result = false;
+    PDLIST_ENTRY list_entry = twin_msgr->operations.Flink;
+
+    while (list_entry != &twin_msgr->operations)
+    {
+        if (containingRecord(list_entry, TWIN_OPERATION_CONTEXT, entry)->type == type)
+        {
+            result = true;
+            break;
+        }
+
+        list_entry = list_entry->Flink;
+    }
+
+    return result;
 }
 
 static void destroy_twin_operation_context(TWIN_OPERATION_CONTEXT* op_ctx)
 {
-    free(op_ctx->correlation_id);
     free(op_ctx);
 }
 
 static int add_twin_operation_context_to_queue(TWIN_OPERATION_CONTEXT* twin_op_ctx)
 {
     int result;
+    TWIN_MESSENGER_INSTANCE* twin_msgr = twin_op_ctx->msgr;
 
-    if (singlylinkedlist_add(twin_op_ctx->msgr->operations, (const void*)twin_op_ctx) == NULL)
+    if (twin_msgr->operations_count >= twin_msgr->operations_index_bucket_count &&
+        grow_twin_operation_index(twin_msgr) != RESULT_OK)
     {
         LogError("Failed adding TWIN operation context to queue (%s, %s)", MU_ENUM_TO_STRING(TWIN_OPERATION_TYPE, twin_op_ctx->type), twin_op_ctx->correlation_id);
         result = MU_FAILURE;
     }
     else
     {
+        size_t bucket = get_twin_operation_index_bucket(twin_msgr, twin_op_ctx->correlation_id);
+
+        DList_InsertTailList(&twin_msgr->operations, &twin_op_ctx->entry);
+        DList_InsertTailList(&twin_msgr->operations_index[bucket], &twin_op_ctx->index_entry);
+        twin_msgr->operations_count++;
         result = RESULT_OK;
     }
 
     return result;
 }
 
-static int remove_twin_operation_context_from_queue(TWIN_OPERATION_CONTEXT* twin_op_ctx)
+static void remove_twin_operation_context_from_queue(TWIN_OPERATION_CONTEXT* twin_op_ctx)
 {
-    int result;
-    LIST_ITEM_HANDLE list_item;
-
-    if ((list_item = singlylinkedlist_find(twin_op_ctx->msgr->operations, find_twin_operation_by_correlation_id, (const void*)twin_op_ctx->correlation_id)) == NULL)
-    {
-        result = RESULT_OK;
-    }
-    else if (singlylinkedlist_remove(twin_op_ctx->msgr->operations, list_item) != 0)
-    {
-        LogError("Failed removing TWIN operation context from queue (%s, %s, %s)",
-            twin_op_ctx->msgr->device_id, MU_ENUM_TO_STRING(TWIN_OPERATION_TYPE, twin_op_ctx->type), twin_op_ctx->correlation_id);
-        result = MU_FAILURE;
-    }
-    else
+    // Entries not in the queue are self-linked (see create_twin_operation_context).
+    if (!DList_IsListEmpty(&twin_op_ctx->entry))
     {
-        result = RESULT_OK;
+        (void)DList_RemoveEntryList(&twin_op_ctx->entry);
+        (void)DList_RemoveEntryList(&twin_op_ctx->index_entry);
+        DList_InitializeListHead(&twin_op_ctx->entry);
+        DList_InitializeListHead(&twin_op_ctx->index_entry);
+        twin_op_ctx->msgr->operations_count--;
     }
-
-    return result;
 }
 
 
@@ -935,14 +1064,8 @@ static void on_amqp_send_complete_callback(AMQP_MESSENGER_SEND_RESULT result, AM
                 }
             }
 
-            if (remove_twin_operation_context_from_queue(twin_op_ctx) != RESULT_OK)
-            {
-                update_state(twin_op_ctx->msgr, TWIN_MESSENGER_STATE_ERROR);
-            }
-            else
-            {
-                destroy_twin_operation_context(twin_op_ctx);
-            }
+            remove_twin_operation_context_from_queue(twin_op_ctx);
+            destroy_twin_operation_context(twin_op_ctx);
         }
     }
 }
@@ -1021,74 +1144,51 @@ static bool remove_expired_twin_patch_request(const void* item, const void* matc
     return remove_item;
 }
 
-static bool remove_expired_twin_operation_request(const void* item, const void* match_context, bool* continue_processing)
+static void expire_twin_operation_request(TWIN_OPERATION_CONTEXT* twin_op_ctx)
 {
-    bool result;
+    TWIN_MESSENGER_INSTANCE* twin_msgr = twin_op_ctx->msgr;
 
-    if (item == NULL || match_context == NULL || continue_processing == NULL)
+    LogError("Twin operation timed out (%s, %s, %s)", twin_msgr->device_id, MU_ENUM_TO_STRING(TWIN_OPERATION_TYPE, twin_op_ctx->type), twin_op_ctx->correlation_id);
+
+    remove_twin_operation_context_from_queue(twin_op_ctx);
+
+    if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PATCH)
     {
-        LogError("Invalid argument (item=%p, match_context=%p, continue_processing=%p)", item, match_context, continue_processing);
-        result = false;
+        if (twin_op_ctx->cb.reported_properties.callback != NULL)
+        {
+            twin_op_ctx->cb.reported_properties.callback(TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_TIMEOUT, 0, twin_op_ctx->cb.reported_properties.context);
+        }
     }
-    else
+    else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_GET)
     {
-        TWIN_OPERATION_CONTEXT* twin_op_ctx = (TWIN_OPERATION_CONTEXT*)item;
-        TWIN_MESSENGER_INSTANCE* twin_msgr = twin_op_ctx->msgr;
-        time_t current_time = *(time_t*)match_context;
-
-        if (get_difftime(current_time, twin_op_ctx->time_sent) < DEFAULT_TWIN_OPERATION_TIMEOUT_SECS)
+        if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_GETTING_COMPLETE_PROPERTIES)
         {
-            result = false;
-            // All next elements in the list have a later time_sent, so they won't be expired, and don't need to be removed.
-            *continue_processing = false;
+            twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_GET_COMPLETE_PROPERTIES;
+            twin_msgr->subscription_error_count++;
         }
-        else
+    }
+    else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PUT)
+    {
+        if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_SUBSCRIBING)
         {
-            LogError("Twin operation timed out (%s, %s, %s)", twin_msgr->device_id, MU_ENUM_TO_STRING(TWIN_OPERATION_TYPE, twin_op_ctx->type), twin_op_ctx->correlation_id);
-            result = true;
-            *continue_processing = true;
-
-            if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PATCH)
-            {
-                if (twin_op_ctx->cb.reported_properties.callback != NULL)
-                {
-                    twin_op_ctx->cb.reported_properties.callback(TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_TIMEOUT, 0, twin_op_ctx->cb.reported_properties.context);
-                }
-            }
-            else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_GET)
-            {
-                if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_GETTING_COMPLETE_PROPERTIES)
-                {
-                    twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_GET_COMPLETE_PROPERTIES;
-                    twin_msgr->subscription_error_count++;
-                }
-            }
-            else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PUT)
-            {
-                if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_SUBSCRIBING)
-                {
-                    twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_SUBSCRIBE_FOR_UPDATES;
-                    twin_msgr->subscription_error_count++;
-                }
-            }
-            else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_DELETE)
-            {
-                if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_UNSUBSCRIBING)
-                {
-                    twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_UNSUBSCRIBE;
-                    twin_msgr->subscription_error_count++;
-                }
-            }
-            else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_GET_ON_DEMAND)
-            {
-                twin_op_ctx->cb.get_twin.callback(TWIN_UPDATE_TYPE_COMPLETE, NULL, 0, twin_op_ctx->cb.get_twin.context);
-            }
-
-            destroy_twin_operation_context(twin_op_ctx);
+            twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_SUBSCRIBE_FOR_UPDATES;
+            twin_msgr->subscription_error_count++;
+        }
+    }
+    else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_DELETE)
+    {
+        if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_UNSUBSCRIBING)
+        {
+            twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_UNSUBSCRIBE;
+            twin_msgr->subscription_error_count++;
         }
     }
+    else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_GET_ON_DEMAND)
+    {
+        twin_op_ctx->cb.get_twin.callback(TWIN_UPDATE_TYPE_COMPLETE, NULL, 0, twin_op_ctx->cb.get_twin.context);
+    }
 
-    return result;
+    destroy_twin_operation_context(twin_op_ctx);
 }
 
 static void process_timeouts(TWIN_MESSENGER_INSTANCE* twin_msgr)
@@ -1103,7 +1203,21 @@ static void process_timeouts(TWIN_MESSENGER_INSTANCE* twin_msgr)
     else
     {
         (void)singlylinkedlist_remove_if(twin_msgr->pending_patches, remove_expired_twin_patch_request, (const void*)&current_time);
-        (void)singlylinkedlist_remove_if(twin_msgr->operations, remove_expired_twin_operation_request, (const void*)&current_time);
+        PDLIST_ENTRY list_entry = twin_msgr->operations.Flink;
+
+        while (list_entry != &twin_msgr->operations)
+        {
+            TWIN_OPERATION_CONTEXT* twin_op_ctx = containingRecord(list_entry, TWIN_OPERATION_CONTEXT, entry);
+
+            if (get_difftime(current_time, twin_op_ctx->time_sent) < DEFAULT_TWIN_OPERATION_TIMEOUT_SECS)
+            {
+                // All next operations were sent later, so they won't be expired either.
+                break;
+            }
+
+            list_entry = list_entry->Flink;
+            expire_twin_operation_request(twin_op_ctx);
+        }
     }
 }
 
@@ -1156,7 +1270,7 @@ static bool send_pending_twin_patch(const void* item, const void* match_context,
                     twin_patch_ctx->on_report_state_complete_callback(TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_FAIL_SENDING, 0, twin_patch_ctx->on_report_state_complete_context);
                 }
 
-                (void)remove_twin_operation_context_from_queue(twin_op_ctx);
+                remove_twin_operation_context_from_queue(twin_op_ctx);
                 destroy_twin_operation_context(twin_op_ctx);
             }
         }
@@ -1220,7 +1334,7 @@ static void process_twin_subscription(TWIN_MESSENGER_INSTANCE* twin_msgr)
                 {
                     LogError("Failed sending TWIN request (%s, %s)", twin_msgr->device_id, MU_ENUM_TO_STRING(TWIN_OPERATION_TYPE, op_type));
 
-                    (void)remove_twin_operation_context_from_queue(twin_op_ctx);
+                    remove_twin_operation_context_from_queue(twin_op_ctx);
                     destroy_twin_operation_context(twin_op_ctx);
                     update_state(twin_msgr, TWIN_MESSENGER_STATE_ERROR);
                 }
@@ -1233,19 +1347,13 @@ static void process_twin_subscription(TWIN_MESSENGER_INSTANCE* twin_msgr)
     }
 }
 
-static bool cancel_all_pending_twin_operations(const void* item, const void* match_context, bool* continue_processing)
+static void cancel_all_pending_twin_operations(TWIN_MESSENGER_INSTANCE* twin_msgr)
 {
-    bool result;
+    PDLIST_ENTRY list_entry;
 
-    if (item == NULL || continue_processing == NULL)
-    {
-        LogError("Invalid argument (item=%p, continue_processing=%p)", item, continue_processing);
-        result = false;
-    }
-    else
+    while ((list_entry = DList_RemoveHeadList(&twin_msgr->operations)) != &twin_msgr->operations)
     {
-        TWIN_OPERATION_CONTEXT* twin_op_ctx = (TWIN_OPERATION_CONTEXT*)item;
-        (void)match_context;
+        TWIN_OPERATION_CONTEXT* twin_op_ctx = containingRecord(list_entry, TWIN_OPERATION_CONTEXT, entry);
 
         if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PATCH)
         {
@@ -1256,12 +1364,9 @@ static bool cancel_all_pending_twin_operations(const void* item, const void* mat
         }
 
         destroy_twin_operation_context(twin_op_ctx);
-
-        *continue_processing = true;
-        result = true;
     }
 
-    return result;
+    twin_msgr->operations_count = 0;
 }
 
 static bool cancel_pending_twin_patch_operation(const void* item, const void* match_context, bool* continue_processing)
@@ -1311,10 +1416,10 @@ static void internal_twin_messenger_destroy(TWIN_MESSENGER_INSTANCE* twin_msgr)
         singlylinkedlist_destroy(twin_msgr->pending_patches);
     }
 
-    if (twin_msgr->operations != NULL)
+    if (twin_msgr->operations_index != NULL)
     {
-        singlylinkedlist_remove_if(twin_msgr->operations, cancel_all_pending_twin_operations, (const void*)twin_msgr);
-        singlylinkedlist_destroy(twin_msgr->operations);
+        cancel_all_pending_twin_operations(twin_msgr);
+        free(twin_msgr->operations_index);
     }
 
     if (twin_msgr->device_id != NULL)
@@ -1376,169 +1481,155 @@ static AMQP_MESSENGER_DISPOSITION_RESULT on_amqp_message_received_callback(MESSA
             {
                 // It is supposed to be a request sent previously (reported properties PATCH, GET, PUT or DELETE).
 
-                LIST_ITEM_HANDLE list_item;
-                if ((list_item = singlylinkedlist_find(twin_msgr->operations, find_twin_operation_by_correlation_id, (const void*)correlation_id)) == NULL)
+                TWIN_OPERATION_CONTEXT* twin_op_ctx;
+
+                if ((twin_op_ctx = find_twin_operation_by_correlation_id(twin_msgr, correlation_id)) == NULL)
                 {
                     LogError("Could not find context of TWIN incoming message (%s, %s)", twin_msgr->device_id, correlation_id);
                 }
                 else
                 {
-                    TWIN_OPERATION_CONTEXT* twin_op_ctx;
+                    remove_twin_operation_context_from_queue(twin_op_ctx);
 
-                    if ((twin_op_ctx = (TWIN_OPERATION_CONTEXT*)singlylinkedlist_item_get_value(list_item)) == NULL)
+                    if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PATCH)
                     {
-                        LogError("Could not get context for incoming TWIN message (%s, %s)", twin_msgr->device_id, correlation_id);
-                    }
-                    else
-                    {
-                        if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PATCH)
+                        if (!has_status_code)
                         {
-                            if (!has_status_code)
-                            {
-                                LogError("Received an incoming TWIN message for a PATCH operation, but with no status code (%s, %s)", twin_msgr->device_id, correlation_id);
+                            LogError("Received an incoming TWIN message for a PATCH operation, but with no status code (%s, %s)", twin_msgr->device_id, correlation_id);
 
-                                disposition_result = AMQP_MESSENGER_DISPOSITION_RESULT_REJECTED;
+                            disposition_result = AMQP_MESSENGER_DISPOSITION_RESULT_REJECTED;
 
-                                if (twin_op_ctx->cb.reported_properties.callback != NULL)
-                                {
-                                    twin_op_ctx->cb.reported_properties.callback(TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_INVALID_RESPONSE, 0, twin_op_ctx->cb.reported_properties.context);
-                                }
-                            }
-                            else
+                            if (twin_op_ctx->cb.reported_properties.callback != NULL)
                             {
-                                if (twin_op_ctx->cb.reported_properties.callback != NULL)
-                                {
-                                    twin_op_ctx->cb.reported_properties.callback(TWIN_REPORT_STATE_RESULT_SUCCESS, TWIN_REPORT_STATE_REASON_NONE, status_code, twin_op_ctx->cb.reported_properties.context);
-                                }
+                                twin_op_ctx->cb.reported_properties.callback(TWIN_REPORT_STATE_RESULT_ERROR, TWIN_REPORT_STATE_REASON_INVALID_RESPONSE, 0, twin_op_ctx->cb.reported_properties.context);
                             }
                         }
-                        else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_GET)
+                        else
                         {
-                            if (!has_twin_report)
+                            if (twin_op_ctx->cb.reported_properties.callback != NULL)
                             {
-                                LogError("Received an incoming TWIN message for a GET operation, but with no report (%s, %s)", twin_msgr->device_id, correlation_id);
-
-                                disposition_result = AMQP_MESSENGER_DISPOSITION_RESULT_REJECTED;
+                                twin_op_ctx->cb.reported_properties.callback(TWIN_REPORT_STATE_RESULT_SUCCESS, TWIN_REPORT_STATE_REASON_NONE, status_code, twin_op_ctx->cb.reported_properties.context);
+                            }
+                        }
+                    }
+                    else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_GET)
+                    {
+                        if (!has_twin_report)
+                        {
+                            LogError("Received an incoming TWIN message for a GET operation, but with no report (%s, %s)", twin_msgr->device_id, correlation_id);
 
-                                if (twin_op_ctx->msgr->on_message_received_callback != NULL)
-                                {
-                                    twin_op_ctx->msgr->on_message_received_callback(TWIN_UPDATE_TYPE_COMPLETE, NULL, 0, twin_op_ctx->msgr->on_message_received_context);
-                                }
+                            disposition_result = AMQP_MESSENGER_DISPOSITION_RESULT_REJECTED;
 
-                                if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_GETTING_COMPLETE_PROPERTIES)
-                                {
-                                    twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_GET_COMPLETE_PROPERTIES;
-                                    twin_msgr->subscription_error_count++;
-                                }
-                            }
-                            else
+                            if (twin_op_ctx->msgr->on_message_received_callback != NULL)
                             {
-                                if (twin_op_ctx->msgr->on_message_received_callback != NULL)
-                                {
-                                    twin_op_ctx->msgr->on_message_received_callback(TWIN_UPDATE_TYPE_COMPLETE, (const char*)twin_report.bytes, twin_report.length, twin_op_ctx->msgr->on_message_received_context);
-                                }
+                                twin_op_ctx->msgr->on_message_received_callback(TWIN_UPDATE_TYPE_COMPLETE, NULL, 0, twin_op_ctx->msgr->on_message_received_context);
+                            }
 
-                                if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_GETTING_COMPLETE_PROPERTIES)
-                                {
-                                    twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_SUBSCRIBE_FOR_UPDATES;
-                                    twin_msgr->subscription_error_count = 0;
-                                }
+                            if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_GETTING_COMPLETE_PROPERTIES)
+                            {
+                                twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_GET_COMPLETE_PROPERTIES;
+                                twin_msgr->subscription_error_count++;
                             }
                         }
-                        else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_GET_ON_DEMAND)
+                        else
                         {
-                            if (!has_twin_report)
+                            if (twin_op_ctx->msgr->on_message_received_callback != NULL)
                             {
-                                LogError("Received an incoming TWIN message for a GET operation, but with no report (%s, %s)", twin_msgr->device_id, correlation_id);
-
-                                disposition_result = AMQP_MESSENGER_DISPOSITION_RESULT_REJECTED;
-
-                                twin_op_ctx->cb.get_twin.callback(TWIN_UPDATE_TYPE_COMPLETE, NULL, 0, twin_op_ctx->cb.get_twin.context);
+                                twin_op_ctx->msgr->on_message_received_callback(TWIN_UPDATE_TYPE_COMPLETE, (const char*)twin_report.bytes, twin_report.length, twin_op_ctx->msgr->on_message_received_context);
                             }
-                            else
+
+                            if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_GETTING_COMPLETE_PROPERTIES)
                             {
-                                twin_op_ctx->cb.get_twin.callback(TWIN_UPDATE_TYPE_COMPLETE, (const char*)twin_report.bytes, twin_report.length, twin_op_ctx->cb.get_twin.context);
+                                twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_SUBSCRIBE_FOR_UPDATES;
+                                twin_msgr->subscription_error_count = 0;
                             }
                         }
-                        else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PUT)
+                    }
+                    else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_GET_ON_DEMAND)
+                    {
+                        if (!has_twin_report)
+                        {
+                            LogError("Received an incoming TWIN message for a GET operation, but with no report (%s, %s)", twin_msgr->device_id, correlation_id);
+
+                            disposition_result = AMQP_MESSENGER_DISPOSITION_RESULT_REJECTED;
+
+                            twin_op_ctx->cb.get_twin.callback(TWIN_UPDATE_TYPE_COMPLETE, NULL, 0, twin_op_ctx->cb.get_twin.context);
+                        }
+                        else
                         {
-                            if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_SUBSCRIBED)
+                            twin_op_ctx->cb.get_twin.callback(TWIN_UPDATE_TYPE_COMPLETE, (const char*)twin_report.bytes, twin_report.length, twin_op_ctx->cb.get_twin.context);
+                        }
+                    }
+                    else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_PUT)
+                    {
+                        if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_SUBSCRIBED)
+                        {
+                            bool subscription_succeeded = true;
+
+                            if (!has_status_code)
                             {
-                                bool subscription_succeeded = true;
+                                LogError("Received an incoming TWIN message for a PUT operation, but with no status code (%s, %s)", twin_msgr->device_id, correlation_id);
 
-                                if (!has_status_code)
-                                {
-                                    LogError("Received an incoming TWIN message for a PUT operation, but with no status code (%s, %s)", twin_msgr->device_id, correlation_id);
+                                subscription_succeeded = false;
+                            }
+                            else if (status_code < 200 || status_code >= 300)
+                            {
+                                LogError("Received status code %d for TWIN subscription request (%s, %s)", status_code, twin_msgr->device_id, correlation_id);
 
-                                    subscription_succeeded = false;
-                                }
-                                else if (status_code < 200 || status_code >= 300)
-                                {
-                                    LogError("Received status code %d for TWIN subscription request (%s, %s)", status_code, twin_msgr->device_id, correlation_id);
+                                subscription_succeeded = false;
+                            }
 
-                                    subscription_succeeded = false;
+                            if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_SUBSCRIBING)
+                            {
+                                if (subscription_succeeded)
+                                {
+                                    twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_SUBSCRIBED;
+                                    twin_msgr->subscription_error_count = 0;
                                 }
-
-                                if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_SUBSCRIBING)
+                                else
                                 {
-                                    if (subscription_succeeded)
-                                    {
-                                        twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_SUBSCRIBED;
-                                        twin_msgr->subscription_error_count = 0;
-                                    }
-                                    else
-                                    {
-                                        twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_SUBSCRIBE_FOR_UPDATES;
-                                        twin_msgr->subscription_error_count++;
-                                    }
+                                    twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_SUBSCRIBE_FOR_UPDATES;
+                                    twin_msgr->subscription_error_count++;
                                 }
                             }
                         }
-                        else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_DELETE)
+                    }
+                    else if (twin_op_ctx->type == TWIN_OPERATION_TYPE_DELETE)
+                    {
+                        if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_NOT_SUBSCRIBED)
                         {
-                            if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_NOT_SUBSCRIBED)
+                            bool unsubscription_succeeded = true;
+
+                            if (!has_status_code)
                             {
-                                bool unsubscription_succeeded = true;
+                                LogError("Received an incoming TWIN message for a DELETE operation, but with no status code (%s, %s)", twin_msgr->device_id, correlation_id);
 
-                                if (!has_status_code)
-                                {
-                                    LogError("Received an incoming TWIN message for a DELETE operation, but with no status code (%s, %s)", twin_msgr->device_id, correlation_id);
+                                unsubscription_succeeded = false;
+                            }
+                            else if (status_code < 200 || status_code >= 300)
+                            {
+                                LogError("Received status code %d for TWIN unsubscription request (%s, %s)", status_code, twin_msgr->device_id, correlation_id);
 
-                                    unsubscription_succeeded = false;
-                                }
-                                else if (status_code < 200 || status_code >= 300)
-                                {
-                                    LogError("Received status code %d for TWIN unsubscription request (%s, %s)", status_code, twin_msgr->device_id, correlation_id);
+                                unsubscription_succeeded = false;
+                            }
 
-                                    unsubscription_succeeded = false;
+                            if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_UNSUBSCRIBING)
+                            {
+                                if (unsubscription_succeeded)
+                                {
+                                    twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_NOT_SUBSCRIBED;
+                                    twin_msgr->subscription_error_count = 0;
                                 }
-
-                                if (twin_msgr->subscription_state == TWIN_SUBSCRIPTION_STATE_UNSUBSCRIBING)
+                                else
                                 {
-                                    if (unsubscription_succeeded)
-                                    {
-                                        twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_NOT_SUBSCRIBED;
-                                        twin_msgr->subscription_error_count = 0;
-                                    }
-                                    else
-                                    {
-                                        twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_UNSUBSCRIBE;
-                                        twin_msgr->subscription_error_count++;
-                                    }
+                                    twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_UNSUBSCRIBE;
+                                    twin_msgr->subscription_error_count++;
                                 }
                             }
                         }
-
-                        destroy_twin_operation_context(twin_op_ctx);
                     }
 
-                    if (singlylinkedlist_remove(twin_msgr->operations, list_item) != 0)
-                    {
-                        LogError("Failed removing context for incoming TWIN message (%s, %s)",
-                            twin_msgr->device_id, correlation_id);
-
-                        update_state(twin_msgr, TWIN_MESSENGER_STATE_ERROR);
-                    }
+                    destroy_twin_operation_context(twin_op_ctx);
                 }
 
                 free(correlation_id);
@@ -1655,10 +1746,10 @@ TWIN_MESSENGER_HANDLE twin_messenger_create(const TWIN_MESSENGER_CONFIG* messeng
         LogError("Invalid argument (messenger_config is NULL)");
         twin_msgr = NULL;
     }
-    else if (messenger_config->device_id == NULL || messenger_config->iothub_host_fqdn == NULL || messenger_config->prod_info_cb == NULL)
+    else if (messenger_config->device_id == NULL || messenger_config->iothub_host_fqdn == NULL || messenger_config->prod_info_cb == NULL || messenger_config->tick_counter == NULL)
     {
-        LogError("Invalid argument (device_id=%p, iothub_host_fqdn=%p, client_version=%p)",
-            messenger_config->device_id, messenger_config->iothub_host_fqdn, messenger_config->prod_info_cb);
+        LogError("Invalid argument (device_id=%p, iothub_host_fqdn=%p, client_version=%p, tick_counter=%p)",
+            messenger_config->device_id, messenger_config->iothub_host_fqdn, messenger_config->prod_info_cb, messenger_config->tick_counter);
         twin_msgr = NULL;
     }
     else
@@ -1672,6 +1763,8 @@ TWIN_MESSENGER_HANDLE twin_messenger_create(const TWIN_MESSENGER_CONFIG* messeng
             MAP_HANDLE link_attach_properties;
 
             memset(twin_msgr, 0, sizeof(TWIN_MESSENGER_INSTANCE));
+            DList_InitializeListHead(&twin_msgr->operations);
+            twin_msgr->operations_index_bucket_count = TWIN_OPERATION_INDEX_INITIAL_BUCKET_COUNT;
             twin_msgr->state = TWIN_MESSENGER_STATE_STOPPED;
             twin_msgr->subscription_state = TWIN_SUBSCRIPTION_STATE_NOT_SUBSCRIBED;
             twin_msgr->amqp_msgr_state = AMQP_MESSENGER_STATE_STOPPED;
@@ -1703,9 +1796,9 @@ TWIN_MESSENGER_HANDLE twin_messenger_create(const TWIN_MESSENGER_CONFIG* messeng
                 internal_twin_messenger_destroy(twin_msgr);
                 twin_msgr = NULL;
             }
-            else if ((twin_msgr->operations = singlylinkedlist_create()) == NULL)
+            else if ((twin_msgr->operations_index = create_twin_operation_index(TWIN_OPERATION_INDEX_INITIAL_BUCKET_COUNT)) == NULL)
             {
-                LogError("Failed creating list for operations (%s)", messenger_config->device_id);
+                LogError("Failed creating index for operations (%s)", messenger_config->device_id);
                 internal_twin_messenger_destroy(twin_msgr);
                 twin_msgr = NULL;
             }
@@ -1738,6 +1831,7 @@ TWIN_MESSENGER_HANDLE twin_messenger_create(const TWIN_MESSENGER_CONFIG* messeng
                 amqp_msgr_config.on_state_changed_context = (void*)twin_msgr;
                 amqp_msgr_config.on_subscription_changed_callback = on_amqp_messenger_subscription_changed_callback;
                 amqp_msgr_config.on_subscription_changed_context = (void*)twin_msgr;
+                amqp_msgr_config.tick_counter = messenger_config->tick_counter;
 
                 if ((twin_msgr->amqp_msgr = amqp_messenger_create(&amqp_msgr_config)) == NULL)
                 {
@@ -1855,7 +1949,7 @@ int twin_messenger_get_twin_async(TWIN_MESSENGER_HANDLE twin_msgr_handle, TWIN_S
             {
                 LogError("Failed sending TWIN request (%s, TWIN_OPERATION_TYPE_GET_ON_DEMAND)", twin_msgr->device_id);
 
-                (void)remove_twin_operation_context_from_queue(twin_op_ctx);
+                remove_twin_operation_context_from_queue(twin_op_ctx);
                 destroy_twin_operation_context(twin_op_ctx);
                 result = MU_FAILURE;
             }
@@ -1932,10 +2026,9 @@ int twin_messenger_get_send_status(TWIN_MESSENGER_HANDLE twin_msgr_handle, TWIN_
     else
     {
         TWIN_MESSENGER_INSTANCE* twin_msgr = (TWIN_MESSENGER_INSTANCE*)twin_msgr_handle;
-        TWIN_OPERATION_TYPE twin_op_type = TWIN_OPERATION_TYPE_PATCH;
 
         if (singlylinkedlist_get_head_item(twin_msgr->pending_patches) != NULL ||
-            singlylinkedlist_find(twin_msgr->operations, find_twin_operation_by_type, &twin_op_type))
+            has_twin_operation_of_type(twin_msgr, TWIN_OPERATION_TYPE_PATCH))
         {
             *send_status = TWIN_MESSENGER_SEND_STATUS_BUSY;
         }
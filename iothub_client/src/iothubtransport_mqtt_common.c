@@ -254,6 +254,9 @@ typedef struct MQTTTRANSPORT_HANDLE_DATA_TAG
     uint16_t keepAliveValue;
     uint16_t connect_timeout_in_sec;
     tickcounter_ms_t mqtt_connect_time;
+    // Time from mqtt_client_connect to CONNACK of the last successful connection: TCP connect, TLS handshake and MQTT CONNECT
+    tickcounter_ms_t lastConnectDuration;
+    bool hasConnected;
     size_t connectFailCount;
     tickcounter_ms_t connectTick;
     bool log_trace;
@@ -2116,6 +2119,18 @@ static void mqttOperationCompleteCallback(MQTT_CLIENT_HANDLE handle, MQTT_CLIENT
                         transport_data->isRecoverableError = true;
                         transport_data->mqttClientStatus = MQTT_CLIENT_STATUS_CONNECTED;
 
+                        tickcounter_ms_t current_ms;
+                        if (tickcounter_get_current_ms(transport_data->msgTickCounter, &current_ms) != 0)
+                        {
+                            LogError("Failure getting the current time, connection establishment time not recorded");
+                        }
+                        else
+                        {
+                            transport_data->lastConnectDuration = current_ms - transport_data->mqtt_connect_time;
+                            transport_data->hasConnected = true;
+                            LogInfo("MQTT connection established in %" PRIu64 " ms", (uint64_t)transport_data->lastConnectDuration);
+                        }
+
                         retry_control_reset(transport_data->retry_control_handle);
 
                         transport_data->transport_callbacks.connection_status_cb(IOTHUB_CLIENT_CONNECTION_AUTHENTICATED, IOTHUB_CLIENT_CONNECTION_OK, transport_data->transport_ctx);
@@ -2335,6 +2350,37 @@ static void processErrorCallback(MQTT_CLIENT_HANDLE handle, MQTT_CLIENT_EVENT_ER
     }
 }
 
+//
+// ScheduleRepublishOfMessagesWaitingForAck resets the expired time of messages waiting for a PUBACK on a service reconnect.
+// This will cause the messages to republish in order as required by the MQTT spec.  It must only run on the CONNACK
+// transition, while every message in the list was published on the previous connection.
+//
+static void ScheduleRepublishOfMessagesWaitingForAck(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    PDLIST_ENTRY current_entry = transport_data->telemetry_waitingForAck.Flink;
+    while (current_entry != &transport_data->telemetry_waitingForAck)
+    {
+        MQTT_MESSAGE_DETAILS_LIST* msg_detail_entry = containingRecord(current_entry, MQTT_MESSAGE_DETAILS_LIST, entry);
+#ifdef RUN_SFC_TESTS
+        if (!isMqttMessageSfcType(msg_detail_entry->iotHubMessageEntry->messageHandle))
+        {
+#endif //RUN_SFC_TESTS
+            // Wait for at least MESSAGE_REPUBLISH_TIMEOUT_SECS before republish on new connection
+            tickcounter_ms_t current_ms;
+            (void)tickcounter_get_current_ms(transport_data->msgTickCounter, &current_ms);
+            tickcounter_ms_t new_publish_time_ms = current_ms - ((RESEND_TIMEOUT_VALUE_MIN - MESSAGE_REPUBLISH_TIMEOUT_SECS) * 1000); // force the message to resend
+            if (new_publish_time_ms < current_ms)
+            {
+                msg_detail_entry->msgPublishTime = new_publish_time_ms;
+            }
+
+#ifdef RUN_SFC_TESTS
+        }
+#endif //RUN_SFC_TESTS
+        current_entry = current_entry->Flink;
+    }
+}
+
 //
 // SubscribeToMqttProtocol determines which topics we should SUBSCRIBE to, based on existing state, and then
 // invokes the underlying umqtt layer to send the SUBSCRIBE across the network.
@@ -2405,31 +2451,6 @@ static void SubscribeToMqttProtocol(PMQTTTRANSPORT_HANDLE_DATA transport_data)
     else
     {
         transport_data->currPacketState = PUBLISH_TYPE;
-
-        // On a service reconnect, reset the expired time of messages waiting for a PUBACK.
-        // This will cause the messages to republish in order as required by the MQTT spec.
-        PDLIST_ENTRY current_entry = transport_data->telemetry_waitingForAck.Flink;
-        while (current_entry != &transport_data->telemetry_waitingForAck)
-        {
-            MQTT_MESSAGE_DETAILS_LIST* msg_detail_entry = containingRecord(current_entry, MQTT_MESSAGE_DETAILS_LIST, entry);
-#ifdef RUN_SFC_TESTS
-            if (!isMqttMessageSfcType(msg_detail_entry->iotHubMessageEntry->messageHandle))
-            {
-#endif //RUN_SFC_TESTS
-                // Wait for at least MESSAGE_REPUBLISH_TIMEOUT_SECS before republish on new connection
-                tickcounter_ms_t current_ms;
-                (void)tickcounter_get_current_ms(transport_data->msgTickCounter, &current_ms);
-                tickcounter_ms_t new_publish_time_ms = current_ms - ((RESEND_TIMEOUT_VALUE_MIN - MESSAGE_REPUBLISH_TIMEOUT_SECS) * 1000); // force the message to resend
-                if (new_publish_time_ms < current_ms)
-                {
-                    msg_detail_entry->msgPublishTime = new_publish_time_ms;
-                }
-
-#ifdef RUN_SFC_TESTS
-            }
-#endif //RUN_SFC_TESTS
-            current_entry = current_entry->Flink;
-        }
     }
 }
 
@@ -3013,7 +3034,7 @@ static PMQTTTRANSPORT_HANDLE_DATA InitializeTransportHandleData(const IOTHUB_CLI
             freeTransportHandleData(state);
             state = NULL;
         }
-        else if ((state->retry_control_handle = retry_control_create(DEFAULT_RETRY_POLICY, DEFAULT_RETRY_TIMEOUT_IN_SECONDS)) == NULL)
+        else if ((state->retry_control_handle = retry_control_create(DEFAULT_RETRY_POLICY, DEFAULT_RETRY_TIMEOUT_IN_SECONDS, state->msgTickCounter)) == NULL)
         {
             LogError("Failed creating default retry control");
             freeTransportHandleData(state);
@@ -3100,6 +3121,8 @@ static PMQTTTRANSPORT_HANDLE_DATA InitializeTransportHandleData(const IOTHUB_CLI
                         state->portNum = 0;
                         state->connectFailCount = 0;
                         state->connectTick = 0;
+                        state->lastConnectDuration = 0;
+                        state->hasConnected = false;
                         state->topic_MqttMessage = NULL;
                         state->topic_GetState = NULL;
                         state->topic_NotifyState = NULL;
@@ -3647,7 +3670,20 @@ void IoTHubTransport_MQTT_Common_DoWork(TRANSPORT_LL_HANDLE handle)
             }
             else if (transport_data->currPacketState == CONNACK_TYPE || transport_data->currPacketState == SUBSCRIBE_TYPE)
             {
+                if (transport_data->currPacketState == CONNACK_TYPE)
+                {
+                    ScheduleRepublishOfMessagesWaitingForAck(transport_data);
+                }
+
                 SubscribeToMqttProtocol(transport_data);
+
+                // Telemetry does not depend on any of the subscriptions, so start sending it alongside the SUBSCRIBE
+                // instead of one DoWork later. This is only safe when no message is waiting for a PUBACK, since those
+                // must be republished first and in packet id order on reconnect [MQTT-4.6.0-1].
+                if (transport_data->currPacketState == SUBSCRIBE_TYPE && DList_IsListEmpty(&transport_data->telemetry_waitingForAck))
+                {
+                    ProcessPublishStateDoWork(transport_data);
+                }
             }
             else if (transport_data->currPacketState == SUBACK_TYPE)
             {
@@ -3681,16 +3717,16 @@ int IoTHubTransport_MQTT_Common_SetRetryPolicy(TRANSPORT_LL_HANDLE handle, IOTHU
     }
     else
     {
+        PMQTTTRANSPORT_HANDLE_DATA transport_data = (PMQTTTRANSPORT_HANDLE_DATA)handle;
         RETRY_CONTROL_HANDLE new_retry_control_handle;
 
-        if ((new_retry_control_handle = retry_control_create(retryPolicy, (unsigned int)retryTimeoutLimitInSeconds)) == NULL)
+        if ((new_retry_control_handle = retry_control_create(retryPolicy, (unsigned int)retryTimeoutLimitInSeconds, transport_data->msgTickCounter)) == NULL)
         {
             LogError("Failed creating new retry control handle");
             result = MU_FAILURE;
         }
         else
         {
-            PMQTTTRANSPORT_HANDLE_DATA transport_data = (PMQTTTRANSPORT_HANDLE_DATA)handle;
             RETRY_CONTROL_HANDLE previous_retry_control_handle = transport_data->retry_control_handle;
 
             transport_data->retry_control_handle = new_retry_control_handle;
@@ -3729,6 +3765,34 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_MQTT_Common_GetSendStatus(TRANSPORT_LL_HAND
     return result;
 }
 
+IOTHUB_CLIENT_RESULT IoTHubTransport_MQTT_Common_GetLastConnectDuration(TRANSPORT_LL_HANDLE handle, tickcounter_ms_t* connectDuration)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    if (handle == NULL || connectDuration == NULL)
+    {
+        LogError("Invalid argument (handle=%p, connectDuration=%p)", handle, connectDuration);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        MQTTTRANSPORT_HANDLE_DATA* transport_data = (MQTTTRANSPORT_HANDLE_DATA*)handle;
+
+        if (!transport_data->hasConnected)
+        {
+            LogError("No connection established yet");
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            *connectDuration = transport_data->lastConnectDuration;
+            result = IOTHUB_CLIENT_OK;
+        }
+    }
+
+    return result;
+}
+
 IOTHUB_CLIENT_RESULT IoTHubTransport_MQTT_Common_SetOption(TRANSPORT_LL_HANDLE handle, const char* option, const void* value)
 {
     IOTHUB_CLIENT_RESULT result;
@@ -3820,6 +3884,18 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_MQTT_Common_SetOption(TRANSPORT_LL_HANDLE h
                 result = IOTHUB_CLIENT_OK;
             }
         }
+        else if (strcmp(OPTION_RETRY_BUDGET_PER_SEC, option) == 0)
+        {
+            if (retry_control_set_global_budget(*(const unsigned int*)value) != 0)
+            {
+                LogError("Failure setting retry budget option");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
         else if (strcmp(OPTION_HTTP_PROXY, option) == 0)
         {
             HTTP_PROXY_OPTIONS* proxy_options = (HTTP_PROXY_OPTIONS*)value;
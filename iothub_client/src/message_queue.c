@@ -6,44 +6,60 @@
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/gballoc.h"
-#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/tickcounter.h"
 #include "azure_c_shared_utility/xlogging.h"
-#include "azure_c_shared_utility/singlylinkedlist.h"
+#include "azure_c_shared_utility/doublylinkedlist.h"
+#include "azure_c_shared_utility/safe_math.h"
 
 typedef struct MESSAGE_QUEUE_TAG MESSAGE_QUEUE;
 
 #include "internal/message_queue.h"
 
 #define RESULT_OK 0
-#define INDEFINITE_TIME ((time_t)(-1))
+#define MILLISECONDS_PER_SECOND 1000
+#define INDEX_INITIAL_BUCKET_COUNT 16
 
 static const char* SAVED_OPTION_MAX_RETRY_COUNT = "SAVED_OPTION_MAX_RETRY_COUNT";
-static const char* SAVED_OPTION_MAX_ENQUEUE_TIME_SECS = "SAVED_OPTION_MAX_ENQUEUE_TIME_SECS";
-static const char* SAVED_OPTION_MAX_PROCESSING_TIME_SECS = "SAVED_OPTION_MAX_PROCESSING_TIME_SECS";
+static const char* SAVED_OPTION_MAX_ENQUEUE_TIME_MS = "SAVED_OPTION_MAX_ENQUEUE_TIME_MS";
+static const char* SAVED_OPTION_MAX_PROCESSING_TIME_MS = "SAVED_OPTION_MAX_PROCESSING_TIME_MS";
 
 
 struct MESSAGE_QUEUE_TAG
 {
     uint32_t id_counter;
-    size_t max_message_enqueued_time_secs;
-    size_t max_message_processing_time_secs;
+    size_t max_message_enqueued_time_ms;
+    size_t max_message_processing_time_ms;
     size_t max_retry_count;
+    TICK_COUNTER_HANDLE tick_counter;
 
     PROCESS_MESSAGE_CALLBACK on_process_message_callback;
     void* on_process_message_context;
 
-    SINGLYLINKEDLIST_HANDLE pending;
-    SINGLYLINKEDLIST_HANDLE in_progress;
+    // Items are intrusively linked into the lists below.
+    // Since the timeouts are the same for all items, these lists are also ordered by deadline:
+    // "enqueued" by enqueue time (max_message_enqueued_time_ms) and "in_progress" by processing start time (max_message_processing_time_ms).
+    DLIST_ENTRY pending;
+    DLIST_ENTRY in_progress;
+    DLIST_ENTRY enqueued;
+
+    // Index of the items by message id (chained hash buckets, bucket count is a power of two).
+    DLIST_ENTRY* index;
+    size_t index_bucket_count;
+    size_t item_count;
 };
 
 typedef struct MESSAGE_QUEUE_ITEM_TAG
 {
+    DLIST_ENTRY queue_entry;
+    DLIST_ENTRY enqueued_entry;
+    DLIST_ENTRY index_entry;
+    bool is_in_progress;
     uint32_t id;
     MQ_MESSAGE_HANDLE message;
     MESSAGE_PROCESSING_COMPLETED_CALLBACK on_message_processing_completed_callback;
     void* user_context;
-    time_t enqueue_time;
-    time_t processing_start_time;
+    tickcounter_ms_t enqueue_time;
+    tickcounter_ms_t processing_start_time;
     size_t number_of_attempts;
 } MESSAGE_QUEUE_ITEM;
 
@@ -51,80 +67,123 @@ typedef struct MESSAGE_QUEUE_ITEM_TAG
 
 // ---------- Helper Functions ---------- //
 
-static bool find_item_by_message_id(LIST_ITEM_HANDLE list_item, const void* match_context)
+static DLIST_ENTRY* create_index(size_t bucket_count)
 {
-    bool result;
-    MESSAGE_QUEUE_ITEM* current_item = (MESSAGE_QUEUE_ITEM*)singlylinkedlist_item_get_value(list_item);
-    uint32_t message_id = *(uint32_t*)match_context;
+    DLIST_ENTRY* result;
+    size_t malloc_size = safe_multiply_size_t(sizeof(DLIST_ENTRY), bucket_count);
 
-    if (current_item == NULL)
+    if (malloc_size == SIZE_MAX ||
+        (result = (DLIST_ENTRY*)malloc(malloc_size)) == NULL)
     {
-        LogError("Failed finding item: current_item is NULL");
-        result = false;
+        LogError("failed allocating message index (size=%zu)", malloc_size);
+        result = NULL;
     }
     else
     {
-        result = (current_item->id == message_id);
-    }
-    return result;
-}
+        size_t i;
 
-static void fire_message_callback(MESSAGE_QUEUE_ITEM* mq_item, MESSAGE_QUEUE_RESULT result, void* reason)
-{
-    if (mq_item->on_message_processing_completed_callback != NULL)
-    {
-        if (result == MESSAGE_QUEUE_RETRYABLE_ERROR)
+        for (i = 0; i < bucket_count; i++)
         {
-            result = MESSAGE_QUEUE_ERROR;
+            DList_InitializeListHead(&result[i]);
         }
-
-        mq_item->on_message_processing_completed_callback(mq_item->message, result, reason, mq_item->user_context);
     }
+
+    return result;
 }
 
-static bool should_retry_sending(MESSAGE_QUEUE_HANDLE message_queue, MESSAGE_QUEUE_ITEM* mq_item, MESSAGE_QUEUE_RESULT result)
+static DLIST_ENTRY* get_index_bucket(MESSAGE_QUEUE_HANDLE message_queue, uint32_t message_id)
 {
-    return (result == MESSAGE_QUEUE_RETRYABLE_ERROR && mq_item->number_of_attempts <= message_queue->max_retry_count);
+    // Ids are sequential, so the lower bits spread them evenly.
+    return &message_queue->index[message_id & (message_queue->index_bucket_count - 1)];
 }
 
-static int retry_sending_message(MESSAGE_QUEUE_HANDLE message_queue, LIST_ITEM_HANDLE list_item)
+static int grow_index(MESSAGE_QUEUE_HANDLE message_queue)
 {
     int result;
-    MESSAGE_QUEUE_ITEM* mq_item;
+    size_t new_bucket_count = safe_multiply_size_t(message_queue->index_bucket_count, 2);
+    DLIST_ENTRY* new_index;
 
-    mq_item = (MESSAGE_QUEUE_ITEM*)singlylinkedlist_item_get_value(list_item);
-    if (message_queue == NULL)
+    if (new_bucket_count == SIZE_MAX ||
+        (new_index = create_index(new_bucket_count)) == NULL)
     {
-        LogError("message_queue is NULL");
-        result = MU_FAILURE;
-    }
-    else if (singlylinkedlist_remove(message_queue->in_progress, list_item))
-    {
-        LogError("Failed removing message from in-progress list");
-        result = MU_FAILURE;
-    }
-    else if (singlylinkedlist_add(message_queue->pending, (const void*)mq_item) == NULL)
-    {
-        LogError("Failed moving message back to pending list");
+        LogError("failed growing message index");
         result = MU_FAILURE;
     }
     else
     {
+        PDLIST_ENTRY list_entry = message_queue->enqueued.Flink;
+
+        free(message_queue->index);
+        message_queue->index = new_index;
+        message_queue->index_bucket_count = new_bucket_count;
+
+        while (list_entry != &message_queue->enqueued)
+        {
+            MESSAGE_QUEUE_ITEM* mq_item = containingRecord(list_entry, MESSAGE_QUEUE_ITEM, enqueued_entry);
+            DList_InsertTailList(get_index_bucket(message_queue, mq_item->id), &mq_item->index_entry);
+            list_entry = list_entry->Flink;
+        }
+
         result = RESULT_OK;
     }
 
     return result;
 }
 
-static void dequeue_message_and_fire_callback(SINGLYLINKEDLIST_HANDLE list, LIST_ITEM_HANDLE list_item, MESSAGE_QUEUE_RESULT result, void* reason)
+static MESSAGE_QUEUE_ITEM* find_item_by_message_id(MESSAGE_QUEUE_HANDLE message_queue, uint32_t message_id)
 {
-    MESSAGE_QUEUE_ITEM* mq_item = (MESSAGE_QUEUE_ITEM*)singlylinkedlist_item_get_value(list_item);
+    MESSAGE_QUEUE_ITEM* result = NULL;
+    PDLIST_ENTRY bucket = get_index_bucket(message_queue, message_id);
+    PDLIST_ENTRY list_entry = bucket->Flink;
 
-    if (singlylinkedlist_remove(list, list_item))
+    while (list_entry != bucket)
     {
-        LogError("failed removing message from list (%p)", list);
+        MESSAGE_QUEUE_ITEM* mq_item = containingRecord(list_entry, MESSAGE_QUEUE_ITEM, index_entry);
+
+        if (mq_item->id == message_id)
+        {
+            result = mq_item;
+            break;
+        }
+
+        list_entry = list_entry->Flink;
     }
 
+    return result;
+}
+
+static void fire_message_callback(MESSAGE_QUEUE_ITEM* mq_item, MESSAGE_QUEUE_RESULT result, void* reason)
+{
+    if (mq_item->on_message_processing_completed_callback != NULL)
+    {
+        if (result == MESSAGE_QUEUE_RETRYABLE_ERROR)
+        {
+            result = MESSAGE_QUEUE_ERROR;
+        }
+
+        mq_item->on_message_processing_completed_callback(mq_item->message, result, reason, mq_item->user_context);
+    }
+}
+
+static bool should_retry_sending(MESSAGE_QUEUE_HANDLE message_queue, MESSAGE_QUEUE_ITEM* mq_item, MESSAGE_QUEUE_RESULT result)
+{
+    return (result == MESSAGE_QUEUE_RETRYABLE_ERROR && mq_item->number_of_attempts <= message_queue->max_retry_count);
+}
+
+static void move_to_pending(MESSAGE_QUEUE_HANDLE message_queue, MESSAGE_QUEUE_ITEM* mq_item)
+{
+    (void)DList_RemoveEntryList(&mq_item->queue_entry);
+    DList_InsertTailList(&message_queue->pending, &mq_item->queue_entry);
+    mq_item->is_in_progress = false;
+}
+
+static void dequeue_message_and_fire_callback(MESSAGE_QUEUE_HANDLE message_queue, MESSAGE_QUEUE_ITEM* mq_item, MESSAGE_QUEUE_RESULT result, void* reason)
+{
+    (void)DList_RemoveEntryList(&mq_item->queue_entry);
+    (void)DList_RemoveEntryList(&mq_item->enqueued_entry);
+    (void)DList_RemoveEntryList(&mq_item->index_entry);
+    message_queue->item_count--;
+
     fire_message_callback(mq_item, result, reason);
 
     free(mq_item);
@@ -138,98 +197,64 @@ static void on_process_message_completed_callback(MESSAGE_QUEUE_HANDLE message_q
     }
     else
     {
-        LIST_ITEM_HANDLE list_item;
+        MESSAGE_QUEUE_ITEM* mq_item;
 
-        if ((list_item = singlylinkedlist_find(message_queue->in_progress, find_item_by_message_id, &message_id)) == NULL)
+        if ((mq_item = find_item_by_message_id(message_queue, message_id)) == NULL || !mq_item->is_in_progress)
         {
             LogError("on_process_message_completed_callback invoked for a message not in the in-progress list (%u)", message_id);
         }
+        else if (should_retry_sending(message_queue, mq_item, result))
+        {
+            move_to_pending(message_queue, mq_item);
+        }
         else
         {
-            MESSAGE_QUEUE_ITEM* mq_item = (MESSAGE_QUEUE_ITEM*)singlylinkedlist_item_get_value(list_item);
-
-            if (!should_retry_sending(message_queue, mq_item, result) || retry_sending_message(message_queue, list_item) != RESULT_OK)
-            {
-                dequeue_message_and_fire_callback(message_queue->in_progress, list_item, result, reason);
-            }
+            dequeue_message_and_fire_callback(message_queue, mq_item, result, reason);
         }
     }
 }
 
 static void process_timeouts(MESSAGE_QUEUE_HANDLE message_queue)
 {
-    time_t current_time;
+    tickcounter_ms_t current_time;
 
-    if ((current_time = get_time(NULL)) == INDEFINITE_TIME)
+    if (tickcounter_get_current_ms(message_queue->tick_counter, &current_time) != 0)
     {
-        LogError("failed processing timeouts (get_time failed)");
+        LogError("failed processing timeouts (tickcounter_get_current_ms failed)");
     }
     else
     {
-        if (message_queue->max_message_enqueued_time_secs > 0)
+        if (message_queue->max_message_enqueued_time_ms > 0)
         {
-            LIST_ITEM_HANDLE list_item = singlylinkedlist_get_head_item(message_queue->pending);
+            PDLIST_ENTRY list_entry;
 
-            while (list_item != NULL)
+            while ((list_entry = message_queue->enqueued.Flink) != &message_queue->enqueued)
             {
-                LIST_ITEM_HANDLE current_list_item = list_item;
-                MESSAGE_QUEUE_ITEM* mq_item = (MESSAGE_QUEUE_ITEM*)singlylinkedlist_item_get_value(current_list_item);
-
-                list_item = singlylinkedlist_get_next_item(list_item);
+                MESSAGE_QUEUE_ITEM* mq_item = containingRecord(list_entry, MESSAGE_QUEUE_ITEM, enqueued_entry);
 
-                if (mq_item == NULL)
-                {
-                    LogError("failed processing timeouts (unexpected NULL pointer to MESSAGE_QUEUE_ITEM)");
-                }
-                else if (get_difftime(current_time, mq_item->enqueue_time) >= message_queue->max_message_enqueued_time_secs)
+                if (current_time - mq_item->enqueue_time >= message_queue->max_message_enqueued_time_ms)
                 {
-                    dequeue_message_and_fire_callback(message_queue->pending, current_list_item, MESSAGE_QUEUE_TIMEOUT, NULL);
+                    dequeue_message_and_fire_callback(message_queue, mq_item, MESSAGE_QUEUE_TIMEOUT, NULL);
                 }
                 else
                 {
-                    // The pending list order is already based on enqueue time, so if one message is not expired, later ones won't be either.
+                    // Items are ordered by enqueue time, so if one message is not expired, later ones won't be either.
                     break;
                 }
             }
-
-            list_item = singlylinkedlist_get_head_item(message_queue->in_progress);
-
-            while (list_item != NULL)
-            {
-                LIST_ITEM_HANDLE current_list_item = list_item;
-                MESSAGE_QUEUE_ITEM* mq_item = (MESSAGE_QUEUE_ITEM*)singlylinkedlist_item_get_value(current_list_item);
-
-                list_item = singlylinkedlist_get_next_item(list_item);
-
-                if (mq_item == NULL)
-                {
-                    LogError("failed processing timeouts (unexpected NULL pointer to MESSAGE_QUEUE_ITEM)");
-                }
-                else if (get_difftime(current_time, mq_item->enqueue_time) >= message_queue->max_message_enqueued_time_secs)
-                {
-                    dequeue_message_and_fire_callback(message_queue->in_progress, current_list_item, MESSAGE_QUEUE_TIMEOUT, NULL);
-                }
-            }
         }
 
-        if (message_queue->max_message_processing_time_secs > 0)
+        if (message_queue->max_message_processing_time_ms > 0)
         {
-            LIST_ITEM_HANDLE list_item = singlylinkedlist_get_head_item(message_queue->in_progress);
+            PDLIST_ENTRY list_entry;
 
-            while (list_item != NULL)
+            while ((list_entry = message_queue->in_progress.Flink) != &message_queue->in_progress)
             {
-                LIST_ITEM_HANDLE current_list_item = list_item;
-                MESSAGE_QUEUE_ITEM* mq_item = (MESSAGE_QUEUE_ITEM*)singlylinkedlist_item_get_value(current_list_item);
+                MESSAGE_QUEUE_ITEM* mq_item = containingRecord(list_entry, MESSAGE_QUEUE_ITEM, queue_entry);
 
-                list_item = singlylinkedlist_get_next_item(list_item);
-
-                if (mq_item == NULL)
-                {
-                    LogError("failed processing timeouts (unexpected NULL pointer to MESSAGE_QUEUE_ITEM)");
-                }
-                else if (get_difftime(current_time, mq_item->processing_start_time) >= message_queue->max_message_processing_time_secs)
+                if (current_time - mq_item->processing_start_time >= message_queue->max_message_processing_time_ms)
                 {
-                    dequeue_message_and_fire_callback(message_queue->in_progress, current_list_item, MESSAGE_QUEUE_TIMEOUT, NULL);
+                    dequeue_message_and_fire_callback(message_queue, mq_item, MESSAGE_QUEUE_TIMEOUT, NULL);
                 }
                 else
                 {
@@ -243,43 +268,23 @@ static void process_timeouts(MESSAGE_QUEUE_HANDLE message_queue)
 
 static void process_pending_messages(MESSAGE_QUEUE_HANDLE message_queue)
 {
-    LIST_ITEM_HANDLE list_item;
+    PDLIST_ENTRY list_entry;
 
-    while ((list_item = singlylinkedlist_get_head_item(message_queue->pending)) != NULL)
+    while ((list_entry = message_queue->pending.Flink) != &message_queue->pending)
     {
-        MESSAGE_QUEUE_ITEM* mq_item = (MESSAGE_QUEUE_ITEM*)singlylinkedlist_item_get_value(list_item);
-
-        if (mq_item == NULL)
-        {
-            LogError("internal error, failed to retrieve list node value");
-            break;
-        }
-        else if (singlylinkedlist_remove(message_queue->pending, list_item) != 0)
-        {
-            LogError("failed moving message out of pending list (%p)", mq_item->message);
-
-            fire_message_callback(mq_item, MESSAGE_QUEUE_ERROR, NULL);
-
-            // Not freeing since this would cause a memory A/V on the next call.
+        MESSAGE_QUEUE_ITEM* mq_item = containingRecord(list_entry, MESSAGE_QUEUE_ITEM, queue_entry);
 
-            break; // Trying to avoid an infinite loop
-        }
-        else if ((mq_item->processing_start_time = get_time(NULL)) == INDEFINITE_TIME)
+        if (tickcounter_get_current_ms(message_queue->tick_counter, &mq_item->processing_start_time) != 0)
         {
             LogError("failed setting message processing_start_time (%p)", mq_item->message);
 
-            fire_message_callback(mq_item, MESSAGE_QUEUE_ERROR, NULL);
-            free(mq_item);
-        }
-        else if (singlylinkedlist_add(message_queue->in_progress, (const void*)mq_item) == NULL)
-        {
-            LogError("failed moving message to in-progress list (%p)", mq_item->message);
-
-            fire_message_callback(mq_item, MESSAGE_QUEUE_ERROR, NULL);
-            free(mq_item);
+            dequeue_message_and_fire_callback(message_queue, mq_item, MESSAGE_QUEUE_ERROR, NULL);
         }
         else
         {
+            (void)DList_RemoveEntryList(&mq_item->queue_entry);
+            DList_InsertTailList(&message_queue->in_progress, &mq_item->queue_entry);
+            mq_item->is_in_progress = true;
             mq_item->number_of_attempts++;
 
             message_queue->on_process_message_callback(message_queue, mq_item->message, mq_item->id, on_process_message_completed_callback, mq_item->user_context);
@@ -296,8 +301,8 @@ static void* cloneOption(const char* name, const void* value)
         LogError("invalid argument (name=%p, value=%p)", name, value);
         result = NULL;
     }
-    else if (strcmp(SAVED_OPTION_MAX_ENQUEUE_TIME_SECS, name) == 0 ||
-        strcmp(SAVED_OPTION_MAX_PROCESSING_TIME_SECS, name) == 0 ||
+    else if (strcmp(SAVED_OPTION_MAX_ENQUEUE_TIME_MS, name) == 0 ||
+        strcmp(SAVED_OPTION_MAX_PROCESSING_TIME_MS, name) == 0 ||
         strcmp(SAVED_OPTION_MAX_RETRY_COUNT, name) == 0)
     {
         if ((result = malloc(sizeof(size_t))) == NULL)
@@ -324,8 +329,8 @@ static void destroyOption(const char* name, const void* value)
     {
         LogError("invalid argument (name=%p, value=%p)", name, value);
     }
-    else if (strcmp(SAVED_OPTION_MAX_ENQUEUE_TIME_SECS, name) == 0 ||
-        strcmp(SAVED_OPTION_MAX_PROCESSING_TIME_SECS, name) == 0 ||
+    else if (strcmp(SAVED_OPTION_MAX_ENQUEUE_TIME_MS, name) == 0 ||
+        strcmp(SAVED_OPTION_MAX_PROCESSING_TIME_MS, name) == 0 ||
         strcmp(SAVED_OPTION_MAX_RETRY_COUNT, name) == 0)
     {
         free((void*)value);
@@ -344,56 +349,20 @@ void message_queue_remove_all(MESSAGE_QUEUE_HANDLE message_queue)
 {
     if (message_queue != NULL)
     {
-        LIST_ITEM_HANDLE list_item;
+        PDLIST_ENTRY list_entry;
 
-        while ((list_item = singlylinkedlist_get_head_item(message_queue->in_progress)) != NULL)
+        while ((list_entry = message_queue->in_progress.Flink) != &message_queue->in_progress)
         {
-            dequeue_message_and_fire_callback(message_queue->in_progress, list_item, MESSAGE_QUEUE_CANCELLED, NULL);
+            dequeue_message_and_fire_callback(message_queue, containingRecord(list_entry, MESSAGE_QUEUE_ITEM, queue_entry), MESSAGE_QUEUE_CANCELLED, NULL);
         }
 
-        while ((list_item = singlylinkedlist_get_head_item(message_queue->pending)) != NULL)
+        while ((list_entry = message_queue->pending.Flink) != &message_queue->pending)
         {
-            dequeue_message_and_fire_callback(message_queue->pending, list_item, MESSAGE_QUEUE_CANCELLED, NULL);
+            dequeue_message_and_fire_callback(message_queue, containingRecord(list_entry, MESSAGE_QUEUE_ITEM, queue_entry), MESSAGE_QUEUE_CANCELLED, NULL);
         }
     }
 }
 
-static int move_messages_between_lists(SINGLYLINKEDLIST_HANDLE from_list, SINGLYLINKEDLIST_HANDLE to_list)
-{
-    int result;
-    LIST_ITEM_HANDLE list_item;
-
-    result = RESULT_OK;
-
-    while ((list_item = singlylinkedlist_get_head_item(from_list)) != NULL)
-    {
-        MESSAGE_QUEUE_ITEM* mq_item = (MESSAGE_QUEUE_ITEM*)singlylinkedlist_item_get_value(list_item);
-
-        if (singlylinkedlist_remove(from_list, list_item) != 0)
-        {
-            LogError("failed removing message from list");
-            result = MU_FAILURE;
-            break;
-        }
-        else if (mq_item == NULL)
-        {
-            LogError("failed moving message to list");
-            result = MU_FAILURE;
-            break;
-        }
-        else if (singlylinkedlist_add(to_list, (const void*)mq_item) == NULL)
-        {
-            LogError("failed moving message to list");
-            fire_message_callback(mq_item, MESSAGE_QUEUE_CANCELLED, NULL);
-            free(mq_item);
-            result = MU_FAILURE;
-            break;
-        }
-    }
-
-    return result;
-}
-
 int message_queue_move_all_back_to_pending(MESSAGE_QUEUE_HANDLE message_queue)
 {
     int result;
@@ -405,25 +374,19 @@ int message_queue_move_all_back_to_pending(MESSAGE_QUEUE_HANDLE message_queue)
     }
     else
     {
-        if (move_messages_between_lists(message_queue->pending, message_queue->in_progress) != 0)
-        {
-            LogError("failed moving pending messages at the end of in-progress");
-            result = MU_FAILURE;
-        }
-        else if (move_messages_between_lists(message_queue->in_progress, message_queue->pending) != 0)
-        {
-            LogError("failed moving all in-progress messages back to pending");
-            result = MU_FAILURE;
-        }
-        else
-        {
-            result = RESULT_OK;
-        }
+        // In-progress messages go back to the beginning of the pending list, preserving their order.
+        PDLIST_ENTRY list_entry;
 
-        if (result != RESULT_OK)
+        while ((list_entry = message_queue->in_progress.Blink) != &message_queue->in_progress)
         {
-            message_queue_remove_all(message_queue);
+            MESSAGE_QUEUE_ITEM* mq_item = containingRecord(list_entry, MESSAGE_QUEUE_ITEM, queue_entry);
+
+            (void)DList_RemoveEntryList(&mq_item->queue_entry);
+            DList_InsertHeadList(&message_queue->pending, &mq_item->queue_entry);
+            mq_item->is_in_progress = false;
         }
+
+        result = RESULT_OK;
     }
 
     return result;
@@ -435,14 +398,9 @@ void message_queue_destroy(MESSAGE_QUEUE_HANDLE message_queue)
     {
         message_queue_remove_all(message_queue);
 
-        if (message_queue->pending != NULL)
+        if (message_queue->index != NULL)
         {
-            singlylinkedlist_destroy(message_queue->pending);
-        }
-
-        if (message_queue->in_progress != NULL)
-        {
-            singlylinkedlist_destroy(message_queue->in_progress);
+            free(message_queue->index);
         }
 
         free(message_queue);
@@ -463,6 +421,11 @@ MESSAGE_QUEUE_HANDLE message_queue_create(MESSAGE_QUEUE_CONFIG* config)
         LogError("invalid configuration (on_process_message_callback is NULL)");
         result = NULL;
     }
+    else if (config->tick_counter == NULL)
+    {
+        LogError("invalid configuration (tick_counter is NULL)");
+        result = NULL;
+    }
     else if ((result = (MESSAGE_QUEUE*)malloc(sizeof(MESSAGE_QUEUE))) == NULL)
     {
         LogError("failed allocating MESSAGE_QUEUE");
@@ -472,24 +435,22 @@ MESSAGE_QUEUE_HANDLE message_queue_create(MESSAGE_QUEUE_CONFIG* config)
     {
         // Here it already sets the id_counter to zero.
         memset(result, 0, sizeof(MESSAGE_QUEUE));
+        DList_InitializeListHead(&result->pending);
+        DList_InitializeListHead(&result->in_progress);
+        DList_InitializeListHead(&result->enqueued);
 
-        if ((result->pending = singlylinkedlist_create()) == NULL)
+        if ((result->index = create_index(INDEX_INITIAL_BUCKET_COUNT)) == NULL)
         {
-            LogError("failed allocating MESSAGE_QUEUE pending list");
-            message_queue_destroy(result);
-            result = NULL;
-        }
-        else if ((result->in_progress = singlylinkedlist_create()) == NULL)
-        {
-            LogError("failed allocating MESSAGE_QUEUE in-progress list");
+            LogError("failed allocating MESSAGE_QUEUE index");
             message_queue_destroy(result);
             result = NULL;
         }
         else
         {
-
-            result->max_message_enqueued_time_secs = config->max_message_enqueued_time_secs;
-            result->max_message_processing_time_secs = config->max_message_processing_time_secs;
+            result->tick_counter = config->tick_counter;
+            result->index_bucket_count = INDEX_INITIAL_BUCKET_COUNT;
+            result->max_message_enqueued_time_ms = config->max_message_enqueued_time_ms;
+            result->max_message_processing_time_ms = config->max_message_processing_time_ms;
             result->max_retry_count = config->max_retry_count;
             result->on_process_message_callback = config->on_process_message_callback;
         }
@@ -520,13 +481,13 @@ int message_queue_add(MESSAGE_QUEUE_HANDLE message_queue, MQ_MESSAGE_HANDLE mess
         {
             memset(mq_item, 0, sizeof(MESSAGE_QUEUE_ITEM));
 
-            if ((mq_item->enqueue_time = get_time(NULL)) == INDEFINITE_TIME)
+            if (tickcounter_get_current_ms(message_queue->tick_counter, &mq_item->enqueue_time) != 0)
             {
                 LogError("failed setting message enqueue time");
                 free(mq_item);
                 result = MU_FAILURE;
             }
-            else if (singlylinkedlist_add(message_queue->pending, (const void*)mq_item) == NULL)
+            else if (message_queue->item_count >= message_queue->index_bucket_count && grow_index(message_queue) != RESULT_OK)
             {
                 LogError("failed enqueuing message");
                 free(mq_item);
@@ -538,7 +499,11 @@ int message_queue_add(MESSAGE_QUEUE_HANDLE message_queue, MQ_MESSAGE_HANDLE mess
                 mq_item->message = message;
                 mq_item->on_message_processing_completed_callback = on_message_processing_completed_callback;
                 mq_item->user_context = user_context;
-                mq_item->processing_start_time = INDEFINITE_TIME;
+
+                DList_InsertTailList(&message_queue->pending, &mq_item->queue_entry);
+                DList_InsertTailList(&message_queue->enqueued, &mq_item->enqueued_entry);
+                DList_InsertTailList(get_index_bucket(message_queue, mq_item->id), &mq_item->index_entry);
+                message_queue->item_count++;
                 result = RESULT_OK;
             }
         }
@@ -558,7 +523,7 @@ int message_queue_is_empty(MESSAGE_QUEUE_HANDLE message_queue, bool* is_empty)
     }
     else
     {
-        *is_empty = (singlylinkedlist_get_head_item(message_queue->pending) == NULL && singlylinkedlist_get_head_item(message_queue->in_progress) == NULL);
+        *is_empty = (message_queue->item_count == 0);
         result = RESULT_OK;
     }
 
@@ -574,7 +539,7 @@ void message_queue_do_work(MESSAGE_QUEUE_HANDLE message_queue)
     }
 }
 
-int message_queue_set_max_message_enqueued_time_secs(MESSAGE_QUEUE_HANDLE message_queue, size_t seconds)
+int message_queue_set_max_message_enqueued_time_ms(MESSAGE_QUEUE_HANDLE message_queue, size_t milliseconds)
 {
     int result;
 
@@ -585,14 +550,32 @@ int message_queue_set_max_message_enqueued_time_secs(MESSAGE_QUEUE_HANDLE messag
     }
     else
     {
-        message_queue->max_message_enqueued_time_secs = seconds;
+        message_queue->max_message_enqueued_time_ms = milliseconds;
         result = RESULT_OK;
     }
 
     return result;
 }
 
-int message_queue_set_max_message_processing_time_secs(MESSAGE_QUEUE_HANDLE message_queue, size_t seconds)
+int message_queue_set_max_message_enqueued_time_secs(MESSAGE_QUEUE_HANDLE message_queue, size_t seconds)
+{
+    int result;
+    size_t milliseconds = safe_multiply_size_t(seconds, MILLISECONDS_PER_SECOND);
+
+    if (milliseconds == SIZE_MAX)
+    {
+        LogError("invalid argument (seconds=%zu is too large)", seconds);
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = message_queue_set_max_message_enqueued_time_ms(message_queue, milliseconds);
+    }
+
+    return result;
+}
+
+int message_queue_set_max_message_processing_time_ms(MESSAGE_QUEUE_HANDLE message_queue, size_t milliseconds)
 {
     int result;
 
@@ -603,13 +586,31 @@ int message_queue_set_max_message_processing_time_secs(MESSAGE_QUEUE_HANDLE mess
     }
     else
     {
-        message_queue->max_message_processing_time_secs = seconds;
+        message_queue->max_message_processing_time_ms = milliseconds;
         result = RESULT_OK;
     }
 
     return result;
 }
 
+int message_queue_set_max_message_processing_time_secs(MESSAGE_QUEUE_HANDLE message_queue, size_t seconds)
+{
+    int result;
+    size_t milliseconds = safe_multiply_size_t(seconds, MILLISECONDS_PER_SECOND);
+
+    if (milliseconds == SIZE_MAX)
+    {
+        LogError("invalid argument (seconds=%zu is too large)", seconds);
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = message_queue_set_max_message_processing_time_ms(message_queue, milliseconds);
+    }
+
+    return result;
+}
+
 int message_queue_set_max_retry_count(MESSAGE_QUEUE_HANDLE message_queue, size_t max_retry_count)
 {
     int result;
@@ -637,9 +638,9 @@ static int setOption(void* handle, const char* name, const void* value)
         LogError("invalid argument (handle=%p, name=%p, value=%p)", handle, name, value);
         result = MU_FAILURE;
     }
-    else if (strcmp(SAVED_OPTION_MAX_ENQUEUE_TIME_SECS, name) == 0)
+    else if (strcmp(SAVED_OPTION_MAX_ENQUEUE_TIME_MS, name) == 0)
     {
-        if (message_queue_set_max_message_enqueued_time_secs((MESSAGE_QUEUE_HANDLE)handle, *(size_t*)value) != RESULT_OK)
+        if (message_queue_set_max_message_enqueued_time_ms((MESSAGE_QUEUE_HANDLE)handle, *(size_t*)value) != RESULT_OK)
         {
             LogError("failed setting option %s", name);
             result = MU_FAILURE;
@@ -649,9 +650,9 @@ static int setOption(void* handle, const char* name, const void* value)
             result = RESULT_OK;
         }
     }
-    else if (strcmp(SAVED_OPTION_MAX_PROCESSING_TIME_SECS, name) == 0)
+    else if (strcmp(SAVED_OPTION_MAX_PROCESSING_TIME_MS, name) == 0)
     {
-        if (message_queue_set_max_message_processing_time_secs((MESSAGE_QUEUE_HANDLE)handle, *(size_t*)value) != RESULT_OK)
+        if (message_queue_set_max_message_processing_time_ms((MESSAGE_QUEUE_HANDLE)handle, *(size_t*)value) != RESULT_OK)
         {
             LogError("failed setting option %s", name);
             result = MU_FAILURE;
@@ -695,21 +696,21 @@ OPTIONHANDLER_HANDLE message_queue_retrieve_options(MESSAGE_QUEUE_HANDLE message
     {
         LogError("failed creating OPTIONHANDLER_HANDLE");
     }
-    else if (OptionHandler_AddOption(result, SAVED_OPTION_MAX_ENQUEUE_TIME_SECS, &message_queue->max_message_enqueued_time_secs) != OPTIONHANDLER_OK)
+    else if (OptionHandler_AddOption(result, SAVED_OPTION_MAX_ENQUEUE_TIME_MS, &message_queue->max_message_enqueued_time_ms) != OPTIONHANDLER_OK)
     {
-        LogError("failed retrieving options (failed adding %s)", SAVED_OPTION_MAX_ENQUEUE_TIME_SECS);
+        LogError("failed retrieving options (failed adding %s)", SAVED_OPTION_MAX_ENQUEUE_TIME_MS);
         OptionHandler_Destroy(result);
         result = NULL;
     }
-    else if (OptionHandler_AddOption(result, SAVED_OPTION_MAX_PROCESSING_TIME_SECS, &message_queue->max_message_processing_time_secs) != OPTIONHANDLER_OK)
+    else if (OptionHandler_AddOption(result, SAVED_OPTION_MAX_PROCESSING_TIME_MS, &message_queue->max_message_processing_time_ms) != OPTIONHANDLER_OK)
     {
-        LogError("failed retrieving options (failed adding %s)", SAVED_OPTION_MAX_PROCESSING_TIME_SECS);
+        LogError("failed retrieving options (failed adding %s)", SAVED_OPTION_MAX_PROCESSING_TIME_MS);
         OptionHandler_Destroy(result);
         result = NULL;
     }
     else if (OptionHandler_AddOption(result, SAVED_OPTION_MAX_RETRY_COUNT, &message_queue->max_retry_count) != OPTIONHANDLER_OK)
     {
-        LogError("failed retrieving options (failed adding %s)", SAVED_OPTION_MAX_PROCESSING_TIME_SECS);
+        LogError("failed retrieving options (failed adding %s)", SAVED_OPTION_MAX_PROCESSING_TIME_MS);
         OptionHandler_Destroy(result);
         result = NULL;
     }
@@ -347,6 +347,53 @@ TEST_FUNCTION(Blob_ClearBlockIdList_NULL_handle_fails)
     ///cleanup
 }
 
+TEST_FUNCTION(Blob_AddUploadedBlockId_happy_path_succeeds)
+{
+    ///arrange
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Azure_Base64_Encode_Bytes(IGNORED_ARG, 6));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_SINGLYLINKEDLIST_HANDLE, IGNORED_ARG));
+
+    ///act
+    BLOB_RESULT result = Blob_AddUploadedBlockId(TEST_SINGLYLINKEDLIST_HANDLE, 7);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, BLOB_OK, result);
+
+    ///cleanup
+}
+
+TEST_FUNCTION(Blob_AddUploadedBlockId_NULL_blockIdList_fails)
+{
+    ///arrange
+    umock_c_reset_all_calls();
+
+    ///act
+    BLOB_RESULT result = Blob_AddUploadedBlockId(NULL, 7);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, BLOB_INVALID_ARG, result);
+
+    ///cleanup
+}
+
+TEST_FUNCTION(Blob_AddUploadedBlockId_blockId_too_large_fails)
+{
+    ///arrange
+    umock_c_reset_all_calls();
+
+    ///act
+    BLOB_RESULT result = Blob_AddUploadedBlockId(TEST_SINGLYLINKEDLIST_HANDLE, 50000);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, BLOB_ERROR, result);
+
+    ///cleanup
+}
+
 TEST_FUNCTION(Blob_PutBlock_happy_path_succeeds)
 {
     ///arrange
@@ -725,6 +772,59 @@ TEST_FUNCTION(Blob_PutBlockList_happy_path_succeeds)
     ///cleanup
 }
 
+TEST_FUNCTION(Blob_PutBlockListWithContentEncoding_sets_content_encoding_header)
+{
+    ///arrange
+    SINGLYLINKEDLIST_HANDLE blockIdList = TEST_SINGLYLINKEDLIST_HANDLE;
+    unsigned int responseHttpStatus = 0;
+    BUFFER_HANDLE responseContent = TEST_BUFFER_HANDLE;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
+    // createBlockIdListXml(1 block)
+    STRICT_EXPECTED_CALL(STRING_construct(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG))
+        .CallCannotFail()
+        .SetReturn(TEST_STRING_HANDLE);
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_ARG))
+        .CallCannotFail()
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, IGNORED_ARG));
+    // Back to Blob_PutBlockListWithContentEncoding
+    STRICT_EXPECTED_CALL(STRING_construct(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(STRING_length(IGNORED_ARG))
+        .CallCannotFail()
+        .SetReturn(100);
+    STRICT_EXPECTED_CALL(BUFFER_create(IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_ARG, "x-ms-blob-content-encoding", "gzip"));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(
+        TEST_HTTPAPIEX_HANDLE, HTTPAPI_REQUEST_PUT, IGNORED_ARG, IGNORED_ARG, IGNORED_ARG, IGNORED_ARG, IGNORED_ARG, responseContent))
+        .CopyOutArgumentBuffer_statusCode(&HTTP_STATUS_200, sizeof(unsigned int));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove_if(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_ARG));
+
+    ///act
+    BLOB_RESULT result = Blob_PutBlockListWithContentEncoding(
+        TEST_HTTPAPIEX_HANDLE, TEST_RELATIVE_PATH_1, blockIdList, "gzip", &responseHttpStatus, responseContent);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, BLOB_OK, result);
+
+    ///cleanup
+}
+
 TEST_FUNCTION(Blob_PutBlockList_401_fails)
 {
     ///arrange
@@ -35,6 +35,7 @@ static void my_gballoc_free(void* ptr)
 #include "azure_c_shared_utility/xio.h"
 #include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/azure_base64.h"
+#include "azure_c_shared_utility/lock.h"
 
 #ifdef USE_PROV_MODULE
 #include "azure_prov_client/internal/iothub_auth_client.h"
@@ -130,6 +131,17 @@ static CREDENTIAL_RESULT* my_iothub_device_auth_generate_credentials(IOTHUB_SECU
 }
 #endif
 
+static LOCK_HANDLE my_Lock_Init(void)
+{
+    return (LOCK_HANDLE)my_gballoc_malloc(1);
+}
+
+static LOCK_RESULT my_Lock_Deinit(LOCK_HANDLE handle)
+{
+    my_gballoc_free(handle);
+    return LOCK_OK;
+}
+
 static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 {
     char temp_str[256];
@@ -158,6 +170,8 @@ TEST_SUITE_INITIALIZE(suite_init)
 
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_AUTHORIZATION_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(time_t, long long);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_RESULT, int);
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
 
@@ -172,6 +186,10 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(SASToken_CreateString, NULL);
 
     REGISTER_GLOBAL_MOCK_RETURN(get_time, TEST_TIME_VALUE);
+    REGISTER_GLOBAL_MOCK_HOOK(Lock_Init, my_Lock_Init);
+    REGISTER_GLOBAL_MOCK_HOOK(Lock_Deinit, my_Lock_Deinit);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(get_time, ((time_t)(-1)));
 
     REGISTER_GLOBAL_MOCK_RETURNS(Azure_Base64_Decode, (BUFFER_HANDLE)0x1, NULL);
@@ -1112,4 +1130,135 @@ TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_Expiry_succeed)
     IoTHubClient_Auth_Destroy(handle);
 }
 
+TEST_FUNCTION(IoTHubClient_Auth_Set_SasToken_Cache_handle_NULL_fail)
+{
+    //arrange
+
+    //act
+    int result = IoTHubClient_Auth_Set_SasToken_Cache(NULL, true);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Set_SasToken_Cache_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+
+    //act
+    int result = IoTHubClient_Auth_Set_SasToken_Cache(handle, true);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_cache_reuses_token)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    (void)IoTHubClient_Auth_Set_SasToken_Cache(handle, true);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_ARG, IGNORED_ARG)).CallCannotFail();
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+
+    //act
+    char* second_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+
+    //assert
+    ASSERT_IS_NOT_NULL(first_token);
+    ASSERT_IS_NOT_NULL(second_token);
+    ASSERT_ARE_EQUAL(char_ptr, first_token, second_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    free(second_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_cache_renews_after_reuse_window)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    (void)IoTHubClient_Auth_Set_SasToken_Cache(handle, true);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_ARG, IGNORED_ARG)).SetReturn((double)TEST_CURRENT_TIME);
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_ARG, IGNORED_ARG)).SetReturn((double)TEST_CURRENT_TIME);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    // Default lifetime is 3600 seconds, so the cached token is only reused for the first 360
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_ARG, IGNORED_ARG)).SetReturn((double)(TEST_CURRENT_TIME + 360)).CallCannotFail();
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_ARG, IGNORED_ARG)).SetReturn((double)(TEST_CURRENT_TIME + 360)).CallCannotFail();
+    STRICT_EXPECTED_CALL(SASToken_CreateString(IGNORED_ARG, SCOPE_NAME, IGNORED_ARG, TEST_CURRENT_TIME + 360 + 3600));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_ARG)).CallCannotFail();
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_ARG, SCOPE_NAME));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+
+    //act
+    char* second_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+
+    //assert
+    ASSERT_IS_NOT_NULL(second_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    free(second_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Set_SasToken_Expiry_clears_cache)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    (void)IoTHubClient_Auth_Set_SasToken_Cache(handle, true);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+
+    //act
+    int result = IoTHubClient_Auth_Set_SasToken_Expiry(handle, 4800);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
 END_TEST_SUITE(iothub_client_authorization_ut)
@@ -0,0 +1,797 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_calloc(size_t nmemb, size_t size)
+{
+    return calloc(nmemb, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "azure_macro_utils/macro_utils.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umocktypes_bool.h"
+#include "umock_c/umocktypes_stdint.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "iothub_client_properties.h"
+#undef ENABLE_MOCKS
+
+#include "iothub_client_dispatcher.h"
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    (void)error_code;
+    ASSERT_FAIL("umock_c reported error");
+}
+
+#define TEST_COMPONENT_NAME_1 "testComponent1"
+#define TEST_COMPONENT_NAME_2 "testComponent2"
+#define TEST_COMMAND_NAME_1 "command1"
+#define TEST_COMMAND_NAME_2 "command2"
+#define TEST_PROP_NAME_1 "name1"
+#define TEST_PROP_NAME_2 "name2"
+#define TEST_PROP_VALUE "1234"
+#define TEST_PROPERTIES_VERSION 17
+
+static const IOTHUB_CLIENT_PROPERTIES_DESERIALIZER_HANDLE TEST_DESERIALIZER_HANDLE = (IOTHUB_CLIENT_PROPERTIES_DESERIALIZER_HANDLE)0x1234;
+static const unsigned char TEST_PAYLOAD[] = "{}";
+static void* TEST_ROOT_CONTEXT = (void*)0x1001;
+static void* TEST_COMPONENT_1_CONTEXT = (void*)0x1002;
+static void* TEST_COMPONENT_2_CONTEXT = (void*)0x1003;
+
+// Records which callbacks the dispatcher invoked.
+static int testCommand1Calls;
+static int testCommand2Calls;
+static void* testCommandContext;
+static const char* testCommandComponentName;
+static int testProperty1Calls;
+static int testProperty2Calls;
+static void* testPropertyContext;
+static const char* testPropertyComponentName;
+static int testPropertyVersion;
+
+static void test_command1_callback(const IOTHUB_CLIENT_COMMAND_REQUEST* commandRequest, IOTHUB_CLIENT_COMMAND_RESPONSE* commandResponse, void* userContextCallback)
+{
+    testCommand1Calls++;
+    testCommandContext = userContextCallback;
+    testCommandComponentName = commandRequest->componentName;
+    commandResponse->statusCode = 200;
+}
+
+static void test_command2_callback(const IOTHUB_CLIENT_COMMAND_REQUEST* commandRequest, IOTHUB_CLIENT_COMMAND_RESPONSE* commandResponse, void* userContextCallback)
+{
+    testCommand2Calls++;
+    testCommandContext = userContextCallback;
+    testCommandComponentName = commandRequest->componentName;
+    commandResponse->statusCode = 201;
+}
+
+static void test_property1_callback(const IOTHUB_CLIENT_PROPERTY_PARSED* property, int propertiesVersion, void* userContextCallback)
+{
+    testProperty1Calls++;
+    testPropertyContext = userContextCallback;
+    testPropertyComponentName = property->componentName;
+    testPropertyVersion = propertiesVersion;
+}
+
+static void test_property2_callback(const IOTHUB_CLIENT_PROPERTY_PARSED* property, int propertiesVersion, void* userContextCallback)
+{
+    testProperty2Calls++;
+    testPropertyContext = userContextCallback;
+    testPropertyComponentName = property->componentName;
+    testPropertyVersion = propertiesVersion;
+}
+
+static const IOTHUB_CLIENT_DISPATCHER_COMMAND TEST_COMMANDS[] = {
+    { TEST_COMMAND_NAME_2, test_command2_callback },
+    { TEST_COMMAND_NAME_1, test_command1_callback }
+};
+
+static const IOTHUB_CLIENT_DISPATCHER_PROPERTY TEST_PROPERTIES[] = {
+    { TEST_PROP_NAME_2, test_property2_callback },
+    { TEST_PROP_NAME_1, test_property1_callback }
+};
+
+// Components are deliberately not in name order, so that the tests exercise the sorting.
+static const IOTHUB_CLIENT_DISPATCHER_COMPONENT TEST_COMPONENTS[] = {
+    { IOTHUB_CLIENT_DISPATCHER_COMPONENT_STRUCT_VERSION_1, TEST_COMPONENT_NAME_2, TEST_COMMANDS, 1, TEST_PROPERTIES, 1, NULL },
+    { IOTHUB_CLIENT_DISPATCHER_COMPONENT_STRUCT_VERSION_1, TEST_COMPONENT_NAME_1, TEST_COMMANDS, 2, TEST_PROPERTIES, 2, NULL },
+    { IOTHUB_CLIENT_DISPATCHER_COMPONENT_STRUCT_VERSION_1, NULL, TEST_COMMANDS + 1, 1, NULL, 0, NULL }
+};
+
+#define TEST_NUM_COMPONENTS (sizeof(TEST_COMPONENTS) / sizeof(TEST_COMPONENTS[0]))
+
+// Properties returned, in order, by the IoTHubClient_Properties_Deserializer_GetNext hook.
+typedef struct TEST_PROPERTY_TAG
+{
+    IOTHUB_CLIENT_PROPERTY_TYPE propertyType;
+    const char* componentName;
+    const char* name;
+} TEST_PROPERTY;
+
+static const TEST_PROPERTY* testProperties;
+static size_t testNumProperties;
+static size_t testNextProperty;
+
+static IOTHUB_CLIENT_RESULT my_IoTHubClient_Properties_Deserializer_Create(IOTHUB_CLIENT_PROPERTY_PAYLOAD_TYPE payloadType, const unsigned char* payload, size_t payloadLength, IOTHUB_CLIENT_PROPERTIES_DESERIALIZER_HANDLE* propertiesDeserializerHandle)
+{
+    (void)payloadType;
+    (void)payload;
+    (void)payloadLength;
+    *propertiesDeserializerHandle = TEST_DESERIALIZER_HANDLE;
+    return IOTHUB_CLIENT_OK;
+}
+
+static IOTHUB_CLIENT_RESULT my_IoTHubClient_Properties_Deserializer_GetVersion(IOTHUB_CLIENT_PROPERTIES_DESERIALIZER_HANDLE propertiesDeserializerHandle, int* propertiesVersion)
+{
+    (void)propertiesDeserializerHandle;
+    *propertiesVersion = TEST_PROPERTIES_VERSION;
+    return IOTHUB_CLIENT_OK;
+}
+
+static IOTHUB_CLIENT_RESULT my_IoTHubClient_Properties_Deserializer_GetNext(IOTHUB_CLIENT_PROPERTIES_DESERIALIZER_HANDLE propertiesDeserializerHandle, IOTHUB_CLIENT_PROPERTY_PARSED* property, bool* propertySpecified)
+{
+    (void)propertiesDeserializerHandle;
+
+    if (testNextProperty < testNumProperties)
+    {
+        property->propertyType = testProperties[testNextProperty].propertyType;
+        property->componentName = testProperties[testNextProperty].componentName;
+        property->name = testProperties[testNextProperty].name;
+        property->valueType = IOTHUB_CLIENT_PROPERTY_VALUE_STRING;
+        property->value.str = TEST_PROP_VALUE;
+        property->valueLength = sizeof(TEST_PROP_VALUE) - 1;
+        testNextProperty++;
+        *propertySpecified = true;
+    }
+    else
+    {
+        *propertySpecified = false;
+    }
+
+    return IOTHUB_CLIENT_OK;
+}
+
+static IOTHUB_CLIENT_DISPATCHER_HANDLE create_test_dispatcher(void)
+{
+    IOTHUB_CLIENT_DISPATCHER_COMPONENT components[TEST_NUM_COMPONENTS];
+
+    memcpy(components, TEST_COMPONENTS, sizeof(TEST_COMPONENTS));
+    components[0].userContextCallback = TEST_COMPONENT_2_CONTEXT;
+    components[1].userContextCallback = TEST_COMPONENT_1_CONTEXT;
+    components[2].userContextCallback = TEST_ROOT_CONTEXT;
+
+    IOTHUB_CLIENT_DISPATCHER_HANDLE result = IoTHubClient_Dispatcher_Create(components, TEST_NUM_COMPONENTS);
+    ASSERT_IS_NOT_NULL(result);
+    umock_c_reset_all_calls();
+    return result;
+}
+
+static void set_command_request(IOTHUB_CLIENT_COMMAND_REQUEST* commandRequest, const char* componentName, const char* commandName)
+{
+    memset(commandRequest, 0, sizeof(*commandRequest));
+    commandRequest->structVersion = IOTHUB_CLIENT_COMMAND_REQUEST_STRUCT_VERSION_1;
+    commandRequest->componentName = componentName;
+    commandRequest->commandName = commandName;
+}
+
+BEGIN_TEST_SUITE(iothub_client_dispatcher_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+
+    umock_c_init(on_umock_c_error);
+
+    result = umocktypes_bool_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_PROPERTY_PAYLOAD_TYPE, int);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_PROPERTIES_DESERIALIZER_HANDLE, void*);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_calloc, my_gballoc_calloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_calloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_Properties_Deserializer_Create, my_IoTHubClient_Properties_Deserializer_Create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_Properties_Deserializer_Create, IOTHUB_CLIENT_ERROR);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_Properties_Deserializer_GetVersion, my_IoTHubClient_Properties_Deserializer_GetVersion);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_Properties_Deserializer_GetVersion, IOTHUB_CLIENT_ERROR);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_Properties_Deserializer_GetNext, my_IoTHubClient_Properties_Deserializer_GetNext);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_Properties_Deserializer_GetNext, IOTHUB_CLIENT_ERROR);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    umock_c_reset_all_calls();
+
+    testCommand1Calls = 0;
+    testCommand2Calls = 0;
+    testCommandContext = NULL;
+    testCommandComponentName = NULL;
+    testProperty1Calls = 0;
+    testProperty2Calls = 0;
+    testPropertyContext = NULL;
+    testPropertyComponentName = NULL;
+    testPropertyVersion = 0;
+    testProperties = NULL;
+    testNumProperties = 0;
+    testNextProperty = 0;
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+}
+
+//
+// IoTHubClient_Dispatcher_Create tests
+//
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_NULL_components_fails)
+{
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(NULL, 1);
+
+    // assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_zero_components_fails)
+{
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(TEST_COMPONENTS, 0);
+
+    // assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_wrong_struct_version_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_COMPONENT component = TEST_COMPONENTS[0];
+    component.structVersion = 2;
+
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(&component, 1);
+
+    // assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_NULL_commands_with_count_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_COMPONENT component = TEST_COMPONENTS[0];
+    component.commands = NULL;
+
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(&component, 1);
+
+    // assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_NULL_properties_with_count_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_COMPONENT component = TEST_COMPONENTS[0];
+    component.writableProperties = NULL;
+
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(&component, 1);
+
+    // assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_NULL_command_name_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_COMMAND command = { NULL, test_command1_callback };
+    IOTHUB_CLIENT_DISPATCHER_COMPONENT component = TEST_COMPONENTS[0];
+    component.commands = &command;
+
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(&component, 1);
+
+    // assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_NULL_command_callback_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_COMMAND command = { TEST_COMMAND_NAME_1, NULL };
+    IOTHUB_CLIENT_DISPATCHER_COMPONENT component = TEST_COMPONENTS[0];
+    component.commands = &command;
+
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(&component, 1);
+
+    // assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_NULL_property_name_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_PROPERTY property = { NULL, test_property1_callback };
+    IOTHUB_CLIENT_DISPATCHER_COMPONENT component = TEST_COMPONENTS[0];
+    component.writableProperties = &property;
+
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(&component, 1);
+
+    // assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_NULL_property_callback_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_PROPERTY property = { TEST_PROP_NAME_1, NULL };
+    IOTHUB_CLIENT_DISPATCHER_COMPONENT component = TEST_COMPONENTS[0];
+    component.writableProperties = &property;
+
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(&component, 1);
+
+    // assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_duplicate_component_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_COMPONENT components[2];
+    components[0] = TEST_COMPONENTS[1];
+    components[1] = TEST_COMPONENTS[1];
+
+    STRICT_EXPECTED_CALL(gballoc_calloc(1, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(components, 2);
+
+    // assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_duplicate_root_component_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_COMPONENT components[2];
+    components[0] = TEST_COMPONENTS[2];
+    components[1] = TEST_COMPONENTS[2];
+
+    STRICT_EXPECTED_CALL(gballoc_calloc(1, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(components, 2);
+
+    // assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_duplicate_command_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_COMMAND commands[] = { { TEST_COMMAND_NAME_1, test_command1_callback }, { TEST_COMMAND_NAME_1, test_command2_callback } };
+    IOTHUB_CLIENT_DISPATCHER_COMPONENT component = TEST_COMPONENTS[0];
+    component.commands = commands;
+    component.numCommands = 2;
+
+    STRICT_EXPECTED_CALL(gballoc_calloc(1, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(&component, 1);
+
+    // assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_duplicate_property_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_PROPERTY properties[] = { { TEST_PROP_NAME_1, test_property1_callback }, { TEST_PROP_NAME_1, test_property2_callback } };
+    IOTHUB_CLIENT_DISPATCHER_COMPONENT component = TEST_COMPONENTS[0];
+    component.writableProperties = properties;
+    component.numWritableProperties = 2;
+
+    STRICT_EXPECTED_CALL(gballoc_calloc(1, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(&component, 1);
+
+    // assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_success)
+{
+    // arrange
+    STRICT_EXPECTED_CALL(gballoc_calloc(1, IGNORED_ARG));
+
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(TEST_COMPONENTS, TEST_NUM_COMPONENTS);
+
+    // assert
+    ASSERT_IS_NOT_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Dispatcher_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_component_without_commands_or_properties_success)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_COMPONENT component = { IOTHUB_CLIENT_DISPATCHER_COMPONENT_STRUCT_VERSION_1, TEST_COMPONENT_NAME_1, NULL, 0, NULL, 0, NULL };
+
+    STRICT_EXPECTED_CALL(gballoc_calloc(1, IGNORED_ARG));
+
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(&component, 1);
+
+    // assert
+    ASSERT_IS_NOT_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Dispatcher_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Create_alloc_fails)
+{
+    // arrange
+    STRICT_EXPECTED_CALL(gballoc_calloc(1, IGNORED_ARG)).SetReturn(NULL);
+
+    // act
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = IoTHubClient_Dispatcher_Create(TEST_COMPONENTS, TEST_NUM_COMPONENTS);
+
+    // assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+//
+// IoTHubClient_Dispatcher_CommandCallback tests
+//
+TEST_FUNCTION(IoTHubClient_Dispatcher_CommandCallback_NULL_dispatcher_does_nothing)
+{
+    // arrange
+    IOTHUB_CLIENT_COMMAND_REQUEST commandRequest;
+    IOTHUB_CLIENT_COMMAND_RESPONSE commandResponse;
+    set_command_request(&commandRequest, TEST_COMPONENT_NAME_1, TEST_COMMAND_NAME_1);
+    memset(&commandResponse, 0, sizeof(commandResponse));
+
+    // act
+    IoTHubClient_Dispatcher_CommandCallback(&commandRequest, &commandResponse, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, testCommand1Calls);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_CommandCallback_routes_component_command)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = create_test_dispatcher();
+    IOTHUB_CLIENT_COMMAND_REQUEST commandRequest;
+    IOTHUB_CLIENT_COMMAND_RESPONSE commandResponse;
+    set_command_request(&commandRequest, TEST_COMPONENT_NAME_1, TEST_COMMAND_NAME_2);
+    memset(&commandResponse, 0, sizeof(commandResponse));
+
+    // act
+    IoTHubClient_Dispatcher_CommandCallback(&commandRequest, &commandResponse, h);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, testCommand1Calls);
+    ASSERT_ARE_EQUAL(int, 1, testCommand2Calls);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_COMPONENT_1_CONTEXT, testCommandContext);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_COMPONENT_NAME_1, testCommandComponentName);
+    ASSERT_ARE_EQUAL(int, 201, commandResponse.statusCode);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Dispatcher_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_CommandCallback_routes_root_command)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = create_test_dispatcher();
+    IOTHUB_CLIENT_COMMAND_REQUEST commandRequest;
+    IOTHUB_CLIENT_COMMAND_RESPONSE commandResponse;
+    set_command_request(&commandRequest, NULL, TEST_COMMAND_NAME_1);
+    memset(&commandResponse, 0, sizeof(commandResponse));
+
+    // act
+    IoTHubClient_Dispatcher_CommandCallback(&commandRequest, &commandResponse, h);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 1, testCommand1Calls);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_ROOT_CONTEXT, testCommandContext);
+    ASSERT_ARE_EQUAL(int, 200, commandResponse.statusCode);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Dispatcher_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_CommandCallback_undeclared_command_not_found)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = create_test_dispatcher();
+    IOTHUB_CLIENT_COMMAND_REQUEST commandRequest;
+    IOTHUB_CLIENT_COMMAND_RESPONSE commandResponse;
+    // TEST_COMMAND_NAME_1 is only declared on TEST_COMPONENT_NAME_1 and the root component.
+    set_command_request(&commandRequest, TEST_COMPONENT_NAME_2, TEST_COMMAND_NAME_1);
+    memset(&commandResponse, 0, sizeof(commandResponse));
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(2));
+
+    // act
+    IoTHubClient_Dispatcher_CommandCallback(&commandRequest, &commandResponse, h);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, testCommand1Calls);
+    ASSERT_ARE_EQUAL(int, 0, testCommand2Calls);
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_DISPATCHER_COMMAND_NOT_FOUND_STATUS, commandResponse.statusCode);
+    ASSERT_ARE_EQUAL(size_t, 2, commandResponse.payloadLength);
+    ASSERT_IS_TRUE(memcmp("{}", commandResponse.payload, 2) == 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    my_gballoc_free(commandResponse.payload);
+    IoTHubClient_Dispatcher_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_CommandCallback_undeclared_component_not_found)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = create_test_dispatcher();
+    IOTHUB_CLIENT_COMMAND_REQUEST commandRequest;
+    IOTHUB_CLIENT_COMMAND_RESPONSE commandResponse;
+    set_command_request(&commandRequest, "unknownComponent", TEST_COMMAND_NAME_1);
+    memset(&commandResponse, 0, sizeof(commandResponse));
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(2));
+
+    // act
+    IoTHubClient_Dispatcher_CommandCallback(&commandRequest, &commandResponse, h);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, testCommand1Calls);
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_DISPATCHER_COMMAND_NOT_FOUND_STATUS, commandResponse.statusCode);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    my_gballoc_free(commandResponse.payload);
+    IoTHubClient_Dispatcher_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_CommandCallback_not_found_alloc_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = create_test_dispatcher();
+    IOTHUB_CLIENT_COMMAND_REQUEST commandRequest;
+    IOTHUB_CLIENT_COMMAND_RESPONSE commandResponse;
+    set_command_request(&commandRequest, TEST_COMPONENT_NAME_2, "unknownCommand");
+    memset(&commandResponse, 0, sizeof(commandResponse));
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(2)).SetReturn(NULL);
+
+    // act
+    IoTHubClient_Dispatcher_CommandCallback(&commandRequest, &commandResponse, h);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_DISPATCHER_COMMAND_NOT_FOUND_STATUS, commandResponse.statusCode);
+    ASSERT_IS_NULL(commandResponse.payload);
+    ASSERT_ARE_EQUAL(size_t, 0, commandResponse.payloadLength);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Dispatcher_Destroy(h);
+}
+
+//
+// IoTHubClient_Dispatcher_PropertiesCallback tests
+//
+static void set_expected_calls_for_PropertiesCallback(size_t numProperties)
+{
+    STRICT_EXPECTED_CALL(IoTHubClient_Properties_Deserializer_Create(IOTHUB_CLIENT_PROPERTY_PAYLOAD_WRITABLE_UPDATES, TEST_PAYLOAD, sizeof(TEST_PAYLOAD) - 1, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Properties_Deserializer_GetVersion(TEST_DESERIALIZER_HANDLE, IGNORED_ARG));
+    for (size_t i = 0; i < numProperties; i++)
+    {
+        STRICT_EXPECTED_CALL(IoTHubClient_Properties_Deserializer_GetNext(TEST_DESERIALIZER_HANDLE, IGNORED_ARG, IGNORED_ARG));
+        STRICT_EXPECTED_CALL(IoTHubClient_Properties_DeserializerProperty_Destroy(IGNORED_ARG));
+    }
+    STRICT_EXPECTED_CALL(IoTHubClient_Properties_Deserializer_GetNext(TEST_DESERIALIZER_HANDLE, IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Properties_Deserializer_Destroy(TEST_DESERIALIZER_HANDLE));
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_PropertiesCallback_NULL_dispatcher_does_nothing)
+{
+    // act
+    IoTHubClient_Dispatcher_PropertiesCallback(IOTHUB_CLIENT_PROPERTY_PAYLOAD_WRITABLE_UPDATES, TEST_PAYLOAD, sizeof(TEST_PAYLOAD) - 1, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_PropertiesCallback_routes_writable_properties)
+{
+    // arrange
+    static const TEST_PROPERTY properties[] = {
+        { IOTHUB_CLIENT_PROPERTY_TYPE_WRITABLE, TEST_COMPONENT_NAME_1, TEST_PROP_NAME_1 },
+        { IOTHUB_CLIENT_PROPERTY_TYPE_WRITABLE, TEST_COMPONENT_NAME_2, TEST_PROP_NAME_2 }
+    };
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = create_test_dispatcher();
+    testProperties = properties;
+    testNumProperties = 2;
+
+    set_expected_calls_for_PropertiesCallback(2);
+
+    // act
+    IoTHubClient_Dispatcher_PropertiesCallback(IOTHUB_CLIENT_PROPERTY_PAYLOAD_WRITABLE_UPDATES, TEST_PAYLOAD, sizeof(TEST_PAYLOAD) - 1, h);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 1, testProperty1Calls);
+    ASSERT_ARE_EQUAL(int, 1, testProperty2Calls);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_COMPONENT_2_CONTEXT, testPropertyContext);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_COMPONENT_NAME_2, testPropertyComponentName);
+    ASSERT_ARE_EQUAL(int, TEST_PROPERTIES_VERSION, testPropertyVersion);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Dispatcher_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_PropertiesCallback_skips_reported_and_undeclared_properties)
+{
+    // arrange
+    static const TEST_PROPERTY properties[] = {
+        { IOTHUB_CLIENT_PROPERTY_TYPE_REPORTED_FROM_CLIENT, TEST_COMPONENT_NAME_1, TEST_PROP_NAME_1 },
+        // TEST_PROP_NAME_2 is only declared on TEST_COMPONENT_NAME_1 and TEST_COMPONENT_NAME_2.
+        { IOTHUB_CLIENT_PROPERTY_TYPE_WRITABLE, NULL, TEST_PROP_NAME_2 },
+        { IOTHUB_CLIENT_PROPERTY_TYPE_WRITABLE, "unknownComponent", TEST_PROP_NAME_1 },
+        { IOTHUB_CLIENT_PROPERTY_TYPE_WRITABLE, TEST_COMPONENT_NAME_2, "unknownProperty" }
+    };
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = create_test_dispatcher();
+    testProperties = properties;
+    testNumProperties = 4;
+
+    set_expected_calls_for_PropertiesCallback(4);
+
+    // act
+    IoTHubClient_Dispatcher_PropertiesCallback(IOTHUB_CLIENT_PROPERTY_PAYLOAD_WRITABLE_UPDATES, TEST_PAYLOAD, sizeof(TEST_PAYLOAD) - 1, h);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, testProperty1Calls);
+    ASSERT_ARE_EQUAL(int, 0, testProperty2Calls);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Dispatcher_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_PropertiesCallback_deserializer_create_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = create_test_dispatcher();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_Properties_Deserializer_Create(IOTHUB_CLIENT_PROPERTY_PAYLOAD_WRITABLE_UPDATES, TEST_PAYLOAD, sizeof(TEST_PAYLOAD) - 1, IGNORED_ARG)).SetReturn(IOTHUB_CLIENT_ERROR);
+
+    // act
+    IoTHubClient_Dispatcher_PropertiesCallback(IOTHUB_CLIENT_PROPERTY_PAYLOAD_WRITABLE_UPDATES, TEST_PAYLOAD, sizeof(TEST_PAYLOAD) - 1, h);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Dispatcher_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_PropertiesCallback_get_version_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = create_test_dispatcher();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_Properties_Deserializer_Create(IOTHUB_CLIENT_PROPERTY_PAYLOAD_WRITABLE_UPDATES, TEST_PAYLOAD, sizeof(TEST_PAYLOAD) - 1, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Properties_Deserializer_GetVersion(TEST_DESERIALIZER_HANDLE, IGNORED_ARG)).SetReturn(IOTHUB_CLIENT_ERROR);
+    STRICT_EXPECTED_CALL(IoTHubClient_Properties_Deserializer_Destroy(TEST_DESERIALIZER_HANDLE));
+
+    // act
+    IoTHubClient_Dispatcher_PropertiesCallback(IOTHUB_CLIENT_PROPERTY_PAYLOAD_WRITABLE_UPDATES, TEST_PAYLOAD, sizeof(TEST_PAYLOAD) - 1, h);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Dispatcher_Destroy(h);
+}
+
+//
+// IoTHubClient_Dispatcher_Destroy tests
+//
+TEST_FUNCTION(IoTHubClient_Dispatcher_Destroy_NULL_does_nothing)
+{
+    // act
+    IoTHubClient_Dispatcher_Destroy(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClient_Dispatcher_Destroy_success)
+{
+    // arrange
+    IOTHUB_CLIENT_DISPATCHER_HANDLE h = create_test_dispatcher();
+
+    STRICT_EXPECTED_CALL(gballoc_free(h));
+
+    // act
+    IoTHubClient_Dispatcher_Destroy(h);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+END_TEST_SUITE(iothub_client_dispatcher_ut)
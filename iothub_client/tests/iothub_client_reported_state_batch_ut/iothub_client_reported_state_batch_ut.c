@@ -0,0 +1,434 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "azure_macro_utils/macro_utils.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umocktypes_stdint.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+
+MOCKABLE_FUNCTION(, void, test_reported_state_callback, int, status_code, void*, userContextCallback);
+#undef ENABLE_MOCKS
+
+#include "internal/iothub_client_reported_state_batch.h"
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    (void)error_code;
+    ASSERT_FAIL("umock_c reported error");
+}
+
+#define TEST_CONTEXT_1 ((void*)0x4401)
+#define TEST_CONTEXT_2 ((void*)0x4402)
+#define TEST_CONTEXT_3 ((void*)0x4403)
+#define TEST_STATUS_CODE 204
+
+#define TEST_REPORTED_STATE_1 "{\"temperature\":20,\"mode\":\"eco\",\"settings\":{\"fan\":1,\"light\":true}}"
+#define TEST_REPORTED_STATE_2 "{\"temperature\":21,\"settings\":{\"fan\":2,\"light\":null}}"
+#define TEST_REPORTED_STATE_3 "{\"mode\":null,\"humidity\":40}"
+#define TEST_MERGED_REPORTED_STATE_1_2 "{\"temperature\":21,\"mode\":\"eco\",\"settings\":{\"fan\":2,\"light\":null}}"
+#define TEST_MERGED_REPORTED_STATE_1_2_3 "{\"temperature\":21,\"mode\":null,\"settings\":{\"fan\":2,\"light\":null},\"humidity\":40}"
+#define TEST_REPORTED_STATE_NESTED_OBJECT "{\"settings\":{\"light\":{\"level\":3}}}"
+#define TEST_REPORTED_STATE_OBJECT_REMOVED "{\"settings\":null}"
+
+static int add_reported_state(REPORTED_STATE_BATCH_HANDLE batch, const char* reportedState, void* context)
+{
+    return reported_state_batch_add(batch, (const unsigned char*)reportedState, strlen(reportedState), test_reported_state_callback, context);
+}
+
+static bool reported_state_conflicts(REPORTED_STATE_BATCH_HANDLE batch, const char* reportedState)
+{
+    return reported_state_batch_conflicts(batch, (const unsigned char*)reportedState, strlen(reportedState));
+}
+
+static char* flush_reported_state(REPORTED_STATE_BATCH_HANDLE batch, void** completionContext)
+{
+    const unsigned char* reportedState = NULL;
+    size_t size = 0;
+    char* result;
+
+    ASSERT_ARE_EQUAL(int, 0, reported_state_batch_flush(batch, &reportedState, &size, completionContext));
+    ASSERT_IS_NOT_NULL(reportedState);
+
+    // Copy so that the result can be compared once the batch is destroyed
+    result = (char*)my_gballoc_malloc(size + 1);
+    ASSERT_IS_NOT_NULL(result);
+    (void)memcpy(result, reportedState, size);
+    result[size] = '\0';
+
+    return result;
+}
+
+BEGIN_TEST_SUITE(iothub_client_reported_state_batch_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+
+    umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    umock_c_negative_tests_deinit();
+}
+
+TEST_FUNCTION(reported_state_batch_create_succeeds)
+{
+    // arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_ARG));
+
+    // act
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+
+    // assert
+    ASSERT_IS_NOT_NULL(batch);
+    ASSERT_ARE_EQUAL(size_t, 0, reported_state_batch_get_count(batch));
+    ASSERT_ARE_EQUAL(size_t, 0, reported_state_batch_get_size(batch));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    reported_state_batch_destroy(batch);
+}
+
+TEST_FUNCTION(reported_state_batch_create_malloc_fails)
+{
+    // arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_ARG)).SetReturn(NULL);
+
+    // act
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+
+    // assert
+    ASSERT_IS_NULL(batch);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(reported_state_batch_add_NULL_handle_fails)
+{
+    // arrange
+
+    // act
+    int result = add_reported_state(NULL, TEST_REPORTED_STATE_1, TEST_CONTEXT_1);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+TEST_FUNCTION(reported_state_batch_add_invalid_json_fails)
+{
+    // arrange
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+
+    // act
+    int result = add_reported_state(batch, "{\"temperature\":", TEST_CONTEXT_1);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 0, reported_state_batch_get_count(batch));
+
+    // cleanup
+    reported_state_batch_destroy(batch);
+}
+
+TEST_FUNCTION(reported_state_batch_add_not_an_object_fails)
+{
+    // arrange
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+
+    // act
+    int result = add_reported_state(batch, "[1,2]", TEST_CONTEXT_1);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 0, reported_state_batch_get_count(batch));
+
+    // cleanup
+    reported_state_batch_destroy(batch);
+}
+
+TEST_FUNCTION(reported_state_batch_add_single_succeeds)
+{
+    // arrange
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+    void* completion;
+
+    // act
+    int result = add_reported_state(batch, TEST_REPORTED_STATE_1, TEST_CONTEXT_1);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, reported_state_batch_get_count(batch));
+    ASSERT_ARE_EQUAL(size_t, strlen(TEST_REPORTED_STATE_1), reported_state_batch_get_size(batch));
+
+    char* flushed = flush_reported_state(batch, &completion);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_REPORTED_STATE_1, flushed);
+
+    // cleanup
+    my_gballoc_free(flushed);
+    reported_state_batch_complete(TEST_STATUS_CODE, completion);
+    reported_state_batch_destroy(batch);
+}
+
+TEST_FUNCTION(reported_state_batch_add_merges_last_writer_wins)
+{
+    // arrange
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+    void* completion;
+
+    // act
+    ASSERT_ARE_EQUAL(int, 0, add_reported_state(batch, TEST_REPORTED_STATE_1, TEST_CONTEXT_1));
+    ASSERT_ARE_EQUAL(int, 0, add_reported_state(batch, TEST_REPORTED_STATE_2, TEST_CONTEXT_2));
+    char* flushed = flush_reported_state(batch, &completion);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MERGED_REPORTED_STATE_1_2, flushed);
+    ASSERT_ARE_EQUAL(size_t, 0, reported_state_batch_get_count(batch));
+
+    // cleanup
+    my_gballoc_free(flushed);
+    reported_state_batch_complete(TEST_STATUS_CODE, completion);
+    reported_state_batch_destroy(batch);
+}
+
+TEST_FUNCTION(reported_state_batch_add_keeps_null_values)
+{
+    // arrange
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+    void* completion;
+
+    // act
+    ASSERT_ARE_EQUAL(int, 0, add_reported_state(batch, TEST_REPORTED_STATE_1, TEST_CONTEXT_1));
+    ASSERT_ARE_EQUAL(int, 0, add_reported_state(batch, TEST_REPORTED_STATE_2, TEST_CONTEXT_2));
+    ASSERT_ARE_EQUAL(int, 0, add_reported_state(batch, TEST_REPORTED_STATE_3, TEST_CONTEXT_3));
+    char* flushed = flush_reported_state(batch, &completion);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MERGED_REPORTED_STATE_1_2_3, flushed);
+
+    // cleanup
+    my_gballoc_free(flushed);
+    reported_state_batch_complete(TEST_STATUS_CODE, completion);
+    reported_state_batch_destroy(batch);
+}
+
+TEST_FUNCTION(reported_state_batch_conflicts_empty_batch_returns_false)
+{
+    // arrange
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+
+    // act
+    bool result = reported_state_conflicts(batch, TEST_REPORTED_STATE_1);
+
+    // assert
+    ASSERT_IS_FALSE(result);
+
+    // cleanup
+    reported_state_batch_destroy(batch);
+}
+
+TEST_FUNCTION(reported_state_batch_conflicts_mergeable_patch_returns_false)
+{
+    // arrange
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+    ASSERT_ARE_EQUAL(int, 0, add_reported_state(batch, TEST_REPORTED_STATE_1, TEST_CONTEXT_1));
+
+    // act
+    bool result = reported_state_conflicts(batch, TEST_REPORTED_STATE_2);
+
+    // assert
+    ASSERT_IS_FALSE(result);
+
+    // cleanup
+    reported_state_batch_abandon(batch, TEST_STATUS_CODE);
+    reported_state_batch_destroy(batch);
+}
+
+TEST_FUNCTION(reported_state_batch_conflicts_null_then_nested_object_returns_true)
+{
+    // arrange
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+    ASSERT_ARE_EQUAL(int, 0, add_reported_state(batch, TEST_REPORTED_STATE_1, TEST_CONTEXT_1));
+    ASSERT_ARE_EQUAL(int, 0, add_reported_state(batch, TEST_REPORTED_STATE_2, TEST_CONTEXT_2));
+
+    // act
+    // "settings.light" is pending as null: sending the object after it must not keep what "light" had before
+    bool result = reported_state_conflicts(batch, TEST_REPORTED_STATE_NESTED_OBJECT);
+
+    // assert
+    ASSERT_IS_TRUE(result);
+
+    // cleanup
+    reported_state_batch_abandon(batch, TEST_STATUS_CODE);
+    reported_state_batch_destroy(batch);
+}
+
+TEST_FUNCTION(reported_state_batch_conflicts_object_then_null_returns_true)
+{
+    // arrange
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+    ASSERT_ARE_EQUAL(int, 0, add_reported_state(batch, TEST_REPORTED_STATE_1, TEST_CONTEXT_1));
+
+    // act
+    bool result = reported_state_conflicts(batch, TEST_REPORTED_STATE_OBJECT_REMOVED);
+
+    // assert
+    ASSERT_IS_TRUE(result);
+
+    // cleanup
+    reported_state_batch_abandon(batch, TEST_STATUS_CODE);
+    reported_state_batch_destroy(batch);
+}
+
+TEST_FUNCTION(reported_state_batch_flush_empty_fails)
+{
+    // arrange
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+    const unsigned char* reportedState;
+    size_t size;
+    void* completion;
+
+    // act
+    int result = reported_state_batch_flush(batch, &reportedState, &size, &completion);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    reported_state_batch_destroy(batch);
+}
+
+TEST_FUNCTION(reported_state_batch_complete_calls_every_caller)
+{
+    // arrange
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+    void* completion;
+    (void)add_reported_state(batch, TEST_REPORTED_STATE_1, TEST_CONTEXT_1);
+    (void)add_reported_state(batch, TEST_REPORTED_STATE_2, TEST_CONTEXT_2);
+    (void)reported_state_batch_add(batch, (const unsigned char*)TEST_REPORTED_STATE_3, strlen(TEST_REPORTED_STATE_3), NULL, NULL);
+    char* flushed = flush_reported_state(batch, &completion);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_reported_state_callback(TEST_STATUS_CODE, TEST_CONTEXT_1));
+    STRICT_EXPECTED_CALL(test_reported_state_callback(TEST_STATUS_CODE, TEST_CONTEXT_2));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(completion));
+
+    // act
+    reported_state_batch_complete(TEST_STATUS_CODE, completion);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    my_gballoc_free(flushed);
+    reported_state_batch_destroy(batch);
+}
+
+TEST_FUNCTION(reported_state_batch_add_after_flush_starts_new_batch)
+{
+    // arrange
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+    void* completion_1;
+    void* completion_2;
+    (void)add_reported_state(batch, TEST_REPORTED_STATE_1, TEST_CONTEXT_1);
+    char* flushed_1 = flush_reported_state(batch, &completion_1);
+
+    // act
+    ASSERT_ARE_EQUAL(int, 0, add_reported_state(batch, TEST_REPORTED_STATE_3, TEST_CONTEXT_3));
+    char* flushed_2 = flush_reported_state(batch, &completion_2);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_REPORTED_STATE_3, flushed_2);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(test_reported_state_callback(TEST_STATUS_CODE, TEST_CONTEXT_1));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(completion_1));
+    reported_state_batch_complete(TEST_STATUS_CODE, completion_1);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    my_gballoc_free(flushed_1);
+    my_gballoc_free(flushed_2);
+    reported_state_batch_complete(TEST_STATUS_CODE, completion_2);
+    reported_state_batch_destroy(batch);
+}
+
+TEST_FUNCTION(reported_state_batch_abandon_calls_every_pending_caller)
+{
+    // arrange
+    REPORTED_STATE_BATCH_HANDLE batch = reported_state_batch_create();
+    (void)add_reported_state(batch, TEST_REPORTED_STATE_1, TEST_CONTEXT_1);
+    (void)add_reported_state(batch, TEST_REPORTED_STATE_2, TEST_CONTEXT_2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_reported_state_callback(TEST_STATUS_CODE, TEST_CONTEXT_1));
+    STRICT_EXPECTED_CALL(test_reported_state_callback(TEST_STATUS_CODE, TEST_CONTEXT_2));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+
+    // act
+    reported_state_batch_abandon(batch, TEST_STATUS_CODE);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, reported_state_batch_get_count(batch));
+
+    // cleanup
+    reported_state_batch_destroy(batch);
+}
+
+END_TEST_SUITE(iothub_client_reported_state_batch_ut)
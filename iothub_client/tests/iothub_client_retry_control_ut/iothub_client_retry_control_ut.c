@@ -125,6 +125,12 @@ static void run_and_verify_should_retry(RETRY_CONTROL_HANDLE handle, time_t firs
 {
     tickcounter_ms_t tickcount;
 
+    // Elapsed times are computed from the tick counter, so they are implied by current_time.
+    (void)first_retry_time;
+    (void)last_retry_time;
+    (void)secs_since_first_retry;
+    (void)secs_since_last_retry;
+
     // arrange
     umock_c_reset_all_calls();
     if (is_first_check)
@@ -137,12 +143,6 @@ static void run_and_verify_should_retry(RETRY_CONTROL_HANDLE handle, time_t firs
     {
         tickcount = SECONDS_TO_TICKS(current_time);
         STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&tickcount, sizeof(tickcount));
-        STRICT_EXPECTED_CALL(get_difftime(current_time, first_retry_time)).SetReturn(secs_since_first_retry);
-
-        if (expected_retry_action != RETRY_ACTION_STOP_RETRYING)
-        {
-            STRICT_EXPECTED_CALL(get_difftime(current_time, last_retry_time)).SetReturn(secs_since_last_retry);
-        }
     }
 
     if (expected_retry_action == RETRY_ACTION_RETRY_NOW)
@@ -246,7 +246,6 @@ static void register_global_mock_returns()
 
     REGISTER_GLOBAL_MOCK_RETURN(OptionHandler_FeedOptions, OPTIONHANDLER_OK);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(OptionHandler_FeedOptions, OPTIONHANDLER_ERROR);
-    REGISTER_GLOBAL_MOCK_RETURN(tickcounter_create, TEST_TICKCOUNTER_HANDLE);
 }
 
 
@@ -254,9 +253,8 @@ static RETRY_CONTROL_HANDLE create_retry_control(IOTHUB_CLIENT_RETRY_POLICY poli
 {
     umock_c_reset_all_calls();
     EXPECTED_CALL(malloc(IGNORED_ARG));
-    EXPECTED_CALL(tickcounter_create());
     EXPECTED_CALL(malloc(IGNORED_ARG));
-    RETRY_CONTROL_HANDLE handle = retry_control_create(policy_name, max_retry_time_in_secs);
+    RETRY_CONTROL_HANDLE handle = retry_control_create(policy_name, max_retry_time_in_secs, TEST_TICKCOUNTER_HANDLE);
 
     return handle;
 }
@@ -321,7 +319,7 @@ TEST_FUNCTION(create_malloc_fails)
     umock_c_negative_tests_fail_call(0);
 
     // act
-    RETRY_CONTROL_HANDLE handle = retry_control_create(IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, 10);
+    RETRY_CONTROL_HANDLE handle = retry_control_create(IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, 10, TEST_TICKCOUNTER_HANDLE);
 
     // assert
     ASSERT_IS_NULL(handle);
@@ -332,29 +330,19 @@ TEST_FUNCTION(create_malloc_fails)
     umock_c_reset_all_calls();
 }
 
-TEST_FUNCTION(tickcounter_create_fails)
+TEST_FUNCTION(create_NULL_tick_counter)
 {
     // arrange
-    ASSERT_ARE_EQUAL(int, 0, umock_c_negative_tests_init());
-
     umock_c_reset_all_calls();
-    EXPECTED_CALL(malloc(IGNORED_ARG));
-    EXPECTED_CALL(tickcounter_create());
-    EXPECTED_CALL(free(IGNORED_ARG));
-    umock_c_negative_tests_snapshot();
-
-    umock_c_negative_tests_fail_call(1);
 
     // act
-    RETRY_CONTROL_HANDLE handle = retry_control_create(IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, 10);
+    RETRY_CONTROL_HANDLE handle = retry_control_create(IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, 10, NULL);
 
     // assert
     ASSERT_IS_NULL(handle);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
-    umock_c_negative_tests_deinit();
-    umock_c_reset_all_calls();
 }
 
 TEST_FUNCTION(create_success)
@@ -362,10 +350,9 @@ TEST_FUNCTION(create_success)
     // arrange
     umock_c_reset_all_calls();
     EXPECTED_CALL(malloc(IGNORED_ARG));
-    EXPECTED_CALL(tickcounter_create());
 
     // act
-    RETRY_CONTROL_HANDLE handle = retry_control_create(IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, 10);
+    RETRY_CONTROL_HANDLE handle = retry_control_create(IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, 10, TEST_TICKCOUNTER_HANDLE);
 
     // assert
     ASSERT_IS_NOT_NULL(handle);
@@ -394,12 +381,10 @@ TEST_FUNCTION(destroy_success)
     // arrange
     umock_c_reset_all_calls();
     EXPECTED_CALL(malloc(IGNORED_ARG));
-    EXPECTED_CALL(tickcounter_create());
     EXPECTED_CALL(malloc(IGNORED_ARG));
-    RETRY_CONTROL_HANDLE handle = retry_control_create(IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, 10);
+    RETRY_CONTROL_HANDLE handle = retry_control_create(IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, 10, TEST_TICKCOUNTER_HANDLE);
 
     umock_c_reset_all_calls();
-    EXPECTED_CALL(tickcounter_destroy(IGNORED_ARG));
     EXPECTED_CALL(free(IGNORED_ARG));
 
     // act
@@ -518,7 +503,7 @@ TEST_FUNCTION(Retrieve_Options_success)
     // arrange
     umock_c_reset_all_calls();
     EXPECTED_CALL(malloc(IGNORED_ARG));
-    RETRY_CONTROL_HANDLE handle = retry_control_create(IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, 10);
+    RETRY_CONTROL_HANDLE handle = retry_control_create(IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, 10, TEST_TICKCOUNTER_HANDLE);
 
     umock_c_reset_all_calls();
     EXPECTED_CALL(OptionHandler_Create(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG));
@@ -546,7 +531,7 @@ TEST_FUNCTION(Retrieve_Options_failure_checks)
 
     umock_c_reset_all_calls();
     EXPECTED_CALL(malloc(IGNORED_ARG));
-    RETRY_CONTROL_HANDLE handle = retry_control_create(IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, 10);
+    RETRY_CONTROL_HANDLE handle = retry_control_create(IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, 10, TEST_TICKCOUNTER_HANDLE);
 
     umock_c_reset_all_calls();
     EXPECTED_CALL(OptionHandler_Create(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG));
@@ -882,7 +867,7 @@ TEST_FUNCTION(Should_Retry_NO_MAX_RETRY_TIME_success)
     tickcount = SECONDS_TO_TICKS(next_try_time);
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&tickcount, sizeof(tickcount));
 
-    // no get_difftime gets invoked.
+    // max_retry_time_in_secs is 0, so the elapsed time is never checked.
 
     // act
     int result = retry_control_should_retry(handle, &retry_action);
@@ -1034,13 +1019,176 @@ TEST_FUNCTION(Should_Retry_RANDOM_success)
 }
 */
 
+TEST_FUNCTION(Should_Retry_DECORRELATED_JITTER_success)
+{
+    // arrange
+    RETRY_CONTROL_HANDLE handle = create_retry_control(IOTHUB_CLIENT_RETRY_DECORRELATED_JITTER, 0);
+
+    // Each wait is at least the base delay (1s) and at most three times the previous one, capped at 30s.
+    tickcounter_ms_t max_wait_in_ms[] = { 3000, 9000, 27000, 30000, 30000, 30000 };
+    tickcounter_ms_t tickcount = SECONDS_TO_TICKS(TEST_current_time);
+    tickcounter_ms_t last_retry_tick = tickcount;
+    RETRY_ACTION retry_action;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&tickcount, sizeof(tickcount));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&tickcount, sizeof(tickcount));
+    int result = retry_control_should_retry(handle, &retry_action);
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, RETRY_ACTION_RETRY_NOW, retry_action);
+
+    size_t i;
+    for (i = 0; i < sizeof(max_wait_in_ms) / sizeof(max_wait_in_ms[0]); i++)
+    {
+        // act
+        tickcount = last_retry_tick + 999;
+        umock_c_reset_all_calls();
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&tickcount, sizeof(tickcount));
+        result = retry_control_should_retry(handle, &retry_action);
+
+        // assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(int, RETRY_ACTION_RETRY_LATER, retry_action);
+
+        // act
+        tickcount = last_retry_tick + max_wait_in_ms[i];
+        umock_c_reset_all_calls();
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&tickcount, sizeof(tickcount));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&tickcount, sizeof(tickcount));
+        result = retry_control_should_retry(handle, &retry_action);
+
+        // assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(int, RETRY_ACTION_RETRY_NOW, retry_action);
+
+        last_retry_tick = tickcount;
+    }
+
+    // cleanup
+    retry_control_destroy(handle);
+}
+
+TEST_FUNCTION(Set_Global_Budget_disable_succeeds)
+{
+    // arrange
+    ASSERT_ARE_EQUAL(int, 0, retry_control_budget_init());
+    umock_c_reset_all_calls();
+
+    // act
+    int result = retry_control_set_global_budget(0);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    // cleanup
+    retry_control_budget_deinit();
+}
+
+TEST_FUNCTION(Set_Global_Budget_without_budget_init_fails)
+{
+    // arrange
+    umock_c_reset_all_calls();
+
+    // act
+    int result = retry_control_set_global_budget(1);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+TEST_FUNCTION(Should_Retry_after_budget_deinit_ignores_budget)
+{
+    // arrange
+    RETRY_CONTROL_HANDLE handle1 = create_retry_control(IOTHUB_CLIENT_RETRY_IMMEDIATE, 0);
+    RETRY_CONTROL_HANDLE handle2 = create_retry_control(IOTHUB_CLIENT_RETRY_IMMEDIATE, 0);
+    ASSERT_ARE_EQUAL(int, 0, retry_control_budget_init());
+    ASSERT_ARE_EQUAL(int, 0, retry_control_set_global_budget(1));
+    retry_control_budget_deinit();
+
+    tickcounter_ms_t tickcount = SECONDS_TO_TICKS(TEST_current_time);
+    RETRY_ACTION retry_action1;
+    RETRY_ACTION retry_action2;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&tickcount, sizeof(tickcount));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&tickcount, sizeof(tickcount));
+
+    // act
+    int result1 = retry_control_should_retry(handle1, &retry_action1);
+    int result2 = retry_control_should_retry(handle2, &retry_action2);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result1);
+    ASSERT_ARE_EQUAL(int, 0, result2);
+    ASSERT_ARE_EQUAL(int, RETRY_ACTION_RETRY_NOW, retry_action1);
+    ASSERT_ARE_EQUAL(int, RETRY_ACTION_RETRY_NOW, retry_action2);
+
+    // cleanup
+    retry_control_destroy(handle1);
+    retry_control_destroy(handle2);
+}
+
+TEST_FUNCTION(Should_Retry_global_budget_postpones_retry)
+{
+    // arrange
+    RETRY_CONTROL_HANDLE handle1 = create_retry_control(IOTHUB_CLIENT_RETRY_IMMEDIATE, 0);
+    RETRY_CONTROL_HANDLE handle2 = create_retry_control(IOTHUB_CLIENT_RETRY_IMMEDIATE, 0);
+    ASSERT_ARE_EQUAL(int, 0, retry_control_budget_init());
+    ASSERT_ARE_EQUAL(int, 0, retry_control_set_global_budget(1));
+
+    time_t next_second = add_seconds(TEST_current_time, 1);
+    tickcounter_ms_t tickcount = SECONDS_TO_TICKS(TEST_current_time);
+    RETRY_ACTION retry_action;
+
+    // The first attempt in this second takes the only slot of the budget
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&tickcount, sizeof(tickcount));
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(TEST_current_time);
+    int result = retry_control_should_retry(handle1, &retry_action);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, RETRY_ACTION_RETRY_NOW, retry_action);
+
+    // act
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&tickcount, sizeof(tickcount));
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(TEST_current_time);
+    STRICT_EXPECTED_CALL(get_difftime(TEST_current_time, TEST_current_time)).SetReturn(0);
+    result = retry_control_should_retry(handle2, &retry_action);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, RETRY_ACTION_RETRY_LATER, retry_action);
+
+    // act
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(next_second);
+    STRICT_EXPECTED_CALL(get_difftime(next_second, TEST_current_time)).SetReturn(1);
+    result = retry_control_should_retry(handle2, &retry_action);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, RETRY_ACTION_RETRY_NOW, retry_action);
+
+    // cleanup
+    retry_control_budget_deinit();
+    retry_control_destroy(handle1);
+    retry_control_destroy(handle2);
+}
+
 TEST_FUNCTION(Should_Retry_RETRY_IMMEDIATE_success)
 {
     // arrange
     unsigned int max_retry_time_in_secs = 10;
     RETRY_CONTROL_HANDLE handle = create_retry_control(IOTHUB_CLIENT_RETRY_IMMEDIATE, max_retry_time_in_secs);
 
-    time_t first_time = TEST_current_time;
     time_t current_time = TEST_current_time;
 
     umock_c_reset_all_calls();
@@ -1052,14 +1200,12 @@ TEST_FUNCTION(Should_Retry_RETRY_IMMEDIATE_success)
     for (i = 0; i <= max_retry_time_in_secs; i++)
     {
         // arrange
-        current_time = add_seconds(current_time, 1);
-
         if (i > 0)
         {
             // i.e., if it's not the first call to _should_retry.
+            current_time = add_seconds(current_time, 1);
             tickcount = SECONDS_TO_TICKS(current_time);
             STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&tickcount, sizeof(tickcount));
-            STRICT_EXPECTED_CALL(get_difftime(current_time, first_time)).SetReturn(i);
         }
 
         // act
@@ -1131,7 +1277,6 @@ TEST_FUNCTION(Reset_success)
     umock_c_reset_all_calls();
     tickcount = SECONDS_TO_TICKS(next_try_time);
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&tickcount, sizeof(tickcount));
-    STRICT_EXPECTED_CALL(get_difftime(next_try_time, first_try_time)).SetReturn(max_retry_time_in_secs);
     result = retry_control_should_retry(handle, &retry_action);
     ASSERT_ARE_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(int, RETRY_ACTION_STOP_RETRYING, retry_action);
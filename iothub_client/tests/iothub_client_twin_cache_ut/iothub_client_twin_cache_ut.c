@@ -0,0 +1,335 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "azure_macro_utils/macro_utils.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umock_c_prod.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umocktypes_stdint.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#undef ENABLE_MOCKS
+
+#include "internal/iothub_client_twin_cache.h"
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    (void)error_code;
+    ASSERT_FAIL("umock_c reported error");
+}
+
+TEST_DEFINE_ENUM_TYPE(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_RESULT_VALUES);
+
+#define TEST_TWIN_VERSION_3 "{\"desired\":{\"a\":1,\"b\":2,\"d\":true,\"$version\":3},\"reported\":{\"r\":1,\"$version\":7}}"
+#define TEST_TWIN_VERSION_3_REPORTED_CHANGED "{\"desired\":{\"a\":1,\"b\":2,\"d\":true,\"$version\":3},\"reported\":{\"r\":2,\"$version\":8}}"
+#define TEST_TWIN_VERSION_5 "{\"desired\":{\"a\":1,\"b\":5,\"c\":{\"x\":1},\"$version\":5},\"reported\":{\"r\":1,\"$version\":7}}"
+#define TEST_TWIN_VERSION_5_PATCH "{\"b\":5,\"c\":{\"x\":1},\"$version\":5,\"d\":null}"
+#define TEST_PATCH_VERSION_3 "{\"b\":2,\"$version\":3}"
+#define TEST_PATCH_VERSION_4 "{\"b\":4,\"d\":null,\"$version\":4}"
+#define TEST_PATCH_VERSION_5 "{\"c\":{\"x\":1},\"$version\":5}"
+#define TEST_TWIN_VERSION_5_AFTER_PATCH_5 "{\"desired\":{\"a\":1,\"b\":5,\"c\":{\"x\":1},\"$version\":5}}"
+#define TEST_TWIN_VERSION_5_AFTER_PATCH_5_PATCH "{\"b\":5,\"d\":null}"
+
+static TWIN_CACHE_UPDATE_RESULT update_twin_cache(TWIN_CACHE_HANDLE twin_cache, DEVICE_TWIN_UPDATE_STATE update_state, const char* json, const char** patch)
+{
+    const unsigned char* patch_buffer = NULL;
+    size_t patch_size = 0;
+    TWIN_CACHE_UPDATE_RESULT result = twin_cache_update(twin_cache, update_state, (const unsigned char*)json, strlen(json), &patch_buffer, &patch_size);
+
+    if (patch != NULL)
+    {
+        *patch = (const char*)patch_buffer;
+    }
+
+    if (patch_buffer != NULL)
+    {
+        ASSERT_ARE_EQUAL(size_t, strlen((const char*)patch_buffer), patch_size);
+    }
+
+    return result;
+}
+
+BEGIN_TEST_SUITE(iothub_client_twin_cache_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+
+    umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    umock_c_negative_tests_deinit();
+}
+
+TEST_FUNCTION(twin_cache_create_succeeds)
+{
+    // arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_ARG));
+
+    // act
+    TWIN_CACHE_HANDLE twin_cache = twin_cache_create();
+
+    // assert
+    ASSERT_IS_NOT_NULL(twin_cache);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    twin_cache_destroy(twin_cache);
+}
+
+TEST_FUNCTION(twin_cache_create_malloc_fails)
+{
+    // arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_ARG)).SetReturn(NULL);
+
+    // act
+    TWIN_CACHE_HANDLE twin_cache = twin_cache_create();
+
+    // assert
+    ASSERT_IS_NULL(twin_cache);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(twin_cache_update_NULL_handle_fails)
+{
+    // arrange
+    const unsigned char* patch;
+    size_t patch_size;
+
+    // act
+    TWIN_CACHE_UPDATE_RESULT result = twin_cache_update(NULL, DEVICE_TWIN_UPDATE_COMPLETE, (const unsigned char*)TEST_TWIN_VERSION_3, strlen(TEST_TWIN_VERSION_3), &patch, &patch_size);
+
+    // assert
+    ASSERT_ARE_EQUAL(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_ERROR, result);
+}
+
+TEST_FUNCTION(twin_cache_update_NULL_payload_fails)
+{
+    // arrange
+    TWIN_CACHE_HANDLE twin_cache = twin_cache_create();
+    const unsigned char* patch;
+    size_t patch_size;
+
+    // act
+    TWIN_CACHE_UPDATE_RESULT result = twin_cache_update(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, NULL, 0, &patch, &patch_size);
+
+    // assert
+    ASSERT_ARE_EQUAL(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_ERROR, result);
+
+    // cleanup
+    twin_cache_destroy(twin_cache);
+}
+
+TEST_FUNCTION(twin_cache_update_invalid_json_fails)
+{
+    // arrange
+    TWIN_CACHE_HANDLE twin_cache = twin_cache_create();
+
+    // act
+    TWIN_CACHE_UPDATE_RESULT result = update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, "{\"desired\":", NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_ERROR, result);
+
+    // cleanup
+    twin_cache_destroy(twin_cache);
+}
+
+TEST_FUNCTION(twin_cache_update_document_without_version_fails)
+{
+    // arrange
+    TWIN_CACHE_HANDLE twin_cache = twin_cache_create();
+
+    // act
+    TWIN_CACHE_UPDATE_RESULT result = update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, "{\"desired\":{\"a\":1}}", NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_ERROR, result);
+
+    // cleanup
+    twin_cache_destroy(twin_cache);
+}
+
+TEST_FUNCTION(twin_cache_update_first_document_is_delivered)
+{
+    // arrange
+    TWIN_CACHE_HANDLE twin_cache = twin_cache_create();
+
+    // act
+    TWIN_CACHE_UPDATE_RESULT result = update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, TEST_TWIN_VERSION_3, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_DELIVER, result);
+
+    // cleanup
+    twin_cache_destroy(twin_cache);
+}
+
+TEST_FUNCTION(twin_cache_update_same_desired_version_is_unchanged)
+{
+    // arrange
+    TWIN_CACHE_HANDLE twin_cache = twin_cache_create();
+    (void)update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, TEST_TWIN_VERSION_3, NULL);
+
+    // act
+    TWIN_CACHE_UPDATE_RESULT result = update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, TEST_TWIN_VERSION_3_REPORTED_CHANGED, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_UNCHANGED, result);
+
+    // cleanup
+    twin_cache_destroy(twin_cache);
+}
+
+TEST_FUNCTION(twin_cache_update_newer_document_is_reduced_to_patch)
+{
+    // arrange
+    TWIN_CACHE_HANDLE twin_cache = twin_cache_create();
+    const char* patch = NULL;
+    (void)update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, TEST_TWIN_VERSION_3, NULL);
+
+    // act
+    TWIN_CACHE_UPDATE_RESULT result = update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, TEST_TWIN_VERSION_5, &patch);
+
+    // assert
+    ASSERT_ARE_EQUAL(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_DELIVER_PATCH, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_TWIN_VERSION_5_PATCH, patch);
+
+    // cleanup
+    twin_cache_destroy(twin_cache);
+}
+
+TEST_FUNCTION(twin_cache_update_patch_before_document_is_delivered)
+{
+    // arrange
+    TWIN_CACHE_HANDLE twin_cache = twin_cache_create();
+
+    // act
+    TWIN_CACHE_UPDATE_RESULT result = update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_PARTIAL, TEST_PATCH_VERSION_4, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_DELIVER, result);
+
+    // cleanup
+    twin_cache_destroy(twin_cache);
+}
+
+TEST_FUNCTION(twin_cache_update_next_patch_is_delivered_and_merged)
+{
+    // arrange
+    TWIN_CACHE_HANDLE twin_cache = twin_cache_create();
+    (void)update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, TEST_TWIN_VERSION_3, NULL);
+
+    // act
+    TWIN_CACHE_UPDATE_RESULT result = update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_PARTIAL, TEST_PATCH_VERSION_4, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_DELIVER, result);
+    // The reconnect GET at version 4 finds the merged copy up to date
+    ASSERT_ARE_EQUAL(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_UNCHANGED, update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, "{\"desired\":{\"a\":1,\"b\":4,\"$version\":4}}", NULL));
+
+    // cleanup
+    twin_cache_destroy(twin_cache);
+}
+
+TEST_FUNCTION(twin_cache_update_old_patch_is_unchanged)
+{
+    // arrange
+    TWIN_CACHE_HANDLE twin_cache = twin_cache_create();
+    (void)update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, TEST_TWIN_VERSION_3, NULL);
+
+    // act
+    TWIN_CACHE_UPDATE_RESULT result = update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_PARTIAL, TEST_PATCH_VERSION_3, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_UNCHANGED, result);
+
+    // cleanup
+    twin_cache_destroy(twin_cache);
+}
+
+TEST_FUNCTION(twin_cache_update_version_gap_is_out_of_sync_until_next_document)
+{
+    // arrange
+    TWIN_CACHE_HANDLE twin_cache = twin_cache_create();
+    const char* patch = NULL;
+    (void)update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, TEST_TWIN_VERSION_3, NULL);
+
+    // act
+    TWIN_CACHE_UPDATE_RESULT gap_result = update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_PARTIAL, TEST_PATCH_VERSION_5, NULL);
+    TWIN_CACHE_UPDATE_RESULT resync_result = update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, TEST_TWIN_VERSION_5_AFTER_PATCH_5, &patch);
+
+    // assert
+    ASSERT_ARE_EQUAL(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_OUT_OF_SYNC, gap_result);
+    // Only what the missed version 4 changed is left to deliver
+    ASSERT_ARE_EQUAL(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_DELIVER_PATCH, resync_result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_TWIN_VERSION_5_AFTER_PATCH_5_PATCH, patch);
+
+    // cleanup
+    twin_cache_destroy(twin_cache);
+}
+
+TEST_FUNCTION(twin_cache_reset_delivers_next_document)
+{
+    // arrange
+    TWIN_CACHE_HANDLE twin_cache = twin_cache_create();
+    (void)update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, TEST_TWIN_VERSION_3, NULL);
+
+    // act
+    twin_cache_reset(twin_cache);
+    TWIN_CACHE_UPDATE_RESULT result = update_twin_cache(twin_cache, DEVICE_TWIN_UPDATE_COMPLETE, TEST_TWIN_VERSION_3, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(TWIN_CACHE_UPDATE_RESULT, TWIN_CACHE_UPDATE_DELIVER, result);
+
+    // cleanup
+    twin_cache_destroy(twin_cache);
+}
+
+END_TEST_SUITE(iothub_client_twin_cache_ut)
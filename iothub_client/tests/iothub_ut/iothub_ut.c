@@ -19,6 +19,7 @@
 
 #define ENABLE_MOCKS
 #include "azure_c_shared_utility/platform.h"
+#include "internal/iothub_client_retry_control.h"
 #undef ENABLE_MOCKS
 
 #include "iothub.h"
@@ -44,6 +45,8 @@ TEST_SUITE_INITIALIZE(suite_init)
 
     REGISTER_GLOBAL_MOCK_RETURN(platform_init, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(platform_init, __LINE__);
+    REGISTER_GLOBAL_MOCK_RETURN(retry_control_budget_init, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(retry_control_budget_init, __LINE__);
 }
 
 TEST_SUITE_CLEANUP(suite_cleanup)
@@ -56,6 +59,7 @@ TEST_FUNCTION(IoTHub_Init_succeed)
 {
     //arrange
     STRICT_EXPECTED_CALL(platform_init());
+    STRICT_EXPECTED_CALL(retry_control_budget_init());
 
     //act
     int result = IoTHub_Init();
@@ -78,9 +82,25 @@ TEST_FUNCTION(IoTHub_Init_fail)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
+TEST_FUNCTION(IoTHub_Init_retry_budget_fail)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(platform_init());
+    STRICT_EXPECTED_CALL(retry_control_budget_init()).SetReturn(__LINE__);
+    STRICT_EXPECTED_CALL(platform_deinit());
+
+    //act
+    int result = IoTHub_Init();
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 TEST_FUNCTION(IoTHub_Deinit_succeed)
 {
     //arrange
+    STRICT_EXPECTED_CALL(retry_control_budget_deinit());
     STRICT_EXPECTED_CALL(platform_deinit());
 
     //act
@@ -55,6 +55,8 @@ void* my_gballoc_realloc(void* ptr, size_t size)
 #include "iothub_message.h"
 #include "internal/iothub_client_authorization.h"
 #include "internal/iothub_client_diagnostic.h"
+#include "internal/iothub_client_twin_cache.h"
+#include "internal/iothub_client_reported_state_batch.h"
 
 #ifndef DONT_USE_UPLOADTOBLOB
 #include "internal/iothub_client_ll_uploadtoblob.h"
@@ -236,6 +238,8 @@ static const char* TEST_STRING_VALUE = "Test string value";
 
 #define TEST_METHOD_ID                      (METHOD_HANDLE)0x61
 #define TEST_IOTHUB_AUTH_HANDLE             (IOTHUB_AUTHORIZATION_HANDLE)0x62
+#define TEST_TWIN_CACHE_HANDLE              (TWIN_CACHE_HANDLE)0x63
+#define TEST_REPORTED_STATE_BATCH_HANDLE    (REPORTED_STATE_BATCH_HANDLE)0x64
 
 static const char* TEST_PROV_URI = "global.azure-devices-provisioning.net";
 
@@ -463,9 +467,11 @@ static void my_STRING_TOKENIZER_destroy(STRING_TOKENIZER_HANDLE handle)
     my_gballoc_free(handle);
 }
 
+static TICK_COUNTER_HANDLE g_last_tick_counter_created;
 static TICK_COUNTER_HANDLE my_tickcounter_create(void)
 {
-    return (TICK_COUNTER_HANDLE)my_gballoc_malloc(1);
+    g_last_tick_counter_created = (TICK_COUNTER_HANDLE)my_gballoc_malloc(1);
+    return g_last_tick_counter_created;
 }
 
 static int my_tickcounter_get_current_ms(TICK_COUNTER_HANDLE tick_counter, tickcounter_ms_t * current_ms)
@@ -524,11 +530,12 @@ static TRANSPORT_LL_HANDLE my_FAKE_IoTHubTransport_Create(const IOTHUBTRANSPORT_
     return TEST_TRANSPORT_LL_HANDLE;
 }
 
+static TICK_COUNTER_HANDLE g_registered_device_tick_counter;
 static IOTHUB_DEVICE_HANDLE my_FAKE_IoTHubTransport_Register(TRANSPORT_LL_HANDLE handle, const IOTHUB_DEVICE_CONFIG* device, PDLIST_ENTRY waitingToSend)
 {
     (void)handle;
-    (void)device;
     (void)waitingToSend;
+    g_registered_device_tick_counter = device->tick_counter;
     return (IOTHUB_DEVICE_HANDLE)my_gballoc_malloc(1);
 }
 
@@ -786,6 +793,10 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(METHOD_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_AUTHORIZATION_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(TWIN_CACHE_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(TWIN_CACHE_UPDATE_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(REPORTED_STATE_BATCH_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_REPORTED_STATE_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_LL_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(PLATFORM_INFO_OPTION, int);
 
@@ -903,6 +914,20 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_Diagnostic_AddIfNecessary, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_Diagnostic_AddIfNecessary, 100);
 
+    REGISTER_GLOBAL_MOCK_RETURN(twin_cache_create, TEST_TWIN_CACHE_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(twin_cache_create, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(twin_cache_update, TWIN_CACHE_UPDATE_DELIVER);
+
+    REGISTER_GLOBAL_MOCK_RETURN(reported_state_batch_create, TEST_REPORTED_STATE_BATCH_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(reported_state_batch_create, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(reported_state_batch_add, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(reported_state_batch_add, MU_FAILURE);
+    REGISTER_GLOBAL_MOCK_RETURN(reported_state_batch_conflicts, false);
+    REGISTER_GLOBAL_MOCK_RETURN(reported_state_batch_get_count, 0);
+    REGISTER_GLOBAL_MOCK_RETURN(reported_state_batch_get_size, 0);
+    REGISTER_GLOBAL_MOCK_RETURN(reported_state_batch_flush, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(reported_state_batch_flush, MU_FAILURE);
+
     REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_Auth_CreateFromDeviceAuth, my_IoTHubClient_Auth_CreateFromDeviceAuth);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_Auth_CreateFromDeviceAuth, NULL);
 
@@ -1638,6 +1663,8 @@ TEST_FUNCTION(IoTHubClientCore_LL_Create_succeeds)
     ///assert
     ASSERT_ARE_NOT_EQUAL(void_ptr, NULL, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(g_registered_device_tick_counter);
+    ASSERT_ARE_EQUAL(void_ptr, g_last_tick_counter_created, g_registered_device_tick_counter);
 
     //cleanup
     IoTHubClientCore_LL_Destroy(result);
@@ -3489,6 +3516,88 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_sas_token_lifetime_fail)
     IoTHubClientCore_LL_Destroy(handle);
 }
 
+TEST_FUNCTION(IoTHubClientCore_LL_SetOption_sas_token_cache_succeeds)
+{
+    //arrange
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Set_SasToken_Cache(IGNORED_ARG, true));
+
+    //act
+    bool sas_token_cache = true;
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SetOption(handle, OPTION_SAS_TOKEN_CACHE, &sas_token_cache);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClientCore_LL_SetOption_twin_cache_succeeds)
+{
+    //arrange
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(twin_cache_create());
+
+    //act
+    bool twin_cache = true;
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SetOption(handle, OPTION_TWIN_CACHE, &twin_cache);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClientCore_LL_SetOption_twin_cache_false_destroys_cache)
+{
+    //arrange
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    bool twin_cache = true;
+    (void)IoTHubClientCore_LL_SetOption(handle, OPTION_TWIN_CACHE, &twin_cache);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(twin_cache_destroy(TEST_TWIN_CACHE_HANDLE));
+
+    //act
+    twin_cache = false;
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SetOption(handle, OPTION_TWIN_CACHE, &twin_cache);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClientCore_LL_SetOption_twin_cache_create_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(twin_cache_create()).SetReturn(NULL);
+
+    //act
+    bool twin_cache = true;
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SetOption(handle, OPTION_TWIN_CACHE, &twin_cache);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
 TEST_FUNCTION(IoTHubClientCore_LL_SetOption_with_NULL_handle_fails)
 {
     //arrange
@@ -4435,6 +4544,240 @@ TEST_FUNCTION(IoTHubClientCore_LL_Destroy_with_pending_reported_state_succeeds)
     //cleanup
 }
 
+static IOTHUB_CLIENT_CORE_LL_HANDLE create_with_reported_state_batch(tickcounter_ms_t interval, size_t size)
+{
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, IoTHubClientCore_LL_SetOption(handle, OPTION_REPORTED_STATE_BATCH_SIZE, &size));
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, IoTHubClientCore_LL_SetOption(handle, OPTION_REPORTED_STATE_BATCH_INTERVAL, &interval));
+    return handle;
+}
+
+TEST_FUNCTION(IoTHubClientCore_LL_SetOption_reported_state_batch_interval_succeeds)
+{
+    //arrange
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(reported_state_batch_create());
+
+    //act
+    tickcounter_ms_t interval = 100;
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SetOption(handle, OPTION_REPORTED_STATE_BATCH_INTERVAL, &interval);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClientCore_LL_SetOption_reported_state_batch_interval_create_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = IoTHubClientCore_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(reported_state_batch_create()).SetReturn(NULL);
+
+    //act
+    tickcounter_ms_t interval = 100;
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SetOption(handle, OPTION_REPORTED_STATE_BATCH_INTERVAL, &interval);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClientCore_LL_SetOption_reported_state_batch_interval_zero_destroys_batch)
+{
+    //arrange
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = create_with_reported_state_batch(100, 0);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(reported_state_batch_get_count(TEST_REPORTED_STATE_BATCH_HANDLE));
+    STRICT_EXPECTED_CALL(reported_state_batch_destroy(TEST_REPORTED_STATE_BATCH_HANDLE));
+
+    //act
+    tickcounter_ms_t interval = 0;
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SetOption(handle, OPTION_REPORTED_STATE_BATCH_INTERVAL, &interval);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClientCore_LL_Destroy_reported_state_batch_flush_fails_calls_back_pending)
+{
+    //arrange
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = create_with_reported_state_batch(100, 0);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_Unregister(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_Destroy(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_ARG));
+
+    STRICT_EXPECTED_CALL(reported_state_batch_get_count(TEST_REPORTED_STATE_BATCH_HANDLE)).SetReturn(2);
+    STRICT_EXPECTED_CALL(reported_state_batch_flush(TEST_REPORTED_STATE_BATCH_HANDLE, IGNORED_ARG, IGNORED_ARG, IGNORED_ARG)).SetReturn(MU_FAILURE);
+    STRICT_EXPECTED_CALL(reported_state_batch_abandon(TEST_REPORTED_STATE_BATCH_HANDLE, 500));
+
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_ARG));
+
+    STRICT_EXPECTED_CALL(reported_state_batch_destroy(TEST_REPORTED_STATE_BATCH_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Destroy(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_destroy(IGNORED_ARG));
+
+#ifndef DONT_USE_UPLOADTOBLOB
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_Destroy(IGNORED_ARG));
+#endif
+#ifdef USE_EDGE_MODULES
+    STRICT_EXPECTED_CALL(IoTHubClient_EdgeHandle_Destroy(IGNORED_ARG));
+#endif
+
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+
+    //act
+    IoTHubClientCore_LL_Destroy(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubClientCore_LL_SendReportedState_with_batch_merges_succeeds)
+{
+    //arrange
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = create_with_reported_state_batch(100, 0);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_Subscribe_DeviceTwin(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(reported_state_batch_get_count(TEST_REPORTED_STATE_BATCH_HANDLE));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(reported_state_batch_add(TEST_REPORTED_STATE_BATCH_HANDLE, TEST_REPORTED_STATE, TEST_REPORTED_SIZE, iothub_reported_state_callback, NULL));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SendReportedState(handle, TEST_REPORTED_STATE, TEST_REPORTED_SIZE, iothub_reported_state_callback, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClientCore_LL_SendReportedState_with_batch_flushes_at_size)
+{
+    //arrange
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = create_with_reported_state_batch(100, TEST_REPORTED_SIZE);
+    const unsigned char* flushed_state = TEST_REPORTED_STATE;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_Subscribe_DeviceTwin(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(reported_state_batch_get_count(TEST_REPORTED_STATE_BATCH_HANDLE)).SetReturn(1);
+    STRICT_EXPECTED_CALL(reported_state_batch_conflicts(TEST_REPORTED_STATE_BATCH_HANDLE, TEST_REPORTED_STATE, TEST_REPORTED_SIZE));
+    STRICT_EXPECTED_CALL(reported_state_batch_add(TEST_REPORTED_STATE_BATCH_HANDLE, TEST_REPORTED_STATE, TEST_REPORTED_SIZE, iothub_reported_state_callback, NULL));
+    STRICT_EXPECTED_CALL(reported_state_batch_get_size(TEST_REPORTED_STATE_BATCH_HANDLE)).SetReturn(TEST_REPORTED_SIZE);
+    STRICT_EXPECTED_CALL(reported_state_batch_flush(TEST_REPORTED_STATE_BATCH_HANDLE, IGNORED_ARG, IGNORED_ARG, IGNORED_ARG))
+        .CopyOutArgumentBuffer_reportedState(&flushed_state, sizeof(flushed_state))
+        .CopyOutArgumentBuffer_size(&TEST_REPORTED_SIZE, sizeof(TEST_REPORTED_SIZE));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Create(TEST_REPORTED_STATE, TEST_REPORTED_SIZE));
+    STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_ARG, IGNORED_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SendReportedState(handle, TEST_REPORTED_STATE, TEST_REPORTED_SIZE, iothub_reported_state_callback, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClientCore_LL_SendReportedState_with_batch_flushes_before_conflicting_patch)
+{
+    //arrange
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = create_with_reported_state_batch(100, 0);
+    const unsigned char* flushed_state = TEST_REPORTED_STATE;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_Subscribe_DeviceTwin(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(reported_state_batch_get_count(TEST_REPORTED_STATE_BATCH_HANDLE)).SetReturn(1);
+    STRICT_EXPECTED_CALL(reported_state_batch_conflicts(TEST_REPORTED_STATE_BATCH_HANDLE, TEST_REPORTED_STATE, TEST_REPORTED_SIZE)).SetReturn(true);
+    STRICT_EXPECTED_CALL(reported_state_batch_flush(TEST_REPORTED_STATE_BATCH_HANDLE, IGNORED_ARG, IGNORED_ARG, IGNORED_ARG))
+        .CopyOutArgumentBuffer_reportedState(&flushed_state, sizeof(flushed_state))
+        .CopyOutArgumentBuffer_size(&TEST_REPORTED_SIZE, sizeof(TEST_REPORTED_SIZE));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(CONSTBUFFER_Create(TEST_REPORTED_STATE, TEST_REPORTED_SIZE));
+    STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(reported_state_batch_add(TEST_REPORTED_STATE_BATCH_HANDLE, TEST_REPORTED_STATE, TEST_REPORTED_SIZE, iothub_reported_state_callback, NULL));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SendReportedState(handle, TEST_REPORTED_STATE, TEST_REPORTED_SIZE, iothub_reported_state_callback, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClientCore_LL_SendReportedState_with_batch_conflicting_patch_flush_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = create_with_reported_state_batch(100, 0);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_Subscribe_DeviceTwin(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(reported_state_batch_get_count(TEST_REPORTED_STATE_BATCH_HANDLE)).SetReturn(1);
+    STRICT_EXPECTED_CALL(reported_state_batch_conflicts(TEST_REPORTED_STATE_BATCH_HANDLE, TEST_REPORTED_STATE, TEST_REPORTED_SIZE)).SetReturn(true);
+    STRICT_EXPECTED_CALL(reported_state_batch_flush(TEST_REPORTED_STATE_BATCH_HANDLE, IGNORED_ARG, IGNORED_ARG, IGNORED_ARG)).SetReturn(MU_FAILURE);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SendReportedState(handle, TEST_REPORTED_STATE, TEST_REPORTED_SIZE, iothub_reported_state_callback, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClientCore_LL_SendReportedState_with_batch_add_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_CORE_LL_HANDLE handle = create_with_reported_state_batch(100, 0);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_Subscribe_DeviceTwin(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(reported_state_batch_get_count(TEST_REPORTED_STATE_BATCH_HANDLE));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(reported_state_batch_add(TEST_REPORTED_STATE_BATCH_HANDLE, TEST_REPORTED_STATE, TEST_REPORTED_SIZE, iothub_reported_state_callback, NULL)).SetReturn(MU_FAILURE);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_LL_SendReportedState(handle, TEST_REPORTED_STATE, TEST_REPORTED_SIZE, iothub_reported_state_callback, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClientCore_LL_Destroy(handle);
+}
+
 TEST_FUNCTION(IoTHubClientCore_LL_SendReportedState_NULL_fails)
 {
     //arrange
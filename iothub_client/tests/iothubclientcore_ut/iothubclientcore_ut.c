@@ -2119,6 +2119,30 @@ TEST_FUNCTION(IoTHubClientCore_SetOption_DO_WORK_FREQUENCY_IN_MS_succeed)
     IoTHubClientCore_Destroy(iothub_handle);
 }
 
+#ifndef DONT_USE_UPLOADTOBLOB
+TEST_FUNCTION(IoTHubClientCore_SetOption_BLOB_UPLOAD_MAX_CONCURRENT_UPLOADS_succeed)
+{
+    // arrange
+    IOTHUB_CLIENT_CORE_HANDLE iothub_handle = IoTHubClientCore_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    size_t maxConcurrentUploads = 4;
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_SetOption(iothub_handle, "blob_upload_max_concurrent_uploads", &maxConcurrentUploads);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClientCore_Destroy(iothub_handle);
+}
+#endif
+
 TEST_FUNCTION(IoTHubClientCore_SetOption_DO_WORK_FREQUENCY_IN_MS_value_limits_fail)
 {
     // arrange
@@ -3225,6 +3249,158 @@ static void set_expected_calls_for_allocateUploadToBlob()
     STRICT_EXPECTED_CALL(Lock_Init());
 }
 
+TEST_FUNCTION(IoTHubClientCore_UploadToBlobAsync_queues_upload_when_max_concurrent_uploads_reached)
+{
+    //arrange
+    size_t maxConcurrentUploads = 1;
+    IOTHUB_CLIENT_CORE_HANDLE iothub_handle = IoTHubClientCore_Create(TEST_CLIENT_CONFIG);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, IoTHubClientCore_SetOption(iothub_handle, "blob_upload_max_concurrent_uploads", &maxConcurrentUploads));
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, IoTHubClientCore_UploadToBlobAsync(iothub_handle, "first.txt", (const unsigned char*)"a", 1, test_file_upload_callback, (void*)1));
+    umock_c_reset_all_calls();
+
+    set_expected_calls_for_allocateUploadToBlob();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_ARG)); /*this is creating a UPLOADTOBLOB_SAVED_DATA*/
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG)); /*queued, no thread is created*/
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClientCore_UploadToBlobAsync(iothub_handle, "second.txt", (const unsigned char*)"b", 1, test_file_upload_callback, (void*)1);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //the thread started for the first upload also runs the queued one before exiting
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(get_time(IGNORED_ARG)).CallCannotFail();
+    STRICT_EXPECTED_CALL(IoTHubClientCore_LL_UploadToBlob(TEST_IOTHUB_CLIENT_CORE_LL_HANDLE, "first.txt", IGNORED_ARG, 1));
+    STRICT_EXPECTED_CALL(test_file_upload_callback(FILE_UPLOAD_OK, IGNORED_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(get_time(IGNORED_ARG)).CallCannotFail();
+    STRICT_EXPECTED_CALL(IoTHubClientCore_LL_UploadToBlob(TEST_IOTHUB_CLIENT_CORE_LL_HANDLE, "second.txt", IGNORED_ARG, 1));
+    STRICT_EXPECTED_CALL(test_file_upload_callback(FILE_UPLOAD_OK, IGNORED_ARG))
+        .IgnoreArgument(1);
+    set_expected_calls_for_freeUploadToBlobThreadInfo();
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Exit(0));
+
+    g_thread_func(g_thread_func_arg);
+
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+
+    EXPECTED_CALL(ThreadAPI_Join(IGNORED_ARG, IGNORED_ARG));
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE))
+        .SetReturn(TEST_LIST_HANDLE);
+
+    setup_gargageCollection(my_malloc_items[2], true);
+    setup_IothubClient_Destroy_after_garbage_collection();
+
+    IoTHubClientCore_Destroy(iothub_handle);
+}
+
+TEST_FUNCTION(IoTHubClientCore_UploadToBlobAsync_pooled_thread_keeps_its_slot_until_Lock_succeeds)
+{
+    //arrange
+    size_t maxConcurrentUploads = 1;
+    IOTHUB_CLIENT_CORE_HANDLE iothub_handle = IoTHubClientCore_Create(TEST_CLIENT_CONFIG);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, IoTHubClientCore_SetOption(iothub_handle, "blob_upload_max_concurrent_uploads", &maxConcurrentUploads));
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, IoTHubClientCore_UploadToBlobAsync(iothub_handle, "first.txt", (const unsigned char*)"a", 1, test_file_upload_callback, (void*)1));
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, IoTHubClientCore_UploadToBlobAsync(iothub_handle, "second.txt", (const unsigned char*)"b", 1, test_file_upload_callback, (void*)1));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(IGNORED_ARG)).CallCannotFail();
+    STRICT_EXPECTED_CALL(IoTHubClientCore_LL_UploadToBlob(TEST_IOTHUB_CLIENT_CORE_LL_HANDLE, "first.txt", IGNORED_ARG, 1));
+    STRICT_EXPECTED_CALL(test_file_upload_callback(FILE_UPLOAD_OK, IGNORED_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG)).SetReturn(LOCK_ERROR);
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(get_time(IGNORED_ARG)).CallCannotFail();
+    STRICT_EXPECTED_CALL(IoTHubClientCore_LL_UploadToBlob(TEST_IOTHUB_CLIENT_CORE_LL_HANDLE, "second.txt", IGNORED_ARG, 1));
+    STRICT_EXPECTED_CALL(test_file_upload_callback(FILE_UPLOAD_OK, IGNORED_ARG))
+        .IgnoreArgument(1);
+    set_expected_calls_for_freeUploadToBlobThreadInfo();
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Exit(0));
+
+    //act
+    g_thread_func(g_thread_func_arg);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+
+    EXPECTED_CALL(ThreadAPI_Join(IGNORED_ARG, IGNORED_ARG));
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE))
+        .SetReturn(TEST_LIST_HANDLE);
+
+    setup_gargageCollection(my_malloc_items[2], true);
+    setup_IothubClient_Destroy_after_garbage_collection();
+
+    IoTHubClientCore_Destroy(iothub_handle);
+}
+
+TEST_FUNCTION(IoTHubClientCore_Destroy_fails_uploads_left_in_the_queue)
+{
+    //arrange
+    size_t maxConcurrentUploads = 1;
+    IOTHUB_CLIENT_CORE_HANDLE iothub_handle = IoTHubClientCore_Create(TEST_CLIENT_CONFIG);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, IoTHubClientCore_SetOption(iothub_handle, "blob_upload_max_concurrent_uploads", &maxConcurrentUploads));
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, IoTHubClientCore_UploadToBlobAsync(iothub_handle, "first.txt", (const unsigned char*)"a", 1, test_file_upload_callback, (void*)1));
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, IoTHubClientCore_UploadToBlobAsync(iothub_handle, "second.txt", (const unsigned char*)"b", 1, test_file_upload_callback, (void*)1));
+    umock_c_reset_all_calls();
+
+    // The thread of the first upload is collected without having picked up the queued one, as if its slot had been lost.
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+
+    EXPECTED_CALL(ThreadAPI_Join(IGNORED_ARG, IGNORED_ARG));
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_ARG));
+    EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE))
+        .SetReturn(TEST_LIST_HANDLE);
+
+    setup_gargageCollection(my_malloc_items[2], true);
+    EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
+    STRICT_EXPECTED_CALL(singlylinkedlist_destroy(TEST_SLL_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClientCore_LL_Destroy(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(test_file_upload_callback(FILE_UPLOAD_ERROR, (void*)1));
+    set_expected_calls_for_freeUploadToBlobThreadInfo();
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(Lock_Deinit(IGNORED_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_ARG));
+
+    //act
+    IoTHubClientCore_Destroy(iothub_handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 TEST_FUNCTION(IoTHubClientCore_UploadMultipleBlocksToBlobAsync_fails_when_handle_is_NULL)
 {
     ///arrange
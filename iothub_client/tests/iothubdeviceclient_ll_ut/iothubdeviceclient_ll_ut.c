@@ -405,6 +405,32 @@ TEST_FUNCTION(IoTHubDeviceClient_LL_UploadToBlob_Test)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
+TEST_FUNCTION(IoTHubDeviceClient_LL_UploadFileToBlob_Test)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(IoTHubClientCore_LL_UploadFileToBlob(TEST_IOTHUB_CLIENT_CORE_LL_HANDLE, TEST_CHAR_PTR, TEST_CHAR_PTR));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubDeviceClient_LL_UploadFileToBlob(TEST_IOTHUB_DEVICE_CLIENT_LL_HANDLE, TEST_CHAR_PTR, TEST_CHAR_PTR);
+
+    //assert
+    ASSERT_IS_TRUE(result == IOTHUB_CLIENT_OK);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHubDeviceClient_LL_UploadFileToBlobResumable_Test)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(IoTHubClientCore_LL_UploadFileToBlobResumable(TEST_IOTHUB_CLIENT_CORE_LL_HANDLE, TEST_CHAR_PTR, TEST_CHAR_PTR, TEST_CHAR_PTR));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubDeviceClient_LL_UploadFileToBlobResumable(TEST_IOTHUB_DEVICE_CLIENT_LL_HANDLE, TEST_CHAR_PTR, TEST_CHAR_PTR, TEST_CHAR_PTR);
+
+    //assert
+    ASSERT_IS_TRUE(result == IOTHUB_CLIENT_OK);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 TEST_FUNCTION(IoTHubDeviceClient_LL_UploadMultipleBlocksToBlob_Test)
 {
     //arrange
@@ -204,6 +204,7 @@ static const char* test_get_product_info(void* ctx)
 #define TEST_SEND_LINK_ATTACH_PROPERTIES                  (MAP_HANDLE)0x4487
 #define TEST_RECEIVE_LINK_ATTACH_PROPERTIES                  (MAP_HANDLE)0x4488
 #define TEST_MAP_HANDLE                                      (MAP_HANDLE)0x4489
+#define TEST_TICK_COUNTER_HANDLE                          (TICK_COUNTER_HANDLE)0x4490
 
 static char* map_key = "abcdefghij";
 static char* map_value = "0123456789";
@@ -423,6 +424,7 @@ static AMQP_MESSENGER_CONFIG* get_messenger_config()
     g_messenger_config.on_state_changed_context = TEST_ON_STATE_CHANGED_CB_CONTEXT;
     g_messenger_config.prod_info_cb = test_get_product_info;
     g_messenger_config.prod_info_ctx = NULL;
+    g_messenger_config.tick_counter = TEST_TICK_COUNTER_HANDLE;
 
     g_messenger_config.send_link.target_suffix = TEST_SEND_LINK_TARGET_SUFFIX_CHAR_PTR;
     g_messenger_config.send_link.rcv_settle_mode = sender_settle_mode_settled;
@@ -1413,6 +1415,24 @@ TEST_FUNCTION(amqp_messenger_create_config_NULL_iothub_host_fqdn)
     // cleanup
 }
 
+TEST_FUNCTION(amqp_messenger_create_config_NULL_tick_counter)
+{
+    // arrange
+    AMQP_MESSENGER_CONFIG* config = get_messenger_config();
+    config->tick_counter = NULL;
+
+    umock_c_reset_all_calls();
+
+    // act
+    AMQP_MESSENGER_HANDLE handle = amqp_messenger_create(config);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, handle, NULL);
+
+    // cleanup
+}
+
 TEST_FUNCTION(amqp_messenger_create_success)
 {
     // arrange
@@ -47,7 +47,7 @@ void real_free(void* ptr)
 #include "azure_c_shared_utility/singlylinkedlist.h"
 #include "azure_c_shared_utility/uniqueid.h"
 #include "azure_c_shared_utility/optionhandler.h"
-#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/tickcounter.h"
 
 #undef ENABLE_MOCK_FILTERING_SWITCH
 #define ENABLE_MOCK_FILTERING
@@ -65,6 +65,7 @@ void real_free(void* ptr)
 #define please_mock_link_destroy MOCK_ENABLED
 #define please_mock_link_get_peer_max_message_size MOCK_ENABLED
 #define please_mock_link_set_attach_properties MOCK_ENABLED
+#define please_mock_link_set_max_link_credit MOCK_ENABLED
 #define please_mock_link_set_max_message_size MOCK_ENABLED
 #define please_mock_link_set_rcv_settle_mode MOCK_ENABLED
 #define please_mock_message_add_body_amqp_data MOCK_ENABLED
@@ -194,7 +195,8 @@ static SINGLYLINKEDLIST_HANDLE TEST_IN_PROGRESS_LIST;
 #define TEST_IN_PROGRESS_LIST2                            (SINGLYLINKEDLIST_HANDLE)0x4484
 #define TEST_OPTIONHANDLER_HANDLE                         (OPTIONHANDLER_HANDLE)0x4485
 #define TEST_CALLBACK_LIST1                               (SINGLYLINKEDLIST_HANDLE)0x4486
-#define INDEFINITE_TIME                                   ((time_t)-1)
+#define TEST_TICK_COUNTER_HANDLE                          (TICK_COUNTER_HANDLE)0x4488
+#define TEST_CURRENT_TIME_MS                              ((tickcounter_ms_t)1234567)
 #define TEST_DISPOSITION_AMQP_VALUE                       (AMQP_VALUE)0x4487
 
 static delivery_number TEST_DELIVERY_NUMBER;
@@ -244,6 +246,7 @@ extern "C"
 #endif
 
 static int TEST_link_set_max_message_size_result;
+static size_t TEST_receiver_link_credit;
 int TEST_amqpvalue_set_map_value_result;
 int TEST_link_set_attach_properties_result;
 
@@ -407,6 +410,7 @@ static TELEMETRY_MESSENGER_CONFIG* get_messenger_config()
     g_messenger_config.iothub_host_fqdn = TEST_IOTHUB_HOST_FQDN;
     g_messenger_config.on_state_changed_callback = TEST_on_state_changed_callback;
     g_messenger_config.on_state_changed_context = TEST_ON_STATE_CHANGED_CB_CONTEXT;
+    g_messenger_config.tick_counter = TEST_TICK_COUNTER_HANDLE;
 
     return &g_messenger_config;
 }
@@ -421,7 +425,7 @@ typedef struct MESSENGER_DO_WORK_EXP_CALL_PROFILE_STRUCT
     int wait_to_send_list_length;
     int in_progress_list_length;
     size_t send_event_timeout_secs;
-    time_t current_time;
+    tickcounter_ms_t current_time;
     SEND_PENDING_EVENTS_TEST_CONFIG *send_pending_events_test_config;
     bool testing_modules;
 } MESSENGER_DO_WORK_EXP_CALL_PROFILE;
@@ -462,7 +466,7 @@ static SEND_PENDING_EVENTS_TEST_CONFIG test_send_one_message_config = {
 
 static MESSENGER_DO_WORK_EXP_CALL_PROFILE g_do_work_profile;
 
-static MESSENGER_DO_WORK_EXP_CALL_PROFILE* get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE current_state, bool is_subscribed_for_messages, bool is_msg_rcvr_created, int wts_list_length, int ip_list_length, time_t current_time, size_t event_send_timeout_secs)
+static MESSENGER_DO_WORK_EXP_CALL_PROFILE* get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE current_state, bool is_subscribed_for_messages, bool is_msg_rcvr_created, int wts_list_length, int ip_list_length, tickcounter_ms_t current_time, size_t event_send_timeout_secs)
 {
     memset(&g_do_work_profile, 0, sizeof(MESSENGER_DO_WORK_EXP_CALL_PROFILE));
     g_do_work_profile.current_state = current_state;
@@ -899,6 +903,11 @@ static void set_expected_calls_for_message_receiver_create(bool testing_modules)
 
     STRICT_EXPECTED_CALL(link_set_max_message_size(TEST_MESSAGE_RECEIVER_LINK_HANDLE, MESSAGE_RECEIVER_MAX_LINK_SIZE));
 
+    if (TEST_receiver_link_credit > 0)
+    {
+        STRICT_EXPECTED_CALL(link_set_max_link_credit(TEST_MESSAGE_RECEIVER_LINK_HANDLE, (uint32_t)TEST_receiver_link_credit));
+    }
+
     set_expected_calls_for_attach_device_client_type_to_link(TEST_MESSAGE_RECEIVER_LINK_HANDLE, 0, 0);
 
     STRICT_EXPECTED_CALL(messagereceiver_create(TEST_MESSAGE_RECEIVER_LINK_HANDLE, IGNORED_ARG, IGNORED_ARG))
@@ -1188,10 +1197,10 @@ static void set_expected_calls_for_create_send_pending_events_state()
     STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_ARG, IGNORED_ARG));
 }
 
-static void set_expected_calls_for_send_batched_message_and_reset_state(time_t current_time)
+static void set_expected_calls_for_send_batched_message_and_reset_state(tickcounter_ms_t current_time)
 {
     STRICT_EXPECTED_CALL(messagesender_send_async(TEST_MESSAGE_SENDER_HANDLE, IGNORED_ARG, IGNORED_ARG, IGNORED_ARG, IGNORED_ARG));
-    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(current_time);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_TICK_COUNTER_HANDLE, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&current_time, sizeof(current_time));
     STRICT_EXPECTED_CALL(message_destroy(IGNORED_ARG));
 }
 
@@ -1407,7 +1416,7 @@ static SEND_PENDING_EVENTS_TEST_CONFIG test_create_message_failure_config = {
 
 
 // Note: This does NOT handle roll-over test paths.  These are handled with different test path.
-static void set_expected_calls_for_message_do_work_send_pending_events(SEND_PENDING_EVENTS_TEST_CONFIG *test_config, time_t current_time)
+static void set_expected_calls_for_message_do_work_send_pending_events(SEND_PENDING_EVENTS_TEST_CONFIG *test_config, tickcounter_ms_t current_time)
 {
     bool callback_cleanup_needed = false;
 
@@ -1489,41 +1498,22 @@ static void set_expected_calls_for_message_do_work_send_pending_events(SEND_PEND
     }
 }
 
-static time_t add_seconds(time_t base_time, int seconds)
+static void set_expected_calls_for_process_event_send_timeouts(size_t in_progress_list_length, size_t send_event_timeout_secs, tickcounter_ms_t current_time)
 {
-    time_t new_time;
-    struct tm *bd_new_time;
+    (void)send_event_timeout_secs;
 
-    if ((bd_new_time = localtime(&base_time)) == NULL)
-    {
-        new_time = INDEFINITE_TIME;
-    }
-    else
-    {
-        bd_new_time->tm_sec += seconds;
-        new_time = mktime(bd_new_time);
-    }
-
-    return new_time;
-}
-
-static void set_expected_calls_for_process_event_send_timeouts(size_t in_progress_list_length, size_t send_event_timeout_secs, time_t current_time)
-{
     if (in_progress_list_length <= 0)
     {
         STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_IN_PROGRESS_LIST)).SetReturn(NULL);
     }
     else
     {
-        time_t send_time = add_seconds(current_time, -1 * (int)send_event_timeout_secs);
-
         STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_IN_PROGRESS_LIST));
 
         for (; in_progress_list_length > 0; in_progress_list_length--)
         {
             EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
-            STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(current_time);
-            EXPECTED_CALL(get_difftime(current_time, send_time)).SetReturn(difftime(current_time, send_time));
+            STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_TICK_COUNTER_HANDLE, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&current_time, sizeof(current_time));
             EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_ARG));
         }
 
@@ -1560,7 +1550,7 @@ static void set_expected_calls_for_telemetry_messenger_destroy(TELEMETRY_MESSENG
 
     set_expected_calls_for_telemetry_messenger_stop(wait_to_send_list_length, in_progress_list_length, destroy_message_receiver);
 
-    time_t current_time = time(NULL);
+    tickcounter_ms_t current_time = TEST_CURRENT_TIME_MS;
 
     MESSENGER_DO_WORK_EXP_CALL_PROFILE *do_work_profile = get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE_STOPPING, false, false, wait_to_send_list_length, in_progress_list_length, current_time, DEFAULT_EVENT_SEND_TIMEOUT_SECS);
     do_work_profile->testing_modules = testing_modules;
@@ -1690,13 +1680,13 @@ static void crank_telemetry_messenger_do_work(TELEMETRY_MESSENGER_HANDLE handle,
 
     if (profile->create_message_sender && saved_messagesender_create_on_message_sender_state_changed != NULL)
     {
-        STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(profile->current_time);
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_TICK_COUNTER_HANDLE, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&profile->current_time, sizeof(profile->current_time));
         saved_messagesender_create_on_message_sender_state_changed(saved_messagesender_create_context, MESSAGE_SENDER_STATE_OPEN, MESSAGE_SENDER_STATE_IDLE);
     }
 
     if (profile->create_message_receiver && saved_messagereceiver_create_on_message_receiver_state_changed != NULL)
     {
-        STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(profile->current_time);
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_TICK_COUNTER_HANDLE, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&profile->current_time, sizeof(profile->current_time));
         saved_messagereceiver_create_on_message_receiver_state_changed(saved_messagereceiver_create_context, MESSAGE_RECEIVER_STATE_OPEN, MESSAGE_RECEIVER_STATE_IDLE);
     }
 }
@@ -1705,7 +1695,7 @@ static TELEMETRY_MESSENGER_HANDLE create_and_start_messenger2(TELEMETRY_MESSENGE
 {
     TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger(config);
 
-    time_t current_time = time(NULL);
+    tickcounter_ms_t current_time = TEST_CURRENT_TIME_MS;
 
     MESSENGER_DO_WORK_EXP_CALL_PROFILE *do_work_profile = get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE_STARTING, false, false, 0, 0, current_time, DEFAULT_EVENT_SEND_TIMEOUT_SECS);
     do_work_profile->create_message_sender = true;
@@ -1864,7 +1854,7 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(pfCloneOption, void*);
     REGISTER_UMOCK_ALIAS_TYPE(pfDestroyOption, void*);
     REGISTER_UMOCK_ALIAS_TYPE(pfSetOption, void*);
-    REGISTER_UMOCK_ALIAS_TYPE(time_t, long long);
+    REGISTER_UMOCK_ALIAS_TYPE(TICK_COUNTER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(delivery_number, int);
     REGISTER_UMOCK_ALIAS_TYPE(LIST_ACTION_FUNCTION, void*);
     REGISTER_UMOCK_ALIAS_TYPE(tickcounter_ms_t, unsigned long long);
@@ -1891,6 +1881,10 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
 
     REGISTER_GLOBAL_MOCK_HOOK(messagereceiver_get_link_name, TEST_messagereceiver_get_link_name);
 
+
+    REGISTER_GLOBAL_MOCK_RETURN(tickcounter_get_current_ms, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(tickcounter_get_current_ms, 1);
+
     REGISTER_GLOBAL_MOCK_RETURN(singlylinkedlist_remove, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(singlylinkedlist_remove, 555);
 
@@ -1909,6 +1903,9 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
 
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(link_create, NULL);
 
+    REGISTER_GLOBAL_MOCK_RETURN(link_set_max_link_credit, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(link_set_max_link_credit, 1);
+
     REGISTER_GLOBAL_MOCK_RETURN(link_set_max_message_size, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(link_set_max_message_size, 1);
 
@@ -2048,6 +2045,7 @@ static void reset_test_data()
     TEST_on_new_message_received_callback_result = TELEMETRY_MESSENGER_DISPOSITION_RESULT_ACCEPTED;
 
     TEST_link_set_max_message_size_result = 0;
+    TEST_receiver_link_credit = 0;
     TEST_amqpvalue_set_map_value_result = 0;
     TEST_link_set_attach_properties_result = 0;
 
@@ -2133,6 +2131,24 @@ TEST_FUNCTION(telemetry_messenger_create_config_NULL_iothub_host_fqdn)
     // cleanup
 }
 
+TEST_FUNCTION(telemetry_messenger_create_config_NULL_tick_counter)
+{
+    // arrange
+    TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
+    config->tick_counter = NULL;
+
+    umock_c_reset_all_calls();
+
+    // act
+    TELEMETRY_MESSENGER_HANDLE handle = telemetry_messenger_create(config, test_get_product_info, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, handle, NULL);
+
+    // cleanup
+}
+
 static void telemetry_messenger_create_success_impl(bool testing_modules)
 {
     // arrange
@@ -2285,7 +2301,7 @@ TEST_FUNCTION(messenger_state_on_event_sender_state_changed_callback_OPEN)
     TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
     TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger(config);
 
-    time_t current_time = time(NULL);
+    tickcounter_ms_t current_time = TEST_CURRENT_TIME_MS;
 
     MESSENGER_DO_WORK_EXP_CALL_PROFILE *do_work_profile = get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE_STARTING, false, false, 0, 0, current_time, DEFAULT_EVENT_SEND_TIMEOUT_SECS);
     set_expected_calls_for_telemetry_messenger_do_work(do_work_profile);
@@ -2311,7 +2327,7 @@ TEST_FUNCTION(messenger_state_on_event_sender_state_changed_callback_ERROR)
     TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
     TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger(config);
 
-    time_t current_time = time(NULL);
+    tickcounter_ms_t current_time = TEST_CURRENT_TIME_MS;
     MESSENGER_DO_WORK_EXP_CALL_PROFILE *do_work_profile = get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE_STARTING, false, false, 0, 0, current_time, DEFAULT_EVENT_SEND_TIMEOUT_SECS);
     set_expected_calls_for_telemetry_messenger_do_work(do_work_profile);
     telemetry_messenger_do_work(handle);
@@ -2414,7 +2430,7 @@ static void telemetry_messenger_destroy_succeeds_impl(bool testing_modules)
 
     ASSERT_ARE_EQUAL(int, 1, send_events(handle, 1));
 
-    time_t current_time = time(NULL);
+    tickcounter_ms_t current_time = TEST_CURRENT_TIME_MS;
     MESSENGER_DO_WORK_EXP_CALL_PROFILE* mdecp = get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE_STARTED, true, true, 1, 0, current_time, DEFAULT_EVENT_SEND_TIMEOUT_SECS);
     mdecp->testing_modules = testing_modules;
     crank_telemetry_messenger_do_work(handle, mdecp);
@@ -2451,7 +2467,7 @@ TEST_FUNCTION(telemetry_messenger_destroy_FAIL_TO_ROLLBACK_EVENTS)
 
     ASSERT_ARE_EQUAL(int, 1, send_events(handle, 1));
 
-    time_t current_time = time(NULL);
+    tickcounter_ms_t current_time = TEST_CURRENT_TIME_MS;
     MESSENGER_DO_WORK_EXP_CALL_PROFILE* mdecp = get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE_STARTED, true, true, 1, 0, current_time, DEFAULT_EVENT_SEND_TIMEOUT_SECS);
     crank_telemetry_messenger_do_work(handle, mdecp);
 
@@ -2516,7 +2532,7 @@ void test_send_events(SEND_PENDING_EVENTS_TEST_CONFIG *test_config, bool testing
 
     ASSERT_ARE_EQUAL(int, test_config->number_test_events, send_events(handle, test_config->number_test_events));
 
-    time_t current_time = time(NULL);
+    tickcounter_ms_t current_time = TEST_CURRENT_TIME_MS;
     MESSENGER_DO_WORK_EXP_CALL_PROFILE *do_work_profile = get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE_STARTED, false, false, 1, 0, current_time, DEFAULT_EVENT_SEND_TIMEOUT_SECS);
     do_work_profile->send_pending_events_test_config = test_config;
     do_work_profile->testing_modules = testing_modules;
@@ -2608,7 +2624,33 @@ TEST_FUNCTION(telemetry_messenger_do_work_create_message_receiver)
 
     (void)telemetry_messenger_subscribe_for_messages(handle, TEST_on_new_message_received_callback, TEST_ON_NEW_MESSAGE_RECEIVED_CB_CONTEXT);
 
-    time_t current_time = time(NULL);
+    tickcounter_ms_t current_time = TEST_CURRENT_TIME_MS;
+    MESSENGER_DO_WORK_EXP_CALL_PROFILE *do_work_profile = get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE_STARTED, true, false, 0, 0, current_time, DEFAULT_EVENT_SEND_TIMEOUT_SECS);
+    umock_c_reset_all_calls();
+    set_expected_calls_for_telemetry_messenger_do_work(do_work_profile);
+
+    // act
+    telemetry_messenger_do_work(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    telemetry_messenger_destroy(handle);
+}
+
+TEST_FUNCTION(telemetry_messenger_do_work_create_message_receiver_with_link_credit)
+{
+    // arrange
+    TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
+    TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger2(config, false);
+
+    TEST_receiver_link_credit = 5000;
+    ASSERT_ARE_EQUAL(int, 0, telemetry_messenger_set_option(handle, TELEMETRY_MESSENGER_OPTION_RECEIVER_LINK_CREDIT, &TEST_receiver_link_credit));
+
+    (void)telemetry_messenger_subscribe_for_messages(handle, TEST_on_new_message_received_callback, TEST_ON_NEW_MESSAGE_RECEIVED_CB_CONTEXT);
+
+    tickcounter_ms_t current_time = TEST_CURRENT_TIME_MS;
     MESSENGER_DO_WORK_EXP_CALL_PROFILE *do_work_profile = get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE_STARTED, true, false, 0, 0, current_time, DEFAULT_EVENT_SEND_TIMEOUT_SECS);
     umock_c_reset_all_calls();
     set_expected_calls_for_telemetry_messenger_do_work(do_work_profile);
@@ -2724,7 +2766,8 @@ TEST_FUNCTION(messenger_state_on_message_receiver_state_changed_callback_ERROR)
     TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
     TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger2(config, true);
 
-    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(time(NULL));
+    tickcounter_ms_t current_time = TEST_CURRENT_TIME_MS;
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_TICK_COUNTER_HANDLE, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&current_time, sizeof(current_time));
 
     // act
     ASSERT_IS_NOT_NULL(saved_messagereceiver_create_on_message_receiver_state_changed);
@@ -2751,7 +2794,7 @@ TEST_FUNCTION(telemetry_messenger_do_work_destroy_message_receiver)
 
     (void)telemetry_messenger_unsubscribe_for_messages(handle);
 
-    time_t current_time = time(NULL);
+    tickcounter_ms_t current_time = TEST_CURRENT_TIME_MS;
     MESSENGER_DO_WORK_EXP_CALL_PROFILE *do_work_profile = get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE_STARTED, false, true, 0, 0, current_time, DEFAULT_EVENT_SEND_TIMEOUT_SECS);
     umock_c_reset_all_calls();
     set_expected_calls_for_telemetry_messenger_do_work(do_work_profile);
@@ -2775,7 +2818,7 @@ static void test_send_events_for_callbacks(MESSAGE_SEND_RESULT message_send_resu
 
     ASSERT_ARE_EQUAL(int, test_config->number_test_events, send_events(handle, test_config->number_test_events));
 
-    time_t current_time = time(NULL);
+    tickcounter_ms_t current_time = TEST_CURRENT_TIME_MS;
     MESSENGER_DO_WORK_EXP_CALL_PROFILE *mdwp = get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE_STARTED, false, false, 1, 0, current_time, DEFAULT_EVENT_SEND_TIMEOUT_SECS);
     mdwp->send_pending_events_test_config = test_config;
 
@@ -3083,7 +3126,7 @@ TEST_FUNCTION(telemetry_messenger_unsubscribe_for_messages_success)
     // act
     int unsubscription_result = telemetry_messenger_unsubscribe_for_messages(handle);
 
-    time_t current_time = time(NULL);
+    tickcounter_ms_t current_time = TEST_CURRENT_TIME_MS;
     MESSENGER_DO_WORK_EXP_CALL_PROFILE *do_work_profile = get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE_STARTED, false, true, 0, 0, current_time, DEFAULT_EVENT_SEND_TIMEOUT_SECS);
     crank_telemetry_messenger_do_work(handle, do_work_profile);
 
@@ -3231,7 +3274,7 @@ TEST_FUNCTION(telemetry_messenger_get_send_status_BUSY_succeeds)
     TELEMETRY_MESSENGER_SEND_STATUS send_status_wts;
     int result_wts = telemetry_messenger_get_send_status(handle, &send_status_wts);
 
-    time_t current_time = time(NULL);
+    tickcounter_ms_t current_time = TEST_CURRENT_TIME_MS;
     MESSENGER_DO_WORK_EXP_CALL_PROFILE *mdwp = get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE_STARTED, false, false, 1, 0, current_time, DEFAULT_EVENT_SEND_TIMEOUT_SECS);
     crank_telemetry_messenger_do_work(handle, mdwp);
 
@@ -3319,6 +3362,63 @@ TEST_FUNCTION(telemetry_messenger_set_option_EVENT_SEND_TIMEOUT_SECS)
     telemetry_messenger_destroy(handle);
 }
 
+TEST_FUNCTION(telemetry_messenger_set_option_EVENT_SEND_TIMEOUT_MS)
+{
+    // arrange
+    TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
+    TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger2(config, false);
+
+    size_t value = 250;
+
+    // act
+    int result = telemetry_messenger_set_option(handle, TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_MS, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_NOT_NULL(handle);
+
+    // cleanup
+    telemetry_messenger_destroy(handle);
+}
+
+TEST_FUNCTION(telemetry_messenger_set_option_EVENT_SEND_TIMEOUT_SECS_overflow)
+{
+    // arrange
+    TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
+    TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger2(config, false);
+
+    size_t value = SIZE_MAX;
+
+    // act
+    int result = telemetry_messenger_set_option(handle, TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_SECS, &value);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    telemetry_messenger_destroy(handle);
+}
+
+#if SIZE_MAX > UINT32_MAX
+TEST_FUNCTION(telemetry_messenger_set_option_RECEIVER_LINK_CREDIT_too_large)
+{
+    // arrange
+    TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
+    TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger2(config, false);
+
+    size_t value = (size_t)UINT32_MAX + 1;
+
+    // act
+    int result = telemetry_messenger_set_option(handle, TELEMETRY_MESSENGER_OPTION_RECEIVER_LINK_CREDIT, &value);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    telemetry_messenger_destroy(handle);
+}
+#endif
+
 TEST_FUNCTION(telemetry_messenger_set_option_SAVED_OPTIONS)
 {
     // arrange
@@ -3555,7 +3655,7 @@ static void set_expected_calls_for_telemetry_messenger_retrieve_options()
 {
     EXPECTED_CALL(OptionHandler_Create(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG));
 
-    STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER_HANDLE, TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_SECS, IGNORED_ARG))
+    STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER_HANDLE, TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_MS, IGNORED_ARG))
         .IgnoreArgument(3);
 }
 
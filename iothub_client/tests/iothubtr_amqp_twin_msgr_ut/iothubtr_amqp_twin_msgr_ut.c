@@ -166,6 +166,7 @@ static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 #define TEST_SYMBOL_AMQP_VALUE                               (AMQP_VALUE)0x4490
 #define TEST_MSG_ANNOTATIONS_AMQP_VALUE                      (AMQP_VALUE)0x4491
 #define TEST_PROPERTIES_HANDLE                               (PROPERTIES_HANDLE)0x4492
+#define TEST_TICK_COUNTER_HANDLE                             (TICK_COUNTER_HANDLE)0x4493
 
 #define INDEFINITE_TIME                                      ((time_t)-1)
 #define DEFAULT_TWIN_SEND_LINK_SOURCE_NAME                   "twin"
@@ -243,7 +244,7 @@ int STRING_sprintf(STRING_HANDLE handle, const char* format, ...)
 #endif
 
 static int saved_malloc_returns_count = 0;
-static void* saved_malloc_returns[20];
+static void* saved_malloc_returns[128];
 
 static void* TEST_malloc(size_t size)
 {
@@ -303,10 +304,21 @@ static AMQP_MESSENGER_HANDLE TEST_amqp_messenger_create(const AMQP_MESSENGER_CON
     TEST_amqp_messenger_create_config.on_state_changed_context = messenger_config->on_state_changed_context;
     TEST_amqp_messenger_create_config.on_subscription_changed_callback = messenger_config->on_subscription_changed_callback;
     TEST_amqp_messenger_create_config.on_subscription_changed_context = messenger_config->on_subscription_changed_context;
+    TEST_amqp_messenger_create_config.tick_counter = messenger_config->tick_counter;
 
     return TEST_amqp_messenger_create_return;
 }
 
+static ON_AMQP_MESSENGER_MESSAGE_RECEIVED TEST_amqp_messenger_subscribe_for_messages_on_message_received_callback;
+static void* TEST_amqp_messenger_subscribe_for_messages_context;
+static int TEST_amqp_messenger_subscribe_for_messages(AMQP_MESSENGER_HANDLE messenger_handle, ON_AMQP_MESSENGER_MESSAGE_RECEIVED on_message_received_callback, void* context)
+{
+    (void)messenger_handle;
+    TEST_amqp_messenger_subscribe_for_messages_on_message_received_callback = on_message_received_callback;
+    TEST_amqp_messenger_subscribe_for_messages_context = context;
+    return 0;
+}
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -462,6 +474,27 @@ static void on_twin_get_completed_callback(TWIN_UPDATE_TYPE update_type, const c
     get_twin_completed_context = context;
 }
 
+#define TEST_GET_TWIN_OPERATION_COUNT 40
+static size_t get_twin_completed_count_by_context[TEST_GET_TWIN_OPERATION_COUNT];
+static size_t get_twin_completed_unknown_context_count;
+static void on_twin_get_completed_count_by_context_callback(TWIN_UPDATE_TYPE update_type, const char* payload, size_t size, const void* context)
+{
+    size_t index = (size_t)context - 1;
+
+    (void)update_type;
+    (void)payload;
+    (void)size;
+
+    if (index < TEST_GET_TWIN_OPERATION_COUNT)
+    {
+        get_twin_completed_count_by_context[index]++;
+    }
+    else
+    {
+        get_twin_completed_unknown_context_count++;
+    }
+}
+
 // ---------- Expected Calls ---------- //
 
 static void set_generate_unique_id_expected_calls()
@@ -502,7 +535,7 @@ static void set_expected_calls_for_twin_messenger_create(TWIN_MESSENGER_CONFIG*
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_ARG, config->iothub_host_fqdn))
         .CopyOutArgumentBuffer(1, &config->iothub_host_fqdn, sizeof(config->iothub_host_fqdn));
     STRICT_EXPECTED_CALL(singlylinkedlist_create());
-    STRICT_EXPECTED_CALL(singlylinkedlist_create());
+    STRICT_EXPECTED_CALL(malloc(IGNORED_ARG)); // operations index
 
     set_create_link_attach_properties_expected_calls(config);
 
@@ -521,6 +554,34 @@ static void set_twin_messenger_report_state_async_expected_calls(CONSTBUFFER_HAN
     STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_ARG, IGNORED_ARG));
 }
 
+static void set_on_amqp_message_received_get_twin_response_expected_calls(const char* correlation_id, BINARY_DATA* twin_report)
+{
+    PROPERTIES_HANDLE properties = TEST_PROPERTIES_HANDLE;
+    AMQP_VALUE correlation_id_value = TEST_STRING_AMQP_VALUE;
+    annotations message_annotations = NULL;
+    MESSAGE_BODY_TYPE body_type = MESSAGE_BODY_TYPE_DATA;
+    size_t body_count = 1;
+
+    STRICT_EXPECTED_CALL(amqp_messenger_destroy_disposition_info(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(message_get_properties(TEST_MESSAGE_HANDLE, IGNORED_ARG))
+        .CopyOutArgumentBuffer(2, &properties, sizeof(properties));
+    STRICT_EXPECTED_CALL(properties_get_correlation_id(TEST_PROPERTIES_HANDLE, IGNORED_ARG))
+        .CopyOutArgumentBuffer(2, &correlation_id_value, sizeof(correlation_id_value));
+    STRICT_EXPECTED_CALL(amqpvalue_get_string(TEST_STRING_AMQP_VALUE, IGNORED_ARG))
+        .CopyOutArgumentBuffer(2, &correlation_id, sizeof(correlation_id));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_ARG, IGNORED_ARG))
+        .CopyOutArgumentBuffer(1, &correlation_id, sizeof(correlation_id));
+    STRICT_EXPECTED_CALL(properties_destroy(TEST_PROPERTIES_HANDLE));
+    STRICT_EXPECTED_CALL(message_get_message_annotations(TEST_MESSAGE_HANDLE, IGNORED_ARG))
+        .CopyOutArgumentBuffer(2, &message_annotations, sizeof(message_annotations));
+    STRICT_EXPECTED_CALL(message_get_body_type(TEST_MESSAGE_HANDLE, IGNORED_ARG))
+        .CopyOutArgumentBuffer(2, &body_type, sizeof(body_type));
+    STRICT_EXPECTED_CALL(message_get_body_amqp_data_count(TEST_MESSAGE_HANDLE, IGNORED_ARG))
+        .CopyOutArgumentBuffer(2, &body_count, sizeof(body_count));
+    STRICT_EXPECTED_CALL(message_get_body_amqp_data_in_place(TEST_MESSAGE_HANDLE, 0, IGNORED_ARG))
+        .CopyOutArgumentBuffer(3, twin_report, sizeof(BINARY_DATA));
+}
+
 static void set_twin_messenger_start_expected_calls()
 {
     STRICT_EXPECTED_CALL(amqp_messenger_set_option(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG));
@@ -556,13 +617,9 @@ static void set_process_timeouts_expected_calls(time_t current_time, size_t numb
         STRICT_EXPECTED_CALL(get_difftime(current_time, IGNORED_ARG)).SetReturn(0); // Simulate it's not expired.
     }
 
-
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove_if(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG));
-
     for (i = 0; i < number_of_expired_pending_operations; i++)
     {
         STRICT_EXPECTED_CALL(get_difftime(current_time, IGNORED_ARG)).SetReturn(10000000); // Simulate it's expired for sure.
-        STRICT_EXPECTED_CALL(free(IGNORED_ARG)); // correlation id
         STRICT_EXPECTED_CALL(free(IGNORED_ARG));
     }
 
@@ -575,7 +632,6 @@ static void set_process_timeouts_expected_calls(time_t current_time, size_t numb
 static void set_create_twin_operation_context_expected_calls()
 {
     STRICT_EXPECTED_CALL(malloc(IGNORED_ARG));
-    set_generate_unique_id_expected_calls();
 }
 
 static void set_add_map_item_expected_calls(const char* name, const char* value)
@@ -682,8 +738,6 @@ static void set_twin_messenger_do_work_expected_calls(DOWORK_TEST_PROFILE* dwtp)
         {
             set_create_twin_operation_context_expected_calls();
 
-            STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_ARG, IGNORED_ARG));
-
             set_send_twin_operation_request_expected_calls(dwtp->current_time, TWIN_OPERATION_TYPE_PATCH);
 
             STRICT_EXPECTED_CALL(CONSTBUFFER_DecRef(IGNORED_ARG));
@@ -696,9 +750,7 @@ static void set_twin_messenger_do_work_expected_calls(DOWORK_TEST_PROFILE* dwtp)
         // This one is for receiving updates:
         if (dwtp->subscription_state == TWIN_SUBSCRIPTION_STATE_GET_COMPLETE_PROPERTIES)
         {
-            STRICT_EXPECTED_CALL(malloc(IGNORED_ARG)); // creating context.
-            set_generate_unique_id_expected_calls();
-            STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_ARG, IGNORED_ARG));
+            set_create_twin_operation_context_expected_calls();
             set_send_twin_operation_request_expected_calls(dwtp->current_time, TWIN_OPERATION_TYPE_GET);
         }
     }
@@ -720,6 +772,7 @@ static TWIN_MESSENGER_CONFIG* get_twin_messenger_config()
     g_twin_msgr_config.iothub_host_fqdn = TEST_IOTHUB_HOST_FQDN;
     g_twin_msgr_config.on_state_changed_callback = TEST_on_state_changed_callback;
     g_twin_msgr_config.on_state_changed_context = TEST_ON_STATE_CHANGED_CB_CONTEXT;
+    g_twin_msgr_config.tick_counter = TEST_TICK_COUNTER_HANDLE;
 
     return &g_twin_msgr_config;
 }
@@ -814,6 +867,7 @@ static void register_global_mock_hooks()
     REGISTER_GLOBAL_MOCK_HOOK(calloc, TEST_calloc);
     REGISTER_GLOBAL_MOCK_HOOK(free, TEST_free);
     REGISTER_GLOBAL_MOCK_HOOK(amqp_messenger_create, TEST_amqp_messenger_create);
+    REGISTER_GLOBAL_MOCK_HOOK(amqp_messenger_subscribe_for_messages, TEST_amqp_messenger_subscribe_for_messages);
     REGISTER_GLOBAL_MOCK_HOOK(CONSTBUFFER_IncRef, real_CONSTBUFFER_IncRef);
     REGISTER_GLOBAL_MOCK_HOOK(CONSTBUFFER_DecRef, real_CONSTBUFFER_DecRef);
     REGISTER_GLOBAL_MOCK_HOOK(CONSTBUFFER_GetContent, real_CONSTBUFFER_GetContent);
@@ -989,6 +1043,10 @@ static void reset_test_data()
 
     memset(&TEST_amqp_messenger_create_config, 0, sizeof(TEST_amqp_messenger_create_config));
     TEST_amqp_messenger_create_return = TEST_AMQP_MESSENGER_HANDLE;
+    TEST_amqp_messenger_subscribe_for_messages_on_message_received_callback = NULL;
+    TEST_amqp_messenger_subscribe_for_messages_context = NULL;
+    memset(get_twin_completed_count_by_context, 0, sizeof(get_twin_completed_count_by_context));
+    get_twin_completed_unknown_context_count = 0;
 
     TEST_on_report_state_complete_callback_result = TWIN_REPORT_STATE_RESULT_SUCCESS;
     TEST_on_report_state_complete_callback_reason = TWIN_REPORT_STATE_REASON_NONE;
@@ -1098,6 +1156,24 @@ TEST_FUNCTION(twin_msgr_create_NULL_device_id)
     twin_messenger_destroy(handle);
 }
 
+TEST_FUNCTION(twin_msgr_create_NULL_tick_counter)
+{
+    // arrange
+    TWIN_MESSENGER_CONFIG* config = get_twin_messenger_config();
+    config->tick_counter = NULL;
+
+    umock_c_reset_all_calls();
+
+    // act
+    TWIN_MESSENGER_HANDLE handle = twin_messenger_create(config);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(handle);
+
+    // cleanup
+}
+
 TEST_FUNCTION(twin_msgr_create_success)
 {
     // arrange
@@ -1119,6 +1195,7 @@ TEST_FUNCTION(twin_msgr_create_success)
     ASSERT_ARE_EQUAL(char_ptr, DEFAULT_TWIN_RECEIVE_LINK_TARGET_NAME, (void*)TEST_amqp_messenger_create_config.receive_link.source_suffix);
     ASSERT_IS_NOT_NULL(TEST_amqp_messenger_create_config.on_state_changed_callback);
     ASSERT_IS_NOT_NULL(TEST_amqp_messenger_create_config.on_subscription_changed_callback);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)TEST_TICK_COUNTER_HANDLE, (void*)TEST_amqp_messenger_create_config.tick_counter);
     ASSERT_IS_NOT_NULL(handle);
 
     // cleanup
@@ -1308,7 +1385,6 @@ TEST_FUNCTION(twin_msgr_get_send_status_IDLE_success)
 
     umock_c_reset_all_calls();
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG));
 
     // act
     int result = twin_messenger_get_send_status(handle, &send_status);
@@ -1364,9 +1440,6 @@ TEST_FUNCTION(twin_msgr_get_send_status_BUSY_in_progress_success)
     umock_c_reset_all_calls();
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
-
     // act
     int result = twin_messenger_get_send_status(handle, &send_status);
 
@@ -1630,7 +1703,6 @@ TEST_FUNCTION(twin_messenger_get_twin_async_success)
 
     umock_c_reset_all_calls();
     set_create_twin_operation_context_expected_calls();
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_ARG, IGNORED_ARG));
 
     set_create_amqp_message_for_twin_operation_expected_calls(TWIN_OPERATION_TYPE_GET);
     STRICT_EXPECTED_CALL(get_time(IGNORED_ARG)).SetReturn(g_initial_time);
@@ -1648,6 +1720,91 @@ TEST_FUNCTION(twin_messenger_get_twin_async_success)
     twin_messenger_destroy(handle);
 }
 
+TEST_FUNCTION(twin_messenger_get_twin_async_many_in_flight_success)
+{
+    // arrange
+    TWIN_MESSENGER_CONFIG* config = get_twin_messenger_config();
+    TWIN_MESSENGER_HANDLE handle = create_twin_messenger(config);
+    TWIN_MESSENGER_SEND_STATUS send_status;
+    size_t i;
+
+    umock_c_reset_all_calls();
+
+    // act
+    // More operations than the initial size of the correlation-id index, forcing it to grow.
+    for (i = 0; i < TEST_GET_TWIN_OPERATION_COUNT; i++)
+    {
+        int result = twin_messenger_get_twin_async(handle, on_twin_get_completed_count_by_context_callback, (void*)(i + 1));
+        ASSERT_ARE_EQUAL(int, 0, result);
+    }
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, twin_messenger_get_send_status(handle, &send_status));
+    ASSERT_ARE_EQUAL(int, TWIN_MESSENGER_SEND_STATUS_IDLE, send_status);
+
+    // cleanup
+    twin_messenger_destroy(handle);
+}
+
+TEST_FUNCTION(twin_messenger_get_twin_async_many_in_flight_out_of_order_responses_success)
+{
+    // arrange
+    // Correlation-ids are the hexadecimal sequence number of each operation.
+    static const size_t response_order[] = { 37, 3, 20, 0, 39, 16 };
+    static const char* response_correlation_ids[] = { "25", "3", "14", "0", "27", "10" };
+    unsigned char twin_report_bytes[] = { '{', '}' };
+    BINARY_DATA twin_report;
+    TWIN_MESSENGER_CONFIG* config = get_twin_messenger_config();
+    TWIN_MESSENGER_HANDLE handle = create_twin_messenger(config);
+    size_t i;
+
+    twin_report.bytes = twin_report_bytes;
+    twin_report.length = sizeof(twin_report_bytes);
+
+    for (i = 0; i < TEST_GET_TWIN_OPERATION_COUNT; i++)
+    {
+        ASSERT_ARE_EQUAL(int, 0, twin_messenger_get_twin_async(handle, on_twin_get_completed_count_by_context_callback, (void*)(i + 1)));
+    }
+
+    ASSERT_IS_NOT_NULL(TEST_amqp_messenger_subscribe_for_messages_on_message_received_callback);
+
+    // act
+    for (i = 0; i < sizeof(response_order) / sizeof(response_order[0]); i++)
+    {
+        AMQP_MESSENGER_DISPOSITION_RESULT disposition_result;
+
+        umock_c_reset_all_calls();
+        set_on_amqp_message_received_get_twin_response_expected_calls(response_correlation_ids[i], &twin_report);
+
+        disposition_result = TEST_amqp_messenger_subscribe_for_messages_on_message_received_callback(
+            TEST_MESSAGE_HANDLE, NULL, TEST_amqp_messenger_subscribe_for_messages_context);
+
+        // assert
+        ASSERT_ARE_EQUAL(int, AMQP_MESSENGER_DISPOSITION_RESULT_ACCEPTED, disposition_result);
+        ASSERT_ARE_EQUAL(size_t, 1, get_twin_completed_count_by_context[response_order[i]]);
+    }
+
+    for (i = 0; i < TEST_GET_TWIN_OPERATION_COUNT; i++)
+    {
+        size_t j;
+        size_t expected_count = 0;
+
+        for (j = 0; j < sizeof(response_order) / sizeof(response_order[0]); j++)
+        {
+            if (response_order[j] == i)
+            {
+                expected_count = 1;
+            }
+        }
+
+        ASSERT_ARE_EQUAL(size_t, expected_count, get_twin_completed_count_by_context[i]);
+    }
+
+    ASSERT_ARE_EQUAL(size_t, 0, get_twin_completed_unknown_context_count);
+
+    // cleanup
+    twin_messenger_destroy(handle);
+}
 
 TEST_FUNCTION(twin_messenger_get_twin_async_NULL_handle)
 {
@@ -1692,8 +1849,7 @@ TEST_FUNCTION(twin_messenger_get_twin_async_failure_checks)
     TWIN_MESSENGER_HANDLE handle = create_twin_messenger(config);
 
     umock_c_reset_all_calls();
-    set_create_twin_operation_context_expected_calls(); // 0 - 2
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_ARG, IGNORED_ARG));
+    set_create_twin_operation_context_expected_calls(); // 0
 
     set_create_amqp_message_for_twin_operation_expected_calls(TWIN_OPERATION_TYPE_GET);
     STRICT_EXPECTED_CALL(get_time(IGNORED_ARG)).SetReturn(g_initial_time);
@@ -110,11 +110,13 @@ extern "C"
 #undef ENABLE_MOCK_FILTERING_SWITCH
 #define ENABLE_MOCK_FILTERING
 
+#define please_mock_amqp_connection_acquire_session_handle MOCK_ENABLED
 #define please_mock_amqp_connection_create MOCK_ENABLED
 #define please_mock_amqp_connection_destroy MOCK_ENABLED
 #define please_mock_amqp_connection_do_work MOCK_ENABLED
 #define please_mock_amqp_connection_get_cbs_handle MOCK_ENABLED
 #define please_mock_amqp_connection_get_session_handle MOCK_ENABLED
+#define please_mock_amqp_connection_release_session_handle MOCK_ENABLED
 #define please_mock_amqp_connection_set_logging MOCK_ENABLED
 #define please_mock_amqp_device_clone_message_disposition_info MOCK_ENABLED
 #define please_mock_amqp_device_create MOCK_ENABLED
@@ -475,6 +477,7 @@ static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 #define TEST_X509_PRIVATE_KEY                      "Raphael Rabello"
 #define TEST_MESSAGE_SOURCE_CHAR_PTR               "messagereceiver_link_name"
 #define TEST_RETRY_CONTROL_HANDLE                  (RETRY_CONTROL_HANDLE)0x4276
+#define TEST_TICK_COUNTER_HANDLE                   (TICK_COUNTER_HANDLE)0x4277
 
 static TRANSPORT_CALLBACKS_INFO transport_cb_info;
 static void* transport_cb_ctx = (void*)0x499922;
@@ -518,7 +521,8 @@ static void set_expected_calls_for_Create(IOTHUBTRANSPORT_CONFIG* transport_conf
     STRICT_EXPECTED_CALL(IoTHub_Transport_ValidateCallbacks(IGNORED_ARG) );
     EXPECTED_CALL(malloc(IGNORED_ARG));
 
-    STRICT_EXPECTED_CALL(retry_control_create(DEFAULT_RETRY_POLICY, DEFAULT_MAX_RETRY_TIME_IN_SECS));
+    STRICT_EXPECTED_CALL(tickcounter_create());
+    STRICT_EXPECTED_CALL(retry_control_create(DEFAULT_RETRY_POLICY, DEFAULT_MAX_RETRY_TIME_IN_SECS, TEST_TICK_COUNTER_HANDLE));
 
     if (transport_config->upperConfig->protocolGatewayHostName != NULL)
     {
@@ -625,7 +629,7 @@ static void set_expected_calls_for_Register(IOTHUB_DEVICE_CONFIG* device_config,
     EXPECTED_CALL(iothubtransportamqp_methods_create(TEST_IOTHUB_HOST_FQDN_CHAR_PTR, device_config->deviceId, NULL));
 
     // replicate_device_options_to
-    STRICT_EXPECTED_CALL(amqp_device_set_option(TEST_DEVICE_HANDLE, DEVICE_OPTION_EVENT_SEND_TIMEOUT_SECS, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(amqp_device_set_option(TEST_DEVICE_HANDLE, DEVICE_OPTION_EVENT_SEND_TIMEOUT_MS, IGNORED_ARG));
 
     if (is_using_cbs)
     {
@@ -659,6 +663,7 @@ static void set_expected_calls_for_establish_amqp_connection()
 {
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE))
         .SetReturn(TEST_IOTHUB_HOST_FQDN_CHAR_PTR);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_TICK_COUNTER_HANDLE, IGNORED_ARG));
     EXPECTED_CALL(amqp_connection_create(IGNORED_ARG));
 }
 
@@ -836,6 +841,7 @@ static void set_expected_calls_for_Destroy(int number_of_registered_devices, IOT
     STRICT_EXPECTED_CALL(amqp_connection_destroy(TEST_AMQP_CONNECTION_HANDLE));
     STRICT_EXPECTED_CALL(xio_destroy(TEST_UNDERLYING_IO_TRANSPORT));
     STRICT_EXPECTED_CALL(retry_control_destroy(TEST_RETRY_CONTROL_HANDLE));
+    STRICT_EXPECTED_CALL(tickcounter_destroy(TEST_TICK_COUNTER_HANDLE));
     STRICT_EXPECTED_CALL(STRING_delete(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE));
     EXPECTED_CALL(free(IGNORED_ARG));
 }
@@ -924,6 +930,7 @@ static ON_AMQP_CONNECTION_STATE_CHANGED TEST_amqp_connection_create_saved_on_sta
 static const void* TEST_amqp_connection_create_saved_on_state_changed_context;
 static size_t TEST_amqp_connection_create_saved_c2d_keep_alive_freq_secs;
 static double TEST_amqp_connection_create_saved_cl2svc_keep_alive_send_ratio;
+static size_t TEST_amqp_connection_create_saved_max_devices_per_session;
 static AMQP_CONNECTION_HANDLE TEST_amqp_connection_create_return;
 static AMQP_CONNECTION_HANDLE TEST_amqp_connection_create(AMQP_CONNECTION_CONFIG* config)
 {
@@ -933,6 +940,7 @@ static AMQP_CONNECTION_HANDLE TEST_amqp_connection_create(AMQP_CONNECTION_CONFIG
     TEST_amqp_connection_create_saved_on_state_changed_context = config->on_state_changed_context;
     TEST_amqp_connection_create_saved_c2d_keep_alive_freq_secs = config->svc2cl_keep_alive_timeout_secs;
     TEST_amqp_connection_create_saved_cl2svc_keep_alive_send_ratio = config->cl2svc_keep_alive_send_ratio;
+    TEST_amqp_connection_create_saved_max_devices_per_session = config->max_devices_per_session;
 
     return TEST_amqp_connection_create_return;
 }
@@ -947,6 +955,14 @@ static int TEST_amqp_connection_get_session_handle(AMQP_CONNECTION_HANDLE conn_h
     return TEST_amqp_connection_get_session_handle_return;
 }
 
+static int TEST_amqp_connection_acquire_session_handle(AMQP_CONNECTION_HANDLE conn_handle, SESSION_HANDLE* session_handle)
+{
+    (void)conn_handle;
+    *session_handle = TEST_SESSION_HANDLE;
+
+    return 0;
+}
+
 static CBS_HANDLE TEST_amqp_connection_get_cbs_handle_cbs_handle;
 static int TEST_amqp_connection_get_cbs_handle_return;
 static int TEST_amqp_connection_get_cbs_handle(AMQP_CONNECTION_HANDLE conn_handle, CBS_HANDLE* cbs_handle)
@@ -962,13 +978,23 @@ static double TEST_get_difftime(time_t t1, time_t t0)
     return difftime(t1, t0);
 }
 
+static tickcounter_ms_t TEST_current_ms;
+static int TEST_tickcounter_get_current_ms(TICK_COUNTER_HANDLE tick_counter, tickcounter_ms_t* current_ms)
+{
+    (void)tick_counter;
+    *current_ms = TEST_current_ms;
+    return 0;
+}
+
 static ON_DEVICE_STATE_CHANGED TEST_device_create_saved_on_state_changed_callback;
 static void* TEST_device_create_saved_on_state_changed_context;
+static TICK_COUNTER_HANDLE TEST_device_create_saved_tick_counter;
 static AMQP_DEVICE_HANDLE TEST_device_create_return;
 static AMQP_DEVICE_HANDLE TEST_device_create(AMQP_DEVICE_CONFIG* config)
 {
     TEST_device_create_saved_on_state_changed_callback = config->on_state_changed_callback;
     TEST_device_create_saved_on_state_changed_context = config->on_state_changed_context;
+    TEST_device_create_saved_tick_counter = config->tick_counter;
     return TEST_device_create_return;
 }
 
@@ -1045,6 +1071,7 @@ static IOTHUB_DEVICE_CONFIG* create_device_config(const char* device_id, bool us
     }
 
     device_config.moduleId = NULL;
+    device_config.tick_counter = TEST_TICK_COUNTER_HANDLE;
 
     return &device_config;
 }
@@ -1170,6 +1197,7 @@ static void register_umock_alias_types()
     REGISTER_UMOCK_ALIAS_TYPE(PDLIST_ENTRY, void*);
     REGISTER_UMOCK_ALIAS_TYPE(const PDLIST_ENTRY, void*);
     REGISTER_UMOCK_ALIAS_TYPE(RETRY_CONTROL_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(TICK_COUNTER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(SESSION_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(SINGLYLINKEDLIST_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(LIST_ITEM_HANDLE, void*);
@@ -1208,9 +1236,11 @@ static void register_global_mock_hooks()
 
     REGISTER_GLOBAL_MOCK_HOOK(amqp_connection_create, TEST_amqp_connection_create);
     REGISTER_GLOBAL_MOCK_HOOK(amqp_connection_get_session_handle, TEST_amqp_connection_get_session_handle);
+    REGISTER_GLOBAL_MOCK_HOOK(amqp_connection_acquire_session_handle, TEST_amqp_connection_acquire_session_handle);
     REGISTER_GLOBAL_MOCK_HOOK(amqp_connection_get_cbs_handle, TEST_amqp_connection_get_cbs_handle);
 
     REGISTER_GLOBAL_MOCK_HOOK(get_difftime, TEST_get_difftime);
+    REGISTER_GLOBAL_MOCK_HOOK(tickcounter_get_current_ms, TEST_tickcounter_get_current_ms);
 
     REGISTER_GLOBAL_MOCK_HOOK(amqp_device_create, TEST_device_create);
     REGISTER_GLOBAL_MOCK_HOOK(amqp_device_subscribe_message, TEST_device_subscribe_message);
@@ -1266,6 +1296,9 @@ static void register_global_mock_returns()
     REGISTER_GLOBAL_MOCK_RETURN(OptionHandler_FeedOptions, OPTIONHANDLER_OK);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(OptionHandler_FeedOptions, OPTIONHANDLER_ERROR);
 
+    REGISTER_GLOBAL_MOCK_RETURN(tickcounter_create, TEST_TICK_COUNTER_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(tickcounter_create, NULL);
+
     REGISTER_GLOBAL_MOCK_RETURN(retry_control_create, TEST_RETRY_CONTROL_HANDLE);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(retry_control_create, NULL);
 
@@ -1295,6 +1328,7 @@ static void reset_test_data()
 
     TEST_device_create_saved_on_state_changed_callback = NULL;
     TEST_device_create_saved_on_state_changed_context = NULL;
+    TEST_device_create_saved_tick_counter = NULL;
     TEST_device_create_return = TEST_DEVICE_HANDLE;
 
     saved_registered_devices_list_count = 0;
@@ -1322,6 +1356,7 @@ static void initialize_test_variables()
 {
     TEST_current_time = time(NULL);
     ASSERT_IS_TRUE(INDEFINITE_TIME != TEST_current_time, "Failed setting TEST_current_time");
+    TEST_current_ms = 0;
 
     real_DList_InitializeListHead(&TEST_waitingToSend);
 }
@@ -2518,6 +2553,7 @@ TEST_FUNCTION(Register_succeeds)
     // assert
     ASSERT_IS_NOT_NULL(device_handle);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, TEST_TICK_COUNTER_HANDLE, TEST_device_create_saved_tick_counter);
 
     // cleanup
     destroy_transport(handle, device_handle, NULL);
@@ -2699,6 +2735,83 @@ TEST_FUNCTION(Unsubscribe_messages_succeeds)
     destroy_transport(handle, device_handle, NULL);
 }
 
+TEST_FUNCTION(GetLastConnectDuration_NULL_handle)
+{
+    // arrange
+    initialize_test_variables();
+    umock_c_reset_all_calls();
+
+    tickcounter_ms_t connectDuration;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_GetLastConnectDuration(NULL, &connectDuration);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+}
+
+TEST_FUNCTION(GetLastConnectDuration_not_connected_fails)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    crank_transport(handle, &TEST_waitingToSend, 0, DEVICE_STATE_STOPPED, false, true, false, false, 1, TEST_current_time, false);
+    umock_c_reset_all_calls();
+
+    tickcounter_ms_t connectDuration;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_GetLastConnectDuration(handle, &connectDuration);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+TEST_FUNCTION(GetLastConnectDuration_returns_time_from_connection_create_to_OPENED)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    TEST_current_ms = 1000;
+    crank_transport(handle, &TEST_waitingToSend, 0, DEVICE_STATE_STOPPED, false, true, false, false, 1, TEST_current_time, false);
+
+    TEST_current_ms = 1350;
+    TEST_amqp_connection_create_saved_on_state_changed_callback(
+        TEST_amqp_connection_create_saved_on_state_changed_context,
+        AMQP_CONNECTION_STATE_CLOSED, AMQP_CONNECTION_STATE_OPENED);
+    umock_c_reset_all_calls();
+
+    tickcounter_ms_t connectDuration = 0;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_GetLastConnectDuration(handle, &connectDuration);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(int, 350, (int)connectDuration);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
 TEST_FUNCTION(GetSendStatus_NULL_handle)
 {
     // arrange
@@ -2960,6 +3073,91 @@ TEST_FUNCTION(SetOption_device_specific_failure_check)
     destroy_transport(handle, device_handle, NULL);
 }
 
+TEST_FUNCTION(SetOption_event_send_timeout_ms_succeed)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    size_t value = 250;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG)).SetReturn(device_handle);
+    STRICT_EXPECTED_CALL(amqp_device_set_option(TEST_DEVICE_HANDLE, DEVICE_OPTION_EVENT_SEND_TIMEOUT_MS, &value))
+        .SetReturn(0);
+    EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_ARG)).SetReturn(NULL);
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_SetOption(handle, OPTION_EVENT_SEND_TIMEOUT_MS, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+TEST_FUNCTION(SetOption_event_send_timeout_secs_overflow_fails)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    size_t value = SIZE_MAX / 1000 + 1;
+
+    umock_c_reset_all_calls();
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_SetOption(handle, OPTION_EVENT_SEND_TIMEOUT_SECS, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+TEST_FUNCTION(SetOption_amqp_receiver_link_credit_succeed)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    size_t value = 5000;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG)).SetReturn(device_handle);
+    STRICT_EXPECTED_CALL(amqp_device_set_option(TEST_DEVICE_HANDLE, DEVICE_OPTION_RECEIVER_LINK_CREDIT, &value))
+        .SetReturn(0);
+    EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_ARG)).SetReturn(NULL);
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_SetOption(handle, OPTION_AMQP_RECEIVER_LINK_CREDIT, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
 TEST_FUNCTION(SetOption_CBS_transport_option_x509certificate)
 {
     // arrange
@@ -4025,6 +4223,7 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_Destroy_frees_proxy_options)
 
     STRICT_EXPECTED_CALL(singlylinkedlist_destroy(TEST_REGISTERED_DEVICES_LIST));
     STRICT_EXPECTED_CALL(retry_control_destroy(TEST_RETRY_CONTROL_HANDLE));
+    STRICT_EXPECTED_CALL(tickcounter_destroy(TEST_TICK_COUNTER_HANDLE));
     STRICT_EXPECTED_CALL(STRING_delete(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE));
     STRICT_EXPECTED_CALL(free(IGNORED_ARG));
     STRICT_EXPECTED_CALL(free(IGNORED_ARG));
@@ -4194,6 +4393,7 @@ TEST_FUNCTION(DoWork_success)
 
     ASSERT_IS_NOT_NULL(TEST_amqp_connection_create_saved_on_state_changed_callback);
 
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_TICK_COUNTER_HANDLE, IGNORED_ARG));
     TEST_amqp_connection_create_saved_on_state_changed_callback(
         TEST_amqp_connection_create_saved_on_state_changed_context,
         AMQP_CONNECTION_STATE_CLOSED, AMQP_CONNECTION_STATE_OPENED);
@@ -4239,6 +4439,7 @@ TEST_FUNCTION(on_amqp_connection_state_changed_CLOSED_unexpectedly)
     set_expected_calls_for_DoWork(&TEST_waitingToSend, 0, DEVICE_STATE_STOPPED, false, true, false, false, 1, TEST_current_time, false);
     IoTHubTransport_AMQP_Common_DoWork(handle);
 
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_TICK_COUNTER_HANDLE, IGNORED_ARG));
     TEST_amqp_connection_create_saved_on_state_changed_callback(
         TEST_amqp_connection_create_saved_on_state_changed_context,
         AMQP_CONNECTION_STATE_CLOSED, AMQP_CONNECTION_STATE_OPENED);
@@ -4428,6 +4629,131 @@ TEST_FUNCTION(DoWork_configures_AMQP_connection_using_cl2svc_keep_alive_send_rat
     destroy_transport(handle, device_handle, NULL);
 }
 
+TEST_FUNCTION(DoWork_acquires_device_session_when_max_devices_per_session_set)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    size_t max_devices_per_session = 50;
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_OK, IoTHubTransport_AMQP_Common_SetOption(handle, OPTION_AMQP_MAX_DEVICES_PER_SESSION, &max_devices_per_session));
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    umock_c_reset_all_calls();
+    set_expected_calls_for_DoWork(&TEST_waitingToSend, 0, DEVICE_STATE_STOPPED, false, true, false, false, 1, TEST_current_time, false);
+    IoTHubTransport_AMQP_Common_DoWork(handle);
+
+    TEST_amqp_connection_create_saved_on_state_changed_callback(
+        TEST_amqp_connection_create_saved_on_state_changed_context,
+        AMQP_CONNECTION_STATE_CLOSED, AMQP_CONNECTION_STATE_OPENED);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(amqp_connection_acquire_session_handle(TEST_AMQP_CONNECTION_HANDLE, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(amqp_connection_get_cbs_handle(TEST_AMQP_CONNECTION_HANDLE, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(amqp_device_start_async(TEST_DEVICE_HANDLE, TEST_SESSION_HANDLE, TEST_CBS_HANDLE));
+    STRICT_EXPECTED_CALL(amqp_device_do_work(TEST_DEVICE_HANDLE));
+    EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(amqp_connection_do_work(TEST_AMQP_CONNECTION_HANDLE));
+
+    // act
+    IoTHubTransport_AMQP_Common_DoWork(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, max_devices_per_session, TEST_amqp_connection_create_saved_max_devices_per_session);
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+TEST_FUNCTION(DoWork_max_devices_per_session_set_after_connection_uses_connection_session)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    umock_c_reset_all_calls();
+    set_expected_calls_for_DoWork(&TEST_waitingToSend, 0, DEVICE_STATE_STOPPED, false, true, false, false, 1, TEST_current_time, false);
+    IoTHubTransport_AMQP_Common_DoWork(handle);
+
+    TEST_amqp_connection_create_saved_on_state_changed_callback(
+        TEST_amqp_connection_create_saved_on_state_changed_context,
+        AMQP_CONNECTION_STATE_CLOSED, AMQP_CONNECTION_STATE_OPENED);
+
+    // Only applies to the next amqp_connection.
+    size_t max_devices_per_session = 50;
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_OK, IoTHubTransport_AMQP_Common_SetOption(handle, OPTION_AMQP_MAX_DEVICES_PER_SESSION, &max_devices_per_session));
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(amqp_connection_get_session_handle(TEST_AMQP_CONNECTION_HANDLE, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(amqp_connection_get_cbs_handle(TEST_AMQP_CONNECTION_HANDLE, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(amqp_device_start_async(TEST_DEVICE_HANDLE, TEST_SESSION_HANDLE, TEST_CBS_HANDLE));
+    STRICT_EXPECTED_CALL(amqp_device_do_work(TEST_DEVICE_HANDLE));
+    EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(amqp_connection_do_work(TEST_AMQP_CONNECTION_HANDLE));
+
+    // act
+    IoTHubTransport_AMQP_Common_DoWork(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, TEST_amqp_connection_create_saved_max_devices_per_session);
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+TEST_FUNCTION(Unregister_releases_device_session)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    size_t max_devices_per_session = 50;
+    (void)IoTHubTransport_AMQP_Common_SetOption(handle, OPTION_AMQP_MAX_DEVICES_PER_SESSION, &max_devices_per_session);
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    IoTHubTransport_AMQP_Common_DoWork(handle);
+    TEST_amqp_connection_create_saved_on_state_changed_callback(
+        TEST_amqp_connection_create_saved_on_state_changed_context,
+        AMQP_CONNECTION_STATE_CLOSED, AMQP_CONNECTION_STATE_OPENED);
+    IoTHubTransport_AMQP_Common_DoWork(handle);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
+        .SetReturn(TEST_DEVICE_ID_CHAR_PTR);
+    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_REGISTERED_DEVICES_LIST, IGNORED_ARG, IGNORED_ARG))
+        .SetReturn((LIST_ITEM_HANDLE)device_handle);
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_REGISTERED_DEVICES_LIST, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(iothubtransportamqp_methods_destroy(TEST_IOTHUBTRANSPORTAMQP_METHODS));
+    STRICT_EXPECTED_CALL(amqp_device_destroy(TEST_DEVICE_HANDLE));
+    STRICT_EXPECTED_CALL(amqp_connection_release_session_handle(TEST_AMQP_CONNECTION_HANDLE, TEST_SESSION_HANDLE));
+    STRICT_EXPECTED_CALL(STRING_delete(TEST_DEVICE_ID_STRING_HANDLE));
+    EXPECTED_CALL(free(IGNORED_ARG));
+
+    // act
+    IoTHubTransport_AMQP_Common_Unregister(device_handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, NULL, NULL);
+}
 
 TEST_FUNCTION(ConnectionStatusCallBack_UNAUTH_OK)
 {
@@ -5064,7 +5390,7 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_SetRetryPolicy_failure_checks)
     TRANSPORT_LL_HANDLE handle = create_transport();
 
     umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(retry_control_create(IOTHUB_CLIENT_RETRY_IMMEDIATE, 1600));
+    STRICT_EXPECTED_CALL(retry_control_create(IOTHUB_CLIENT_RETRY_IMMEDIATE, 1600, TEST_TICK_COUNTER_HANDLE));
     umock_c_negative_tests_snapshot();
 
     // act
@@ -5097,7 +5423,7 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_SetRetryPolicy_success)
     TRANSPORT_LL_HANDLE handle = create_transport();
 
     umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(retry_control_create(IOTHUB_CLIENT_RETRY_IMMEDIATE, 1600));
+    STRICT_EXPECTED_CALL(retry_control_create(IOTHUB_CLIENT_RETRY_IMMEDIATE, 1600, TEST_TICK_COUNTER_HANDLE));
     STRICT_EXPECTED_CALL(retry_control_destroy(TEST_RETRY_CONTROL_HANDLE));
 
     // act
@@ -109,6 +109,7 @@ static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 #define TEST_UNIQUE_ID                                    "ab345cd00829ef12"
 #define TEST_SESSION_HANDLE                               (SESSION_HANDLE)0x4453
 #define TEST_CBS_HANDLE                                   (CBS_HANDLE)0x4454
+#define TEST_SESSION_HANDLE_2                             (SESSION_HANDLE)0x4455
 
 // Helpers
 static int saved_malloc_returns_count = 0;
@@ -199,6 +200,7 @@ static AMQP_CONNECTION_CONFIG* get_amqp_connection_config()
     global_amqp_connection_config.is_trace_on = true;
     global_amqp_connection_config.svc2cl_keep_alive_timeout_secs = 123;
     global_amqp_connection_config.cl2svc_keep_alive_send_ratio   = 0.5;
+    global_amqp_connection_config.max_devices_per_session = 0;
 
     return &global_amqp_connection_config;
 }
@@ -917,6 +919,225 @@ TEST_FUNCTION(amqp_connection_get_session_handle_success)
     amqp_connection_destroy(handle);
 }
 
+TEST_FUNCTION(amqp_connection_acquire_session_handle_NULL_handle)
+{
+    // arrange
+    SESSION_HANDLE session_handle;
+
+    // act
+    int result = amqp_connection_acquire_session_handle(NULL, &session_handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+
+    // cleanup
+}
+
+TEST_FUNCTION(amqp_connection_acquire_session_handle_NULL_session_handle)
+{
+    // arrange
+    AMQP_CONNECTION_CONFIG* config = get_amqp_connection_config();
+
+    umock_c_reset_all_calls();
+    set_exp_calls_for_amqp_connection_create(config);
+
+    AMQP_CONNECTION_HANDLE handle = amqp_connection_create(config);
+
+    umock_c_reset_all_calls();
+
+    // act
+    int result = amqp_connection_acquire_session_handle(handle, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+
+    // cleanup
+    amqp_connection_destroy(handle);
+}
+
+TEST_FUNCTION(amqp_connection_acquire_session_handle_shared_session)
+{
+    // arrange
+    AMQP_CONNECTION_CONFIG* config = get_amqp_connection_config();
+
+    umock_c_reset_all_calls();
+    set_exp_calls_for_amqp_connection_create(config);
+
+    AMQP_CONNECTION_HANDLE handle = amqp_connection_create(config);
+
+    umock_c_reset_all_calls();
+
+    SESSION_HANDLE session_handle1;
+    SESSION_HANDLE session_handle2;
+
+    // act
+    int result1 = amqp_connection_acquire_session_handle(handle, &session_handle1);
+    int result2 = amqp_connection_acquire_session_handle(handle, &session_handle2);
+    amqp_connection_release_session_handle(handle, session_handle1);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, result1, 0);
+    ASSERT_ARE_EQUAL(int, result2, 0);
+    ASSERT_ARE_EQUAL(void_ptr, session_handle1, TEST_SESSION_HANDLE);
+    ASSERT_ARE_EQUAL(void_ptr, session_handle2, TEST_SESSION_HANDLE);
+
+    // cleanup
+    amqp_connection_destroy(handle);
+}
+
+TEST_FUNCTION(amqp_connection_acquire_session_handle_creates_session_when_full)
+{
+    // arrange
+    AMQP_CONNECTION_CONFIG* config = get_amqp_connection_config();
+    config->max_devices_per_session = 2;
+
+    umock_c_reset_all_calls();
+    set_exp_calls_for_amqp_connection_create(config);
+
+    AMQP_CONNECTION_HANDLE handle = amqp_connection_create(config);
+
+    SESSION_HANDLE session_handle1;
+    SESSION_HANDLE session_handle2;
+    SESSION_HANDLE session_handle3;
+    SESSION_HANDLE session_handle4;
+
+    (void)amqp_connection_acquire_session_handle(handle, &session_handle1);
+    (void)amqp_connection_acquire_session_handle(handle, &session_handle2);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(malloc(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(session_create(TEST_CONNECTION_HANDLE, NULL, NULL))
+        .SetReturn(TEST_SESSION_HANDLE_2);
+    STRICT_EXPECTED_CALL(session_set_incoming_window(TEST_SESSION_HANDLE_2, (uint32_t)DEFAULT_INCOMING_WINDOW_SIZE));
+    STRICT_EXPECTED_CALL(session_set_outgoing_window(TEST_SESSION_HANDLE_2, (uint32_t)DEFAULT_OUTGOING_WINDOW_SIZE));
+
+    // act
+    int result3 = amqp_connection_acquire_session_handle(handle, &session_handle3);
+    int result4 = amqp_connection_acquire_session_handle(handle, &session_handle4);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, session_handle1, TEST_SESSION_HANDLE);
+    ASSERT_ARE_EQUAL(void_ptr, session_handle2, TEST_SESSION_HANDLE);
+    ASSERT_ARE_EQUAL(int, result3, 0);
+    ASSERT_ARE_EQUAL(int, result4, 0);
+    ASSERT_ARE_EQUAL(void_ptr, session_handle3, TEST_SESSION_HANDLE_2);
+    ASSERT_ARE_EQUAL(void_ptr, session_handle4, TEST_SESSION_HANDLE_2);
+
+    // cleanup
+    amqp_connection_destroy(handle);
+}
+
+TEST_FUNCTION(amqp_connection_acquire_session_handle_session_create_fails)
+{
+    // arrange
+    AMQP_CONNECTION_CONFIG* config = get_amqp_connection_config();
+    config->max_devices_per_session = 1;
+
+    umock_c_reset_all_calls();
+    set_exp_calls_for_amqp_connection_create(config);
+
+    AMQP_CONNECTION_HANDLE handle = amqp_connection_create(config);
+
+    SESSION_HANDLE session_handle1;
+    SESSION_HANDLE session_handle2;
+
+    (void)amqp_connection_acquire_session_handle(handle, &session_handle1);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(malloc(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(session_create(TEST_CONNECTION_HANDLE, NULL, NULL))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(free(IGNORED_ARG));
+
+    // act
+    int result = amqp_connection_acquire_session_handle(handle, &session_handle2);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+
+    // cleanup
+    amqp_connection_destroy(handle);
+}
+
+TEST_FUNCTION(amqp_connection_release_session_handle_destroys_empty_session)
+{
+    // arrange
+    AMQP_CONNECTION_CONFIG* config = get_amqp_connection_config();
+    config->max_devices_per_session = 1;
+
+    umock_c_reset_all_calls();
+    set_exp_calls_for_amqp_connection_create(config);
+
+    AMQP_CONNECTION_HANDLE handle = amqp_connection_create(config);
+
+    SESSION_HANDLE session_handle1;
+    SESSION_HANDLE session_handle2;
+
+    (void)amqp_connection_acquire_session_handle(handle, &session_handle1);
+    STRICT_EXPECTED_CALL(session_create(TEST_CONNECTION_HANDLE, NULL, NULL))
+        .SetReturn(TEST_SESSION_HANDLE_2);
+    (void)amqp_connection_acquire_session_handle(handle, &session_handle2);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(session_destroy(TEST_SESSION_HANDLE_2));
+    STRICT_EXPECTED_CALL(free(IGNORED_ARG));
+
+    // act
+    amqp_connection_release_session_handle(handle, session_handle1);
+    amqp_connection_release_session_handle(handle, session_handle2);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, session_handle2, TEST_SESSION_HANDLE_2);
+
+    // cleanup
+    amqp_connection_destroy(handle);
+}
+
+TEST_FUNCTION(amqp_connection_destroy_with_additional_sessions_success)
+{
+    // arrange
+    AMQP_CONNECTION_CONFIG* config = get_amqp_connection_config();
+    config->max_devices_per_session = 1;
+
+    umock_c_reset_all_calls();
+    set_exp_calls_for_amqp_connection_create(config);
+
+    AMQP_CONNECTION_HANDLE handle = amqp_connection_create(config);
+
+    SESSION_HANDLE session_handle1;
+    SESSION_HANDLE session_handle2;
+
+    (void)amqp_connection_acquire_session_handle(handle, &session_handle1);
+    STRICT_EXPECTED_CALL(session_create(TEST_CONNECTION_HANDLE, NULL, NULL))
+        .SetReturn(TEST_SESSION_HANDLE_2);
+    (void)amqp_connection_acquire_session_handle(handle, &session_handle2);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(cbs_destroy(TEST_CBS_HANDLE));
+    STRICT_EXPECTED_CALL(session_destroy(TEST_SESSION_HANDLE_2));
+    STRICT_EXPECTED_CALL(free(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(session_destroy(TEST_SESSION_HANDLE));
+    STRICT_EXPECTED_CALL(connection_destroy(TEST_CONNECTION_HANDLE));
+    STRICT_EXPECTED_CALL(xio_destroy(TEST_SASL_IO_HANDLE));
+    STRICT_EXPECTED_CALL(saslmechanism_destroy(TEST_SASL_MECHANISM_HANDLE));
+    STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE));
+    STRICT_EXPECTED_CALL(free(handle));
+
+    // act
+    amqp_connection_destroy(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+}
+
 TEST_FUNCTION(amqp_connection_get_cbs_handle_NULL_handle)
 {
     // arrange
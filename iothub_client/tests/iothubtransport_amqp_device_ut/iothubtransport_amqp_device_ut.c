@@ -242,6 +242,7 @@ static AUTHENTICATION_HANDLE TEST_authentication_create(const AUTHENTICATION_CON
 
 static ON_TELEMETRY_MESSENGER_STATE_CHANGED_CALLBACK TEST_telemetry_messenger_create_saved_on_state_changed_callback;
 static void* TEST_telemetry_messenger_create_saved_on_state_changed_context;
+static TICK_COUNTER_HANDLE TEST_telemetry_messenger_create_saved_tick_counter;
 static TELEMETRY_MESSENGER_HANDLE TEST_telemetry_messenger_create_return;
 static TELEMETRY_MESSENGER_HANDLE TEST_telemetry_messenger_create(const TELEMETRY_MESSENGER_CONFIG *config, pfTransport_GetOption_Product_Info_Callback prod_info_cb, void* prod_info_ctx)
 {
@@ -249,16 +250,19 @@ static TELEMETRY_MESSENGER_HANDLE TEST_telemetry_messenger_create(const TELEMETR
     (void)prod_info_ctx;
     TEST_telemetry_messenger_create_saved_on_state_changed_callback = config->on_state_changed_callback;
     TEST_telemetry_messenger_create_saved_on_state_changed_context = config->on_state_changed_context;
+    TEST_telemetry_messenger_create_saved_tick_counter = config->tick_counter;
     return TEST_telemetry_messenger_create_return;
 }
 
 static TWIN_MESSENGER_STATE_CHANGED_CALLBACK TEST_twin_messenger_create_on_state_changed_callback;
 static void* TEST_twin_messenger_create_on_state_changed_context;
+static TICK_COUNTER_HANDLE TEST_twin_messenger_create_tick_counter;
 static TWIN_MESSENGER_HANDLE TEST_twin_messenger_create_return;
 static TWIN_MESSENGER_HANDLE TEST_twin_messenger_create(const TWIN_MESSENGER_CONFIG* messenger_config)
 {
     TEST_twin_messenger_create_on_state_changed_callback = messenger_config->on_state_changed_callback;
     TEST_twin_messenger_create_on_state_changed_context = messenger_config->on_state_changed_context;
+    TEST_twin_messenger_create_tick_counter = messenger_config->tick_counter;
     return TEST_twin_messenger_create_return;
 }
 
@@ -346,6 +350,7 @@ static AMQP_DEVICE_CONFIG* get_device_config(DEVICE_AUTH_MODE auth_mode)
     TEST_device_config.on_state_changed_callback = TEST_on_state_changed_callback;
     TEST_device_config.on_state_changed_context = TEST_ON_STATE_CHANGED_CONTEXT;
     TEST_device_config.authorization_module = TEST_AUTHORIZATION_HANDLE;
+    TEST_device_config.tick_counter = TEST_TICK_COUNTER_HANDLE;
 
     return &TEST_device_config;
 }
@@ -388,10 +393,12 @@ static void reset_test_data()
 
     TEST_telemetry_messenger_create_saved_on_state_changed_callback = NULL;
     TEST_telemetry_messenger_create_saved_on_state_changed_context = NULL;
+    TEST_telemetry_messenger_create_saved_tick_counter = NULL;
     TEST_telemetry_messenger_create_return = TEST_TELEMETRY_MESSENGER_HANDLE;
 
     TEST_twin_messenger_create_on_state_changed_callback = NULL;
     TEST_twin_messenger_create_on_state_changed_context = NULL;
+    TEST_twin_messenger_create_tick_counter = NULL;
     TEST_twin_messenger_create_return = TEST_TWIN_MESSENGER_HANDLE;
 
     TEST_telemetry_messenger_send_async_saved_message = NULL;
@@ -532,9 +539,6 @@ static void register_global_mock_returns()
 
     REGISTER_GLOBAL_MOCK_RETURN(twin_messenger_get_twin_async, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(twin_messenger_get_twin_async, 1);
-
-    REGISTER_GLOBAL_MOCK_RETURN(tickcounter_create, TEST_TICK_COUNTER_HANDLE);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(tickcounter_create, NULL);
 }
 
 // ---------- Expected Call Helpers ---------- //
@@ -584,8 +588,6 @@ static void set_expected_calls_for_device_create(AMQP_DEVICE_CONFIG *config, tim
 
     set_expected_calls_for_clone_device_config(config);
 
-    STRICT_EXPECTED_CALL(tickcounter_create());
-
     if (config->authentication_mode == DEVICE_AUTH_MODE_CBS)
     {
         set_expected_calls_for_create_authentication_instance(config);
@@ -695,8 +697,6 @@ static void set_expected_calls_for_device_destroy(AMQP_DEVICE_HANDLE handle, AMQ
         STRICT_EXPECTED_CALL(authentication_destroy(TEST_AUTHENTICATION_HANDLE));
     }
 
-    STRICT_EXPECTED_CALL(tickcounter_destroy(TEST_TICK_COUNTER_HANDLE));
-
     // destroy config
     STRICT_EXPECTED_CALL(free(config->iothub_host_fqdn));
     EXPECTED_CALL(free(IGNORED_ARG));
@@ -743,6 +743,14 @@ static void set_expected_calls_for_device_set_option(AMQP_DEVICE_HANDLE handle,
     {
         STRICT_EXPECTED_CALL(telemetry_messenger_set_option(TEST_TELEMETRY_MESSENGER_HANDLE, TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_SECS, option_value));
     }
+    else if (strcmp(DEVICE_OPTION_EVENT_SEND_TIMEOUT_MS, option_name) == 0)
+    {
+        STRICT_EXPECTED_CALL(telemetry_messenger_set_option(TEST_TELEMETRY_MESSENGER_HANDLE, TELEMETRY_MESSENGER_OPTION_EVENT_SEND_TIMEOUT_MS, option_value));
+    }
+    else if (strcmp(DEVICE_OPTION_RECEIVER_LINK_CREDIT, option_name) == 0)
+    {
+        STRICT_EXPECTED_CALL(telemetry_messenger_set_option(TEST_TELEMETRY_MESSENGER_HANDLE, TELEMETRY_MESSENGER_OPTION_RECEIVER_LINK_CREDIT, option_value));
+    }
     else if (strcmp(DEVICE_OPTION_SAVED_MESSENGER_OPTIONS, option_name) == 0)
     {
         STRICT_EXPECTED_CALL(OptionHandler_FeedOptions((OPTIONHANDLER_HANDLE)option_value, TEST_TELEMETRY_MESSENGER_HANDLE));
@@ -939,6 +947,21 @@ TEST_FUNCTION(device_create_NULL_config_on_state_changed_callback)
     // cleanup
 }
 
+TEST_FUNCTION(device_create_NULL_config_tick_counter)
+{
+    // arrange
+    AMQP_DEVICE_CONFIG* config = get_device_config(DEVICE_AUTH_MODE_CBS);
+    config->tick_counter = NULL;
+
+    // act
+    AMQP_DEVICE_HANDLE handle = amqp_device_create(config);
+
+    // assert
+    ASSERT_IS_NULL(handle);
+
+    // cleanup
+}
+
 TEST_FUNCTION(device_create_succeeds)
 {
     // arrange
@@ -953,6 +976,8 @@ TEST_FUNCTION(device_create_succeeds)
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_IS_NOT_NULL(handle);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_TICK_COUNTER_HANDLE, TEST_telemetry_messenger_create_saved_tick_counter);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_TICK_COUNTER_HANDLE, TEST_twin_messenger_create_tick_counter);
 
     // cleanup
     amqp_device_destroy(handle);
@@ -1906,6 +1931,56 @@ TEST_FUNCTION(device_set_option_MSGR_succeeds)
     amqp_device_destroy(handle);
 }
 
+TEST_FUNCTION(device_set_option_MSGR_milliseconds_succeeds)
+{
+    // arrange
+    ASSERT_IS_TRUE(INDEFINITE_TIME != TEST_current_time, "Failed setting TEST_current_time");
+
+    AMQP_DEVICE_CONFIG* config = get_device_config(DEVICE_AUTH_MODE_CBS);
+    AMQP_DEVICE_HANDLE handle = create_and_start_device(config, TEST_current_time);
+
+    size_t value = 250;
+
+    umock_c_reset_all_calls();
+    set_expected_calls_for_device_set_option(handle, config, DEVICE_OPTION_EVENT_SEND_TIMEOUT_MS, &value);
+
+    // act
+    int result = amqp_device_set_option(handle, DEVICE_OPTION_EVENT_SEND_TIMEOUT_MS, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_NOT_NULL(handle);
+
+    // cleanup
+    amqp_device_destroy(handle);
+}
+
+TEST_FUNCTION(device_set_option_receiver_link_credit_succeeds)
+{
+    // arrange
+    ASSERT_IS_TRUE(INDEFINITE_TIME != TEST_current_time, "Failed setting TEST_current_time");
+
+    AMQP_DEVICE_CONFIG* config = get_device_config(DEVICE_AUTH_MODE_CBS);
+    AMQP_DEVICE_HANDLE handle = create_and_start_device(config, TEST_current_time);
+
+    size_t value = 5000;
+
+    umock_c_reset_all_calls();
+    set_expected_calls_for_device_set_option(handle, config, DEVICE_OPTION_RECEIVER_LINK_CREDIT, &value);
+
+    // act
+    int result = amqp_device_set_option(handle, DEVICE_OPTION_RECEIVER_LINK_CREDIT, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_NOT_NULL(handle);
+
+    // cleanup
+    amqp_device_destroy(handle);
+}
+
 TEST_FUNCTION(device_set_option_X509_saved_auth_options)
 {
     // arrange
@@ -41,8 +41,7 @@ void real_free(void* ptr)
 #define ENABLE_MOCKS
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/optionhandler.h"
-#include "azure_c_shared_utility/agenttime.h"
-#include "azure_c_shared_utility/singlylinkedlist.h"
+#include "azure_c_shared_utility/tickcounter.h"
 #undef ENABLE_MOCKS
 
 #include "internal/message_queue.h"
@@ -61,7 +60,6 @@ static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 
 // Data definitions
 
-#define INDEFINITE_TIME                     ((time_t)-1)
 #define TEST_OPTIONHANDLER_HANDLE           (OPTIONHANDLER_HANDLE)0x7771
 #define TEST_PROCESS_MESSAGE_CONTEXT        (void*)0x7772
 #define TEST_PROCESS_COMPLETE_CONTEXT       (void*)0x7773
@@ -69,23 +67,21 @@ static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 #define USE_DEFAULT_CONFIG                  NULL
 #define TEST_SOME_OTHER_MESSAGE_ID          17777
 #define TEST_MQ_MESSAGE_HANDLE_2            (MQ_MESSAGE_HANDLE)0x7778
-#define TEST_LIST_ITEM_HANDLE               (LIST_ITEM_HANDLE)0x7779
-#define TEST_LIST_ITEM_VALUE                (void*)0x7780
 #define TEST_REASON                         (void*)0x7781
+#define TEST_TICK_COUNTER_HANDLE            (TICK_COUNTER_HANDLE)0x7782
 
 
 static MQ_MESSAGE_HANDLE TEST_BASE_MQ_MESSAGE_HANDLE[10];
-static time_t TEST_current_time;
+static tickcounter_ms_t TEST_current_time;
 
 
 typedef struct TEST_MESSAGE_EXPIRATION_PROFILE_TAG
 {
-    double max_message_enqueued_time_secs;
-    double max_message_processing_time_secs;
-    size_t* expired_pending_messages;
-    size_t expired_pending_messages_size;
-    size_t* expired_enqueued_in_progress_messages;
-    size_t expired_enqueued_in_progress_messages_size;
+    size_t max_message_enqueued_time_ms;
+    size_t max_message_processing_time_ms;
+    // Indexes in enqueue order, across pending and in-progress messages.
+    size_t* expired_enqueued_messages;
+    size_t expired_enqueued_messages_size;
     size_t* expired_in_progress_messages;
     size_t expired_in_progress_messages_size;
 } TEST_MESSAGE_EXPIRATION_PROFILE;
@@ -94,7 +90,7 @@ static TEST_MESSAGE_EXPIRATION_PROFILE TEST_test_message_expiration_profile;
 
 // Helpers
 static int saved_malloc_returns_count = 0;
-static void* saved_malloc_returns[20];
+static void* saved_malloc_returns[64];
 
 static void* TEST_malloc(size_t size)
 {
@@ -129,40 +125,9 @@ static OPTIONHANDLER_RESULT TEST_OptionHandler_AddOption(OPTIONHANDLER_HANDLE ha
     return TEST_OptionHandler_AddOption_result;
 }
 
-#ifdef __cplusplus
-extern "C"
+static tickcounter_ms_t add_seconds(tickcounter_ms_t base_time, int seconds)
 {
-#endif
-
-    SINGLYLINKEDLIST_HANDLE real_singlylinkedlist_create(void);
-    void real_singlylinkedlist_destroy(SINGLYLINKEDLIST_HANDLE list);
-    LIST_ITEM_HANDLE real_singlylinkedlist_add(SINGLYLINKEDLIST_HANDLE list, const void* item);
-    int real_singlylinkedlist_remove(SINGLYLINKEDLIST_HANDLE list, LIST_ITEM_HANDLE item_handle);
-    LIST_ITEM_HANDLE real_singlylinkedlist_get_head_item(SINGLYLINKEDLIST_HANDLE list);
-    LIST_ITEM_HANDLE real_singlylinkedlist_get_next_item(LIST_ITEM_HANDLE item_handle);
-    LIST_ITEM_HANDLE real_singlylinkedlist_find(SINGLYLINKEDLIST_HANDLE list, LIST_MATCH_FUNCTION match_function, const void* match_context);
-    const void* real_singlylinkedlist_item_get_value(LIST_ITEM_HANDLE item_handle);
-
-#ifdef __cplusplus
-}
-#endif
-
-static time_t add_seconds(time_t base_time, int seconds)
-{
-    time_t new_time;
-    struct tm *bd_new_time;
-
-    if ((bd_new_time = localtime(&base_time)) == NULL)
-    {
-        new_time = INDEFINITE_TIME;
-    }
-    else
-    {
-        bd_new_time->tm_sec += seconds;
-        new_time = mktime(bd_new_time);
-    }
-
-    return new_time;
+    return base_time + (tickcounter_ms_t)seconds * 1000;
 }
 
 static MESSAGE_QUEUE_HANDLE TEST_on_process_message_callback_message_queue;
@@ -215,10 +180,11 @@ static void TEST_on_message_processing_completed_callback(MQ_MESSAGE_HANDLE mess
 static MESSAGE_QUEUE_CONFIG g_config;
 static MESSAGE_QUEUE_CONFIG* get_message_queue_config()
 {
-    g_config.max_message_enqueued_time_secs = 0;
-    g_config.max_message_processing_time_secs = 0;
+    g_config.max_message_enqueued_time_ms = 0;
+    g_config.max_message_processing_time_ms = 0;
     g_config.max_retry_count = 0;
     g_config.on_process_message_callback = TEST_on_process_message_callback;
+    g_config.tick_counter = TEST_TICK_COUNTER_HANDLE;
 
     return &g_config;
 }
@@ -226,50 +192,20 @@ static MESSAGE_QUEUE_CONFIG* get_message_queue_config()
 static void set_message_queue_create_expected_calls()
 {
     STRICT_EXPECTED_CALL(malloc(IGNORED_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_create());
-    STRICT_EXPECTED_CALL(singlylinkedlist_create());
+    STRICT_EXPECTED_CALL(malloc(IGNORED_ARG)); // message index
 }
 
 static void set_dequeue_message_and_fire_callback_expected_calls()
 {
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(IGNORED_ARG, IGNORED_ARG));
     STRICT_EXPECTED_CALL(free(IGNORED_ARG));
 }
 
-static void set_retry_sending_message_expected_calls()
-{
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(IGNORED_ARG, IGNORED_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_ARG, IGNORED_ARG));
-}
-
-static void set_on_message_processing_completed_callback_expected_calls(int number_of_messages, int message_order_in_list, bool should_retry)
+static void set_on_message_processing_completed_callback_expected_calls(bool is_message_in_progress, bool should_retry)
 {
-    int i;
-
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG));
-
-    for (i = 0; i < number_of_messages; i++)
-    {
-        // Invoked by singlylinkedlist_find.
-        STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
-
-        if (i == message_order_in_list) break;
-    }
-
-    if (i == message_order_in_list)
+    // Retrying a message only moves it back to the pending list.
+    if (is_message_in_progress && !should_retry)
     {
-        STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
-
-        if (should_retry)
-        {
-            set_retry_sending_message_expected_calls();
-        }
-        else
-        {
-            set_dequeue_message_and_fire_callback_expected_calls();
-        }
+        set_dequeue_message_and_fire_callback_expected_calls();
     }
 }
 
@@ -277,20 +213,9 @@ static void set_message_queue_remove_all_expected_calls(size_t number_of_message
 {
     size_t i;
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-
-    for (i = 0; i < number_of_messages_pending; i++)
+    for (i = 0; i < number_of_messages_pending + number_of_messages_in_progress; i++)
     {
         set_dequeue_message_and_fire_callback_expected_calls();
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-    }
-
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-
-    for (i = 0; i < number_of_messages_in_progress; i++)
-    {
-        set_dequeue_message_and_fire_callback_expected_calls();
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
     }
 }
 
@@ -298,19 +223,17 @@ static void set_message_queue_destroy_expected_calls(size_t number_of_messages_p
 {
     set_message_queue_remove_all_expected_calls(number_of_messages_pending, number_of_messages_in_progress);
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_destroy(IGNORED_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_destroy(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(free(IGNORED_ARG)); // message index
     STRICT_EXPECTED_CALL(free(IGNORED_ARG));
 }
 
-static void set_message_queue_add_expected_calls(time_t current_time)
+static void set_message_queue_add_expected_calls(tickcounter_ms_t current_time)
 {
     STRICT_EXPECTED_CALL(malloc(IGNORED_ARG));
-    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(current_time);
-    STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_ARG, IGNORED_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_TICK_COUNTER_HANDLE, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&current_time, sizeof(current_time));
 }
 
-static void add_messages(MESSAGE_QUEUE_HANDLE mq, size_t number_of_messages, time_t current_time)
+static void add_messages(MESSAGE_QUEUE_HANDLE mq, size_t number_of_messages, tickcounter_ms_t current_time)
 {
     size_t i;
     for (i = 0; i < number_of_messages; i++)
@@ -335,110 +258,61 @@ static MESSAGE_QUEUE_HANDLE create_message_queue(MESSAGE_QUEUE_CONFIG* config)
     return message_queue_create(config);
 }
 
-static void set_process_timeouts_expected_calls(MESSAGE_QUEUE_HANDLE mq, time_t current_time,
+static void set_process_timeouts_expected_calls(MESSAGE_QUEUE_HANDLE mq, tickcounter_ms_t current_time,
     size_t number_of_messages_pending, size_t number_of_messages_in_progress,
     TEST_MESSAGE_EXPIRATION_PROFILE* expiration_profile
     )
 {
     (void)mq;
-    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(current_time);
+    (void)number_of_messages_pending;
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_TICK_COUNTER_HANDLE, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&current_time, sizeof(current_time));
 
-    if (expiration_profile->max_message_enqueued_time_secs > 0)
+    // Expiration is evaluated against the tick counter, so only expired messages cause calls.
+    if (expiration_profile->max_message_enqueued_time_ms > 0)
     {
-        size_t i, j;
-
-        // pending messages, max queued time
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
+        size_t i;
 
-        for (i = 0, j = 0; i < number_of_messages_pending; i++)
+        // all messages in enqueue order, max queued time
+        for (i = 0; i < expiration_profile->expired_enqueued_messages_size; i++)
         {
-            STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
-            STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_ARG));
-
-            if (j < expiration_profile->expired_pending_messages_size && i == expiration_profile->expired_pending_messages[j])
-            {
-                STRICT_EXPECTED_CALL(get_difftime(IGNORED_ARG, IGNORED_ARG)).SetReturn(expiration_profile->max_message_enqueued_time_secs + 1);
-                set_dequeue_message_and_fire_callback_expected_calls();
-                number_of_messages_pending--;
-                j++;
-            }
-            else
-            {
-                STRICT_EXPECTED_CALL(get_difftime(IGNORED_ARG, IGNORED_ARG)).SetReturn(0);
-                break;
-            }
+            set_dequeue_message_and_fire_callback_expected_calls();
         }
 
-        // in progress messages, max queued time
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-
-        for (i = 0, j = 0; i < number_of_messages_in_progress; i++)
+        // Expired messages are assumed to be the in-progress ones first (those were enqueued earlier).
+        if (expiration_profile->expired_enqueued_messages_size > number_of_messages_in_progress)
+        {
+            number_of_messages_in_progress = 0;
+        }
+        else
         {
-            STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
-            STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_ARG));
-
-            if (j < expiration_profile->expired_enqueued_in_progress_messages_size && i == expiration_profile->expired_enqueued_in_progress_messages[j])
-            {
-                STRICT_EXPECTED_CALL(get_difftime(IGNORED_ARG, IGNORED_ARG)).SetReturn(expiration_profile->max_message_enqueued_time_secs + 1);
-                set_dequeue_message_and_fire_callback_expected_calls();
-                //set_dequeue_message_and_fire_callback_expected_calls(number_of_messages_in_progress, expiration_profile->expired_enqueued_in_progress_messages[j] - i, false);
-                number_of_messages_in_progress--;
-                j++;
-            }
-            else
-            {
-                STRICT_EXPECTED_CALL(get_difftime(IGNORED_ARG, IGNORED_ARG)).SetReturn(0);
-            }
+            number_of_messages_in_progress -= expiration_profile->expired_enqueued_messages_size;
         }
     }
 
-    if (expiration_profile->max_message_processing_time_secs > 0)
+    if (expiration_profile->max_message_processing_time_ms > 0)
     {
-        size_t i, j;
+        size_t i;
 
         // in progress messages, max in progress time
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-
-        for (i = 0, j = 0; i < number_of_messages_in_progress; i++)
+        for (i = 0; i < expiration_profile->expired_in_progress_messages_size && i < number_of_messages_in_progress; i++)
         {
-            STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
-            STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_ARG));
-
-            if (j < expiration_profile->expired_in_progress_messages_size && i == expiration_profile->expired_in_progress_messages[j])
-            {
-                STRICT_EXPECTED_CALL(get_difftime(IGNORED_ARG, IGNORED_ARG)).SetReturn(expiration_profile->max_message_processing_time_secs + 1);
-                set_dequeue_message_and_fire_callback_expected_calls();
-                number_of_messages_in_progress--;
-                j++;
-            }
-            else
-            {
-                STRICT_EXPECTED_CALL(get_difftime(IGNORED_ARG, IGNORED_ARG)).SetReturn(0);
-                break;
-            }
+            set_dequeue_message_and_fire_callback_expected_calls();
         }
     }
 }
 
-static void set_process_pending_messages_calls(MESSAGE_QUEUE_HANDLE mq, time_t current_time, size_t number_of_messages_pending)
+static void set_process_pending_messages_calls(MESSAGE_QUEUE_HANDLE mq, tickcounter_ms_t current_time, size_t number_of_messages_pending)
 {
     (void)mq;
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-
     size_t i;
 
     for (i = 0; i < number_of_messages_pending; i++)
     {
-        STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
-        STRICT_EXPECTED_CALL(singlylinkedlist_remove(IGNORED_ARG, IGNORED_ARG));
-        STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(current_time);
-        STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_ARG, IGNORED_ARG));
-
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_TICK_COUNTER_HANDLE, IGNORED_ARG)).CopyOutArgumentBuffer_current_ms(&current_time, sizeof(current_time));
     }
 }
 
-static void set_message_queue_do_work_expected_calls(MESSAGE_QUEUE_HANDLE mq, time_t current_time,
+static void set_message_queue_do_work_expected_calls(MESSAGE_QUEUE_HANDLE mq, tickcounter_ms_t current_time,
     size_t number_of_messages_pending, size_t number_of_messages_in_progress,
     TEST_MESSAGE_EXPIRATION_PROFILE* expiration_profile)
 {
@@ -446,7 +320,7 @@ static void set_message_queue_do_work_expected_calls(MESSAGE_QUEUE_HANDLE mq, ti
     set_process_pending_messages_calls(mq, current_time, number_of_messages_pending);
 }
 
-static void crank_message_queue(MESSAGE_QUEUE_HANDLE mq, time_t current_time,
+static void crank_message_queue(MESSAGE_QUEUE_HANDLE mq, tickcounter_ms_t current_time,
     size_t number_of_messages_pending, size_t number_of_messages_in_progress,
     TEST_MESSAGE_EXPIRATION_PROFILE* expiration_profile)
 {
@@ -460,18 +334,6 @@ static void crank_message_queue(MESSAGE_QUEUE_HANDLE mq, time_t current_time,
     message_queue_do_work(mq);
 }
 
-static void set_message_queue_is_empty_expected_calls(size_t number_of_messages_pending, size_t number_of_messages_in_progress)
-{
-    (void)number_of_messages_in_progress;
-
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-
-    if (number_of_messages_pending == 0) // this statement will only be evaluated if the first boolean check (in code) succeeds.
-    {
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-    }
-}
-
 static void set_message_queue_retrieve_options_expected_calls()
 {
     STRICT_EXPECTED_CALL(OptionHandler_Create(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG));
@@ -482,7 +344,7 @@ static void set_message_queue_retrieve_options_expected_calls()
 
 static void reset_test_data()
 {
-    TEST_current_time = time(NULL);
+    TEST_current_time = 1234567;
 
     saved_malloc_returns_count = 0;
     memset(saved_malloc_returns, 0, sizeof(saved_malloc_returns));
@@ -504,27 +366,23 @@ static void reset_test_data()
     TEST_on_message_processing_completed_callback_ERROR_result_count = 0;
     TEST_on_message_processing_completed_callback_TIMEOUT_result_count = 0;
 
-    TEST_test_message_expiration_profile.expired_enqueued_in_progress_messages = NULL;
-    TEST_test_message_expiration_profile.expired_enqueued_in_progress_messages_size = 0;
+    TEST_test_message_expiration_profile.expired_enqueued_messages = NULL;
+    TEST_test_message_expiration_profile.expired_enqueued_messages_size = 0;
     TEST_test_message_expiration_profile.expired_in_progress_messages = NULL;
     TEST_test_message_expiration_profile.expired_in_progress_messages_size = 0;
-    TEST_test_message_expiration_profile.expired_pending_messages = NULL;
-    TEST_test_message_expiration_profile.expired_pending_messages_size = 0;
-    TEST_test_message_expiration_profile.max_message_enqueued_time_secs = 0;
-    TEST_test_message_expiration_profile.max_message_processing_time_secs = 0;
+    TEST_test_message_expiration_profile.max_message_enqueued_time_ms = 0;
+    TEST_test_message_expiration_profile.max_message_processing_time_ms = 0;
 }
 
 static void register_umock_alias_types()
 {
-    REGISTER_UMOCK_ALIAS_TYPE(time_t, long long);
+    REGISTER_UMOCK_ALIAS_TYPE(TICK_COUNTER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(tickcounter_ms_t, unsigned long long);
     REGISTER_UMOCK_ALIAS_TYPE(OPTIONHANDLER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(OPTIONHANDLER_RESULT, int);
     REGISTER_UMOCK_ALIAS_TYPE(pfCloneOption, void*);
     REGISTER_UMOCK_ALIAS_TYPE(pfDestroyOption, void*);
     REGISTER_UMOCK_ALIAS_TYPE(pfSetOption, void*);
-    REGISTER_UMOCK_ALIAS_TYPE(SINGLYLINKEDLIST_HANDLE, void*);
-    REGISTER_UMOCK_ALIAS_TYPE(LIST_ITEM_HANDLE, void*);
-    REGISTER_UMOCK_ALIAS_TYPE(LIST_MATCH_FUNCTION, void*);
     REGISTER_UMOCK_ALIAS_TYPE(MQ_MESSAGE_HANDLE, void*);
 }
 
@@ -533,14 +391,6 @@ static void register_global_mock_hooks()
     REGISTER_GLOBAL_MOCK_HOOK(malloc, TEST_malloc);
     REGISTER_GLOBAL_MOCK_HOOK(free, TEST_free);
     REGISTER_GLOBAL_MOCK_HOOK(OptionHandler_AddOption, TEST_OptionHandler_AddOption);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_create, real_singlylinkedlist_create);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_destroy, real_singlylinkedlist_destroy);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_add, real_singlylinkedlist_add);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_remove, real_singlylinkedlist_remove);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_get_head_item, real_singlylinkedlist_get_head_item);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_get_next_item, real_singlylinkedlist_get_next_item);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_find, real_singlylinkedlist_find);
-    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_item_get_value, real_singlylinkedlist_item_get_value);
 }
 
 static void register_global_mock_returns()
@@ -554,19 +404,9 @@ static void register_global_mock_returns()
     REGISTER_GLOBAL_MOCK_RETURN(OptionHandler_FeedOptions, OPTIONHANDLER_OK);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(OptionHandler_FeedOptions, OPTIONHANDLER_ERROR);
 
-    REGISTER_GLOBAL_MOCK_RETURN(singlylinkedlist_add, TEST_LIST_ITEM_HANDLE);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(singlylinkedlist_add, NULL);
 
-    REGISTER_GLOBAL_MOCK_RETURN(singlylinkedlist_remove, 0);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(singlylinkedlist_remove, 1);
-
-    REGISTER_GLOBAL_MOCK_RETURN(singlylinkedlist_get_head_item, TEST_LIST_ITEM_HANDLE);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(singlylinkedlist_get_head_item, NULL);
-
-    REGISTER_GLOBAL_MOCK_RETURN(singlylinkedlist_item_get_value, TEST_LIST_ITEM_VALUE);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(singlylinkedlist_item_get_value, NULL);
-
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(get_time, INDEFINITE_TIME);
+    REGISTER_GLOBAL_MOCK_RETURN(tickcounter_get_current_ms, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(tickcounter_get_current_ms, 1);
 }
 
 
@@ -668,6 +508,24 @@ TEST_FUNCTION(create_NULL_on_process_message_callback)
     // cleanup
 }
 
+TEST_FUNCTION(create_NULL_tick_counter)
+{
+    // arrange
+    MESSAGE_QUEUE_CONFIG* config = get_message_queue_config();
+    config->tick_counter = NULL;
+
+    umock_c_reset_all_calls();
+
+    // act
+    MESSAGE_QUEUE_HANDLE mq = message_queue_create(config);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(mq);
+
+    // cleanup
+}
+
 TEST_FUNCTION(create_failure_checks)
 {
     // arrange
@@ -916,7 +774,6 @@ TEST_FUNCTION(is_empty_0_pending_0_in_progress_success)
     MESSAGE_QUEUE_HANDLE mq = create_message_queue(USE_DEFAULT_CONFIG);
 
     umock_c_reset_all_calls();
-    set_message_queue_is_empty_expected_calls(0, 0);
 
     // act
     bool is_empty;
@@ -939,7 +796,6 @@ TEST_FUNCTION(is_empty_1_pending_0_in_progress_success)
     add_messages(mq, 1, TEST_current_time);
 
     umock_c_reset_all_calls();
-    set_message_queue_is_empty_expected_calls(1, 0);
 
     // act
     bool is_empty;
@@ -963,7 +819,6 @@ TEST_FUNCTION(is_empty_0_pending_1_in_progress_success)
     crank_message_queue(mq, TEST_current_time, 1, 0, NULL);
 
     umock_c_reset_all_calls();
-    set_message_queue_is_empty_expected_calls(0, 1);
 
     // act
     bool is_empty;
@@ -988,7 +843,6 @@ TEST_FUNCTION(is_empty_1_pending_1_in_progress_success)
     add_messages(mq, 1, TEST_current_time);
 
     umock_c_reset_all_calls();
-    set_message_queue_is_empty_expected_calls(1, 1);
 
     // act
     bool is_empty;
@@ -1049,22 +903,15 @@ TEST_FUNCTION(do_work_NO_EXPIRATION_failure_checks)
     size_t i, j;
     for (i = 0, j = 1; i < j; i++)
     {
-        if (i == 6)
-        {
-            continue;
-        }
-
         // arrange
+        TEST_on_process_message_callback_message = NULL;
         TEST_on_message_processing_completed_callback_message = NULL;
         TEST_on_message_processing_completed_callback_result = MESSAGE_QUEUE_TIMEOUT;
 
         char error_msg[128];
         sprintf(error_msg, "On failed call %lu", (unsigned long)i);
 
-        if (i >= 3 && i != 4)
-        {
-            add_messages(mq, 1, TEST_current_time);
-        }
+        add_messages(mq, 1, TEST_current_time);
 
         umock_c_reset_all_calls();
         set_message_queue_do_work_expected_calls(mq, TEST_current_time, 1, 0, &TEST_test_message_expiration_profile);
@@ -1079,13 +926,15 @@ TEST_FUNCTION(do_work_NO_EXPIRATION_failure_checks)
         message_queue_do_work(mq);
 
         // assert
-        if (i == 1 || i == 2)
+        if (i == 0)
         {
-            ASSERT_IS_NULL(TEST_on_process_message_callback_message, error_msg);
+            // Failing to process timeouts does not prevent pending messages from being processed.
+            ASSERT_IS_NOT_NULL(TEST_on_process_message_callback_message, error_msg);
             ASSERT_IS_NULL(TEST_on_message_processing_completed_callback_message, error_msg);
         }
-        else if (i >= 3)
+        else
         {
+            ASSERT_IS_NULL(TEST_on_process_message_callback_message, error_msg);
             ASSERT_IS_NOT_NULL(TEST_on_message_processing_completed_callback_message, error_msg);
             ASSERT_ARE_EQUAL(int, (int)MESSAGE_QUEUE_ERROR, (int)TEST_on_message_processing_completed_callback_result, error_msg);
         }
@@ -1198,6 +1047,39 @@ TEST_FUNCTION(message_queue_set_max_message_enqueued_time_secs_success)
 }
 
 
+TEST_FUNCTION(message_queue_set_max_message_enqueued_time_ms_NULL_handle)
+{
+    // arrange
+    umock_c_reset_all_calls();
+
+    // act
+    int result = message_queue_set_max_message_enqueued_time_ms(NULL, 500);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+}
+
+TEST_FUNCTION(message_queue_set_max_message_processing_time_ms_success)
+{
+    // arrange
+    MESSAGE_QUEUE_HANDLE mq = create_message_queue(USE_DEFAULT_CONFIG);
+
+    umock_c_reset_all_calls();
+
+    // act
+    int result = message_queue_set_max_message_processing_time_ms(mq, 500);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    // cleanup
+    message_queue_destroy(mq);
+}
+
 TEST_FUNCTION(message_queue_retrieve_options_NULL_handle)
 {
     // arrange
@@ -1275,8 +1157,6 @@ TEST_FUNCTION(on_message_processing_completed_callback_INVALID_message)
     crank_message_queue(mq, TEST_current_time, 1, 0, NULL);
 
     umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
 
     // act
     TEST_on_process_message_callback_on_process_message_completed_callback(mq, 12345, MESSAGE_QUEUE_SUCCESS, TEST_REASON);
@@ -1327,7 +1207,7 @@ TEST_FUNCTION(on_message_processing_completed_callback_MESSAGE_not_present)
     crank_message_queue(mq, TEST_current_time, 1, 0, NULL);
 
     umock_c_reset_all_calls();
-    set_on_message_processing_completed_callback_expected_calls(1, -1, false);
+    set_on_message_processing_completed_callback_expected_calls(false, false);
 
     // act
     TEST_on_process_message_callback_on_process_message_completed_callback(mq, TEST_SOME_OTHER_MESSAGE_ID, MESSAGE_QUEUE_SUCCESS, TEST_REASON);
@@ -1356,7 +1236,7 @@ TEST_FUNCTION(on_message_processing_completed_callback_success)
     ASSERT_ARE_EQUAL(void_ptr, (void*)TEST_USER_CONTEXT, (void*)TEST_on_process_message_callback_context);
 
     umock_c_reset_all_calls();
-    set_on_message_processing_completed_callback_expected_calls(1, 0, false);
+    set_on_message_processing_completed_callback_expected_calls(true, false);
 
     // act
     TEST_on_process_message_callback_on_process_message_completed_callback(mq, TEST_on_process_message_callback_message_id, MESSAGE_QUEUE_SUCCESS, TEST_REASON);
@@ -1383,11 +1263,11 @@ TEST_FUNCTION(on_message_processing_completed_callback_RETRYABLE_ERROR)
     crank_message_queue(mq, TEST_current_time, 1, 0, NULL);
 
     umock_c_reset_all_calls();
-    set_on_message_processing_completed_callback_expected_calls(1, 0, true);
+    set_on_message_processing_completed_callback_expected_calls(true, true);
     set_message_queue_do_work_expected_calls(mq, TEST_current_time, 1, 0, &TEST_test_message_expiration_profile);
-    set_on_message_processing_completed_callback_expected_calls(1, 0, true);
+    set_on_message_processing_completed_callback_expected_calls(true, true);
     set_message_queue_do_work_expected_calls(mq, TEST_current_time, 1, 0, &TEST_test_message_expiration_profile);
-    set_on_message_processing_completed_callback_expected_calls(1, 0, false);
+    set_on_message_processing_completed_callback_expected_calls(true, false);
 
     // act
     TEST_on_process_message_callback_on_process_message_completed_callback(mq,
@@ -1419,18 +1299,16 @@ TEST_FUNCTION(do_work_pending_queue_timeout)
 
     add_messages(mq, 1, TEST_current_time);
 
-    time_t t1 = add_seconds(TEST_current_time, 10);
+    tickcounter_ms_t t1 = add_seconds(TEST_current_time, 10);
 
     TEST_MESSAGE_EXPIRATION_PROFILE exp_prof;
-    exp_prof.max_message_enqueued_time_secs = 10;
-    exp_prof.max_message_processing_time_secs = 0;
-    size_t expired_pending_messages[] = { 0 };
-    exp_prof.expired_pending_messages = expired_pending_messages;
-    exp_prof.expired_pending_messages_size = 1;
+    exp_prof.max_message_enqueued_time_ms = 10000;
+    exp_prof.max_message_processing_time_ms = 0;
+    size_t expired_enqueued_messages[] = { 0 };
+    exp_prof.expired_enqueued_messages = expired_enqueued_messages;
+    exp_prof.expired_enqueued_messages_size = 1;
     exp_prof.expired_in_progress_messages = NULL;
     exp_prof.expired_in_progress_messages_size = 0;
-    exp_prof.expired_enqueued_in_progress_messages = NULL;
-    exp_prof.expired_enqueued_in_progress_messages_size = 0;
 
     umock_c_reset_all_calls();
     set_process_timeouts_expected_calls(mq, t1, 1, 0, &exp_prof);
@@ -1460,18 +1338,16 @@ TEST_FUNCTION(do_work_in_progress_processing_timeout)
 
     (void)message_queue_set_max_message_processing_time_secs(mq, 10);
 
-    time_t t1 = add_seconds(TEST_current_time, 10);
+    tickcounter_ms_t t1 = add_seconds(TEST_current_time, 10);
 
     TEST_MESSAGE_EXPIRATION_PROFILE exp_prof;
-    exp_prof.max_message_enqueued_time_secs = 0;
-    exp_prof.max_message_processing_time_secs = 10;
-    exp_prof.expired_pending_messages = NULL;
-    exp_prof.expired_pending_messages_size = 0;
+    exp_prof.max_message_enqueued_time_ms = 0;
+    exp_prof.max_message_processing_time_ms = 10000;
+    exp_prof.expired_enqueued_messages = NULL;
+    exp_prof.expired_enqueued_messages_size = 0;
     size_t expired_in_progress_messages[] = { 0 };
     exp_prof.expired_in_progress_messages = expired_in_progress_messages;
     exp_prof.expired_in_progress_messages_size = 1;
-    exp_prof.expired_enqueued_in_progress_messages = NULL;
-    exp_prof.expired_enqueued_in_progress_messages_size = 0;
 
     umock_c_reset_all_calls();
     set_process_timeouts_expected_calls(mq, t1, 0, 1, &exp_prof);
@@ -1501,18 +1377,16 @@ TEST_FUNCTION(do_work_in_progress_queue_timeout)
 
     (void)message_queue_set_max_message_enqueued_time_secs(mq, 10);
 
-    time_t t1 = add_seconds(TEST_current_time, 10);
+    tickcounter_ms_t t1 = add_seconds(TEST_current_time, 10);
 
     TEST_MESSAGE_EXPIRATION_PROFILE exp_prof;
-    exp_prof.max_message_enqueued_time_secs = 10;
-    exp_prof.max_message_processing_time_secs = 0;
-    exp_prof.expired_pending_messages = NULL;
-    exp_prof.expired_pending_messages_size = 0;
+    exp_prof.max_message_enqueued_time_ms = 10000;
+    exp_prof.max_message_processing_time_ms = 0;
+    size_t expired_enqueued_messages[] = { 0 };
+    exp_prof.expired_enqueued_messages = expired_enqueued_messages;
+    exp_prof.expired_enqueued_messages_size = 1;
     exp_prof.expired_in_progress_messages = NULL;
     exp_prof.expired_in_progress_messages_size = 0;
-    size_t expired_enqueued_in_progress_messages[] = { 0 };
-    exp_prof.expired_enqueued_in_progress_messages = expired_enqueued_in_progress_messages;
-    exp_prof.expired_enqueued_in_progress_messages_size = 1;
 
     umock_c_reset_all_calls();
     set_process_timeouts_expected_calls(mq, t1, 0, 1, &exp_prof);
@@ -1532,28 +1406,53 @@ TEST_FUNCTION(do_work_in_progress_queue_timeout)
     message_queue_destroy(mq);
 }
 
+TEST_FUNCTION(do_work_pending_queue_timeout_milliseconds)
+{
+    // arrange
+    MESSAGE_QUEUE_HANDLE mq = create_message_queue(USE_DEFAULT_CONFIG);
+    (void)message_queue_set_max_message_enqueued_time_ms(mq, 250);
+
+    add_messages(mq, 2, TEST_current_time);
+
+    umock_c_reset_all_calls();
+    set_message_queue_add_expected_calls(TEST_current_time + 100);
+    (void)message_queue_add(mq, TEST_BASE_MQ_MESSAGE_HANDLE[2], TEST_on_message_processing_completed_callback, TEST_USER_CONTEXT);
+
+    TEST_MESSAGE_EXPIRATION_PROFILE exp_prof;
+    exp_prof.max_message_enqueued_time_ms = 250;
+    exp_prof.max_message_processing_time_ms = 0;
+    size_t expired_enqueued_messages[] = { 0, 1 };
+    exp_prof.expired_enqueued_messages = expired_enqueued_messages;
+    exp_prof.expired_enqueued_messages_size = 2;
+    exp_prof.expired_in_progress_messages = NULL;
+    exp_prof.expired_in_progress_messages_size = 0;
+
+    umock_c_reset_all_calls();
+    set_process_timeouts_expected_calls(mq, TEST_current_time + 250, 3, 0, &exp_prof);
+    set_process_pending_messages_calls(mq, TEST_current_time + 250, 1);
+
+    // act
+    message_queue_do_work(mq);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 2, (int)TEST_on_message_processing_completed_callback_TIMEOUT_result_count);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)TEST_BASE_MQ_MESSAGE_HANDLE[2], (void*)TEST_on_process_message_callback_message);
+
+    // cleanup
+    message_queue_destroy(mq);
+}
+
 TEST_FUNCTION(message_queue_move_all_back_to_pending_with_in_progress_and_pending_succeed)
 {
     // arrange
     MESSAGE_QUEUE_HANDLE mq = create_message_queue(USE_DEFAULT_CONFIG);
 
     add_messages(mq, 2, TEST_current_time);
-    crank_message_queue(mq, TEST_current_time, 1, 0, NULL);
+    crank_message_queue(mq, TEST_current_time, 2, 0, NULL);
     add_messages(mq, 2, TEST_current_time);
 
     umock_c_reset_all_calls();
-    for (int i = 0; i < 2; i++)
-    {
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-        set_retry_sending_message_expected_calls();
-    }
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-    for (int i = 0; i < 4; i++)
-    {
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-        set_retry_sending_message_expected_calls();
-    }
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
 
     // act
     int result = message_queue_move_all_back_to_pending(mq);
@@ -1562,6 +1461,11 @@ TEST_FUNCTION(message_queue_move_all_back_to_pending_with_in_progress_and_pendin
     ASSERT_ARE_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
+    // In-progress messages are processed again before the ones that were already pending.
+    crank_message_queue(mq, TEST_current_time, 4, 0, NULL);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, (void*)TEST_BASE_MQ_MESSAGE_HANDLE[3], (void*)TEST_on_process_message_callback_message);
+
     // cleanup
     message_queue_destroy(mq);
 }
@@ -1572,16 +1476,9 @@ TEST_FUNCTION(message_queue_move_all_back_to_pending_with_only_in_progress_succe
     MESSAGE_QUEUE_HANDLE mq = create_message_queue(USE_DEFAULT_CONFIG);
 
     add_messages(mq, 2, TEST_current_time);
-    crank_message_queue(mq, TEST_current_time, 1, 0, NULL);
+    crank_message_queue(mq, TEST_current_time, 2, 0, NULL);
 
     umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-    for (int i = 0; i < 2; i++)
-    {
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-        set_retry_sending_message_expected_calls();
-    }
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
 
     // act
     int result = message_queue_move_all_back_to_pending(mq);
@@ -1590,6 +1487,10 @@ TEST_FUNCTION(message_queue_move_all_back_to_pending_with_only_in_progress_succe
     ASSERT_ARE_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
+    crank_message_queue(mq, TEST_current_time, 2, 0, NULL);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, (void*)TEST_BASE_MQ_MESSAGE_HANDLE[1], (void*)TEST_on_process_message_callback_message);
+
     // cleanup
     message_queue_destroy(mq);
 }
@@ -1602,18 +1503,6 @@ TEST_FUNCTION(message_queue_move_all_back_to_pending_with_only_pending_succeed)
     add_messages(mq, 2, TEST_current_time);
 
     umock_c_reset_all_calls();
-    for (int i = 0; i < 2; i++)
-    {
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-        set_retry_sending_message_expected_calls();
-    }
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-    for (int i = 0; i < 2; i++)
-    {
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-        set_retry_sending_message_expected_calls();
-    }
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
 
     // act
     int result = message_queue_move_all_back_to_pending(mq);
@@ -1640,79 +1529,90 @@ TEST_FUNCTION(message_queue_move_all_back_to_pending_null_message_queue_failed)
     // cleanup
 }
 
-TEST_FUNCTION(message_queue_move_all_back_to_pending_move_pending_failed)
+TEST_FUNCTION(on_message_processing_completed_callback_out_of_order_success)
 {
     // arrange
     MESSAGE_QUEUE_HANDLE mq = create_message_queue(USE_DEFAULT_CONFIG);
 
-    add_messages(mq, 2, TEST_current_time);
-    crank_message_queue(mq, TEST_current_time, 1, 0, NULL);
-    add_messages(mq, 2, TEST_current_time);
+    add_messages(mq, 3, TEST_current_time);
+    crank_message_queue(mq, TEST_current_time, 3, 0, NULL);
+    uint32_t last_message_id = TEST_on_process_message_callback_message_id;
 
     umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(IGNORED_ARG, IGNORED_ARG)).SetReturn(1);
-    for (int i = 0; i < 2; i++)
-    {
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-        set_dequeue_message_and_fire_callback_expected_calls();
-    }
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-    for (int i = 0; i < 2; i++)
-    {
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-        set_dequeue_message_and_fire_callback_expected_calls();
-    }
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
+    set_on_message_processing_completed_callback_expected_calls(true, false);
 
     // act
-    int result = message_queue_move_all_back_to_pending(mq);
+    TEST_on_process_message_callback_on_process_message_completed_callback(mq, last_message_id - 1, MESSAGE_QUEUE_SUCCESS, TEST_REASON);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 1, (int)TEST_on_message_processing_completed_callback_SUCCESS_result_count);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)TEST_BASE_MQ_MESSAGE_HANDLE[1], (void*)TEST_on_message_processing_completed_callback_message);
+
+    // Completing the same message again is ignored.
+    umock_c_reset_all_calls();
+    set_on_message_processing_completed_callback_expected_calls(false, false);
+    TEST_on_process_message_callback_on_process_message_completed_callback(mq, last_message_id - 1, MESSAGE_QUEUE_SUCCESS, TEST_REASON);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 1, (int)TEST_on_message_processing_completed_callback_SUCCESS_result_count);
+
+    umock_c_reset_all_calls();
+    set_on_message_processing_completed_callback_expected_calls(true, false);
+    TEST_on_process_message_callback_on_process_message_completed_callback(mq, last_message_id, MESSAGE_QUEUE_SUCCESS, TEST_REASON);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, (void*)TEST_BASE_MQ_MESSAGE_HANDLE[2], (void*)TEST_on_message_processing_completed_callback_message);
+
+    umock_c_reset_all_calls();
+    set_on_message_processing_completed_callback_expected_calls(true, false);
+    TEST_on_process_message_callback_on_process_message_completed_callback(mq, last_message_id - 2, MESSAGE_QUEUE_SUCCESS, TEST_REASON);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, (void*)TEST_BASE_MQ_MESSAGE_HANDLE[0], (void*)TEST_on_message_processing_completed_callback_message);
+    ASSERT_ARE_EQUAL(int, 3, (int)TEST_on_message_processing_completed_callback_SUCCESS_result_count);
 
     // cleanup
     message_queue_destroy(mq);
 }
 
-TEST_FUNCTION(message_queue_move_all_back_to_pending_move_in_progress_failed)
+TEST_FUNCTION(add_grows_message_index_success)
 {
     // arrange
+    size_t i;
     MESSAGE_QUEUE_HANDLE mq = create_message_queue(USE_DEFAULT_CONFIG);
 
-    add_messages(mq, 2, TEST_current_time);
-    crank_message_queue(mq, TEST_current_time, 1, 0, NULL);
-    add_messages(mq, 2, TEST_current_time);
-
-    umock_c_reset_all_calls();
-    for (int i = 0; i < 2; i++)
+    for (i = 0; i < 16; i++)
     {
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-        set_retry_sending_message_expected_calls();
-    }
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_remove(IGNORED_ARG, IGNORED_ARG)).SetReturn(1);
-    for (int i = 0; i < 4; i++)
-    {
-        STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-        set_dequeue_message_and_fire_callback_expected_calls();
+        umock_c_reset_all_calls();
+        set_message_queue_add_expected_calls(TEST_current_time);
+        ASSERT_ARE_EQUAL(int, 0, message_queue_add(mq, TEST_BASE_MQ_MESSAGE_HANDLE[i % 10], TEST_on_message_processing_completed_callback, TEST_USER_CONTEXT));
     }
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(IGNORED_ARG));
+
+    umock_c_reset_all_calls();
+    set_message_queue_add_expected_calls(TEST_current_time);
+    STRICT_EXPECTED_CALL(malloc(IGNORED_ARG)); // new message index
+    STRICT_EXPECTED_CALL(free(IGNORED_ARG)); // previous message index
 
     // act
-    int result = message_queue_move_all_back_to_pending(mq);
+    int result = message_queue_add(mq, TEST_BASE_MQ_MESSAGE_HANDLE[6], TEST_on_message_processing_completed_callback, TEST_USER_CONTEXT);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    crank_message_queue(mq, TEST_current_time, 17, 0, NULL);
+
+    umock_c_reset_all_calls();
+    set_on_message_processing_completed_callback_expected_calls(true, false);
+    TEST_on_process_message_callback_on_process_message_completed_callback(mq, TEST_on_process_message_callback_message_id, MESSAGE_QUEUE_SUCCESS, TEST_REASON);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 1, (int)TEST_on_message_processing_completed_callback_SUCCESS_result_count);
+
+    umock_c_reset_all_calls();
+    set_message_queue_destroy_expected_calls(0, 16);
 
     // cleanup
     message_queue_destroy(mq);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 16, (int)TEST_on_message_processing_completed_callback_CANCELLED_result_count);
 }
 
 END_TEST_SUITE(message_queue_ut)
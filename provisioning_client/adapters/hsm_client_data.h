@@ -76,12 +76,28 @@ typedef struct HSM_CLIENT_KEY_INTERFACE_TAG
     HSM_CLIENT_SET_SYMMETRICAL_KEY_INFO hsm_client_set_symm_key_info;
 } HSM_CLIENT_KEY_INTERFACE;
 
+#ifdef HSM_KEY_SIGN_INTERFACE
+#define HSM_CLIENT_KEY_SIGN_INTERFACE_VERSION_1     1
+
+// Optional extension of HSM_CLIENT_KEY_INTERFACE, kept separate so the layout of the key interface never changes.
+// hsm_client_sign_with_key computes the HMAC-SHA256 of the data keyed with the symmetric key, e.g. with
+// SHA instruction set extensions or a crypto engine.  When NULL the portable software HMAC is used.
+typedef struct HSM_CLIENT_KEY_SIGN_INTERFACE_TAG
+{
+    unsigned int version;
+    HSM_CLIENT_SIGN_WITH_IDENTITY hsm_client_sign_with_key;
+} HSM_CLIENT_KEY_SIGN_INTERFACE;
+#endif
+
 extern int initialize_hsm_system(void);
 extern void deinitialize_hsm_system(void);
 
 extern const HSM_CLIENT_TPM_INTERFACE* hsm_client_tpm_interface(void);
 extern const HSM_CLIENT_X509_INTERFACE* hsm_client_x509_interface(void);
 extern const HSM_CLIENT_KEY_INTERFACE* hsm_client_key_interface(void);
+#ifdef HSM_KEY_SIGN_INTERFACE
+extern const HSM_CLIENT_KEY_SIGN_INTERFACE* hsm_client_key_sign_interface(void);
+#endif
 
 extern int hsm_client_x509_init(void);
 extern void hsm_client_x509_deinit(void);
@@ -50,7 +50,7 @@ static int sign_sas_data(IOTHUB_SECURITY_INFO* security_info, const char* payloa
 {
     int result;
     size_t payload_len = strlen(payload);
-    if (security_info->cred_type == AUTH_TYPE_SAS)
+    if (security_info->cred_type == AUTH_TYPE_SAS || security_info->hsm_client_sign_data != NULL)
     {
         if (security_info->hsm_client_sign_data(security_info->hsm_client_handle, (const unsigned char*)payload, strlen(payload), output, len) != 0)
         {
@@ -189,6 +189,16 @@ IOTHUB_SECURITY_HANDLE iothub_device_auth_create()
                 free(result);
                 result = NULL;
             }
+#ifdef HSM_KEY_SIGN_INTERFACE
+            else
+            {
+                const HSM_CLIENT_KEY_SIGN_INTERFACE* key_sign_interface = hsm_client_key_sign_interface();
+                if (key_sign_interface != NULL && key_sign_interface->version >= HSM_CLIENT_KEY_SIGN_INTERFACE_VERSION_1)
+                {
+                    result->hsm_client_sign_data = key_sign_interface->hsm_client_sign_with_key;
+                }
+            }
+#endif
         }
 #endif
 #ifdef HSM_TYPE_HTTP_EDGE
@@ -154,7 +154,7 @@ static int sign_sas_data(PROV_AUTH_INFO* auth_info, const char* payload, unsigne
 {
     int result;
     size_t payload_len = strlen(payload);
-    if (auth_info->sec_type == PROV_AUTH_TYPE_TPM)
+    if (auth_info->sec_type == PROV_AUTH_TYPE_TPM || auth_info->hsm_client_sign_data != NULL)
     {
         if (auth_info->hsm_client_sign_data(auth_info->hsm_client_handle, (const unsigned char*)payload, strlen(payload), output, len) != 0)
         {
@@ -290,6 +290,16 @@ PROV_AUTH_HANDLE prov_auth_create(void)
                 free(result);
                 result = NULL;
             }
+#ifdef HSM_KEY_SIGN_INTERFACE
+            else
+            {
+                const HSM_CLIENT_KEY_SIGN_INTERFACE* key_sign_interface = hsm_client_key_sign_interface();
+                if (key_sign_interface != NULL && key_sign_interface->version >= HSM_CLIENT_KEY_SIGN_INTERFACE_VERSION_1)
+                {
+                    result->hsm_client_sign_data = key_sign_interface->hsm_client_sign_with_key;
+                }
+            }
+#endif
         }
 #endif
 
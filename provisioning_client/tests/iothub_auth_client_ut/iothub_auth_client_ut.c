@@ -57,6 +57,7 @@ MOCKABLE_FUNCTION(, int, hsm_client_set_symmetrical_key_info, HSM_CLIENT_HANDLE,
 MOCKABLE_FUNCTION(, const HSM_CLIENT_TPM_INTERFACE*, hsm_client_tpm_interface);
 MOCKABLE_FUNCTION(, const HSM_CLIENT_X509_INTERFACE*, hsm_client_x509_interface);
 MOCKABLE_FUNCTION(, const HSM_CLIENT_KEY_INTERFACE*, hsm_client_key_interface);
+MOCKABLE_FUNCTION(, const HSM_CLIENT_KEY_SIGN_INTERFACE*, hsm_client_key_sign_interface);
 
 #ifdef HSM_TYPE_HTTP_EDGE
 MOCKABLE_FUNCTION(, const HSM_CLIENT_HTTP_EDGE_INTERFACE*, hsm_client_http_edge_interface);
@@ -154,6 +155,12 @@ static const HSM_CLIENT_KEY_INTERFACE test_key_interface =
     hsm_client_set_symmetrical_key_info
 };
 
+static const HSM_CLIENT_KEY_SIGN_INTERFACE test_key_sign_interface =
+{
+    HSM_CLIENT_KEY_SIGN_INTERFACE_VERSION_1,
+    hsm_client_sign_data
+};
+
 #ifdef HSM_TYPE_HTTP_EDGE
 static const HSM_CLIENT_HTTP_EDGE_INTERFACE test_http_edge_interface =
 {
@@ -381,6 +388,7 @@ BEGIN_TEST_SUITE(iothub_auth_client_ut)
         REGISTER_GLOBAL_MOCK_RETURN(hsm_client_tpm_interface, &test_tpm_interface);
         REGISTER_GLOBAL_MOCK_RETURN(hsm_client_x509_interface, &test_x509_interface);
         REGISTER_GLOBAL_MOCK_RETURN(hsm_client_key_interface, &test_key_interface);
+        REGISTER_GLOBAL_MOCK_RETURN(hsm_client_key_sign_interface, NULL);
 
         g_test_sas_cred.dev_auth_type = AUTH_TYPE_SAS;
         g_test_sas_cred.sas_info.token_scope = "scope";
@@ -754,6 +762,7 @@ BEGIN_TEST_SUITE(iothub_auth_client_ut)
         STRICT_EXPECTED_CALL(iothub_security_type()).SetReturn(IOTHUB_SECURITY_TYPE_SYMMETRIC_KEY);
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_ARG));
         STRICT_EXPECTED_CALL(hsm_client_key_interface());
+        STRICT_EXPECTED_CALL(hsm_client_key_sign_interface());
 
         IOTHUB_SECURITY_HANDLE xda_handle = iothub_device_auth_create();
         umock_c_reset_all_calls();
@@ -771,6 +780,31 @@ BEGIN_TEST_SUITE(iothub_auth_client_ut)
         my_gballoc_free(result);
         iothub_device_auth_destroy(xda_handle);
     }
+
+    TEST_FUNCTION(iothub_device_auth_generate_credentials_key_hsm_sign_succeed)
+    {
+        //arrange
+        STRICT_EXPECTED_CALL(iothub_security_type()).SetReturn(IOTHUB_SECURITY_TYPE_SYMMETRIC_KEY);
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_ARG));
+        STRICT_EXPECTED_CALL(hsm_client_key_interface());
+        STRICT_EXPECTED_CALL(hsm_client_key_sign_interface()).SetReturn(&test_key_sign_interface);
+
+        IOTHUB_SECURITY_HANDLE xda_handle = iothub_device_auth_create();
+        umock_c_reset_all_calls();
+
+        setup_iothub_device_auth_generate_credentials_mocks(true, false, false);
+
+        //act
+        void* result = iothub_device_auth_generate_credentials(xda_handle, &g_test_key_cred);
+
+        //assert
+        ASSERT_IS_NOT_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        my_gballoc_free(result);
+        iothub_device_auth_destroy(xda_handle);
+    }
 #endif
 
     TEST_FUNCTION(iothub_device_auth_generate_credentials_no_key_succeed)
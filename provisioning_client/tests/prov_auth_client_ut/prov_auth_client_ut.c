@@ -74,6 +74,7 @@ MOCKABLE_FUNCTION(, int, SHA256Result, SHA256Context*, ctx, uint8_t*, Message_Di
 MOCKABLE_FUNCTION(, const HSM_CLIENT_TPM_INTERFACE*, hsm_client_tpm_interface);
 MOCKABLE_FUNCTION(, const HSM_CLIENT_X509_INTERFACE*, hsm_client_x509_interface);
 MOCKABLE_FUNCTION(, const HSM_CLIENT_KEY_INTERFACE*, hsm_client_key_interface);
+MOCKABLE_FUNCTION(, const HSM_CLIENT_KEY_SIGN_INTERFACE*, hsm_client_key_sign_interface);
 
 #undef ENABLE_MOCKS
 
@@ -177,6 +178,12 @@ static const HSM_CLIENT_KEY_INTERFACE test_key_interface =
     secure_device_set_symmetrical_key_info
 };
 
+static const HSM_CLIENT_KEY_SIGN_INTERFACE test_key_sign_interface =
+{
+    HSM_CLIENT_KEY_SIGN_INTERFACE_VERSION_1,
+    secure_device_sign_data
+};
+
 static HSM_CLIENT_HANDLE my_secure_device_create(void)
 {
     return (HSM_CLIENT_HANDLE)my_gballoc_malloc(1);
@@ -422,6 +429,7 @@ BEGIN_TEST_SUITE(prov_auth_client_ut)
         REGISTER_GLOBAL_MOCK_RETURN(hsm_client_tpm_interface, &test_tpm_interface);
         REGISTER_GLOBAL_MOCK_RETURN(hsm_client_x509_interface, &test_x509_interface);
         REGISTER_GLOBAL_MOCK_RETURN(hsm_client_key_interface, &test_key_interface);
+        REGISTER_GLOBAL_MOCK_RETURN(hsm_client_key_sign_interface, NULL);
     }
 
     TEST_SUITE_CLEANUP(suite_cleanup)
@@ -1135,6 +1143,7 @@ BEGIN_TEST_SUITE(prov_auth_client_ut)
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_ARG));
         STRICT_EXPECTED_CALL(prov_dev_security_get_type()).SetReturn(SECURE_DEVICE_TYPE_SYMMETRIC_KEY);
         STRICT_EXPECTED_CALL(hsm_client_key_interface());
+        STRICT_EXPECTED_CALL(hsm_client_key_sign_interface());
         PROV_AUTH_HANDLE sec_handle = prov_auth_create();
         umock_c_reset_all_calls();
 
@@ -1153,6 +1162,30 @@ BEGIN_TEST_SUITE(prov_auth_client_ut)
         prov_auth_destroy(sec_handle);
     }
 
+    TEST_FUNCTION(prov_auth_construct_symm_key_hsm_sign_succeed)
+    {
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_ARG));
+        STRICT_EXPECTED_CALL(prov_dev_security_get_type()).SetReturn(SECURE_DEVICE_TYPE_SYMMETRIC_KEY);
+        STRICT_EXPECTED_CALL(hsm_client_key_interface());
+        STRICT_EXPECTED_CALL(hsm_client_key_sign_interface()).SetReturn(&test_key_sign_interface);
+        PROV_AUTH_HANDLE sec_handle = prov_auth_create();
+        umock_c_reset_all_calls();
+
+        //arrange
+        setup_prov_auth_construct_sas_token_mocks(false);
+
+        //act
+        char* result = prov_auth_construct_sas_token(sec_handle, TEST_TOKEN_SCOPE_VALUE, TEST_KEY_NAME_VALUE, TEST_EXPIRY_TIME_T_VALUE);
+
+        //assert
+        ASSERT_IS_NOT_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        my_gballoc_free(result);
+        prov_auth_destroy(sec_handle);
+    }
+
     TEST_FUNCTION(prov_auth_construct_sas_token_succeed)
     {
         PROV_AUTH_HANDLE sec_handle = prov_auth_create();
@@ -111,9 +111,18 @@ typedef struct REFLECTION_DESIRED_PROPERTY_TAG
     const char* modelName;
 } REFLECTION_DESIRED_PROPERTY;
 
+/*a WITH_DATA property of a model together with the JSON encoder DECLARE_MODEL generated for its type*/
+typedef struct REFLECTION_PROPERTY_ENCODER_TAG
+{
+    const char* jsonMember; /*", \"name\":", the first member of an object skips the leading ", "*/
+    size_t offset;
+    AGENT_DATA_TYPES_RESULT(*ToJSON_from_Ptr)(const void* param, STRING_HANDLE destination);
+} REFLECTION_PROPERTY_ENCODER;
+
 typedef struct REFLECTION_MODEL_TAG
 {
     const char* name;
+    const REFLECTION_PROPERTY_ENCODER* (*getPropertyEncoders)(void); /*NULL terminated, in declaration order (and so in offset order)*/
 } REFLECTION_MODEL;
 
 typedef struct REFLECTED_SOMETHING_TAG
@@ -178,6 +187,7 @@ MOCKABLE_FUNCTION(, void*, CodeFirst_CreateDevice, SCHEMA_MODEL_TYPE_HANDLE, mod
 MOCKABLE_FUNCTION(, void, CodeFirst_DestroyDevice, void*, device);
 
 extern CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destinationSize, size_t numProperties, ...);
+extern CODEFIRST_RESULT CodeFirst_SendAsyncDirect(unsigned char** destination, size_t* destinationSize, size_t numProperties, ...);
 extern CODEFIRST_RESULT CodeFirst_SendAsyncReported(unsigned char** destination, size_t* destinationSize, size_t numReportedProperties, ...);
 
 MOCKABLE_FUNCTION(, CODEFIRST_RESULT, CodeFirst_IngestDesiredProperties, void*, device, const char*, jsonPayload, bool, parseDesiredNode);
@@ -102,6 +102,7 @@ extern "C"
     REFLECTED_STRUCT(name) \
     MU_FOR_EACH_2_KEEP_1(REFLECTED_FIELD, name, __VA_ARGS__) \
     TO_AGENT_DATA_TYPE(name, __VA_ARGS__) \
+    TO_JSON(name, __VA_ARGS__) \
     static AGENT_DATA_TYPES_RESULT FromAGENT_DATA_TYPE_##name(const AGENT_DATA_TYPE* source, name* destination) \
     { \
         AGENT_DATA_TYPES_RESULT result; \
@@ -168,6 +169,16 @@ extern "C"
     typedef struct name { int :1; MU_FOR_EACH_1(BUILD_MODEL_STRUCT, __VA_ARGS__) } name;        \
     MU_FOR_EACH_1_KEEP_1(CREATE_MODEL_ELEMENT, name, __VA_ARGS__)                               \
     TO_AGENT_DATA_TYPE(name, DROP_FIRST_COMMA_FROM_ARGS(EXPAND_MODEL_ARGS(__VA_ARGS__)))     \
+    TO_JSON(name, DROP_FIRST_COMMA_FROM_ARGS(EXPAND_MODEL_ARGS(__VA_ARGS__)))                \
+    static const REFLECTION_PROPERTY_ENCODER MU_C2(PropertyEncoders_, name)[] =              \
+    {                                                                                        \
+        MU_FOR_EACH_1_KEEP_1(CREATE_MODEL_ELEMENT_PROPERTY_ENCODER, name, __VA_ARGS__)       \
+        { NULL, 0, NULL }                                                                    \
+    };                                                                                       \
+    static const REFLECTION_PROPERTY_ENCODER* MU_C2(GetPropertyEncoders_, name)(void)        \
+    {                                                                                        \
+        return MU_C2(PropertyEncoders_, name);                                               \
+    }                                                                                        \
     int FromAGENT_DATA_TYPE_##name(const AGENT_DATA_TYPE* source, void* destination)         \
     {                                                                                        \
         (void)source;                                                                        \
@@ -285,6 +296,17 @@ extern "C"
  */
 #define SERIALIZE(destination, destinationSize,...) CodeFirst_SendAsync(destination, destinationSize, MU_COUNT_ARG(__VA_ARGS__) MU_FOR_EACH_1(ADDRESS_MACRO, __VA_ARGS__))
 
+/**
+ * @def      SERIALIZE_DIRECT(destination, destinationSize,...)
+ * This macro produces the same JSON as ::SERIALIZE. When every value is a
+ * ::WITH_DATA property of the device's model (or the whole device) the JSON
+ * is written straight from the device's memory by the encoders that
+ * ::DECLARE_MODEL generates, without looking up the properties in the
+ * reflected metadata and without building AGENT_DATA_TYPEs. Any other
+ * list of values is serialized exactly as ::SERIALIZE would.
+ */
+#define SERIALIZE_DIRECT(destination, destinationSize,...) CodeFirst_SendAsyncDirect(destination, destinationSize, MU_COUNT_ARG(__VA_ARGS__) MU_FOR_EACH_1(ADDRESS_MACRO, __VA_ARGS__))
+
 #define SERIALIZE_REPORTED_PROPERTIES(destination, destinationSize,...) CodeFirst_SendAsyncReported(destination, destinationSize, MU_COUNT_ARG(__VA_ARGS__) MU_FOR_EACH_1(ADDRESS_MACRO, __VA_ARGS__))
 
 
@@ -410,6 +432,39 @@ Actions are discarded, since no marshalling will be done for those when sending
 
 #define FIELD_AS_STRING(x,y) memberNames[iMember++] = #y;
 
+/*appends the same JSON that AgentDataTypes_ToString produces for the AGENT_DATA_TYPE built by ToAGENT_DATA_TYPE_<name>, member by
+member from the struct itself*/
+#define TO_JSON(name, ...) \
+    static AGENT_DATA_TYPES_RESULT ToJSON_##name(STRING_HANDLE destination, const name* value) \
+    { \
+        AGENT_DATA_TYPES_RESULT result = AGENT_DATA_TYPES_OK; \
+        size_t iMember = 0; \
+        (void)value; \
+        if (STRING_concat(destination, "{") != 0) \
+        { \
+            result = AGENT_DATA_TYPES_ERROR; \
+        } \
+        else \
+        { \
+            MU_FOR_EACH_2(APPEND_JSON_MEMBER, MU_EXPAND_TWICE(__VA_ARGS__)) \
+            /*same as ToAGENT_DATA_TYPE_<name>, a type without members cannot be encoded*/ \
+            if ((result == AGENT_DATA_TYPES_OK) && \
+                ((iMember == 0) || (STRING_concat(destination, "}") != 0))) \
+            { \
+                result = AGENT_DATA_TYPES_ERROR; \
+            } \
+        } \
+        return result; \
+    }
+
+#define APPEND_JSON_MEMBER(type, name) \
+    if ((result == AGENT_DATA_TYPES_OK) && \
+        ((STRING_concat(destination, (iMember++ == 0) ? "\"" MU_TOSTRING(name) "\":" : ", \"" MU_TOSTRING(name) "\":") != 0) || \
+        (ToJSON_##type(destination, &value->name) != AGENT_DATA_TYPES_OK))) \
+    { \
+        result = AGENT_DATA_TYPES_ERROR; \
+    }
+
 #define REFLECTED_LIST_HEAD(name) \
     static const REFLECTED_DATA_FROM_DATAPROVIDER ALL_REFLECTED(name) = { &MU_C2(REFLECTED_, MU_C1(MU_DEC(__COUNTER__))) };
 #define REFLECTED_STRUCT(name) \
@@ -417,7 +472,8 @@ Actions are discarded, since no marshalling will be done for those when sending
 #define REFLECTED_FIELD(XstructName, XfieldType, XfieldName) \
     static const REFLECTED_SOMETHING MU_C2(REFLECTED_, MU_C1(MU_INC(__COUNTER__))) = { REFLECTION_FIELD_TYPE,                &MU_C2(REFLECTED_, MU_C1(MU_DEC(MU_DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {MU_TOSTRING(XfieldName), MU_TOSTRING(XfieldType), MU_TOSTRING(XstructName)}, {0}, {0}, {0} } };
 #define REFLECTED_MODEL(name) \
-    static const REFLECTED_SOMETHING MU_C2(REFLECTED_, MU_C1(MU_INC(__COUNTER__))) = { REFLECTION_MODEL_TYPE,                &MU_C2(REFLECTED_, MU_C1(MU_DEC(MU_DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {0}, {0}, {0}, {MU_TOSTRING(name)} } };
+    static const REFLECTION_PROPERTY_ENCODER* MU_C2(GetPropertyEncoders_, name)(void); \
+    static const REFLECTED_SOMETHING MU_C2(REFLECTED_, MU_C1(MU_INC(__COUNTER__))) = { REFLECTION_MODEL_TYPE,                &MU_C2(REFLECTED_, MU_C1(MU_DEC(MU_DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {0}, {0}, {0}, {MU_TOSTRING(name), MU_C2(GetPropertyEncoders_, name)} } };
 #define REFLECTED_PROPERTY(type, name, modelName) \
     static const REFLECTED_SOMETHING MU_C2(REFLECTED_, MU_C1(MU_INC(__COUNTER__))) = { REFLECTION_PROPERTY_TYPE,             &MU_C2(REFLECTED_, MU_C1(MU_DEC(MU_DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {0}, {MU_TOSTRING(name), MU_TOSTRING(type), Create_AGENT_DATA_TYPE_From_Ptr_##modelName##name, offsetof(modelName, name), sizeof(type), MU_TOSTRING(modelName)}, {0}, {0} } };
 #define REFLECTED_REPORTED_PROPERTY(type, name, modelName) \
@@ -472,22 +528,30 @@ Actions are discarded, since no marshalling will be done for those when sending
 #define CREATE_ELEMENT_GLOBAL_DEINITIALIZATION(modelName, elem) MU_EXPAND_ARGS(CREATE_SOMETHING_GLOBAL_DEINITIALIZATION(modelName, MU_EXPAND_ARGS(EXPAND_##elem)))
 #define CREATE_MODEL_ELEMENT_GLOBAL_DEINITIALIZE(modelName, elem) MU_EXPAND_ARGS(CREATE_ELEMENT_GLOBAL_DEINITIALIZATION(modelName, elem))
 
+#define CREATE_MODEL_ENTITY_PROPERTY_ENCODER(modelName, callType, ...) MU_EXPAND_ARGS(CREATE_PROPERTY_ENCODER_##callType(modelName, __VA_ARGS__))
+#define CREATE_SOMETHING_PROPERTY_ENCODER(modelName, ...) MU_EXPAND_ARGS(CREATE_MODEL_ENTITY_PROPERTY_ENCODER(modelName, __VA_ARGS__))
+#define CREATE_ELEMENT_PROPERTY_ENCODER(modelName, elem) MU_EXPAND_ARGS(CREATE_SOMETHING_PROPERTY_ENCODER(modelName, MU_EXPAND_ARGS(EXPAND_##elem)))
+#define CREATE_MODEL_ELEMENT_PROPERTY_ENCODER(modelName, elem) MU_EXPAND_ARGS(CREATE_ELEMENT_PROPERTY_ENCODER(modelName, elem))
+
 #define INSERT_FIELD_INTO_STRUCT(x, y) x y;
 
 
 #define INSERT_FIELD_FOR_MODEL_PROPERTY(type, name) INSERT_FIELD_INTO_STRUCT(type, name)
 #define CREATE_GLOBAL_INITIALIZE_MODEL_PROPERTY(modelName, type, name) /*do nothing, this is written by user*/
 #define CREATE_GLOBAL_DEINITIALIZE_MODEL_PROPERTY(modelName, type, name) /*do nothing, this is user's stuff*/
+#define CREATE_PROPERTY_ENCODER_MODEL_PROPERTY(modelName, type, name) { ", \"" MU_TOSTRING(name) "\":", offsetof(modelName, name), ToJSON_From_Ptr_##modelName##name },
 
 /*REPORTED_PROPERTY is not different than regular WITH_DATA*/
 #define INSERT_FIELD_FOR_MODEL_REPORTED_PROPERTY(type, name) INSERT_FIELD_INTO_STRUCT(type, name)
 #define CREATE_GLOBAL_INITIALIZE_MODEL_REPORTED_PROPERTY(modelName, type,name) GlobalInitialize_##type((char*)destination+offsetof(modelName, name));
 #define CREATE_GLOBAL_DEINITIALIZE_MODEL_REPORTED_PROPERTY(modelName, type,name) GlobalDeinitialize_##type((char*)destination+offsetof(modelName, name));
+#define CREATE_PROPERTY_ENCODER_MODEL_REPORTED_PROPERTY(modelName, type, name) /*only WITH_DATA is sent by SERIALIZE*/
 
 /*DESIRED_PROPERTY is not different than regular WITH_DATA*/
 #define INSERT_FIELD_FOR_MODEL_DESIRED_PROPERTY(type, name, ...) INSERT_FIELD_INTO_STRUCT(type, name)
 #define CREATE_GLOBAL_INITIALIZE_MODEL_DESIRED_PROPERTY(modelName, type, name, ...) /*do nothing*/
 #define CREATE_GLOBAL_DEINITIALIZE_MODEL_DESIRED_PROPERTY(modelName, type, name, ...) /*do nothing*/
+#define CREATE_PROPERTY_ENCODER_MODEL_DESIRED_PROPERTY(modelName, type, name, ...) /*only WITH_DATA is sent by SERIALIZE*/
 
 #define INSERT_FIELD_FOR_MODEL_ACTION(name, ...) /* action isn't a part of the model struct */
 #define INSERT_FIELD_FOR_MODEL_METHOD(name, ...) /* method isn't a part of the model struct */
@@ -498,6 +562,9 @@ Actions are discarded, since no marshalling will be done for those when sending
 #define CREATE_GLOBAL_INITIALIZE_MODEL_METHOD(...) /*do nothing*/
 #define CREATE_GLOBAL_DEINITIALIZE_MODEL_METHOD(...) /*do nothing*/
 
+#define CREATE_PROPERTY_ENCODER_MODEL_ACTION(...) /*do nothing*/
+#define CREATE_PROPERTY_ENCODER_MODEL_METHOD(...) /*do nothing*/
+
 #define CREATE_MODEL_PROPERTY(modelName, type, name) \
     IMPL_PROPERTY(type, name, modelName)
 
@@ -512,6 +579,10 @@ Actions are discarded, since no marshalling will be done for those when sending
     { \
         return MU_C1(ToAGENT_DATA_TYPE_##propertyType)(dest, *(propertyType*)param); \
     } \
+    static AGENT_DATA_TYPES_RESULT ToJSON_From_Ptr_##modelName##propertyName(const void* param, STRING_HANDLE destination) \
+    { \
+        return MU_C1(ToJSON_##propertyType)(destination, (const propertyType*)param); \
+    } \
     REFLECTED_PROPERTY(propertyType, propertyName, modelName)
 
 #define IMPL_REPORTED_PROPERTY(propertyType, propertyName, modelName) \
@@ -1449,6 +1520,86 @@ static void MU_C2(destroyLocalParameter, ascii_char_ptr_no_quotes)(ascii_char_pt
     }
 }
 
+/*ToJSON_<type> appends to destination what AgentDataTypes_ToString writes for the AGENT_DATA_TYPE that ToAGENT_DATA_TYPE_<type>
+creates, without allocating: the AGENT_DATA_TYPE lives on the stack and strings and binary data are not copied*/
+#define DEFINE_SCALAR_TO_JSON(type) \
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, type)(STRING_HANDLE destination, const type* source) \
+{ \
+    AGENT_DATA_TYPES_RESULT result; \
+    AGENT_DATA_TYPE value; \
+    if ((result = MU_C2(ToAGENT_DATA_TYPE_, type)(&value, *source)) == AGENT_DATA_TYPES_OK) \
+    { \
+        result = AgentDataTypes_ToString(destination, &value); \
+    } \
+    return result; \
+}
+
+DEFINE_SCALAR_TO_JSON(double)
+DEFINE_SCALAR_TO_JSON(float)
+DEFINE_SCALAR_TO_JSON(int)
+DEFINE_SCALAR_TO_JSON(long)
+DEFINE_SCALAR_TO_JSON(int8_t)
+DEFINE_SCALAR_TO_JSON(uint8_t)
+DEFINE_SCALAR_TO_JSON(int16_t)
+DEFINE_SCALAR_TO_JSON(int32_t)
+DEFINE_SCALAR_TO_JSON(int64_t)
+DEFINE_SCALAR_TO_JSON(bool)
+DEFINE_SCALAR_TO_JSON(EDM_DATE_TIME_OFFSET)
+DEFINE_SCALAR_TO_JSON(EDM_GUID)
+
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, ascii_char_ptr)(STRING_HANDLE destination, const ascii_char_ptr* source)
+{
+    AGENT_DATA_TYPES_RESULT result;
+    if (*source == NULL)
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+    }
+    else
+    {
+        AGENT_DATA_TYPE value;
+        value.type = EDM_STRING_TYPE;
+        value.value.edmString.chars = *source;
+        value.value.edmString.length = strlen(*source);
+        result = AgentDataTypes_ToString(destination, &value);
+    }
+    return result;
+}
+
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, ascii_char_ptr_no_quotes)(STRING_HANDLE destination, const ascii_char_ptr_no_quotes* source)
+{
+    AGENT_DATA_TYPES_RESULT result;
+    if (*source == NULL)
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+    }
+    else
+    {
+        AGENT_DATA_TYPE value;
+        value.type = EDM_STRING_NO_QUOTES_TYPE;
+        value.value.edmStringNoQuotes.chars = *source;
+        value.value.edmStringNoQuotes.length = strlen(*source);
+        result = AgentDataTypes_ToString(destination, &value);
+    }
+    return result;
+}
+
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, EDM_BINARY)(STRING_HANDLE destination, const EDM_BINARY* source)
+{
+    AGENT_DATA_TYPES_RESULT result;
+    if ((source->data == NULL) && (source->size != 0))
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+    }
+    else
+    {
+        AGENT_DATA_TYPE value;
+        value.type = EDM_BINARY_TYPE;
+        value.value.edmBinary = *source;
+        result = AgentDataTypes_ToString(destination, &value);
+    }
+    return result;
+}
+
 #ifdef __cplusplus
     }
 #endif
@@ -1237,6 +1237,242 @@ static char hexDigitToChar(uint8_t hexDigit)
     else return ('A' - 10) + hexDigit;
 }
 
+/*writes value the way printf("%.*d", minDigits, value) does, or printf("%+.*d", minDigits, value) when forceSign is true, for minDigits of at least 1. Returns the number of characters written, the string is not '\0' terminated*/
+static size_t intToPaddedString(char* destination, int value, size_t minDigits, bool forceSign)
+{
+    char digits[MAX_LONG_STRING_LENGTH];
+    size_t nDigits = 0;
+    size_t pos = 0;
+    unsigned int magnitude = (value < 0) ? (0U - (unsigned int)value) : (unsigned int)value;
+
+    do
+    {
+        digits[nDigits++] = '0' + (char)(magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    if (value < 0)
+    {
+        destination[pos++] = '-';
+    }
+    else if (forceSign)
+    {
+        destination[pos++] = '+';
+    }
+
+    while (minDigits > nDigits)
+    {
+        destination[pos++] = '0';
+        minDigits--;
+    }
+
+    while (nDigits > 0)
+    {
+        destination[pos++] = digits[--nDigits];
+    }
+
+    return pos;
+}
+
+/*same as intToPaddedString for printf("%.*llu", minDigits, value)*/
+static size_t uint64ToPaddedString(char* destination, uint64_t value, size_t minDigits)
+{
+    char digits[MAX_ULONG_LONG_STRING_LENGTH];
+    size_t nDigits = 0;
+    size_t pos = 0;
+
+    do
+    {
+        digits[nDigits++] = '0' + (char)(value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (minDigits > nDigits)
+    {
+        destination[pos++] = '0';
+        minDigits--;
+    }
+
+    while (nDigits > 0)
+    {
+        destination[pos++] = digits[--nDigits];
+    }
+
+    return pos;
+}
+
+#ifndef NO_FLOATS
+/*a double scaled by 10^DBL_DIG can need 128 bits, that is 39 decimal digits*/
+#define MAX_FIXED_POINT_DIGITS 39
+#define MAX_FIXED_POINT_STRING_LENGTH (1 + MAX_FIXED_POINT_DIGITS + 1 + 1)
+
+/*(*high:*low) = a * b*/
+static void multiply64(uint64_t a, uint64_t b, uint64_t* high, uint64_t* low)
+{
+    uint64_t aLow = a & 0xFFFFFFFFU;
+    uint64_t aHigh = a >> 32;
+    uint64_t bLow = b & 0xFFFFFFFFU;
+    uint64_t bHigh = b >> 32;
+    uint64_t lowLow = aLow * bLow;
+    uint64_t lowHigh = aLow * bHigh;
+    uint64_t highLow = aHigh * bLow;
+    uint64_t middle = (lowLow >> 32) + (lowHigh & 0xFFFFFFFFU) + (highLow & 0xFFFFFFFFU);
+
+    *low = (lowLow & 0xFFFFFFFFU) | (middle << 32);
+    *high = (aHigh * bHigh) + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+}
+
+/*(*high:*low) = (*high:*low) / 10, returns the remainder*/
+static char divide128By10(uint64_t* high, uint64_t* low)
+{
+    uint64_t remainder = *high % 10;
+    uint64_t partial;
+    uint64_t quotientHigh;
+
+    *high /= 10;
+    partial = (remainder << 32) | (*low >> 32);
+    quotientHigh = partial / 10;
+    remainder = partial % 10;
+    partial = (remainder << 32) | (*low & 0xFFFFFFFFU);
+    *low = (quotientHigh << 32) | (partial / 10);
+    return (char)(partial % 10);
+}
+
+/*writes a finite value the way printf("%.*f", decimals, value) does: the exact binary value is scaled by 10^decimals and rounded
+half to even in integer arithmetic, so the digits are the same as printf's without going through printf. Returns the number of
+characters written (and '\0' terminates them) or 0 when the scaled value needs more than 128 bits and printf has to be used*/
+static size_t fixedPointToString(char* destination, double value, unsigned int decimals)
+{
+    size_t result;
+    int exponent;
+    /*frexp and ldexp are exact: |value| = mantissa * 2^(exponent - 53)*/
+    uint64_t mantissa = (uint64_t)ldexp(frexp(fabs(value), &exponent), 53);
+    int shift = exponent - 53;
+    uint64_t scale = 1;
+    uint64_t high;
+    uint64_t low;
+    unsigned int i;
+
+    for (i = 0; i < decimals; i++)
+    {
+        scale *= 10;
+    }
+    multiply64(mantissa, scale, &high, &low);
+
+    if (shift >= 0)
+    {
+        /*only whole numbers, they have to fit 128 bits after the shift*/
+        if ((shift >= 64) ||
+            ((shift > 0) && ((high >> (64 - shift)) != 0)))
+        {
+            result = 0;
+        }
+        else
+        {
+            if (shift > 0)
+            {
+                high = (high << shift) | (low >> (64 - shift));
+                low <<= shift;
+            }
+            result = 1;
+        }
+    }
+    else
+    {
+        unsigned int rightShift = (unsigned int)(-shift);
+        uint64_t remainderHigh;
+        uint64_t remainderLow;
+        uint64_t halfHigh;
+        uint64_t halfLow;
+
+        if (rightShift >= 128)
+        {
+            /*mantissa * scale < 2^117, less than half of 2^rightShift, rounds to 0*/
+            high = 0;
+            low = 0;
+            remainderHigh = 0;
+            remainderLow = 0;
+            halfHigh = 1;
+            halfLow = 0;
+        }
+        else if (rightShift >= 64)
+        {
+            unsigned int highShift = rightShift - 64;
+            remainderHigh = (highShift == 0) ? 0 : (high & ((((uint64_t)1) << highShift) - 1));
+            remainderLow = low;
+            halfHigh = (highShift == 0) ? 0 : (((uint64_t)1) << (highShift - 1));
+            halfLow = (highShift == 0) ? (((uint64_t)1) << 63) : 0;
+            low = high >> highShift;
+            high = 0;
+        }
+        else
+        {
+            remainderHigh = 0;
+            remainderLow = low & ((((uint64_t)1) << rightShift) - 1);
+            halfHigh = 0;
+            halfLow = ((uint64_t)1) << (rightShift - 1);
+            low = (low >> rightShift) | (high << (64 - rightShift));
+            high >>= rightShift;
+        }
+
+        if ((remainderHigh > halfHigh) ||
+            ((remainderHigh == halfHigh) && (remainderLow > halfLow)) ||
+            ((remainderHigh == halfHigh) && (remainderLow == halfLow) && ((low & 1) != 0)))
+        {
+            low++;
+            if (low == 0)
+            {
+                high++;
+            }
+        }
+        result = 1;
+    }
+
+    if (result != 0)
+    {
+        char digits[MAX_FIXED_POINT_DIGITS];
+        size_t nDigits = 0;
+        size_t pos = 0;
+
+        do
+        {
+            digits[nDigits++] = '0' + divide128By10(&high, &low);
+        } while ((high != 0) || (low != 0));
+
+        /*at least one digit before the decimal point*/
+        while (nDigits <= decimals)
+        {
+            digits[nDigits++] = '0';
+        }
+
+        /*printf writes the sign of negative values even when they round to 0*/
+        if (signbit(value))
+        {
+            destination[pos++] = '-';
+        }
+
+        while (nDigits > decimals)
+        {
+            destination[pos++] = digits[--nDigits];
+        }
+
+        if (decimals > 0)
+        {
+            destination[pos++] = '.';
+            while (nDigits > 0)
+            {
+                destination[pos++] = digits[--nDigits];
+            }
+        }
+
+        destination[pos] = '\0';
+        result = pos;
+    }
+
+    return result;
+}
+#endif
+
 AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -1369,228 +1605,56 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
             case (EDM_DATE_TIME_OFFSET_TYPE):
             {
                 /*from ABNF seems like these numbers HAVE to be padded with zeroes*/
+                /*"%.4d-%.2d-%.2dT%.2d:%.2d:%.2d[.%.12llu](%+.2d:%.2d|Z)" between quotes, written in place without sprintf*/
+                char tempBuffer[
+                    1 + // \"
+                    6 * (1 + MAX_LONG_STRING_LENGTH) + // %.4d-%.2d-%.2dT%.2d:%.2d:%.2d
+                    1 + MAX_ULONG_LONG_STRING_LENGTH + // .%.12llu
+                    2 * (1 + MAX_LONG_STRING_LENGTH) + // %+.2d:%.2d
+                    1 + // \"
+                    1]; // terminating NULL
+                const struct tm* dateTime = &value->value.edmDateTimeOffset.dateTime;
+                size_t pos = 0;
+
+                tempBuffer[pos++] = '\"';
+                pos += intToPaddedString(tempBuffer + pos, dateTime->tm_year + 1900, 4, false);
+                tempBuffer[pos++] = '-';
+                pos += intToPaddedString(tempBuffer + pos, dateTime->tm_mon + 1, 2, false);
+                tempBuffer[pos++] = '-';
+                pos += intToPaddedString(tempBuffer + pos, dateTime->tm_mday, 2, false);
+                tempBuffer[pos++] = 'T';
+                pos += intToPaddedString(tempBuffer + pos, dateTime->tm_hour, 2, false);
+                tempBuffer[pos++] = ':';
+                pos += intToPaddedString(tempBuffer + pos, dateTime->tm_min, 2, false);
+                tempBuffer[pos++] = ':';
+                pos += intToPaddedString(tempBuffer + pos, dateTime->tm_sec, 2, false);
+                if (value->value.edmDateTimeOffset.hasFractionalSecond)
+                {
+                    tempBuffer[pos++] = '.';
+                    pos += uint64ToPaddedString(tempBuffer + pos, value->value.edmDateTimeOffset.fractionalSecond, 12);
+                }
                 if (value->value.edmDateTimeOffset.hasTimeZone)
                 {
-                    if (value->value.edmDateTimeOffset.hasFractionalSecond)
-                    {
-                        size_t tempBufferSize = 1 + // \"
-                            MAX_LONG_STRING_LENGTH + // %.4d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // T
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // .
-                            MAX_ULONG_LONG_STRING_LENGTH + // %.12llu
-                            1 + MAX_LONG_STRING_LENGTH + // %+.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + //\"
-                            1;  // " (terminating NULL);
-
-                        char* tempBuffer = (char*)malloc(tempBufferSize);
-                        if (tempBuffer == NULL)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            if (sprintf_s(tempBuffer, tempBufferSize, "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2d.%.12llu%+.2d:%.2d\"", /*+ in printf forces the sign to appear*/
-                                value->value.edmDateTimeOffset.dateTime.tm_year+1900,
-                                value->value.edmDateTimeOffset.dateTime.tm_mon+1,
-                                value->value.edmDateTimeOffset.dateTime.tm_mday,
-                                value->value.edmDateTimeOffset.dateTime.tm_hour,
-                                value->value.edmDateTimeOffset.dateTime.tm_min,
-                                value->value.edmDateTimeOffset.dateTime.tm_sec,
-                                value->value.edmDateTimeOffset.fractionalSecond,
-                                value->value.edmDateTimeOffset.timeZoneHour,
-                                value->value.edmDateTimeOffset.timeZoneMinute) < 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else if (STRING_concat(destination, tempBuffer) != 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else
-                            {
-                                result = AGENT_DATA_TYPES_OK;
-                            }
-
-                            // Clean up temp buffer if allocated
-                            free(tempBuffer);
-                        }
-                    }
-                    else
-                    {
-                        size_t tempBufferSize = 1 + // \"
-                            MAX_LONG_STRING_LENGTH + // %.4d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // T
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + MAX_LONG_STRING_LENGTH + // %+.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // \"
-                            1; // " terminating NULL
-                        char* tempBuffer = (char*)malloc(tempBufferSize);
-
-                        if (tempBuffer == NULL)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            if (sprintf_s(tempBuffer, tempBufferSize, "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2d%+.2d:%.2d\"", /*+ in printf forces the sign to appear*/
-                                value->value.edmDateTimeOffset.dateTime.tm_year + 1900,
-                                value->value.edmDateTimeOffset.dateTime.tm_mon+1,
-                                value->value.edmDateTimeOffset.dateTime.tm_mday,
-                                value->value.edmDateTimeOffset.dateTime.tm_hour,
-                                value->value.edmDateTimeOffset.dateTime.tm_min,
-                                value->value.edmDateTimeOffset.dateTime.tm_sec,
-                                value->value.edmDateTimeOffset.timeZoneHour,
-                                value->value.edmDateTimeOffset.timeZoneMinute) < 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else if (STRING_concat(destination, tempBuffer) != 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else
-                            {
-                                result = AGENT_DATA_TYPES_OK;
-                            }
-
-                            // Clean up temp buffer if allocated
-                            free(tempBuffer);
-                        }
-                    }
+                    /*+ forces the sign to appear*/
+                    pos += intToPaddedString(tempBuffer + pos, value->value.edmDateTimeOffset.timeZoneHour, 2, true);
+                    tempBuffer[pos++] = ':';
+                    pos += intToPaddedString(tempBuffer + pos, value->value.edmDateTimeOffset.timeZoneMinute, 2, false);
                 }
                 else
                 {
-                    if (value->value.edmDateTimeOffset.hasFractionalSecond)
-                    {
-                        size_t tempBufferSize = 1 + //\"
-                            MAX_LONG_STRING_LENGTH + // %.4d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // T
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // .
-                            MAX_ULONG_LONG_STRING_LENGTH + // %.12llu
-                            1 + // Z
-                            1 + // \"
-                            1; // " (terminating NULL)
-                        char* tempBuffer = (char*)malloc(tempBufferSize);
-
-                        if (tempBuffer == NULL)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            if (sprintf_s(tempBuffer, tempBufferSize, "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2d.%.12lluZ\"", /*+ in printf forces the sign to appear*/
-                                value->value.edmDateTimeOffset.dateTime.tm_year + 1900,
-                                value->value.edmDateTimeOffset.dateTime.tm_mon+1,
-                                value->value.edmDateTimeOffset.dateTime.tm_mday,
-                                value->value.edmDateTimeOffset.dateTime.tm_hour,
-                                value->value.edmDateTimeOffset.dateTime.tm_min,
-                                value->value.edmDateTimeOffset.dateTime.tm_sec,
-                                value->value.edmDateTimeOffset.fractionalSecond) < 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else if (STRING_concat(destination, tempBuffer) != 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else
-                            {
-                                result = AGENT_DATA_TYPES_OK;
-                            }
-
-                            free(tempBuffer);
-                        }
-                    }
-                    else
-                    {
-                        size_t tempBufferSize = 1 + // \"
-                            MAX_LONG_STRING_LENGTH + // %.4d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // T
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // Z
-                            1 + // \"
-                            1; // " (terminating null);
-
-                        char* tempBuffer = (char*)malloc(tempBufferSize);
-
-                        if (tempBuffer == NULL)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            if (sprintf_s(tempBuffer, tempBufferSize, "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2dZ\"",
-                                value->value.edmDateTimeOffset.dateTime.tm_year + 1900,
-                                value->value.edmDateTimeOffset.dateTime.tm_mon+1,
-                                value->value.edmDateTimeOffset.dateTime.tm_mday,
-                                value->value.edmDateTimeOffset.dateTime.tm_hour,
-                                value->value.edmDateTimeOffset.dateTime.tm_min,
-                                value->value.edmDateTimeOffset.dateTime.tm_sec) < 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else if (STRING_concat(destination, tempBuffer) != 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else
-                            {
-                                result = AGENT_DATA_TYPES_OK;
-                            }
+                    tempBuffer[pos++] = 'Z';
+                }
+                tempBuffer[pos++] = '\"';
+                tempBuffer[pos] = '\0';
 
-                            free(tempBuffer);
-                        }
-                    }
+                if (STRING_concat(destination, tempBuffer) != 0)
+                {
+                    result = AGENT_DATA_TYPES_ERROR;
+                    LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+                }
+                else
+                {
+                    result = AGENT_DATA_TYPES_OK;
                 }
                 break;
             }
@@ -1938,31 +2002,47 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                 }
                 else
                 {
-                    size_t tempBufferSize = MAX_FLOATING_POINT_STRING_LENGTH;
-                    char* tempBuffer = (char*)malloc(tempBufferSize);
-                    if (tempBuffer == NULL)
-                    {
-                        result = AGENT_DATA_TYPES_ERROR;
-                        LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                    }
-                    else
+                    char fixedPointBuffer[MAX_FIXED_POINT_STRING_LENGTH];
+                    if (fixedPointToString(fixedPointBuffer, (double)(value->value.edmSingle.value), FLT_DIG) != 0)
                     {
-                        if (sprintf_s(tempBuffer, tempBufferSize, "%.*f", FLT_DIG, (double)(value->value.edmSingle.value)) < 0)
+                        if (STRING_concat(destination, fixedPointBuffer) != 0)
                         {
                             result = AGENT_DATA_TYPES_ERROR;
                             LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                         }
-                        else if (STRING_concat(destination, tempBuffer) != 0)
+                        else
+                        {
+                            result = AGENT_DATA_TYPES_OK;
+                        }
+                    }
+                    else
+                    {
+                        size_t tempBufferSize = MAX_FLOATING_POINT_STRING_LENGTH;
+                        char* tempBuffer = (char*)malloc(tempBufferSize);
+                        if (tempBuffer == NULL)
                         {
                             result = AGENT_DATA_TYPES_ERROR;
                             LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                         }
                         else
                         {
-                            result = AGENT_DATA_TYPES_OK;
-                        }
+                            if (sprintf_s(tempBuffer, tempBufferSize, "%.*f", FLT_DIG, (double)(value->value.edmSingle.value)) < 0)
+                            {
+                                result = AGENT_DATA_TYPES_ERROR;
+                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+                            }
+                            else if (STRING_concat(destination, tempBuffer) != 0)
+                            {
+                                result = AGENT_DATA_TYPES_ERROR;
+                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+                            }
+                            else
+                            {
+                                result = AGENT_DATA_TYPES_OK;
+                            }
 
-                        free(tempBuffer);
+                            free(tempBuffer);
+                        }
                     }
                 }
                 break;
@@ -2012,31 +2092,47 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                 }
                 else
                 {
-                    size_t tempBufferSize = DECIMAL_DIG * 2;
-                    char* tempBuffer = (char*)malloc(tempBufferSize);
-                    if (tempBuffer == NULL)
+                    char fixedPointBuffer[MAX_FIXED_POINT_STRING_LENGTH];
+                    if (fixedPointToString(fixedPointBuffer, value->value.edmDouble.value, DBL_DIG) != 0)
                     {
-                        result = AGENT_DATA_TYPES_ERROR;
-                        LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                    }
-                    else
-                    {
-                        if (sprintf_s(tempBuffer, tempBufferSize, "%.*f", DBL_DIG, value->value.edmDouble.value) < 0)
+                        if (STRING_concat(destination, fixedPointBuffer) != 0)
                         {
                             result = AGENT_DATA_TYPES_ERROR;
                             LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                         }
-                        else if (STRING_concat(destination, tempBuffer) != 0)
+                        else
+                        {
+                            result = AGENT_DATA_TYPES_OK;
+                        }
+                    }
+                    else
+                    {
+                        size_t tempBufferSize = DECIMAL_DIG * 2;
+                        char* tempBuffer = (char*)malloc(tempBufferSize);
+                        if (tempBuffer == NULL)
                         {
                             result = AGENT_DATA_TYPES_ERROR;
                             LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                         }
                         else
                         {
-                            result = AGENT_DATA_TYPES_OK;
-                        }
+                            if (sprintf_s(tempBuffer, tempBufferSize, "%.*f", DBL_DIG, value->value.edmDouble.value) < 0)
+                            {
+                                result = AGENT_DATA_TYPES_ERROR;
+                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+                            }
+                            else if (STRING_concat(destination, tempBuffer) != 0)
+                            {
+                                result = AGENT_DATA_TYPES_ERROR;
+                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+                            }
+                            else
+                            {
+                                result = AGENT_DATA_TYPES_OK;
+                            }
 
-                        free(tempBuffer);
+                            free(tempBuffer);
+                        }
                     }
                 }
                 break;
@@ -26,6 +26,10 @@ typedef struct DEVICE_HEADER_DATA_TAG
     SCHEMA_MODEL_TYPE_HANDLE ModelHandle;
     size_t DataSize;
     unsigned char* data;
+    bool IncludePropertyPath;
+    /*the encoders DECLARE_MODEL generated for the WITH_DATA properties of the model, looked up by the first SERIALIZE_DIRECT*/
+    const REFLECTION_PROPERTY_ENCODER* PropertyEncoders;
+    size_t PropertyEncoderCount;
 } DEVICE_HEADER_DATA;
 
 #define COUNT_OF(A) (sizeof(A) / sizeof((A)[0]))
@@ -696,7 +700,11 @@ SCHEMA_HANDLE CodeFirst_RegisterSchema(const char* schemaNamespace, const REFLEC
                 }
                 else
                 {
-                    /* do nothing, everything is OK */
+                    /*the schema does not change after registration, so index its names once; without the index lookups still work by scanning*/
+                    if (Schema_BuildIndex(result) != SCHEMA_OK)
+                    {
+                        LogError("unable to index schema %s, lookups will scan", schemaNamespace);
+                    }
                 }
             }
         }
@@ -913,6 +921,7 @@ void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DAT
                     deviceHeader->ReflectedData = metadata;
                     deviceHeader->DataSize = dataSize;
                     deviceHeader->ModelHandle = model;
+                    deviceHeader->IncludePropertyPath = includePropertyPath;
                     schemaResult = Schema_AddDeviceRef(model);
                     if (schemaResult != SCHEMA_OK)
                     {
@@ -1159,10 +1168,9 @@ static CODEFIRST_RESULT SendAllDeviceReportedProperties(DEVICE_HEADER_DATA* devi
 }
 
 
-CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destinationSize, size_t numProperties, ...)
+static CODEFIRST_RESULT SendAsync(unsigned char** destination, size_t* destinationSize, size_t numProperties, va_list ap)
 {
     CODEFIRST_RESULT result;
-    va_list ap;
 
     if (
         (numProperties == 0) ||
@@ -1182,8 +1190,6 @@ CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destin
         TRANSACTION_HANDLE transaction = NULL;
         result = CODEFIRST_OK;
 
-        va_start(ap, numProperties);
-
         for (i = 0; i < numProperties; i++)
         {
             void* value = (void*)va_arg(ap, void*);
@@ -1302,9 +1308,239 @@ CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destin
         {
             result = CODEFIRST_OK;
         }
+    }
 
-        va_end(ap);
+    return result;
+}
+
+CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destinationSize, size_t numProperties, ...)
+{
+    CODEFIRST_RESULT result;
+    va_list ap;
+
+    va_start(ap, numProperties);
+    result = SendAsync(destination, destinationSize, numProperties, ap);
+    va_end(ap);
+
+    return result;
+}
+
+static const REFLECTION_PROPERTY_ENCODER* GetPropertyEncoders(DEVICE_HEADER_DATA* deviceHeader)
+{
+    if (deviceHeader->PropertyEncoders == NULL)
+    {
+        const char* modelName = Schema_GetModelName(deviceHeader->ModelHandle);
+        const REFLECTED_SOMETHING* model;
+
+        if ((modelName != NULL) &&
+            ((model = FindModelInCodeFirstMetadata(deviceHeader->ReflectedData->reflectedData, modelName)) != NULL) &&
+            (model->what.model.getPropertyEncoders != NULL))
+        {
+            const REFLECTION_PROPERTY_ENCODER* encoders = model->what.model.getPropertyEncoders();
+            size_t count = 0;
+
+            while (encoders[count].jsonMember != NULL)
+            {
+                count++;
+            }
+
+            deviceHeader->PropertyEncoderCount = count;
+            deviceHeader->PropertyEncoders = encoders;
+        }
+    }
+
+    return deviceHeader->PropertyEncoders;
+}
+
+/*the encoders are in declaration order, so in offset order. Only a value that starts a property is found: a value inside a
+property (a field of a child model) is left to the transaction path, which knows its full path*/
+static size_t FindPropertyEncoder(const DEVICE_HEADER_DATA* deviceHeader, void* value)
+{
+    size_t valueOffset = (size_t)((unsigned char*)value - deviceHeader->data);
+    size_t left = 0;
+    size_t right = deviceHeader->PropertyEncoderCount;
 
+    while (left < right)
+    {
+        size_t middle = left + (right - left) / 2;
+        if (deviceHeader->PropertyEncoders[middle].offset < valueOffset)
+        {
+            left = middle + 1;
+        }
+        else
+        {
+            right = middle;
+        }
+    }
+
+    return ((left < deviceHeader->PropertyEncoderCount) && (deviceHeader->PropertyEncoders[left].offset == valueOffset))
+        ? left
+        : deviceHeader->PropertyEncoderCount;
+}
+
+static int AppendEncodedProperty(const DEVICE_HEADER_DATA* deviceHeader, size_t index, STRING_HANDLE payload, bool* isEncoded, size_t* memberCount, size_t* firstValueStart)
+{
+    int result;
+    const REFLECTION_PROPERTY_ENCODER* encoder = &deviceHeader->PropertyEncoders[index];
+
+    if (isEncoded[index])
+    {
+        /*the transaction keeps one value per property*/
+        result = MU_FAILURE;
+    }
+    else if (STRING_concat(payload, encoder->jsonMember + ((*memberCount == 0) ? 2 : 0)) != 0)
+    {
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if (*memberCount == 0)
+        {
+            *firstValueStart = STRING_length(payload);
+        }
+
+        if (encoder->ToJSON_from_Ptr(deviceHeader->data + encoder->offset, payload) != AGENT_DATA_TYPES_OK)
+        {
+            result = MU_FAILURE;
+        }
+        else
+        {
+            isEncoded[index] = true;
+            (*memberCount)++;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+/*produces the JSON SendAsync would for values that are all WITH_DATA properties of one device (or the device itself), straight
+from the device's memory. Returns false, without touching destination, for anything that is not exactly reproduced here, so
+that SendAsync can take care of it (and of reporting errors)*/
+static bool SendDirectly(unsigned char** destination, size_t* destinationSize, size_t numProperties, va_list ap)
+{
+    bool result = false;
+    void* value = (numProperties == 0) ? NULL : va_arg(ap, void*);
+    DEVICE_HEADER_DATA* deviceHeader = FindDevice(value);
+    bool* isEncoded;
+    STRING_HANDLE payload;
+
+    if ((destination == NULL) ||
+        (destinationSize == NULL) ||
+        (deviceHeader == NULL) ||
+        (GetPropertyEncoders(deviceHeader) == NULL) ||
+        (deviceHeader->PropertyEncoderCount == 0))
+    {
+        /*fall back*/
+    }
+    else if ((isEncoded = (bool*)calloc(deviceHeader->PropertyEncoderCount, sizeof(bool))) == NULL)
+    {
+        LogError("failure in calloc");
+    }
+    else
+    {
+        if ((payload = STRING_construct("{")) == NULL)
+        {
+            LogError("failure in STRING_construct");
+        }
+        else
+        {
+            size_t memberCount = 0;
+            size_t firstValueStart = 0;
+            size_t i;
+
+            for (i = 0; i < numProperties; i++)
+            {
+                if (i > 0)
+                {
+                    value = va_arg(ap, void*);
+                }
+
+                if (FindDevice(value) != deviceHeader)
+                {
+                    break;
+                }
+                else if (value == deviceHeader->data)
+                {
+                    /*SendAllDeviceProperties walks the reflected data, which lists the properties last to first*/
+                    size_t j;
+                    for (j = deviceHeader->PropertyEncoderCount; j > 0; j--)
+                    {
+                        if (AppendEncodedProperty(deviceHeader, j - 1, payload, isEncoded, &memberCount, &firstValueStart) != 0)
+                        {
+                            break;
+                        }
+                    }
+
+                    if (j > 0)
+                    {
+                        break;
+                    }
+                }
+                else
+                {
+                    size_t index = FindPropertyEncoder(deviceHeader, value);
+                    if ((index == deviceHeader->PropertyEncoderCount) ||
+                        (AppendEncodedProperty(deviceHeader, index, payload, isEncoded, &memberCount, &firstValueStart) != 0))
+                    {
+                        break;
+                    }
+                }
+            }
+
+            if ((i < numProperties) ||
+                (memberCount == 0) ||
+                /*without the property path a lone struct is replaced by its fields, which is left to SendAsync*/
+                ((memberCount == 1) && (!deviceHeader->IncludePropertyPath) && (STRING_c_str(payload)[firstValueStart] == '{')) ||
+                (STRING_concat(payload, "}") != 0))
+            {
+                /*fall back*/
+            }
+            else
+            {
+                size_t payloadSize = STRING_length(payload);
+                unsigned char* temp = (unsigned char*)malloc(payloadSize);
+                if (temp == NULL)
+                {
+                    LogError("failure in malloc");
+                }
+                else
+                {
+                    (void)memcpy(temp, STRING_c_str(payload), payloadSize);
+                    *destination = temp;
+                    *destinationSize = payloadSize;
+                    result = true;
+                }
+            }
+
+            STRING_delete(payload);
+        }
+
+        free(isEncoded);
+    }
+
+    return result;
+}
+
+CODEFIRST_RESULT CodeFirst_SendAsyncDirect(unsigned char** destination, size_t* destinationSize, size_t numProperties, ...)
+{
+    CODEFIRST_RESULT result;
+    va_list ap;
+    bool isSent;
+
+    va_start(ap, numProperties);
+    isSent = SendDirectly(destination, destinationSize, numProperties, ap);
+    va_end(ap);
+
+    if (isSent)
+    {
+        result = CODEFIRST_OK;
+    }
+    else
+    {
+        va_start(ap, numProperties);
+        result = SendAsync(destination, destinationSize, numProperties, ap);
+        va_end(ap);
     }
 
     return result;
@@ -5,6 +5,7 @@
 #include "azure_c_shared_utility/gballoc.h"
 
 #include <stdbool.h>
+#include <string.h>
 #include "datamarshaller.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "schema.h"
@@ -36,6 +37,134 @@ static void NoFreeFunction(void* value)
     (void)value;
 }
 
+/*the members of the JSON object produced by DataMarshaller_SendData: either the values themselves, or the fields of the only value*/
+typedef struct JSON_MEMBERS_TAG
+{
+    size_t count;
+    const DATA_MARSHALLER_VALUE* values;
+    const COMPLEX_TYPE_FIELD_TYPE* fields;
+} JSON_MEMBERS;
+
+static const char* GetMemberName(const JSON_MEMBERS* members, size_t index)
+{
+    const char* result = (members->fields != NULL) ? members->fields[index].fieldName : members->values[index].PropertyPath;
+    /*same as MultiTree_AddLeaf, a leading '/' is not part of the name*/
+    if ((result != NULL) && (result[0] == '/'))
+    {
+        result++;
+    }
+    return result;
+}
+
+static const AGENT_DATA_TYPE* GetMemberValue(const JSON_MEMBERS* members, size_t index)
+{
+    return (members->fields != NULL) ? members->fields[index].value : members->values[index].Value;
+}
+
+/*members can be written straight to the JSON when none of them nests (has a '/' in its name) and no name repeats. Otherwise the
+MultiTree is needed to group nested members under their common parent and to reject duplicates. Names are few, so the quadratic
+duplicate check costs less than the allocations it saves*/
+static bool CanEncodeMembersDirectly(const JSON_MEMBERS* members)
+{
+    size_t i;
+    for (i = 0; i < members->count; i++)
+    {
+        const char* name = GetMemberName(members, i);
+        size_t j;
+
+        if ((name == NULL) ||
+            (name[0] == '\0') ||
+            (strchr(name, '/') != NULL) ||
+            (GetMemberValue(members, i) == NULL))
+        {
+            break;
+        }
+
+        for (j = 0; j < i; j++)
+        {
+            if (strcmp(name, GetMemberName(members, j)) == 0)
+            {
+                break;
+            }
+        }
+
+        if (j < i)
+        {
+            break;
+        }
+    }
+
+    return (i == members->count);
+}
+
+static DATA_MARSHALLER_RESULT CopyPayload(STRING_HANDLE payload, unsigned char** destination, size_t* destinationSize)
+{
+    DATA_MARSHALLER_RESULT result;
+    size_t resultSize = STRING_length(payload);
+    unsigned char* temp = malloc(resultSize);
+    if (temp == NULL)
+    {
+        result = DATA_MARSHALLER_ERROR;
+        LOG_DATA_MARSHALLER_ERROR;
+    }
+    else
+    {
+        (void)memcpy(temp, STRING_c_str(payload), resultSize);
+        *destination = temp;
+        *destinationSize = resultSize;
+        result = DATA_MARSHALLER_OK;
+    }
+    return result;
+}
+
+/*produces the same JSON as JSONEncoder_EncodeTree would for the same members, but appends every member to one payload in order
+instead of building a MultiTree and a STRING per name and per value*/
+static DATA_MARSHALLER_RESULT EncodeMembersDirectly(const JSON_MEMBERS* members, unsigned char** destination, size_t* destinationSize)
+{
+    DATA_MARSHALLER_RESULT result;
+    STRING_HANDLE payload = STRING_new();
+    if (payload == NULL)
+    {
+        result = DATA_MARSHALLER_ERROR;
+        LOG_DATA_MARSHALLER_ERROR
+    }
+    else
+    {
+        if (STRING_concat(payload, "{") != 0)
+        {
+            result = DATA_MARSHALLER_JSON_ENCODER_ERROR;
+            LOG_DATA_MARSHALLER_ERROR
+        }
+        else
+        {
+            size_t i;
+            for (i = 0; i < members->count; i++)
+            {
+                if ((STRING_concat(payload, (i == 0) ? "\"" : ", \"") != 0) ||
+                    (STRING_concat(payload, GetMemberName(members, i)) != 0) ||
+                    (STRING_concat(payload, "\":") != 0) ||
+                    (AgentDataTypes_ToString(payload, GetMemberValue(members, i)) != AGENT_DATA_TYPES_OK))
+                {
+                    break;
+                }
+            }
+
+            if ((i < members->count) ||
+                (STRING_concat(payload, "}") != 0))
+            {
+                result = DATA_MARSHALLER_JSON_ENCODER_ERROR;
+                LOG_DATA_MARSHALLER_ERROR
+            }
+            else
+            {
+                result = CopyPayload(payload, destination, destinationSize);
+            }
+        }
+        STRING_delete(payload);
+    }
+    return result;
+}
+
 DATA_MARSHALLER_HANDLE DataMarshaller_Create(SCHEMA_MODEL_TYPE_HANDLE modelHandle, bool includePropertyPath)
 {
     DATA_MARSHALLER_HANDLE_DATA* result;
@@ -110,7 +239,26 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData(DATA_MARSHALLER_HANDLE dataMarsha
 
         if (i == valueCount)
         {
-            if ((treeHandle = MultiTree_Create(NoCloneFunction, NoFreeFunction)) == NULL)
+            JSON_MEMBERS members;
+            if ((includePropertyPath == false) && (values[0].Value->type == EDM_COMPLEX_TYPE_TYPE))
+            {
+                /*only one value can be here (see above), its fields become the members*/
+                members.count = values[0].Value->value.edmComplexType.nMembers;
+                members.values = NULL;
+                members.fields = values[0].Value->value.edmComplexType.fields;
+            }
+            else
+            {
+                members.count = valueCount;
+                members.values = values;
+                members.fields = NULL;
+            }
+
+            if (CanEncodeMembersDirectly(&members))
+            {
+                result = EncodeMembersDirectly(&members, destination, destinationSize);
+            }
+            else if ((treeHandle = MultiTree_Create(NoCloneFunction, NoFreeFunction)) == NULL)
             {
                 result = DATA_MARSHALLER_MULTITREE_ERROR;
                 LOG_DATA_MARSHALLER_ERROR
@@ -169,20 +317,7 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData(DATA_MARSHALLER_HANDLE dataMarsha
                         }
                         else
                         {
-                            size_t resultSize = STRING_length(payload);
-                            unsigned char* temp = malloc(resultSize);
-                            if (temp == NULL)
-                            {
-                                result = DATA_MARSHALLER_ERROR;
-                                LOG_DATA_MARSHALLER_ERROR;
-                            }
-                            else
-                            {
-                                (void)memcpy(temp, STRING_c_str(payload), resultSize);
-                                *destination = temp;
-                                *destinationSize = resultSize;
-                                result = DATA_MARSHALLER_OK;
-                            }
+                            result = CopyPayload(payload, destination, destinationSize);
                         }
                         STRING_delete(payload);
                     }
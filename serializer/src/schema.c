@@ -2,6 +2,8 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
 
 #include "schema.h"
@@ -69,6 +71,35 @@ typedef struct MODEL_IN_MODEL_TAG
     SCHEMA_MODEL_TYPE_HANDLE modelHandle;
 } MODEL_IN_MODEL;
 
+/*the kinds of names held by a SCHEMA_INDEX. The same name can be used by elements of different kinds.*/
+typedef enum SCHEMA_INDEX_KIND_TAG
+{
+    SCHEMA_INDEX_MODEL_TYPE,
+    SCHEMA_INDEX_STRUCT_TYPE,
+    SCHEMA_INDEX_PROPERTY,
+    SCHEMA_INDEX_REPORTED_PROPERTY,
+    SCHEMA_INDEX_DESIRED_PROPERTY,
+    SCHEMA_INDEX_ACTION,
+    SCHEMA_INDEX_METHOD,
+    SCHEMA_INDEX_MODEL_IN_MODEL
+} SCHEMA_INDEX_KIND;
+
+typedef struct SCHEMA_INDEX_ENTRY_TAG
+{
+    const char* name; /*NULL for an empty slot*/
+    size_t nameLength;
+    SCHEMA_INDEX_KIND kind;
+    void* element; /*what the linear search would have found: the handle for arrays, the VECTOR element for vectors*/
+} SCHEMA_INDEX_ENTRY;
+
+/*open addressing hash table of the names of a schema or of a model. It is filled once by Schema_BuildIndex and
+never modified afterwards; adding an element to the schema or model frees it, and lookups go back to scanning.*/
+typedef struct SCHEMA_INDEX_TAG
+{
+    size_t mask; /*number of slots - 1, the number of slots being a power of 2*/
+    SCHEMA_INDEX_ENTRY* entries;
+} SCHEMA_INDEX;
+
 typedef struct SCHEMA_MODEL_TYPE_HANDLE_DATA_TAG
 {
     VECTOR_HANDLE methods; /*holds SCHEMA_METHOD_HANDLE*/
@@ -82,6 +113,7 @@ typedef struct SCHEMA_MODEL_TYPE_HANDLE_DATA_TAG
     size_t ActionCount;
     VECTOR_HANDLE models;
     size_t DeviceCount;
+    SCHEMA_INDEX* Index; /*NULL until Schema_BuildIndex, and again after the model changes*/
 } SCHEMA_MODEL_TYPE_HANDLE_DATA;
 
 typedef struct SCHEMA_STRUCT_TYPE_HANDLE_DATA_TAG
@@ -99,10 +131,119 @@ typedef struct SCHEMA_HANDLE_DATA_TAG
     size_t ModelTypeCount;
     SCHEMA_STRUCT_TYPE_HANDLE* StructTypes;
     size_t StructTypeCount;
+    SCHEMA_INDEX* Index; /*NULL until Schema_BuildIndex, and again after a model or struct type is added*/
 } SCHEMA_HANDLE_DATA;
 
 static VECTOR_HANDLE g_schemas = NULL;
 
+/*at most half of the slots are used, so that probe sequences stay short*/
+#define SCHEMA_INDEX_MIN_SLOTS 8
+
+static size_t SchemaIndex_Hash(SCHEMA_INDEX_KIND kind, const char* name, size_t nameLength)
+{
+    /*FNV-1a*/
+    uint32_t hash = 2166136261u ^ (uint32_t)kind;
+    size_t i;
+
+    for (i = 0; i < nameLength; i++)
+    {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+
+    return (size_t)hash;
+}
+
+static SCHEMA_INDEX* SchemaIndex_Create(size_t nameCount)
+{
+    SCHEMA_INDEX* result;
+    size_t slotCount = SCHEMA_INDEX_MIN_SLOTS;
+    size_t malloc_size;
+
+    while ((slotCount < SIZE_MAX / 2) && (slotCount / 2 < nameCount))
+    {
+        slotCount *= 2;
+    }
+
+    malloc_size = safe_add_size_t(sizeof(SCHEMA_INDEX), safe_multiply_size_t(slotCount, sizeof(SCHEMA_INDEX_ENTRY)));
+    if ((slotCount / 2 < nameCount) ||
+        (malloc_size == SIZE_MAX))
+    {
+        result = NULL;
+        LogError("(Error code:%s), too many names: %lu", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ERROR), (unsigned long)nameCount);
+    }
+    else if ((result = (SCHEMA_INDEX*)calloc(1, malloc_size)) == NULL)
+    {
+        LogError("(Error code:%s), size:%zu", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ERROR), malloc_size);
+    }
+    else
+    {
+        /*the slots follow the header in the same allocation*/
+        result->mask = slotCount - 1;
+        result->entries = (SCHEMA_INDEX_ENTRY*)(result + 1);
+    }
+
+    return result;
+}
+
+/*names are unique within a kind (the Schema_Add/Create functions refuse duplicates) and SchemaIndex_Create sized the
+table for all of them, so there always is a free slot*/
+static void SchemaIndex_Add(SCHEMA_INDEX* index, SCHEMA_INDEX_KIND kind, const char* name, void* element)
+{
+    size_t nameLength = strlen(name);
+    size_t slot = SchemaIndex_Hash(kind, name, nameLength) & index->mask;
+
+    while (index->entries[slot].name != NULL)
+    {
+        slot = (slot + 1) & index->mask;
+    }
+
+    index->entries[slot].name = name;
+    index->entries[slot].nameLength = nameLength;
+    index->entries[slot].kind = kind;
+    index->entries[slot].element = element;
+}
+
+/*name does not need to be '\0' terminated, only its first nameLength characters are compared*/
+static void* SchemaIndex_Find(const SCHEMA_INDEX* index, SCHEMA_INDEX_KIND kind, const char* name, size_t nameLength)
+{
+    void* result = NULL;
+    size_t slot = SchemaIndex_Hash(kind, name, nameLength) & index->mask;
+
+    while (index->entries[slot].name != NULL)
+    {
+        const SCHEMA_INDEX_ENTRY* entry = &index->entries[slot];
+        if ((entry->kind == kind) &&
+            (entry->nameLength == nameLength) &&
+            (memcmp(entry->name, name, nameLength) == 0))
+        {
+            result = entry->element;
+            break;
+        }
+        slot = (slot + 1) & index->mask;
+    }
+
+    return result;
+}
+
+static void InvalidateModelIndex(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType)
+{
+    if (modelType->Index != NULL)
+    {
+        free(modelType->Index);
+        modelType->Index = NULL;
+    }
+}
+
+static void InvalidateSchemaIndex(SCHEMA_HANDLE_DATA* schema)
+{
+    if (schema->Index != NULL)
+    {
+        free(schema->Index);
+        schema->Index = NULL;
+    }
+}
+
 static void DestroyProperty(SCHEMA_PROPERTY_HANDLE propertyHandle)
 {
     SCHEMA_PROPERTY_HANDLE_DATA* propertyType = (SCHEMA_PROPERTY_HANDLE_DATA*)propertyHandle;
@@ -253,6 +394,8 @@ static void DestroyModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle)
     VECTOR_clear(modelType->models);
     VECTOR_destroy(modelType->models);
 
+    InvalidateModelIndex(modelType);
+
     free(modelType->Actions);
     free(modelType);
 }
@@ -289,6 +432,7 @@ static SCHEMA_RESULT AddModelProperty(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType,
         else
         {
             SCHEMA_PROPERTY_HANDLE* newProperties;
+            InvalidateModelIndex(modelType);
             size_t realloc_size = safe_multiply_size_t(sizeof(SCHEMA_PROPERTY_HANDLE), safe_add_size_t(modelType->PropertyCount, 1));
             if (realloc_size == SIZE_MAX ||
                 (newProperties = (SCHEMA_PROPERTY_HANDLE*)realloc(modelType->Properties, realloc_size)) == NULL)
@@ -476,6 +620,7 @@ void Schema_Destroy(SCHEMA_HANDLE schemaHandle)
         }
 
         free(schema->StructTypes);
+        InvalidateSchemaIndex(schema);
         free((void*)schema->Namespace);
         free(schema);
 
@@ -493,6 +638,129 @@ void Schema_Destroy(SCHEMA_HANDLE schemaHandle)
     }
 }
 
+static SCHEMA_INDEX* BuildModelIndex(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType)
+{
+    SCHEMA_INDEX* result;
+    size_t nReportedProperties = VECTOR_size(modelType->reportedProperties);
+    size_t nDesiredProperties = VECTOR_size(modelType->desiredProperties);
+    size_t nMethods = VECTOR_size(modelType->methods);
+    size_t nModels = VECTOR_size(modelType->models);
+    size_t nameCount = safe_add_size_t(safe_add_size_t(safe_add_size_t(modelType->PropertyCount, modelType->ActionCount), safe_add_size_t(nReportedProperties, nDesiredProperties)), safe_add_size_t(nMethods, nModels));
+
+    if ((result = SchemaIndex_Create(nameCount)) == NULL)
+    {
+        LogError("unable to create the index of model %s", modelType->Name);
+    }
+    else
+    {
+        size_t i;
+
+        for (i = 0; i < modelType->PropertyCount; i++)
+        {
+            SCHEMA_PROPERTY_HANDLE_DATA* property = (SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i];
+            SchemaIndex_Add(result, SCHEMA_INDEX_PROPERTY, property->PropertyName, property);
+        }
+
+        for (i = 0; i < modelType->ActionCount; i++)
+        {
+            SCHEMA_ACTION_HANDLE_DATA* action = (SCHEMA_ACTION_HANDLE_DATA*)modelType->Actions[i];
+            SchemaIndex_Add(result, SCHEMA_INDEX_ACTION, action->ActionName, action);
+        }
+
+        for (i = 0; i < nReportedProperties; i++)
+        {
+            SCHEMA_REPORTED_PROPERTY_HANDLE* reportedProperty = (SCHEMA_REPORTED_PROPERTY_HANDLE*)VECTOR_element(modelType->reportedProperties, i);
+            SchemaIndex_Add(result, SCHEMA_INDEX_REPORTED_PROPERTY, (*reportedProperty)->reportedPropertyName, reportedProperty);
+        }
+
+        for (i = 0; i < nDesiredProperties; i++)
+        {
+            SCHEMA_DESIRED_PROPERTY_HANDLE* desiredProperty = (SCHEMA_DESIRED_PROPERTY_HANDLE*)VECTOR_element(modelType->desiredProperties, i);
+            SchemaIndex_Add(result, SCHEMA_INDEX_DESIRED_PROPERTY, (*desiredProperty)->desiredPropertyName, desiredProperty);
+        }
+
+        for (i = 0; i < nMethods; i++)
+        {
+            SCHEMA_METHOD_HANDLE* method = (SCHEMA_METHOD_HANDLE*)VECTOR_element(modelType->methods, i);
+            SchemaIndex_Add(result, SCHEMA_INDEX_METHOD, (*method)->methodName, method);
+        }
+
+        for (i = 0; i < nModels; i++)
+        {
+            MODEL_IN_MODEL* modelInModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
+            SchemaIndex_Add(result, SCHEMA_INDEX_MODEL_IN_MODEL, modelInModel->propertyName, modelInModel);
+        }
+    }
+
+    return result;
+}
+
+SCHEMA_RESULT Schema_BuildIndex(SCHEMA_HANDLE schemaHandle)
+{
+    SCHEMA_RESULT result;
+
+    if (schemaHandle == NULL)
+    {
+        result = SCHEMA_INVALID_ARG;
+        LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, result));
+    }
+    else
+    {
+        SCHEMA_HANDLE_DATA* schema = (SCHEMA_HANDLE_DATA*)schemaHandle;
+        size_t i;
+
+        /*start over, so that calling Schema_BuildIndex again after adding elements picks them up*/
+        InvalidateSchemaIndex(schema);
+        for (i = 0; i < schema->ModelTypeCount; i++)
+        {
+            InvalidateModelIndex((SCHEMA_MODEL_TYPE_HANDLE_DATA*)schema->ModelTypes[i]);
+        }
+
+        if ((schema->Index = SchemaIndex_Create(safe_add_size_t(schema->ModelTypeCount, schema->StructTypeCount))) == NULL)
+        {
+            result = SCHEMA_ERROR;
+            LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, result));
+        }
+        else
+        {
+            for (i = 0; i < schema->StructTypeCount; i++)
+            {
+                SCHEMA_STRUCT_TYPE_HANDLE_DATA* structType = (SCHEMA_STRUCT_TYPE_HANDLE_DATA*)schema->StructTypes[i];
+                SchemaIndex_Add(schema->Index, SCHEMA_INDEX_STRUCT_TYPE, structType->Name, structType);
+            }
+
+            for (i = 0; i < schema->ModelTypeCount; i++)
+            {
+                SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)schema->ModelTypes[i];
+                SchemaIndex_Add(schema->Index, SCHEMA_INDEX_MODEL_TYPE, modelType->Name, modelType);
+
+                if ((modelType->Index = BuildModelIndex(modelType)) == NULL)
+                {
+                    break;
+                }
+            }
+
+            if (i < schema->ModelTypeCount)
+            {
+                /*lookups keep working without the index, they are just slower*/
+                InvalidateSchemaIndex(schema);
+                for (i = 0; i < schema->ModelTypeCount; i++)
+                {
+                    InvalidateModelIndex((SCHEMA_MODEL_TYPE_HANDLE_DATA*)schema->ModelTypes[i]);
+                }
+                result = SCHEMA_ERROR;
+                LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, result));
+            }
+            else
+            {
+                result = SCHEMA_OK;
+            }
+        }
+    }
+
+    return result;
+}
+
 SCHEMA_RESULT Schema_DestroyIfUnused(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle)
 {
     SCHEMA_RESULT result;
@@ -609,6 +877,7 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_CreateModelType(SCHEMA_HANDLE schemaHandle, cons
         {
             SCHEMA_MODEL_TYPE_HANDLE* newModelTypes;
             size_t realloc_size = safe_multiply_size_t(sizeof(SCHEMA_MODEL_TYPE_HANDLE), safe_add_size_t(schema->ModelTypeCount, 1));
+            InvalidateSchemaIndex(schema);
             if (realloc_size == SIZE_MAX ||
                 (newModelTypes = (SCHEMA_MODEL_TYPE_HANDLE*)realloc(schema->ModelTypes, realloc_size)) == NULL)
             {
@@ -765,6 +1034,7 @@ SCHEMA_RESULT Schema_AddModelReportedProperty(SCHEMA_MODEL_TYPE_HANDLE modelType
         }
         else
         {
+            InvalidateModelIndex(modelType);
             SCHEMA_REPORTED_PROPERTY_HANDLE_DATA* reportedProperty = (SCHEMA_REPORTED_PROPERTY_HANDLE_DATA*)malloc(sizeof(SCHEMA_REPORTED_PROPERTY_HANDLE_DATA));
             if (reportedProperty == NULL)
             {
@@ -843,6 +1113,7 @@ SCHEMA_ACTION_HANDLE Schema_CreateModelAction(SCHEMA_MODEL_TYPE_HANDLE modelType
         {
             SCHEMA_ACTION_HANDLE* newActions;
             size_t realloc_size = safe_multiply_size_t(sizeof(SCHEMA_ACTION_HANDLE), safe_add_size_t(modelType->ActionCount, 1));
+            InvalidateModelIndex(modelType);
             if (realloc_size == SIZE_MAX ||
                 (newActions = (SCHEMA_ACTION_HANDLE*)realloc(modelType->Actions, realloc_size)) == NULL)
             {
@@ -933,6 +1204,7 @@ SCHEMA_METHOD_HANDLE Schema_CreateModelMethod(SCHEMA_MODEL_TYPE_HANDLE modelType
         }
         else
         {
+            InvalidateModelIndex(modelTypeHandle);
             result = malloc(sizeof(SCHEMA_METHOD_HANDLE_DATA));
             if (result == NULL)
             {
@@ -1168,26 +1440,37 @@ SCHEMA_PROPERTY_HANDLE Schema_GetModelPropertyByName(SCHEMA_MODEL_TYPE_HANDLE mo
     }
     else
     {
-        size_t i;
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
-        for (i = 0; i < modelType->PropertyCount; i++)
+        if (modelType->Index != NULL)
         {
-            SCHEMA_PROPERTY_HANDLE_DATA* modelProperty = (SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i];
-            if (strcmp(modelProperty->PropertyName, propertyName) == 0)
+            if ((result = (SCHEMA_PROPERTY_HANDLE)SchemaIndex_Find(modelType->Index, SCHEMA_INDEX_PROPERTY, propertyName, strlen(propertyName))) == NULL)
             {
-                break;
+                LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
             }
         }
-
-        if (i == modelType->PropertyCount)
-        {
-            result = NULL;
-            LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
-        }
         else
         {
-            result = (SCHEMA_PROPERTY_HANDLE)(modelType->Properties[i]);
+            size_t i;
+
+            for (i = 0; i < modelType->PropertyCount; i++)
+            {
+                SCHEMA_PROPERTY_HANDLE_DATA* modelProperty = (SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i];
+                if (strcmp(modelProperty->PropertyName, propertyName) == 0)
+                {
+                    break;
+                }
+            }
+
+            if (i == modelType->PropertyCount)
+            {
+                result = NULL;
+                LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
+            }
+            else
+            {
+                result = (SCHEMA_PROPERTY_HANDLE)(modelType->Properties[i]);
+            }
         }
     }
 
@@ -1249,7 +1532,16 @@ SCHEMA_REPORTED_PROPERTY_HANDLE Schema_GetModelReportedPropertyByName(SCHEMA_MOD
     else
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-        if((result = VECTOR_find_if(modelType->reportedProperties, reportedPropertyExists, reportedPropertyName))==NULL)
+        if (modelType->Index != NULL)
+        {
+            result = (SCHEMA_REPORTED_PROPERTY_HANDLE)SchemaIndex_Find(modelType->Index, SCHEMA_INDEX_REPORTED_PROPERTY, reportedPropertyName, strlen(reportedPropertyName));
+        }
+        else
+        {
+            result = VECTOR_find_if(modelType->reportedProperties, reportedPropertyExists, reportedPropertyName);
+        }
+
+        if (result == NULL)
         {
             LogError("a reported property with name \"%s\" does not exist", reportedPropertyName);
         }
@@ -1316,26 +1608,37 @@ SCHEMA_ACTION_HANDLE Schema_GetModelActionByName(SCHEMA_MODEL_TYPE_HANDLE modelT
     }
     else
     {
-        size_t i;
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
-        for (i = 0; i < modelType->ActionCount; i++)
+        if (modelType->Index != NULL)
         {
-            SCHEMA_ACTION_HANDLE_DATA* modelAction = (SCHEMA_ACTION_HANDLE_DATA*)modelType->Actions[i];
-            if (strcmp(modelAction->ActionName, actionName) == 0)
+            if ((result = (SCHEMA_ACTION_HANDLE)SchemaIndex_Find(modelType->Index, SCHEMA_INDEX_ACTION, actionName, strlen(actionName))) == NULL)
             {
-                break;
+                LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
             }
         }
-
-        if (i == modelType->ActionCount)
-        {
-            result = NULL;
-            LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
-        }
         else
         {
-            result = modelType->Actions[i];
+            size_t i;
+
+            for (i = 0; i < modelType->ActionCount; i++)
+            {
+                SCHEMA_ACTION_HANDLE_DATA* modelAction = (SCHEMA_ACTION_HANDLE_DATA*)modelType->Actions[i];
+                if (strcmp(modelAction->ActionName, actionName) == 0)
+                {
+                    break;
+                }
+            }
+
+            if (i == modelType->ActionCount)
+            {
+                result = NULL;
+                LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
+            }
+            else
+            {
+                result = modelType->Actions[i];
+            }
         }
     }
 
@@ -1362,7 +1665,15 @@ SCHEMA_METHOD_HANDLE Schema_GetModelMethodByName(SCHEMA_MODEL_TYPE_HANDLE modelT
     }
     else
     {
-        SCHEMA_METHOD_HANDLE* found = VECTOR_find_if(modelTypeHandle->methods, matchModelMethod, methodName);
+        SCHEMA_METHOD_HANDLE* found;
+        if (modelTypeHandle->Index != NULL)
+        {
+            found = (SCHEMA_METHOD_HANDLE*)SchemaIndex_Find(modelTypeHandle->Index, SCHEMA_INDEX_METHOD, methodName, strlen(methodName));
+        }
+        else
+        {
+            found = VECTOR_find_if(modelTypeHandle->methods, matchModelMethod, methodName);
+        }
         if (found == NULL)
         {
             LogError("no such method by name = %s", methodName);
@@ -1659,6 +1970,7 @@ SCHEMA_STRUCT_TYPE_HANDLE Schema_CreateStructType(SCHEMA_HANDLE schemaHandle, co
         {
             SCHEMA_STRUCT_TYPE_HANDLE* newStructTypes;
             size_t realloc_size = safe_multiply_size_t(sizeof(SCHEMA_STRUCT_TYPE_HANDLE), safe_add_size_t(schema->StructTypeCount, 1));
+            InvalidateSchemaIndex(schema);
             if (realloc_size == SIZE_MAX ||
                 (newStructTypes = (SCHEMA_STRUCT_TYPE_HANDLE*)realloc(schema->StructTypes, realloc_size)) == NULL)
             {
@@ -1767,6 +2079,13 @@ SCHEMA_STRUCT_TYPE_HANDLE Schema_GetStructTypeByName(SCHEMA_HANDLE schemaHandle,
         result = NULL;
         LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_INVALID_ARG));
     }
+    else if (schema->Index != NULL)
+    {
+        if ((result = (SCHEMA_STRUCT_TYPE_HANDLE)SchemaIndex_Find(schema->Index, SCHEMA_INDEX_STRUCT_TYPE, name, strlen(name))) == NULL)
+        {
+            LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
+        }
+    }
     else
     {
         size_t i;
@@ -2065,22 +2384,29 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelByName(SCHEMA_HANDLE schemaHandle, const
     else
     {
         SCHEMA_HANDLE_DATA* schema = (SCHEMA_HANDLE_DATA*)schemaHandle;
-        size_t i;
-        for (i = 0; i < schema->ModelTypeCount; i++)
-        {
-            SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)schema->ModelTypes[i];
-            if (strcmp(modelName, modelType->Name)==0)
-            {
-                break;
-            }
-        }
-        if (i == schema->ModelTypeCount)
+        if (schema->Index != NULL)
         {
-            result = NULL;
+            result = (SCHEMA_MODEL_TYPE_HANDLE)SchemaIndex_Find(schema->Index, SCHEMA_INDEX_MODEL_TYPE, modelName, strlen(modelName));
         }
         else
         {
-            result = schema->ModelTypes[i];
+            size_t i;
+            for (i = 0; i < schema->ModelTypeCount; i++)
+            {
+                SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)schema->ModelTypes[i];
+                if (strcmp(modelName, modelType->Name)==0)
+                {
+                    break;
+                }
+            }
+            if (i == schema->ModelTypeCount)
+            {
+                result = NULL;
+            }
+            else
+            {
+                result = schema->ModelTypes[i];
+            }
         }
     }
     return result;
@@ -2136,6 +2462,7 @@ SCHEMA_RESULT Schema_AddModelModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, con
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* parentModel = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         MODEL_IN_MODEL temp;
+        InvalidateModelIndex(parentModel);
         temp.modelHandle = modelType;
         temp.offset = offset;
         temp.onDesiredProperty = onDesiredProperty;
@@ -2188,6 +2515,20 @@ static bool matchModelName(const void* element, const void* value)
     return (strcmp(decodedElement->propertyName, name) == 0);
 }
 
+static MODEL_IN_MODEL* FindModelInModel(SCHEMA_MODEL_TYPE_HANDLE_DATA* model, const char* propertyName)
+{
+    MODEL_IN_MODEL* result;
+    if (model->Index != NULL)
+    {
+        result = (MODEL_IN_MODEL*)SchemaIndex_Find(model->Index, SCHEMA_INDEX_MODEL_IN_MODEL, propertyName, strlen(propertyName));
+    }
+    else
+    {
+        result = (MODEL_IN_MODEL*)VECTOR_find_if(model->models, matchModelName, propertyName);
+    }
+    return result;
+}
+
 SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelModelByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* propertyName)
 {
     SCHEMA_MODEL_TYPE_HANDLE result;
@@ -2201,8 +2542,7 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelModelByName(SCHEMA_MODEL_TYPE_HANDLE mod
     }
     else
     {
-        SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        void* temp = FindModelInModel((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle, propertyName);
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2229,8 +2569,7 @@ size_t Schema_GetModelModelByName_Offset(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandl
     }
     else
     {
-        SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        void* temp = FindModelInModel((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle, propertyName);
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2257,8 +2596,7 @@ pfOnDesiredProperty Schema_GetModelModelByName_OnDesiredProperty(SCHEMA_MODEL_TY
     }
     else
     {
-        SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        void* temp = FindModelInModel((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle, propertyName);
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2349,6 +2687,35 @@ const char* Schema_GetModelModelPropertyNameByIndex(SCHEMA_MODEL_TYPE_HANDLE mod
     return result;
 }
 
+/*FindModelInModelByPathSegment returns the model in model named by the first nameLength characters of name, or NULL*/
+static MODEL_IN_MODEL* FindModelInModelByPathSegment(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* name, size_t nameLength)
+{
+    MODEL_IN_MODEL* result = NULL;
+
+    if (modelType->Index != NULL)
+    {
+        result = (MODEL_IN_MODEL*)SchemaIndex_Find(modelType->Index, SCHEMA_INDEX_MODEL_IN_MODEL, name, nameLength);
+    }
+    else
+    {
+        size_t i;
+        size_t modelCount = VECTOR_size(modelType->models);
+        for (i = 0; i < modelCount; i++)
+        {
+            MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
+            if (childModel != NULL &&
+                (strncmp(childModel->propertyName, name, nameLength) == 0) &&
+                (strlen(childModel->propertyName) == nameLength))
+            {
+                result = childModel;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
 bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* propertyPath)
 {
     bool result;
@@ -2362,6 +2729,7 @@ bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
     else
     {
         const char* slashPos;
+
         result = false;
 
         if (*propertyPath == '/')
@@ -2372,8 +2740,7 @@ bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
         do
         {
             const char* endPos;
-            size_t i;
-            size_t modelCount;
+            MODEL_IN_MODEL* childModel;
             SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
             slashPos = strchr(propertyPath, '/');
@@ -2384,22 +2751,10 @@ bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
             }
 
             /* get the child-model */
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
+            if ((childModel = FindModelInModelByPathSegment(modelType, propertyPath, (size_t)(endPos - propertyPath))) != NULL)
             {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if (childModel != NULL &&
-                    (strncmp(childModel->propertyName, propertyPath, endPos - propertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - propertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
+                modelTypeHandle = childModel->modelHandle;
 
-            if (i < modelCount)
-            {
                 /* model found, check if there is more in the path */
                 if (slashPos == NULL)
                 {
@@ -2416,18 +2771,25 @@ bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
             else
             {
                 /* no model found, let's see if this is a property */
-                for (i = 0; i < modelType->PropertyCount; i++)
+                if (modelType->Index != NULL)
                 {
-                    SCHEMA_PROPERTY_HANDLE_DATA* property = (SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i];
-                    if ((strncmp(property->PropertyName, propertyPath, endPos - propertyPath) == 0) &&
-                        (strlen(property->PropertyName) == (size_t)(endPos - propertyPath)))
+                    result = (SchemaIndex_Find(modelType->Index, SCHEMA_INDEX_PROPERTY, propertyPath, (size_t)(endPos - propertyPath)) != NULL);
+                }
+                else
+                {
+                    size_t i;
+                    for (i = 0; i < modelType->PropertyCount; i++)
                     {
-                        /* found property */
-                        result = true;
-                        break;
+                        SCHEMA_PROPERTY_HANDLE_DATA* property = (SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i];
+                        if ((strncmp(property->PropertyName, propertyPath, endPos - propertyPath) == 0) &&
+                            (strlen(property->PropertyName) == (size_t)(endPos - propertyPath)))
+                        {
+                            /* found property */
+                            result = true;
+                            break;
+                        }
                     }
                 }
-
                 break;
             }
         } while (slashPos != NULL);
@@ -2460,8 +2822,7 @@ bool Schema_ModelReportedPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelType
         do
         {
             const char* endPos;
-            size_t i;
-            size_t modelCount;
+            MODEL_IN_MODEL* childModel;
             SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
             slashPos = strchr(reportedPropertyPath, '/');
@@ -2471,22 +2832,11 @@ bool Schema_ModelReportedPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelType
                 endPos = &reportedPropertyPath[strlen(reportedPropertyPath)];
             }
 
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
+            /* get the child-model */
+            if ((childModel = FindModelInModelByPathSegment(modelType, reportedPropertyPath, (size_t)(endPos - reportedPropertyPath))) != NULL)
             {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if (childModel != NULL &&
-                    (strncmp(childModel->propertyName, reportedPropertyPath, endPos - reportedPropertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - reportedPropertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
+                modelTypeHandle = childModel->modelHandle;
 
-            if (i < modelCount)
-            {
                 /* model found, check if there is more in the path */
                 if (slashPos == NULL)
                 {
@@ -2503,7 +2853,14 @@ bool Schema_ModelReportedPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelType
             else
             {
                 /* no model found, let's see if this is a property */
-                result = (VECTOR_find_if(modelType->reportedProperties, reportedPropertyExists, reportedPropertyPath) != NULL);
+                if (modelType->Index != NULL)
+                {
+                    result = (SchemaIndex_Find(modelType->Index, SCHEMA_INDEX_REPORTED_PROPERTY, reportedPropertyPath, strlen(reportedPropertyPath)) != NULL);
+                }
+                else
+                {
+                    result = (VECTOR_find_if(modelType->reportedProperties, reportedPropertyExists, reportedPropertyPath) != NULL);
+                }
                 if (!result)
                 {
                     LogError("no such reported property \"%s\"", reportedPropertyPath);
@@ -2548,7 +2905,9 @@ SCHEMA_RESULT Schema_AddModelDesiredProperty(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
         }
         else
         {
-            SCHEMA_DESIRED_PROPERTY_HANDLE_DATA* desiredProperty = (SCHEMA_DESIRED_PROPERTY_HANDLE_DATA*)calloc(1, sizeof(SCHEMA_DESIRED_PROPERTY_HANDLE_DATA));
+            SCHEMA_DESIRED_PROPERTY_HANDLE_DATA* desiredProperty;
+            InvalidateModelIndex(handleData);
+            desiredProperty = (SCHEMA_DESIRED_PROPERTY_HANDLE_DATA*)calloc(1, sizeof(SCHEMA_DESIRED_PROPERTY_HANDLE_DATA));
             if (desiredProperty == NULL)
             {
                 LogError("failure in malloc");
@@ -2633,7 +2992,15 @@ SCHEMA_DESIRED_PROPERTY_HANDLE Schema_GetModelDesiredPropertyByName(SCHEMA_MODEL
     else
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* handleData = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-        SCHEMA_DESIRED_PROPERTY_HANDLE* temp = VECTOR_find_if(handleData->desiredProperties, desiredPropertyExists, desiredPropertyName);
+        SCHEMA_DESIRED_PROPERTY_HANDLE* temp;
+        if (handleData->Index != NULL)
+        {
+            temp = (SCHEMA_DESIRED_PROPERTY_HANDLE*)SchemaIndex_Find(handleData->Index, SCHEMA_INDEX_DESIRED_PROPERTY, desiredPropertyName, strlen(desiredPropertyName));
+        }
+        else
+        {
+            temp = VECTOR_find_if(handleData->desiredProperties, desiredPropertyExists, desiredPropertyName);
+        }
         if (temp == NULL)
         {
             LogError("no such desired property by name %s", desiredPropertyName);
@@ -2675,6 +3042,7 @@ SCHEMA_DESIRED_PROPERTY_HANDLE Schema_GetModelDesiredPropertyByIndex(SCHEMA_MODE
 bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* desiredPropertyPath)
 {
     bool result;
+
     if (
         (modelTypeHandle == NULL) ||
         (desiredPropertyPath == NULL)
@@ -2697,8 +3065,7 @@ bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
         do
         {
             const char* endPos;
-            size_t i;
-            size_t modelCount;
+            MODEL_IN_MODEL* childModel;
             SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
             slashPos = strchr(desiredPropertyPath, '/');
@@ -2708,22 +3075,11 @@ bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
                 endPos = &desiredPropertyPath[strlen(desiredPropertyPath)];
             }
 
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
+            /* get the child-model */
+            if ((childModel = FindModelInModelByPathSegment(modelType, desiredPropertyPath, (size_t)(endPos - desiredPropertyPath))) != NULL)
             {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if (childModel != NULL &&
-                    (strncmp(childModel->propertyName, desiredPropertyPath, endPos - desiredPropertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - desiredPropertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
+                modelTypeHandle = childModel->modelHandle;
 
-            if (i < modelCount)
-            {
                 /* model found, check if there is more in the path */
                 if (slashPos == NULL)
                 {
@@ -2740,7 +3096,14 @@ bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
             else
             {
                 /* no model found, let's see if this is a property */
-                result = (VECTOR_find_if(modelType->desiredProperties, desiredPropertyExists, desiredPropertyPath) != NULL);
+                if (modelType->Index != NULL)
+                {
+                    result = (SchemaIndex_Find(modelType->Index, SCHEMA_INDEX_DESIRED_PROPERTY, desiredPropertyPath, strlen(desiredPropertyPath)) != NULL);
+                }
+                else
+                {
+                    result = (VECTOR_find_if(modelType->desiredProperties, desiredPropertyExists, desiredPropertyPath) != NULL);
+                }
                 if (!result)
                 {
                     LogError("no such desired property \"%s\"", desiredPropertyPath);
@@ -2749,6 +3112,7 @@ bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
             }
         } while (slashPos != NULL);
     }
+
     return result;
 }
 
@@ -2822,6 +3186,46 @@ static bool modelInModelExists(const void* element, const void* value)
     return (strcmp(modelInModel->propertyName, value) == 0);
 }
 
+/*same search order as the linear search in Schema_GetModelElementByName*/
+static SCHEMA_MODEL_ELEMENT GetIndexedModelElement(const SCHEMA_INDEX* index, const char* elementName)
+{
+    SCHEMA_MODEL_ELEMENT result;
+    size_t elementNameLength = strlen(elementName);
+    void* element;
+
+    if ((element = SchemaIndex_Find(index, SCHEMA_INDEX_DESIRED_PROPERTY, elementName, elementNameLength)) != NULL)
+    {
+        result.elementType = SCHEMA_DESIRED_PROPERTY;
+        result.elementHandle.desiredPropertyHandle = *(SCHEMA_DESIRED_PROPERTY_HANDLE*)element;
+    }
+    else if ((element = SchemaIndex_Find(index, SCHEMA_INDEX_PROPERTY, elementName, elementNameLength)) != NULL)
+    {
+        result.elementType = SCHEMA_PROPERTY;
+        result.elementHandle.propertyHandle = (SCHEMA_PROPERTY_HANDLE)element;
+    }
+    else if ((element = SchemaIndex_Find(index, SCHEMA_INDEX_REPORTED_PROPERTY, elementName, elementNameLength)) != NULL)
+    {
+        result.elementType = SCHEMA_REPORTED_PROPERTY;
+        result.elementHandle.reportedPropertyHandle = *(SCHEMA_REPORTED_PROPERTY_HANDLE*)element;
+    }
+    else if ((element = SchemaIndex_Find(index, SCHEMA_INDEX_ACTION, elementName, elementNameLength)) != NULL)
+    {
+        result.elementType = SCHEMA_MODEL_ACTION;
+        result.elementHandle.actionHandle = (SCHEMA_ACTION_HANDLE)element;
+    }
+    else if ((element = SchemaIndex_Find(index, SCHEMA_INDEX_MODEL_IN_MODEL, elementName, elementNameLength)) != NULL)
+    {
+        result.elementType = SCHEMA_MODEL_IN_MODEL;
+        result.elementHandle.modelHandle = ((MODEL_IN_MODEL*)element)->modelHandle;
+    }
+    else
+    {
+        result.elementType = SCHEMA_NOT_FOUND;
+    }
+
+    return result;
+}
+
 SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* elementName)
 {
     SCHEMA_MODEL_ELEMENT result;
@@ -2833,6 +3237,10 @@ SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE model
         LogError("invalid argument SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle=%p, const char* elementName=%p", modelTypeHandle, elementName);
         result.elementType = SCHEMA_SEARCH_INVALID_ARG;
     }
+    else if (modelTypeHandle->Index != NULL)
+    {
+        result = GetIndexedModelElement(modelTypeHandle->Index, elementName);
+    }
     else
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* handleData = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
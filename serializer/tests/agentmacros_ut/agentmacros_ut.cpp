@@ -149,6 +149,9 @@ public:
     MOCK_STATIC_METHOD_1(, void, Destroy_AGENT_DATA_TYPE, AGENT_DATA_TYPE*, agentData)
     MOCK_VOID_METHOD_END()
 
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_ToString, STRING_HANDLE, destination, const AGENT_DATA_TYPE*, value)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, (BASEIMPLEMENTATION::STRING_concat(destination, "0") == 0) ? AGENT_DATA_TYPES_OK : AGENT_DATA_TYPES_ERROR)
+
     /* IOT action functions */
     MOCK_STATIC_METHOD_3(, EXECUTE_COMMAND_RESULT, lotsOfAction, modelWithAction*, device, double, x, ascii_char_ptr, y)
     MOCK_METHOD_END(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS)
@@ -255,6 +258,7 @@ DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , AGENT_DATA_TYPES_RESULT, Create_
 DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , AGENT_DATA_TYPES_RESULT, Create_AGENT_DATA_TYPE_from_charz_no_quotes, AGENT_DATA_TYPE*, agentData, const char*, v);
 DECLARE_GLOBAL_MOCK_METHOD_5(AgentMacroMocks, , AGENT_DATA_TYPES_RESULT, Create_AGENT_DATA_TYPE_from_Members, AGENT_DATA_TYPE*, agentData, const char*, typeName, size_t, nMembers, const char* const *, memberNames, const AGENT_DATA_TYPE*, memberValues);
 DECLARE_GLOBAL_MOCK_METHOD_1(AgentMacroMocks, , void, Destroy_AGENT_DATA_TYPE, AGENT_DATA_TYPE*, agentData);
+DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_ToString, STRING_HANDLE, destination, const AGENT_DATA_TYPE*, value);
 DECLARE_GLOBAL_MOCK_METHOD_3(AgentMacroMocks, , EXECUTE_COMMAND_RESULT, lotsOfAction, modelWithAction*, device, double, x, ascii_char_ptr, y);
 DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , EXECUTE_COMMAND_RESULT, simpleAction, modelWithEachElement*, device, int, actionArg1);
 DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , SCHEMA_HANDLE, CodeFirst_RegisterSchema, const char*, schemaNamespace, const REFLECTED_DATA_FROM_DATAPROVIDER*, metadata);
@@ -289,6 +293,19 @@ CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destin
     return g_SendResult;
 }
 
+CODEFIRST_RESULT CodeFirst_SendAsyncDirect(unsigned char** destination, size_t* destinationSize, size_t numProperties, ...)
+{
+    (void)destination;
+    (void)destinationSize;
+
+    g_NumProperties = numProperties;
+    va_list argptr;
+    va_start(argptr, numProperties);
+    va_end(argptr);
+
+    return g_SendResult;
+}
+
 /* Helpers */
 
 namespace
@@ -711,6 +728,127 @@ BEGIN_TEST_SUITE(AgentMacros_ut)
         ASSERT_ARE_EQUAL(int, 7777, result);
     }
 
+    TEST_FUNCTION(ToJSON_Struct_with_valid_args_writes_the_fields_in_declaration_order)
+    {
+        // arrange
+        AgentMacroMocks macroMocks;
+        multifieldStruct multi = { (char*)"hello", 77, { 42 } };
+        STRING_HANDLE json = BASEIMPLEMENTATION::STRING_new();
+
+        STRICT_EXPECTED_CALL(macroMocks, AgentDataTypes_ToString(json, NULL))
+            .IgnoreArgument(2);
+        STRICT_EXPECTED_CALL(macroMocks, Create_AGENT_DATA_TYPE_from_SINT32(NULL, multi.value))
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(macroMocks, AgentDataTypes_ToString(json, NULL))
+            .IgnoreArgument(2);
+        STRICT_EXPECTED_CALL(macroMocks, Create_AGENT_DATA_TYPE_from_SINT32(NULL, multi.sub.value))
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(macroMocks, AgentDataTypes_ToString(json, NULL))
+            .IgnoreArgument(2);
+        EXPECTED_CALL(macroMocks, STRING_concat(json, NULL))
+            .ExpectedTimesExactly(8);
+
+        // act
+        AGENT_DATA_TYPES_RESULT result = ToJSON_multifieldStruct(json, &multi);
+
+        // assert
+        ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, "{\"name\":0, \"value\":0, \"sub\":{\"value\":0}}", BASEIMPLEMENTATION::STRING_c_str(json));
+        macroMocks.AssertActualAndExpectedCalls();
+
+        // cleanup
+        BASEIMPLEMENTATION::STRING_delete(json);
+    }
+
+    TEST_FUNCTION(ToJSON_Struct_fails_when_a_field_cannot_be_encoded)
+    {
+        // arrange
+        AgentMacroMocks macroMocks;
+        multifieldStruct multi = { NULL, 77, { 42 } };
+        STRING_HANDLE json = BASEIMPLEMENTATION::STRING_new();
+
+        // act
+        AGENT_DATA_TYPES_RESULT result = ToJSON_multifieldStruct(json, &multi);
+
+        // assert
+        ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, result);
+
+        // cleanup
+        BASEIMPLEMENTATION::STRING_delete(json);
+    }
+
+    TEST_FUNCTION(ToJSON_Struct_fails_when_STRING_concat_fails)
+    {
+        // arrange
+        AgentMacroMocks macroMocks;
+        multifieldStruct multi = { (char*)"hello", 77, { 42 } };
+        STRING_HANDLE json = BASEIMPLEMENTATION::STRING_new();
+        whenShallSTRING_concat_fail = 1;
+
+        // act
+        AGENT_DATA_TYPES_RESULT result = ToJSON_multifieldStruct(json, &multi);
+
+        // assert
+        ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, result);
+
+        // cleanup
+        BASEIMPLEMENTATION::STRING_delete(json);
+    }
+
+    TEST_FUNCTION(DECLARE_MODEL_generates_an_encoder_for_each_WITH_DATA_in_declaration_order)
+    {
+        // arrange
+
+        // act
+        const REFLECTION_PROPERTY_ENCODER* encoders = GetPropertyEncoders_SimpleDevice();
+
+        // assert
+        ASSERT_ARE_EQUAL(char_ptr, ", \"Speed\":", encoders[0].jsonMember);
+        ASSERT_ARE_EQUAL(size_t, offsetof(SimpleDevice, Speed), encoders[0].offset);
+        ASSERT_IS_NOT_NULL((void*)encoders[0].ToJSON_from_Ptr);
+        ASSERT_ARE_EQUAL(char_ptr, ", \"moreSpeed\":", encoders[1].jsonMember);
+        ASSERT_ARE_EQUAL(size_t, offsetof(SimpleDevice, moreSpeed), encoders[1].offset);
+        ASSERT_IS_NOT_NULL((void*)encoders[1].ToJSON_from_Ptr);
+        ASSERT_IS_NULL(encoders[2].jsonMember);
+    }
+
+    TEST_FUNCTION(DECLARE_MODEL_does_not_generate_encoders_for_actions)
+    {
+        // arrange
+
+        // act
+        const REFLECTION_PROPERTY_ENCODER* encoders = GetPropertyEncoders_modelWithEachElement();
+
+        // assert
+        ASSERT_ARE_EQUAL(char_ptr, ", \"simpleProperty\":", encoders[0].jsonMember);
+        ASSERT_IS_NULL(encoders[1].jsonMember);
+        ASSERT_IS_NULL(GetPropertyEncoders_modelWithAction()[0].jsonMember);
+    }
+
+    TEST_FUNCTION(ToJSON_From_Ptr_Property_encodes_the_property_with_AgentDataTypes_ToString)
+    {
+        // arrange
+        AgentMacroMocks macroMocks;
+        STRING_HANDLE json = BASEIMPLEMENTATION::STRING_new();
+        const int value = 42;
+
+        STRICT_EXPECTED_CALL(macroMocks, Create_AGENT_DATA_TYPE_from_SINT32(NULL, value))
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(macroMocks, AgentDataTypes_ToString(json, NULL))
+            .IgnoreArgument(2)
+            .SetReturn((AGENT_DATA_TYPES_RESULT)7777);
+
+        // act
+        AGENT_DATA_TYPES_RESULT result = ToJSON_From_Ptr_modelWithEachElementsimpleProperty((const void*)&value, json);
+
+        // assert
+        ASSERT_ARE_EQUAL(int, 7777, (int)result);
+        macroMocks.AssertActualAndExpectedCalls();
+
+        // cleanup
+        BASEIMPLEMENTATION::STRING_delete(json);
+    }
+
     TEST_FUNCTION(ActionWRAPPER_function_with_wrong_ParameterCount_arg_should_fail)
     {
         // arrange
@@ -971,6 +1109,22 @@ BEGIN_TEST_SUITE(AgentMacros_ut)
         ASSERT_ARE_EQUAL(size_t, 2, g_NumProperties);
     }
 
+    TEST_FUNCTION(SERIALIZE_DIRECT_With_2_Properties_calls_CodeFirst_SendAsyncDirect)
+    {
+        // arrange
+        AgentMacroMocks macroMocks;
+        SimpleDevice* myDevice = CREATE_MODEL_INSTANCE(schemaWithModel, SimpleDevice);
+        macroMocks.ResetAllCalls();
+
+        // act
+        CODEFIRST_RESULT result = SERIALIZE_DIRECT(NULL, NULL, myDevice->Speed, myDevice->moreSpeed);
+
+        // assert
+        // uMock checks the calls
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(size_t, 2, g_NumProperties);
+    }
+
     TEST_FUNCTION(SEND_With_Model_In_Model_Property_Succeeds)
     {
         // arrange
@@ -3360,6 +3360,8 @@ static const struct testVector {
     { 2014, 6, 18, 13, 15, 59, 0, 11, 1, 2, 13, "\"2014-06-18T13:15:59+02:13\"" },
     /*hasFractionalSeconds = 0, hasTimeZone=1, 2 digit positive time zone hour, 1 digit minute*/
     { 2014, 6, 18, 13, 15, 59, 0, 11, 1, 23, 8, "\"2014-06-18T13:15:59+23:08\"" },
+    /*hasFractionalSeconds = 0, hasTimeZone=1, zero time zone hour and minute*/
+    { 2014, 6, 18, 13, 15, 59, 0, 11, 1, 0, 0, "\"2014-06-18T13:15:59+00:00\"" },
     /*hasFractionalSeconds = 0, hasTimeZone=1, 2 digit positive time zone hour, 2 digit minute*/
 
     /*hasFractionalSeconds = 1, 1 digit fractional second, hasTimeZone=1, 2 digit negative time zone hour, 1 digit minute*/
@@ -4356,6 +4358,32 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(double, TEST_DOUBLE_2, atof(STRING_c_str(global_bufferTemp)));
         }
 
+        TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_produces_the_same_digits_as_printf)
+        {
+            ///arrange
+            static const double values[] = { 0.0, -0.0, 1.0, -1.0, 0.1, -0.1, 0.5, 2.5, 0.0078125, 5e-16, -5e-16, 1.5e-15, 2.5e-15, 1e-300, DBL_MIN,
+                3.14159265358979, 123456789.123456789, 9007199254740993.0, 1e22, 1e23, 1.8446744073709552e19, 1e24, -1e24 };
+
+            for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+            {
+                AGENT_DATA_TYPE ag;
+                char expected[512];
+                (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&ag, values[i]);
+                (void)sprintf_s(expected, sizeof(expected), "%.*f", DBL_DIG, values[i]);
+                STRING_empty(global_bufferTemp);
+
+                ///act
+                auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+                ///assert
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+                ASSERT_ARE_EQUAL(char_ptr, expected, STRING_c_str(global_bufferTemp));
+
+                ///cleanup
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
+
         TEST_FUNCTION(Create_AGENT_DATA_TYPE_from_FLOAT_succeeds_1)
         {
             ///arrange
@@ -4574,6 +4602,32 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(float, TEST_FLOAT_2, (float)atof(STRING_c_str(global_bufferTemp)));
 
         }
+
+        TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_produces_the_same_digits_as_printf)
+        {
+            ///arrange
+            static const float values[] = { 0.0f, -0.0f, 1.0f, -1.0f, 0.1f, -0.1f, 0.5f, 2.5f, 0.0078125f, 5e-7f, -5e-7f, 1.5e-6f, 2.5e-6f, FLT_MIN,
+                3.14159265f, 16777217.0f, 1e20f, 3.4e32f, 1e35f };
+
+            for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+            {
+                AGENT_DATA_TYPE ag;
+                char expected[512];
+                (void)Create_AGENT_DATA_TYPE_from_FLOAT(&ag, values[i]);
+                (void)sprintf_s(expected, sizeof(expected), "%.*f", FLT_DIG, (double)values[i]);
+                STRING_empty(global_bufferTemp);
+
+                ///act
+                auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+                ///assert
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+                ASSERT_ARE_EQUAL(char_ptr, expected, STRING_c_str(global_bufferTemp));
+
+                ///cleanup
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
 #endif
 
         TEST_FUNCTION(Create_AGENT_DATA_TYPE_from_SINT16_succeeds)
@@ -413,6 +413,12 @@ static AGENT_DATA_TYPES_RESULT my_Create_AGENT_DATA_TYPE_from_DOUBLE(AGENT_DATA_
     return AGENT_DATA_TYPES_OK;
 }
 
+static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
+{
+    (void)value;
+    return (real_STRING_concat(destination, "0") == 0) ? AGENT_DATA_TYPES_OK : AGENT_DATA_TYPES_ERROR;
+}
+
 static DEVICE_RESULT my_Device_PublishTransacted(TRANSACTION_HANDLE transactionHandle, const char* propertyName, const AGENT_DATA_TYPE* data)
 {
     (void)transactionHandle;
@@ -768,6 +774,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         REGISTER_GLOBAL_MOCK_HOOK(Device_CancelTransaction, my_Device_CancelTransaction);
         REGISTER_GLOBAL_MOCK_HOOK(Create_AGENT_DATA_TYPE_from_SINT32, my_Create_AGENT_DATA_TYPE_from_SINT32);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(Create_AGENT_DATA_TYPE_from_SINT32, AGENT_DATA_TYPES_JSON_ENCODER_ERRROR);
+        REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_ToString, my_AgentDataTypes_ToString);
 
         REGISTER_GLOBAL_MOCK_RETURN(Schema_Create, TEST_SCHEMA_HANDLE);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(Schema_Create, NULL);
@@ -779,6 +786,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         REGISTER_GLOBAL_MOCK_RETURN(Schema_AddModelProperty, SCHEMA_OK);
         REGISTER_GLOBAL_MOCK_RETURN(Schema_CreateModelAction, TEST1_ACTION_HANDLE);
         REGISTER_GLOBAL_MOCK_RETURN(Schema_AddModelModel, SCHEMA_OK);
+        REGISTER_GLOBAL_MOCK_RETURN(Schema_BuildIndex, SCHEMA_OK);
 
         REGISTER_STRING_GLOBAL_MOCK_HOOK;
 
@@ -2792,6 +2800,208 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         CodeFirst_Deinit();
     }
 
+    /* CodeFirst_SendAsyncDirect */
+
+    TEST_FUNCTION(CodeFirst_SendAsyncDirect_With_One_Property_Writes_The_JSON_Without_A_Transaction)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        unsigned char* destination;
+        size_t destinationSize;
+        const char expectedJSON[] = "{\"this_is_double_Property\":0}";
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_construct("{"));
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "\"this_is_double_Property\":"))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(STRING_length(IGNORED_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_ARG, 42.0))
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_ARG, IGNORED_ARG))
+            .IgnoreArgument_destination()
+            .IgnoreArgument_value();
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "}"))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(STRING_length(IGNORED_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_ARG))
+            .IgnoreArgument_handle();
+        device->this_is_double_Property = 42.0;
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncDirect(&destination, &destinationSize, 1, &device->this_is_double_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, sizeof(expectedJSON) - 1, destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expectedJSON, destination, destinationSize));
+
+        // cleanup
+        free(destination);
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    TEST_FUNCTION(CodeFirst_SendAsyncDirect_2_Properties_Succeeds)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        unsigned char* destination;
+        size_t destinationSize;
+        const char expectedJSON[] = "{\"this_is_int_Property\":0, \"this_is_double_Property\":0}";
+        device->this_is_double_Property = 42.0;
+        device->this_is_int_Property = 1;
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncDirect(&destination, &destinationSize, 2, &device->this_is_int_Property, &device->this_is_double_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(size_t, sizeof(expectedJSON) - 1, destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expectedJSON, destination, destinationSize));
+
+        // cleanup
+        free(destination);
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    TEST_FUNCTION(CodeFirst_SendAsyncDirect_The_Entire_Device_State_In_The_Same_Order_As_CodeFirst_SendAsync)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        unsigned char* destination;
+        size_t destinationSize;
+        const char expectedJSON[] = "{\"this_is_int_Property\":0, \"this_is_double_Property\":0}";
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_construct("{"));
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "\"this_is_int_Property\":"))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(STRING_length(IGNORED_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_ARG, 1))
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_ARG, IGNORED_ARG))
+            .IgnoreArgument_destination()
+            .IgnoreArgument_value();
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, ", \"this_is_double_Property\":"))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_ARG, 42.0))
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_ARG, IGNORED_ARG))
+            .IgnoreArgument_destination()
+            .IgnoreArgument_value();
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "}"))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(STRING_length(IGNORED_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_ARG))
+            .IgnoreArgument_handle();
+        device->this_is_double_Property = 42.0;
+        device->this_is_int_Property = 1;
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncDirect(&destination, &destinationSize, 1, device);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, sizeof(expectedJSON) - 1, destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expectedJSON, destination, destinationSize));
+
+        // cleanup
+        free(destination);
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    TEST_FUNCTION(CodeFirst_SendAsyncDirect_With_A_Property_From_A_Child_Model_Falls_Back_To_The_Transaction)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        OuterType* device = (OuterType*)CodeFirst_CreateDevice(TEST_OUTERTYPE_MODEL_HANDLE, &ALL_REFLECTED(testModelInModelReflected), sizeof(OuterType), false);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
+        STRICT_EXPECTED_CALL(STRING_construct("{"));
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_ARG))
+            .IgnoreArgument_handle();
+
+        STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, IGNORED_ARG))
+            .IgnoreArgument_handle()
+            .IgnoreArgument_s2();
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, IGNORED_ARG))
+            .IgnoreArgument_handle()
+            .IgnoreArgument_s2();
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, IGNORED_ARG))
+            .IgnoreArgument_handle()
+            .IgnoreArgument_s2();
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_ARG, (int32_t)(IGNORED_ARG)));
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_ARG, "Inner/this_is_int2", IGNORED_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(3);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_ARG))
+            .IgnoreArgument_handle();
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_ARG));
+        STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(2)
+            .IgnoreArgument(3);
+        device->Inner.this_is_int2 = 1;
+        unsigned char* destination;
+        size_t destinationSize;
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncDirect(&destination, &destinationSize, 1, &device->Inner.this_is_int2);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    TEST_FUNCTION(CodeFirst_SendAsyncDirect_With_NULL_destination_Fails)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncDirect(NULL, &destinationSize, 1, &device->this_is_double_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
     /* CodeFirst_RegisterSchema */
     TEST_FUNCTION(CodeFirst_RegisterSchema_succeeds)
     {
@@ -2828,6 +3038,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         STRICT_EXPECTED_CALL(Schema_AddModelActionArgument(SETSPEED_ACTION_HANDLE, "theSpeed", "double"));
         STRICT_EXPECTED_CALL(Schema_CreateModelAction(TEST_MODEL_HANDLE, "reset_Action"))
             .SetReturn(RESET_ACTION_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_BuildIndex(TEST_SCHEMA_HANDLE));
 
         ///act
 
@@ -2877,6 +3088,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_INNERTYPE_MODEL_HANDLE, "this_is_double2", "double"));
         STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int"));
         STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_INNERTYPE_MODEL_HANDLE, "this_is_int2", "int"));
+        STRICT_EXPECTED_CALL(Schema_BuildIndex(TEST_SCHEMA_HANDLE));
 
         ///act
         SCHEMA_HANDLE result = CodeFirst_RegisterSchema("TestSchema", &ALL_REFLECTED(testModelInModelReflected));
@@ -2890,6 +3102,57 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
 
     }
 
+    TEST_FUNCTION(When_Schema_BuildIndex_Fails_CodeFirst_RegisterSchema_Still_Succeeds)
+    {
+        static const SCHEMA_STRUCT_TYPE_HANDLE TEST_CAR_BEHIND_VAN_HANDLE = (SCHEMA_STRUCT_TYPE_HANDLE)0x7001;
+
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        umock_c_reset_all_calls();
+        STRICT_EXPECTED_CALL(Schema_GetSchemaByNamespace("TestSchema"));
+        STRICT_EXPECTED_CALL(Schema_Create("TestSchema", IGNORED_ARG))
+            .IgnoreArgument_metadata();
+        STRICT_EXPECTED_CALL(Schema_CreateStructType(TEST_SCHEMA_HANDLE, "theCarIsBehindTheVan_Struct"))
+            .SetReturn(TEST_CAR_BEHIND_VAN_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_AddStructTypeProperty(TEST_CAR_BEHIND_VAN_HANDLE, "whereIsMyCar_Field", "whereIsMyDevice_Struct"));
+        STRICT_EXPECTED_CALL(Schema_AddStructTypeProperty(TEST_CAR_BEHIND_VAN_HANDLE, "Alt_Field", "int"));
+        STRICT_EXPECTED_CALL(Schema_CreateStructType(TEST_SCHEMA_HANDLE, "whereIsMyDevice_Struct"));
+        STRICT_EXPECTED_CALL(Schema_AddStructTypeProperty(TEST_STRUCT_TYPE_HANDLE, "Long_Field", "double"));
+        STRICT_EXPECTED_CALL(Schema_AddStructTypeProperty(TEST_STRUCT_TYPE_HANDLE, "Lat_Field", "double"));
+        STRICT_EXPECTED_CALL(Schema_CreateModelType(TEST_SCHEMA_HANDLE, "SimpleDevice_Model"))
+            .SetReturn(TEST_TRUCKTYPE_MODEL_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_CreateModelType(TEST_SCHEMA_HANDLE, "truckType_Model"));
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "SimpleDevice_Model")).SetReturn(TEST_TRUCKTYPE_MODEL_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "double")).SetReturn(NULL);
+        STRICT_EXPECTED_CALL(Schema_AddModelReportedProperty(TEST_TRUCKTYPE_MODEL_HANDLE, "new_reported_this_is_double", "double"));
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int")).SetReturn(NULL);
+        STRICT_EXPECTED_CALL(Schema_AddModelReportedProperty(TEST_TRUCKTYPE_MODEL_HANDLE, "new_reported_this_is_int", "int"));
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int")).SetReturn(NULL);
+        STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_TRUCKTYPE_MODEL_HANDLE, "this_is_int_Property", "int"));
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "double")).SetReturn(NULL);
+        STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_TRUCKTYPE_MODEL_HANDLE, "this_is_double_Property", "double"));
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "truckType_Model")).SetReturn(TEST_MODEL_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_CreateModelAction(TEST_MODEL_HANDLE, "setSpeed_Action"))
+            .SetReturn(SETSPEED_ACTION_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_AddModelActionArgument(SETSPEED_ACTION_HANDLE, "theSpeed", "double"));
+        STRICT_EXPECTED_CALL(Schema_CreateModelAction(TEST_MODEL_HANDLE, "reset_Action"))
+            .SetReturn(RESET_ACTION_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_BuildIndex(TEST_SCHEMA_HANDLE))
+            .SetReturn(SCHEMA_ERROR);
+
+        ///act
+
+        SCHEMA_HANDLE result = CodeFirst_RegisterSchema("TestSchema", &ALL_REFLECTED(testReflectedData));
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(void_ptr, TEST_SCHEMA_HANDLE, result);
+
+        ///cleanup
+        CodeFirst_Deinit();
+
+    }
+
     TEST_FUNCTION(When_Schema_Create_Fails_Then_CodeFirst_RegisterSchema_Fails)
     {
 
@@ -3754,6 +4017,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_INNERTYPE_MODEL_HANDLE, "this_is_double2_onDesiredProperty", "double"));
         STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int"));
         STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_INNERTYPE_MODEL_HANDLE, "this_is_int2_onDesiredProperty", "int"));
+        STRICT_EXPECTED_CALL(Schema_BuildIndex(TEST_SCHEMA_HANDLE));
 
         ///act
         SCHEMA_HANDLE result = CodeFirst_RegisterSchema("TestSchema", &ALL_REFLECTED(testModelInModelReflected_with_onDesiredProperty));
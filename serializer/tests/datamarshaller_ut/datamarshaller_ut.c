@@ -169,6 +169,23 @@ static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_ToString(STRING_HANDLE destinat
     return AGENT_DATA_TYPES_OK;
 }
 
+static void setup_direct_member_expectations(const char* separator, const char* name, const AGENT_DATA_TYPE* value)
+{
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, separator));
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, name));
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "\":"));
+    STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_ARG, value));
+}
+
+static void setup_direct_payload_end_expectations(void)
+{
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "}"));
+    STRICT_EXPECTED_CALL(STRING_length(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_ARG));
+}
+
 static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 {
     char temp_str[256];
@@ -540,7 +557,7 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
 
-        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid };
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_ARG, IGNORED_ARG))
             .SetReturn((MULTITREE_HANDLE)NULL);
@@ -564,13 +581,13 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
 
-        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid };
 
         STRICT_EXPECTED_CALL(MultiTree_Create(IGNORED_ARG, IGNORED_ARG))
             .IgnoreArgument_cloneFunction()
             .IgnoreArgument_freeFunction();
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid))
             .IgnoreArgument_treeHandle()
             .SetReturn(MULTITREE_ERROR);
 
@@ -598,7 +615,7 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         AGENT_DATA_TYPE floatValid2;
 
         DATA_MARSHALLER_VALUE values[2];
-        values[0].PropertyPath = DEFAULT_PROPERTY_NAME;
+        values[0].PropertyPath = DEFAULT_PROPERTY_NAME_LEVEL2;
         values[0].Value = &floatValid;
 
         values[1].PropertyPath = DEFAULT_PROPERTY_NAME_2;
@@ -606,7 +623,7 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_ARG, IGNORED_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid))
             .IgnoreArgument_treeHandle();
         STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME_2, &floatValid2))
             .IgnoreArgument_treeHandle()
@@ -633,11 +650,11 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         umock_c_reset_all_calls();
         unsigned char* destination;
         size_t destinationSize;
-        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid };
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_ARG, IGNORED_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid))
             .IgnoreArgument_treeHandle();
         STRICT_EXPECTED_CALL(STRING_new());
         EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG))
@@ -671,12 +688,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         unsigned char* destination;
         size_t destinationSize;
         umock_c_reset_all_calls();
-        DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &structTypeValue } };
+        DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &structTypeValue } };
         char json_payload[] = "Test";
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_ARG, IGNORED_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid))
             .IgnoreArgument_treeHandle();
         STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME_2, &structTypeValue))
             .IgnoreArgument_treeHandle();
@@ -721,12 +738,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         unsigned char* destination;
         size_t destinationSize;
         umock_c_reset_all_calls();
-        DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &structTypeValue } };
+        DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &structTypeValue } };
         char json_payload[] = "Test";
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_ARG, IGNORED_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid))
             .IgnoreArgument_treeHandle();
         STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME_2, &structTypeValue))
             .IgnoreArgument_treeHandle();
@@ -768,12 +785,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         unsigned char* destination;
         size_t destinationSize;
         umock_c_reset_all_calls();
-        DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &floatValid } };
+        DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &floatValid } };
         char json_payload[] = "Test";
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_ARG, IGNORED_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid))
             .IgnoreArgument_treeHandle();
         STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME_2, &floatValid))
             .IgnoreArgument_treeHandle();
@@ -815,12 +832,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         unsigned char* destination;
         size_t destinationSize;
         umock_c_reset_all_calls();
-        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid };
         char json_payload[] = "Test";
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_ARG, IGNORED_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME_LEVEL2, &floatValid))
             .IgnoreArgument_treeHandle();
         EXPECTED_CALL(STRING_new());
         EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG))
@@ -861,31 +878,13 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &structTypeValue2Members };
-        char json_payload[] = "Test";
-
-        EXPECTED_CALL(MultiTree_Create(IGNORED_ARG, IGNORED_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, "y", structTypeValue2Members.value.edmComplexType.fields[1].value))
-            .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_ARG, IGNORED_ARG, IGNORED_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
-
-        EXPECTED_CALL(STRING_length(IGNORED_ARG))
-            .SetReturn(strlen(json_payload));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_ARG))
-            .IgnoreArgument_size();
+        const char* expectedPayload = "{\"x\":2.4, \"y\":2.4}";
 
-        EXPECTED_CALL(STRING_c_str(IGNORED_ARG))
-            .SetReturn(json_payload);
-        EXPECTED_CALL(STRING_delete(IGNORED_ARG));
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "{"));
+        setup_direct_member_expectations("\"", "x", structTypeValue2Members.value.edmComplexType.fields[0].value);
+        setup_direct_member_expectations(", \"", "y", structTypeValue2Members.value.edmComplexType.fields[1].value);
+        setup_direct_payload_end_expectations();
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
@@ -893,13 +892,15 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         ///assert
         ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, strlen(expectedPayload), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, expectedPayload, destinationSize));
 
         ///cleanup
         free(destination);
         DataMarshaller_Destroy(handle);
     }
 
-    TEST_FUNCTION(when_adding_the_first_member_of_the_struct_fails_then_senddata_fails)
+    TEST_FUNCTION(when_encoding_the_first_member_of_the_struct_fails_then_senddata_fails)
     {
         ///arrange
         DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, false);
@@ -908,27 +909,27 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &structTypeValue2Members };
 
-        EXPECTED_CALL(MultiTree_Create(IGNORED_ARG, IGNORED_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
-            .IgnoreArgument_treeHandle()
-            .SetReturn(MULTITREE_ERROR);
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "{"));
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "\""));
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "x"));
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "\":"));
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_ARG, structTypeValue2Members.value.edmComplexType.fields[0].value))
+            .SetReturn(AGENT_DATA_TYPES_ERROR);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
 
         ///assert
-        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_JSON_ENCODER_ERROR, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
         ///cleanup
         DataMarshaller_Destroy(handle);
     }
 
-    TEST_FUNCTION(when_adding_the_second_member_of_the_struct_fails_then_senddata_fails)
+    TEST_FUNCTION(when_encoding_the_second_member_of_the_struct_fails_then_senddata_fails)
     {
         ///arrange
         DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, false);
@@ -937,22 +938,19 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &structTypeValue2Members };
 
-        EXPECTED_CALL(MultiTree_Create(IGNORED_ARG, IGNORED_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, "y", structTypeValue2Members.value.edmComplexType.fields[1].value))
-            .IgnoreArgument_treeHandle()
-            .SetReturn(MULTITREE_ERROR);
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "{"));
+        setup_direct_member_expectations("\"", "x", structTypeValue2Members.value.edmComplexType.fields[0].value);
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, ", \""));
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "y"))
+            .SetReturn(MU_FAILURE);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
 
         ///assert
-        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_JSON_ENCODER_ERROR, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
         ///cleanup
@@ -968,14 +966,8 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
 
-        EXPECTED_CALL(MultiTree_Create(IGNORED_ARG, IGNORED_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
         EXPECTED_CALL(STRING_new())
             .SetReturn(NULL);
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_ARG))
-            .IgnoreArgument_treeHandle();
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
@@ -988,6 +980,89 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         DataMarshaller_Destroy(handle);
     }
 
+    TEST_FUNCTION(DataMarshaller_SendData_writes_values_without_nested_paths_directly_to_the_payload)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        unsigned char* destination;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+        DATA_MARSHALLER_VALUE values[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { "/" DEFAULT_PROPERTY_NAME_2, &structTypeValue } };
+        const char* expectedPayload = "{\"" DEFAULT_PROPERTY_NAME "\":2.4, \"" DEFAULT_PROPERTY_NAME_2 "\":2.4}";
+
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "{"));
+        setup_direct_member_expectations("\"", DEFAULT_PROPERTY_NAME, &floatValid);
+        setup_direct_member_expectations(", \"", DEFAULT_PROPERTY_NAME_2, &structTypeValue);
+        setup_direct_payload_end_expectations();
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 2, values, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, strlen(expectedPayload), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, expectedPayload, destinationSize));
+
+        ///cleanup
+        free(destination);
+        DataMarshaller_Destroy(handle);
+    }
+
+    TEST_FUNCTION(DataMarshaller_SendData_with_the_same_name_twice_uses_the_MultiTree)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        unsigned char* destination;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+        DATA_MARSHALLER_VALUE values[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME, &intValid } };
+
+        EXPECTED_CALL(MultiTree_Create(IGNORED_ARG, IGNORED_ARG));
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME, &floatValid));
+        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_ARG, DEFAULT_PROPERTY_NAME, &intValid))
+            .SetReturn(MULTITREE_ALREADY_HAS_A_VALUE);
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_ARG));
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 2, values, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        DataMarshaller_Destroy(handle);
+    }
+
+    TEST_FUNCTION(DataMarshaller_SendData_when_closing_the_directly_written_payload_fails_then_fails)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        unsigned char* destination;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
+
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "{"));
+        setup_direct_member_expectations("\"", DEFAULT_PROPERTY_NAME, &floatValid);
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_ARG, "}"))
+            .SetReturn(MU_FAILURE);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_ARG));
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_JSON_ENCODER_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        DataMarshaller_Destroy(handle);
+    }
+
     TEST_FUNCTION(DataMarshaller_SendData_ReportedProperties_with_NULL_dataMarshallerHandle_fails)
     {
         ///arrange
@@ -6077,4 +6077,145 @@ BEGIN_TEST_SUITE(Schema_ut)
         ///clean
         Schema_Destroy(schemaHandle);
     }
+
+    /* Schema_BuildIndex */
+    TEST_FUNCTION(Schema_BuildIndex_with_NULL_schemaHandle_fails)
+    {
+        ///arrange
+
+        ///act
+        SCHEMA_RESULT result = Schema_BuildIndex(NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_INVALID_ARG, result);
+    }
+
+    static SCHEMA_HANDLE Schema_BuildIndex_create_schema(SCHEMA_MODEL_TYPE_HANDLE* model, SCHEMA_MODEL_TYPE_HANDLE* innerModel)
+    {
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        (void)Schema_CreateStructType(schemaHandle, "GeoLocation");
+        *innerModel = Schema_CreateModelType(schemaHandle, "InnerModel");
+        (void)Schema_AddModelProperty(*innerModel, "innerProperty", "int");
+        *model = Schema_CreateModelType(schemaHandle, "Model");
+        (void)Schema_AddModelProperty(*model, "property", "int");
+        (void)Schema_AddModelReportedProperty(*model, "reportedProperty", "int");
+        (void)Schema_AddModelDesiredProperty(*model, "desiredProperty", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 0, NULL);
+        (void)Schema_CreateModelAction(*model, "action");
+        (void)Schema_CreateModelMethod(*model, "method");
+        (void)Schema_AddModelModel(*model, "inner", *innerModel, 0, NULL);
+        return schemaHandle;
+    }
+
+    TEST_FUNCTION(Schema_BuildIndex_succeeds_and_lookups_do_not_scan)
+    {
+        ///arrange
+        SCHEMA_MODEL_TYPE_HANDLE model;
+        SCHEMA_MODEL_TYPE_HANDLE innerModel;
+        SCHEMA_HANDLE schemaHandle = Schema_BuildIndex_create_schema(&model, &innerModel);
+
+        ///act
+        SCHEMA_RESULT result = Schema_BuildIndex(schemaHandle);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result);
+        umock_c_reset_all_calls();
+        ASSERT_ARE_EQUAL(void_ptr, model, Schema_GetModelByName(schemaHandle, "Model"));
+        ASSERT_ARE_EQUAL(void_ptr, innerModel, Schema_GetModelByName(schemaHandle, "InnerModel"));
+        ASSERT_IS_NULL(Schema_GetModelByName(schemaHandle, "NoSuchModel"));
+        ASSERT_IS_NOT_NULL(Schema_GetStructTypeByName(schemaHandle, "GeoLocation"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelPropertyByName(model, "property"));
+        ASSERT_IS_NULL(Schema_GetModelPropertyByName(model, "reportedProperty"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelReportedPropertyByName(model, "reportedProperty"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelDesiredPropertyByName(model, "desiredProperty"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelActionByName(model, "action"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelMethodByName(model, "method"));
+        ASSERT_ARE_EQUAL(void_ptr, innerModel, Schema_GetModelModelByName(model, "inner"));
+        ASSERT_IS_TRUE(Schema_ModelPropertyByPathExists(model, "inner/innerProperty"));
+        ASSERT_IS_FALSE(Schema_ModelPropertyByPathExists(model, "inner/noSuchProperty"));
+        ASSERT_ARE_EQUAL(char_ptr, "", umock_c_get_actual_calls());
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    TEST_FUNCTION(Schema_BuildIndex_adding_an_element_afterwards_still_finds_it)
+    {
+        ///arrange
+        SCHEMA_MODEL_TYPE_HANDLE model;
+        SCHEMA_MODEL_TYPE_HANDLE innerModel;
+        SCHEMA_HANDLE schemaHandle = Schema_BuildIndex_create_schema(&model, &innerModel);
+        (void)Schema_BuildIndex(schemaHandle);
+
+        ///act
+        (void)Schema_AddModelProperty(model, "lateProperty", "int");
+        (void)Schema_AddModelReportedProperty(model, "lateReportedProperty", "int");
+        SCHEMA_MODEL_TYPE_HANDLE lateModel = Schema_CreateModelType(schemaHandle, "LateModel");
+
+        ///assert
+        ASSERT_IS_NOT_NULL(Schema_GetModelPropertyByName(model, "lateProperty"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelPropertyByName(model, "property"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelReportedPropertyByName(model, "lateReportedProperty"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelReportedPropertyByName(model, "reportedProperty"));
+        ASSERT_ARE_EQUAL(void_ptr, lateModel, Schema_GetModelByName(schemaHandle, "LateModel"));
+        ASSERT_ARE_EQUAL(void_ptr, model, Schema_GetModelByName(schemaHandle, "Model"));
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    TEST_FUNCTION(Schema_BuildIndex_when_gballoc_calloc_fails_it_fails_and_lookups_still_succeed)
+    {
+        ///arrange
+        SCHEMA_MODEL_TYPE_HANDLE model;
+        SCHEMA_MODEL_TYPE_HANDLE innerModel;
+        SCHEMA_HANDLE schemaHandle = Schema_BuildIndex_create_schema(&model, &innerModel);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_calloc(IGNORED_ARG, IGNORED_ARG));
+        STRICT_EXPECTED_CALL(gballoc_calloc(IGNORED_ARG, IGNORED_ARG));
+        STRICT_EXPECTED_CALL(gballoc_calloc(IGNORED_ARG, IGNORED_ARG))
+            .SetReturn(NULL);
+
+        ///act
+        SCHEMA_RESULT result = Schema_BuildIndex(schemaHandle);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_ERROR, result);
+        ASSERT_ARE_EQUAL(void_ptr, model, Schema_GetModelByName(schemaHandle, "Model"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelPropertyByName(model, "property"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelReportedPropertyByName(model, "reportedProperty"));
+        ASSERT_ARE_EQUAL(void_ptr, innerModel, Schema_GetModelModelByName(model, "inner"));
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    TEST_FUNCTION(Schema_BuildIndex_finds_every_property_of_a_large_model)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE model = Schema_CreateModelType(schemaHandle, "Model");
+        char propertyName[32];
+        size_t i;
+        for (i = 0; i < 200; i++)
+        {
+            (void)sprintf(propertyName, "property%u", (unsigned int)i);
+            (void)Schema_AddModelProperty(model, propertyName, "int");
+        }
+
+        ///act
+        SCHEMA_RESULT result = Schema_BuildIndex(schemaHandle);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result);
+        for (i = 0; i < 200; i++)
+        {
+            (void)sprintf(propertyName, "property%u", (unsigned int)i);
+            ASSERT_ARE_EQUAL(void_ptr, Schema_GetModelPropertyByIndex(model, i), Schema_GetModelPropertyByName(model, propertyName));
+        }
+        ASSERT_IS_NULL(Schema_GetModelPropertyByName(model, "property200"));
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
 END_TEST_SUITE(Schema_ut)